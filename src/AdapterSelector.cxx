@@ -0,0 +1,338 @@
+#include "AdapterSelector.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	// Whole-string decimal index; anything else ("1x", out of range) is matched as a name.
+	bool parseIndex(const std::string& arg_Text, size_t& arg_Index)
+	{
+		if (arg_Text.empty() || !std::isdigit(static_cast<unsigned char>(arg_Text[0]))) return false;
+
+		errno = 0;
+		char* end = nullptr;
+		unsigned long long value = std::strtoull(arg_Text.c_str(), &end, 10);
+		if (errno != 0 || *end != '\0' || value > SIZE_MAX) return false;
+
+		arg_Index = static_cast<size_t>(value);
+		return true;
+	}
+
+	std::string toLower(std::string arg_Text)
+	{
+		std::transform(arg_Text.begin(), arg_Text.end(), arg_Text.begin(),
+			[](unsigned char arg_Char) { return static_cast<char>(std::tolower(arg_Char)); });
+		return arg_Text;
+	}
+
+	int64_t log2Floor(uint64_t arg_Value)
+	{
+		int64_t result = 0;
+		while (arg_Value > 1)
+		{
+			arg_Value >>= 1;
+			++result;
+		}
+		return result;
+	}
+
+	std::string defaultCachePath()
+	{
+		std::string base = Config::getString("XDG_CACHE_HOME");
+		if (base.empty())
+		{
+			std::string home = Config::getString("HOME");
+			if (home.empty()) return {};
+			base = home + "/.cache";
+		}
+
+		return base + "/webgpu-hello-rectangle/adapter";
+	}
+}
+
+AdapterSelector::Preferences AdapterSelector::Preferences::fromConfig()
+{
+	Preferences preferences{};
+	preferences.adapter = toLower(Config::getString("APP_ADAPTER"));
+	preferences.backend = toLower(Config::getString("APP_BACKEND"));
+	preferences.lowPower = toLower(Config::getString("APP_POWER_PREFERENCE")) == "low-power";
+	preferences.cachePath = Config::getString("APP_ADAPTER_CACHE", defaultCachePath());
+	if (preferences.cachePath == "off") preferences.cachePath.clear();
+
+	return preferences;
+}
+
+AdapterSelector::AdapterSelector(Preferences arg_Preferences)
+	: preferences(std::move(arg_Preferences))
+{
+	// An explicit choice always re-enumerates; the cache only replaces the automatic one.
+	if (!hasOverrides()) cacheHit = loadCache();
+}
+
+WGPUInstanceBackendFlags AdapterSelector::getInstanceBackends() const
+{
+	if (!preferences.backend.empty()) return parseBackends(preferences.backend);
+	if (cacheHit) return backendFlag(cachedBackend);
+
+	return WGPUInstanceBackend_All;
+}
+
+WGPUAdapter AdapterSelector::select(WGPUInstance arg_Instance, WGPUSurface arg_Surface)
+{
+	scores.clear();
+	retryAllBackends = false;
+
+	WGPUInstanceEnumerateAdapterOptions options{};
+	options.nextInChain = nullptr;
+	options.backends = getInstanceBackends();
+
+	size_t adapterCount = wgpuInstanceEnumerateAdapters(arg_Instance, &options, nullptr);
+	std::vector<WGPUAdapter> adapters(adapterCount, nullptr);
+	if (adapterCount > 0) wgpuInstanceEnumerateAdapters(arg_Instance, &options, adapters.data());
+
+	for (size_t i = 0; i < adapters.size(); ++i)
+		scores.push_back(score(adapters[i], i, arg_Surface));
+
+	size_t best = adapters.size();
+	for (size_t i = 0; i < scores.size(); ++i)
+	{
+		AdapterScore& current = scores[i];
+		if (cacheHit && isCached(current)) current.overrideScore += 1000000;
+		current.total = current.typeScore + current.backendScore + current.limitScore + current.featureScore + current.overrideScore;
+
+		LOG_MSG_SUC("Adapter " << i << ": " << current.name
+			<< " [" << backendName(current.backend) << ", " << adapterTypeName(current.type) << "]"
+			<< " type " << current.typeScore
+			<< " + backend " << current.backendScore
+			<< " + limits " << current.limitScore
+			<< " + features " << current.featureScore
+			<< " + override " << current.overrideScore
+			<< " = " << current.total
+			<< (current.surfaceCompatible ? "" : " (not surface compatible)"));
+
+		if (!current.surfaceCompatible) continue;
+		if (best == adapters.size() || current.total > scores[best].total) best = i;
+	}
+
+	// The instance only covers the cached backend, so anything but the cached adapter means the
+	// cache is stale (driver change, GPU removed, no longer presents): forget it and let the
+	// caller retry on every backend rather than settle for what this backend offers.
+	if (cacheHit && (best == adapters.size() || !isCached(scores[best])))
+	{
+		LOG_MSG_SUC("Cached adapter \"" << cachedName << "\" is not usable, retrying on all backends");
+		cacheHit = false;
+		retryAllBackends = true;
+		removeCache();
+		best = adapters.size();
+	}
+
+	for (size_t i = 0; i < adapters.size(); ++i)
+	{
+		if (i != best) wgpuAdapterRelease(adapters[i]);
+	}
+
+	if (best == adapters.size()) return nullptr;
+
+	LOG_MSG_SUC("Selected adapter " << best << ": " << scores[best].name << (cacheHit ? " (from cache)" : ""));
+
+	// Only an automatic choice is remembered; an overridden one would pin later default launches.
+	if (!cacheHit && !hasOverrides()) storeCache(scores[best]);
+
+	return adapters[best];
+}
+
+AdapterScore AdapterSelector::score(WGPUAdapter arg_Adapter, size_t arg_Index, WGPUSurface arg_Surface) const
+{
+	WGPUAdapterProperties properties{};
+	properties.nextInChain = nullptr;
+	wgpuAdapterGetProperties(arg_Adapter, &properties);
+
+	WGPUSupportedLimits supported{};
+	supported.nextInChain = nullptr;
+	wgpuAdapterGetLimits(arg_Adapter, &supported);
+
+	std::vector<WGPUFeatureName> features(wgpuAdapterEnumerateFeatures(arg_Adapter, nullptr));
+	wgpuAdapterEnumerateFeatures(arg_Adapter, features.data());
+
+	AdapterScore result{};
+	result.name = properties.name ? properties.name : "";
+	result.backend = properties.backendType;
+	result.type = properties.adapterType;
+
+	result.surfaceCompatible = true;
+	if (arg_Surface)
+	{
+		WGPUSurfaceCapabilities capabilities{};
+		capabilities.nextInChain = nullptr;
+		wgpuSurfaceGetCapabilities(arg_Surface, arg_Adapter, &capabilities);
+		result.surfaceCompatible = capabilities.formatCount > 0;
+		wgpuSurfaceCapabilitiesFreeMembers(capabilities);
+	}
+
+	switch (properties.adapterType)
+	{
+	case WGPUAdapterType_DiscreteGPU: result.typeScore = preferences.lowPower ? 600 : 1000; break;
+	case WGPUAdapterType_IntegratedGPU: result.typeScore = preferences.lowPower ? 1000 : 600; break;
+	case WGPUAdapterType_CPU: result.typeScore = 100; break;
+	default: result.typeScore = 300; break;
+	}
+
+	switch (properties.backendType)
+	{
+	case WGPUBackendType_Vulkan:
+	case WGPUBackendType_Metal:
+	case WGPUBackendType_D3D12: result.backendScore = 200; break;
+	case WGPUBackendType_D3D11:
+	case WGPUBackendType_OpenGL:
+	case WGPUBackendType_OpenGLES: result.backendScore = 50; break;
+	default: result.backendScore = 0; break;
+	}
+
+	const WGPULimits& limits = supported.limits;
+	result.limitScore =
+		log2Floor(limits.maxBufferSize) * 4 +
+		log2Floor(limits.maxStorageBufferBindingSize) * 2 +
+		log2Floor(limits.maxTextureDimension2D) * 4 +
+		log2Floor(limits.maxComputeInvocationsPerWorkgroup) * 2;
+
+	for (WGPUFeatureName feature : features)
+	{
+		if (feature == WGPUFeatureName_TimestampQuery ||
+			feature == static_cast<WGPUFeatureName>(WGPUNativeFeature_PushConstants) ||
+			feature == static_cast<WGPUFeatureName>(WGPUNativeFeature_MultiDrawIndirect))
+		{
+			result.featureScore += 25;
+		}
+	}
+
+	result.overrideScore = overrideScore(result, arg_Index);
+
+	return result;
+}
+
+int64_t AdapterSelector::overrideScore(const AdapterScore& arg_Score, size_t arg_Index) const
+{
+	const std::string& wanted = preferences.adapter;
+	if (wanted.empty()) return 0;
+
+	bool matches = false;
+	size_t index = 0;
+	if (wanted == "cpu" || wanted == "software") matches = arg_Score.type == WGPUAdapterType_CPU;
+	else if (wanted == "discrete") matches = arg_Score.type == WGPUAdapterType_DiscreteGPU;
+	else if (wanted == "integrated") matches = arg_Score.type == WGPUAdapterType_IntegratedGPU;
+	else if (parseIndex(wanted, index)) matches = index == arg_Index;
+	else
+		matches = toLower(arg_Score.name).find(wanted) != std::string::npos;
+
+	return matches ? 1000000 : 0;
+}
+
+bool AdapterSelector::hasOverrides() const
+{
+	return !preferences.adapter.empty() || !preferences.backend.empty() || preferences.lowPower;
+}
+
+bool AdapterSelector::loadCache()
+{
+	if (preferences.cachePath.empty()) return false;
+
+	std::ifstream file(preferences.cachePath);
+	if (!file) return false;
+
+	int backend = 0;
+	std::string key;
+	if (!(file >> key >> backend) || key != "backend") return false;
+	if (!(file >> key) || key != "name") return false;
+
+	std::getline(file >> std::ws, cachedName);
+	cachedBackend = static_cast<WGPUBackendType>(backend);
+
+	return backendFlag(cachedBackend) != WGPUInstanceBackend_All && !cachedName.empty();
+}
+
+bool AdapterSelector::isCached(const AdapterScore& arg_Score) const
+{
+	return arg_Score.name == cachedName && arg_Score.backend == cachedBackend;
+}
+
+void AdapterSelector::removeCache() const
+{
+	if (preferences.cachePath.empty()) return;
+
+	std::error_code err;
+	std::filesystem::remove(preferences.cachePath, err);
+}
+
+void AdapterSelector::storeCache(const AdapterScore& arg_Selected) const
+{
+	if (preferences.cachePath.empty()) return;
+
+	std::error_code err;
+	std::filesystem::create_directories(std::filesystem::path(preferences.cachePath).parent_path(), err);
+
+	std::ofstream file(preferences.cachePath, std::ios::trunc);
+	if (!file) return;
+
+	file << "backend " << static_cast<int>(arg_Selected.backend) << '\n';
+	file << "name " << arg_Selected.name << '\n';
+}
+
+WGPUInstanceBackendFlags AdapterSelector::parseBackends(const std::string& arg_Backend)
+{
+	if (arg_Backend == "vulkan") return WGPUInstanceBackend_Vulkan;
+	if (arg_Backend == "gl" || arg_Backend == "opengl") return WGPUInstanceBackend_GL;
+	if (arg_Backend == "metal") return WGPUInstanceBackend_Metal;
+	if (arg_Backend == "dx12") return WGPUInstanceBackend_DX12;
+	if (arg_Backend == "dx11") return WGPUInstanceBackend_DX11;
+	if (arg_Backend == "primary") return WGPUInstanceBackend_Primary;
+
+	return WGPUInstanceBackend_All;
+}
+
+WGPUInstanceBackendFlags AdapterSelector::backendFlag(WGPUBackendType arg_Backend)
+{
+	switch (arg_Backend)
+	{
+	case WGPUBackendType_Vulkan: return WGPUInstanceBackend_Vulkan;
+	case WGPUBackendType_OpenGL:
+	case WGPUBackendType_OpenGLES: return WGPUInstanceBackend_GL;
+	case WGPUBackendType_Metal: return WGPUInstanceBackend_Metal;
+	case WGPUBackendType_D3D12: return WGPUInstanceBackend_DX12;
+	case WGPUBackendType_D3D11: return WGPUInstanceBackend_DX11;
+	default: return WGPUInstanceBackend_All;
+	}
+}
+
+const char* AdapterSelector::backendName(WGPUBackendType arg_Backend)
+{
+	switch (arg_Backend)
+	{
+	case WGPUBackendType_Null: return "null";
+	case WGPUBackendType_WebGPU: return "webgpu";
+	case WGPUBackendType_D3D11: return "dx11";
+	case WGPUBackendType_D3D12: return "dx12";
+	case WGPUBackendType_Metal: return "metal";
+	case WGPUBackendType_Vulkan: return "vulkan";
+	case WGPUBackendType_OpenGL: return "gl";
+	case WGPUBackendType_OpenGLES: return "gles";
+	default: return "undefined";
+	}
+}
+
+const char* AdapterSelector::adapterTypeName(WGPUAdapterType arg_Type)
+{
+	switch (arg_Type)
+	{
+	case WGPUAdapterType_DiscreteGPU: return "discrete";
+	case WGPUAdapterType_IntegratedGPU: return "integrated";
+	case WGPUAdapterType_CPU: return "cpu";
+	default: return "unknown";
+	}
+}
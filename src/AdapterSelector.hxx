@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
+
+// Per-adapter scoring breakdown, kept so the decision can be logged and inspected.
+struct AdapterScore
+{
+	std::string name;
+	WGPUBackendType backend;
+	WGPUAdapterType type;
+	bool surfaceCompatible;
+	int64_t typeScore;
+	int64_t backendScore;
+	int64_t limitScore;
+	int64_t featureScore;
+	int64_t overrideScore;
+	int64_t total;
+};
+
+// Enumerates every adapter on the enabled backends and picks the best one by score instead
+// of taking whatever wgpuInstanceRequestAdapter returns. Overrides (env or --flag):
+//   APP_BACKEND            vulkan | gl | metal | dx12 | dx11 | primary | all
+//   APP_ADAPTER            index, case-insensitive name substring, or one of
+//                          discrete | integrated | cpu | software
+//   APP_POWER_PREFERENCE   high-performance (default) | low-power
+//   APP_ADAPTER_CACHE      path of the cached decision, "off" to disable
+// With no override, the previous launch's choice is read from the cache and the instance
+// is restricted to that backend, so other backends are never initialized or enumerated. If
+// the cached adapter is no longer usable the cache is deleted and select() asks for a retry
+// on an instance with every backend.
+class AdapterSelector
+{
+public:
+	struct Preferences
+	{
+		std::string adapter;
+		std::string backend;
+		bool lowPower;
+		std::string cachePath;
+
+		static Preferences fromConfig();
+	};
+
+	explicit AdapterSelector(Preferences arg_Preferences);
+
+	// Backends to enable in WGPUInstanceExtras.
+	WGPUInstanceBackendFlags getInstanceBackends() const;
+
+	// arg_Surface may be null for headless use. Returns null if nothing usable was found.
+	WGPUAdapter select(WGPUInstance arg_Instance, WGPUSurface arg_Surface);
+	// True after select() returned null because the cached adapter was stale. The cache is
+	// gone and getInstanceBackends() now covers every backend, so create a new instance and
+	// surface and select again.
+	bool shouldRetry() const { return retryAllBackends; }
+
+	const std::vector<AdapterScore>& getScores() const { return scores; }
+	bool usedCache() const { return cacheHit; }
+
+	static WGPUInstanceBackendFlags parseBackends(const std::string& arg_Backend);
+	static WGPUInstanceBackendFlags backendFlag(WGPUBackendType arg_Backend);
+	static const char* backendName(WGPUBackendType arg_Backend);
+	static const char* adapterTypeName(WGPUAdapterType arg_Type);
+
+private:
+	AdapterScore score(WGPUAdapter arg_Adapter, size_t arg_Index, WGPUSurface arg_Surface) const;
+	int64_t overrideScore(const AdapterScore& arg_Score, size_t arg_Index) const;
+	// True if APP_ADAPTER, APP_BACKEND or the power preference steer the choice, which then
+	// neither reads nor writes the cache.
+	bool hasOverrides() const;
+	bool isCached(const AdapterScore& arg_Score) const;
+	bool loadCache();
+	void removeCache() const;
+	void storeCache(const AdapterScore& arg_Selected) const;
+
+private:
+	Preferences preferences;
+	std::vector<AdapterScore> scores;
+
+	bool cacheHit = false;
+	bool retryAllBackends = false;
+	WGPUBackendType cachedBackend = WGPUBackendType_Undefined;
+	std::string cachedName;
+};
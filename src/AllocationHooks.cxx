@@ -0,0 +1,93 @@
+#include "AllocationTracker.hxx"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions so AllocationTracker sees every C++ heap
+// allocation. Linked into executables rather than the renderer library: a static library
+// member that only defines operator new would never be pulled in by the linker.
+namespace
+{
+	void* allocate(std::size_t arg_Bytes)
+	{
+		AllocationTracker::onAllocate(arg_Bytes);
+		return std::malloc(arg_Bytes ? arg_Bytes : 1);
+	}
+
+	// Over-allocates and keeps the pointer malloc returned just below the aligned block, as
+	// aligned_alloc is missing on MSVC and restricts sizes elsewhere.
+	void* allocateAligned(std::size_t arg_Bytes, std::align_val_t arg_Alignment)
+	{
+		const std::size_t alignment = std::max(static_cast<std::size_t>(arg_Alignment), sizeof(void*));
+		AllocationTracker::onAllocate(arg_Bytes);
+
+		void* raw = std::malloc(arg_Bytes + alignment + sizeof(void*));
+		if (!raw) return nullptr;
+
+		const uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+		reinterpret_cast<void**>(aligned)[-1] = raw;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	void release(void* arg_Pointer) noexcept
+	{
+		if (!arg_Pointer) return;
+
+		AllocationTracker::onFree();
+		std::free(arg_Pointer);
+	}
+
+	void releaseAligned(void* arg_Pointer) noexcept
+	{
+		if (!arg_Pointer) return;
+
+		AllocationTracker::onFree();
+		std::free(reinterpret_cast<void**>(arg_Pointer)[-1]);
+	}
+}
+
+void* operator new(std::size_t arg_Bytes)
+{
+	if (void* pointer = allocate(arg_Bytes)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t arg_Bytes)
+{
+	if (void* pointer = allocate(arg_Bytes)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t arg_Bytes, const std::nothrow_t&) noexcept { return allocate(arg_Bytes); }
+void* operator new[](std::size_t arg_Bytes, const std::nothrow_t&) noexcept { return allocate(arg_Bytes); }
+
+void* operator new(std::size_t arg_Bytes, std::align_val_t arg_Alignment)
+{
+	if (void* pointer = allocateAligned(arg_Bytes, arg_Alignment)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t arg_Bytes, std::align_val_t arg_Alignment)
+{
+	if (void* pointer = allocateAligned(arg_Bytes, arg_Alignment)) return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t arg_Bytes, std::align_val_t arg_Alignment, const std::nothrow_t&) noexcept { return allocateAligned(arg_Bytes, arg_Alignment); }
+void* operator new[](std::size_t arg_Bytes, std::align_val_t arg_Alignment, const std::nothrow_t&) noexcept { return allocateAligned(arg_Bytes, arg_Alignment); }
+
+void operator delete(void* arg_Pointer) noexcept { release(arg_Pointer); }
+void operator delete[](void* arg_Pointer) noexcept { release(arg_Pointer); }
+void operator delete(void* arg_Pointer, std::size_t) noexcept { release(arg_Pointer); }
+void operator delete[](void* arg_Pointer, std::size_t) noexcept { release(arg_Pointer); }
+void operator delete(void* arg_Pointer, const std::nothrow_t&) noexcept { release(arg_Pointer); }
+void operator delete[](void* arg_Pointer, const std::nothrow_t&) noexcept { release(arg_Pointer); }
+
+void operator delete(void* arg_Pointer, std::align_val_t) noexcept { releaseAligned(arg_Pointer); }
+void operator delete[](void* arg_Pointer, std::align_val_t) noexcept { releaseAligned(arg_Pointer); }
+void operator delete(void* arg_Pointer, std::size_t, std::align_val_t) noexcept { releaseAligned(arg_Pointer); }
+void operator delete[](void* arg_Pointer, std::size_t, std::align_val_t) noexcept { releaseAligned(arg_Pointer); }
+void operator delete(void* arg_Pointer, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(arg_Pointer); }
+void operator delete[](void* arg_Pointer, std::align_val_t, const std::nothrow_t&) noexcept { releaseAligned(arg_Pointer); }
@@ -0,0 +1,259 @@
+#include "AllocationTracker.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	// Written by the owning thread only, except the last slot, which every thread beyond
+	// MAX_THREADS shares.
+	struct ThreadSlot
+	{
+		std::atomic<uint64_t> allocations{ 0 };
+		std::atomic<uint64_t> frees{ 0 };
+		std::atomic<uint64_t> bytes{ 0 };
+		std::atomic<const char*> name{ nullptr };
+	};
+
+	// Everything here is constant-initialized, so the hooks may run before static
+	// initialization and during static destruction.
+	ThreadSlot threadSlots[AllocationTracker::MAX_THREADS];
+	std::atomic<size_t> threadSlotCount{ 0 };
+	std::atomic<bool> hooked{ false };
+
+	// Trivially constructible, so accessing it from inside operator new cannot allocate.
+	struct ThreadState
+	{
+		ThreadSlot* slot;
+		AllocationTracker::ScopeState scope;
+		uint64_t exemptAllocations;
+		AllocationTracker::ScopeCounts scopes[AllocationTracker::MAX_SCOPES];
+		size_t scopeCount;
+	};
+
+	thread_local ThreadState threadState;
+
+	ThreadSlot& threadSlot()
+	{
+		if (!threadState.slot)
+		{
+			const size_t index = threadSlotCount.fetch_add(1, std::memory_order_relaxed);
+			threadState.slot = &threadSlots[std::min(index, AllocationTracker::MAX_THREADS - 1)];
+		}
+		return *threadState.slot;
+	}
+
+	AllocationTracker::ScopeCounts* scopeCounts(const char* arg_Scope, bool arg_Exempt)
+	{
+		for (size_t i = 0; i < threadState.scopeCount; ++i)
+			if (threadState.scopes[i].scope == arg_Scope) return &threadState.scopes[i];
+
+		if (threadState.scopeCount == AllocationTracker::MAX_SCOPES) return &threadState.scopes[AllocationTracker::MAX_SCOPES - 1];
+
+		AllocationTracker::ScopeCounts& counts = threadState.scopes[threadState.scopeCount++];
+		counts.scope = arg_Scope;
+		counts.exempt = arg_Exempt;
+		return &counts;
+	}
+
+	AllocationTracker::Counts load(const ThreadSlot& arg_Slot)
+	{
+		AllocationTracker::Counts counts{};
+		counts.allocations = arg_Slot.allocations.load(std::memory_order_relaxed);
+		counts.frees = arg_Slot.frees.load(std::memory_order_relaxed);
+		counts.bytes = arg_Slot.bytes.load(std::memory_order_relaxed);
+		return counts;
+	}
+}
+
+void AllocationTracker::onAllocate(size_t arg_Bytes)
+{
+	ThreadSlot& slot = threadSlot();
+	slot.allocations.fetch_add(1, std::memory_order_relaxed);
+	slot.bytes.fetch_add(arg_Bytes, std::memory_order_relaxed);
+
+	if (threadState.scope.scope)
+	{
+		ScopeCounts* counts = scopeCounts(threadState.scope.scope, threadState.scope.exempt);
+		++counts->counts.allocations;
+		counts->counts.bytes += arg_Bytes;
+	}
+	if (threadState.scope.exempt) ++threadState.exemptAllocations;
+
+	if (!hooked.load(std::memory_order_relaxed)) hooked.store(true, std::memory_order_relaxed);
+}
+
+void AllocationTracker::onFree()
+{
+	threadSlot().frees.fetch_add(1, std::memory_order_relaxed);
+	if (threadState.scope.scope) ++scopeCounts(threadState.scope.scope, threadState.scope.exempt)->counts.frees;
+}
+
+bool AllocationTracker::isHooked()
+{
+	return hooked.load(std::memory_order_relaxed);
+}
+
+AllocationTracker::Counts AllocationTracker::getThreadCounts()
+{
+	return load(threadSlot());
+}
+
+AllocationTracker::Counts AllocationTracker::getProcessCounts()
+{
+	Counts total{};
+	const size_t count = std::min(threadSlotCount.load(std::memory_order_relaxed), MAX_THREADS);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Counts counts = load(threadSlots[i]);
+		total.allocations += counts.allocations;
+		total.frees += counts.frees;
+		total.bytes += counts.bytes;
+	}
+	return total;
+}
+
+uint64_t AllocationTracker::getThreadExemptAllocations()
+{
+	return threadState.exemptAllocations;
+}
+
+std::vector<AllocationTracker::ThreadCounts> AllocationTracker::getAllThreadCounts()
+{
+	std::vector<ThreadCounts> threads;
+	const size_t count = std::min(threadSlotCount.load(std::memory_order_relaxed), MAX_THREADS);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const char* name = threadSlots[i].name.load(std::memory_order_relaxed);
+		threads.push_back({ name ? name : "thread " + std::to_string(i + 1), load(threadSlots[i]) });
+	}
+	return threads;
+}
+
+void AllocationTracker::setThreadName(const char* arg_Name)
+{
+	threadSlot().name.store(arg_Name, std::memory_order_relaxed);
+}
+
+const AllocationTracker::ScopeCounts* AllocationTracker::getScopeCounts(size_t& arg_Count)
+{
+	arg_Count = threadState.scopeCount;
+	return threadState.scopes;
+}
+
+AllocationTracker::ScopeState AllocationTracker::enterScope(const char* arg_Scope, bool arg_Exempt)
+{
+	ScopeState previous = threadState.scope;
+	// An exempt scope stays exempt for everything nested inside it.
+	threadState.scope = { arg_Scope, arg_Exempt || previous.exempt };
+	return previous;
+}
+
+void AllocationTracker::leaveScope(ScopeState arg_Previous)
+{
+	threadState.scope = arg_Previous;
+}
+
+FrameAllocationMonitor::Settings FrameAllocationMonitor::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.enabled = Config::getBool("APP_ALLOC_TRACK", false);
+	settings.gate = Config::getBool("APP_ALLOC_GATE", false);
+	settings.warmupFrames = static_cast<uint32_t>(std::clamp(Config::getInt("APP_ALLOC_WARMUP", 120), 0LL, 1000000LL));
+
+	return settings;
+}
+
+FrameAllocationMonitor::FrameAllocationMonitor(Settings arg_Settings)
+	: settings(arg_Settings)
+{
+	// Without the hooks the gate would pass every frame without having looked at any.
+	if (settings.gate && !AllocationTracker::isHooked())
+		throw std::runtime_error("APP_ALLOC_GATE needs a build with ALLOC_TRACKING, the allocation hooks are not linked");
+}
+
+void FrameAllocationMonitor::beginFrame()
+{
+	if (!isEnabled()) return;
+
+	frameStart = AllocationTracker::getThreadCounts();
+	exemptStart = AllocationTracker::getThreadExemptAllocations();
+
+	const AllocationTracker::ScopeCounts* scopes = AllocationTracker::getScopeCounts(scopeStartCount);
+	std::copy(scopes, scopes + scopeStartCount, scopeStart);
+}
+
+void FrameAllocationMonitor::endFrame()
+{
+	if (!isEnabled()) return;
+
+	const AllocationTracker::Counts counts = AllocationTracker::getThreadCounts();
+	const uint64_t exempt = AllocationTracker::getThreadExemptAllocations() - exemptStart;
+	const uint64_t allocations = counts.allocations - frameStart.allocations;
+	const uint64_t bytes = counts.bytes - frameStart.bytes;
+
+	if (frames++ < settings.warmupFrames) return;
+
+	allocationsPerFrame.record(allocations);
+	bytesPerFrame.record(bytes);
+	if (allocations > exempt) ++framesWithAllocations;
+
+	if (settings.gate && allocations > exempt) failGate(allocations - exempt, bytes);
+}
+
+void FrameAllocationMonitor::failGate(uint64_t arg_Allocations, uint64_t arg_Bytes) const
+{
+	std::ostringstream message;
+	message << arg_Allocations << " heap allocation(s) (" << arg_Bytes << " bytes) in frame " << frames
+		<< " after a warmup of " << settings.warmupFrames << " frames:";
+
+	size_t count = 0;
+	const AllocationTracker::ScopeCounts* scopes = AllocationTracker::getScopeCounts(count);
+	uint64_t tagged = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (scopes[i].exempt) continue;
+
+		const uint64_t before = i < scopeStartCount ? scopeStart[i].counts.allocations : 0;
+		const uint64_t delta = scopes[i].counts.allocations - before;
+		if (delta == 0) continue;
+
+		message << ' ' << scopes[i].scope << " x" << delta;
+		tagged += delta;
+	}
+	if (tagged < arg_Allocations) message << " (untagged) x" << arg_Allocations - tagged;
+
+	throw std::runtime_error(message.str());
+}
+
+void FrameAllocationMonitor::logSummary() const
+{
+	if (!isEnabled()) return;
+
+	LOG_MSG_SUC("Heap allocations per frame after " << settings.warmupFrames << " warmup frames: p50 "
+		<< allocationsPerFrame.percentile(50.0)
+		<< ", p99 " << allocationsPerFrame.percentile(99.0)
+		<< ", max " << allocationsPerFrame.getMax()
+		<< ", bytes p99 " << bytesPerFrame.percentile(99.0)
+		<< ", " << framesWithAllocations << " of " << allocationsPerFrame.getCount() << " frames allocated");
+
+	size_t count = 0;
+	const AllocationTracker::ScopeCounts* scopes = AllocationTracker::getScopeCounts(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		LOG_MSG_SUC(" - scope " << scopes[i].scope << (scopes[i].exempt ? " (exempt)" : "") << ": "
+			<< scopes[i].counts.allocations << " allocations, " << scopes[i].counts.bytes << " bytes");
+	}
+	(void)scopes;
+
+	for (const AllocationTracker::ThreadCounts& thread : AllocationTracker::getAllThreadCounts())
+	{
+		LOG_MSG_SUC(" - thread " << thread.name << ": " << thread.counts.allocations << " allocations, "
+			<< thread.counts.frees << " frees, " << thread.counts.bytes << " bytes");
+		(void)thread;
+	}
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Histogram.hxx"
+
+// Heap allocation counters fed by the global operator new/delete replacements in
+// AllocationHooks.cxx, which executables link when built with ALLOC_TRACKING (the default).
+// Counting is a few relaxed atomic adds and never allocates itself. Only C++ allocations are
+// seen; wgpu and GLFW allocate through their own allocators.
+namespace AllocationTracker
+{
+	struct Counts
+	{
+		uint64_t allocations;
+		uint64_t frees;
+		uint64_t bytes;
+	};
+
+	struct ThreadCounts
+	{
+		std::string name;
+		Counts counts;
+	};
+
+	// Allocations made by the calling thread under one scope tag.
+	struct ScopeCounts
+	{
+		const char* scope;
+		bool exempt;
+		Counts counts;
+	};
+
+	const size_t MAX_THREADS = 64;
+	const size_t MAX_SCOPES = 32;
+
+	void onAllocate(size_t arg_Bytes);
+	void onFree();
+
+	// False when the hooks are not linked in, in which case every count stays zero.
+	bool isHooked();
+
+	Counts getThreadCounts();
+	Counts getProcessCounts();
+	// Allocations the calling thread made inside exempt scopes, see ALLOC_SCOPE_EXEMPT.
+	uint64_t getThreadExemptAllocations();
+	std::vector<ThreadCounts> getAllThreadCounts();
+
+	// The name must outlive the thread, e.g. a string literal.
+	void setThreadName(const char* arg_Name);
+
+	// Scope tags of the calling thread; the table holds the first MAX_SCOPES distinct tags and
+	// counts anything beyond under the last one.
+	const ScopeCounts* getScopeCounts(size_t& arg_Count);
+
+	struct ScopeState
+	{
+		const char* scope;
+		bool exempt;
+	};
+
+	ScopeState enterScope(const char* arg_Scope, bool arg_Exempt);
+	void leaveScope(ScopeState arg_Previous);
+}
+
+// Tags the calling thread's allocations in the enclosing scope. The name must be a string
+// literal (see ALLOC_SCOPE), so only the pointer is stored.
+class AllocationScope
+{
+public:
+	AllocationScope(const char* arg_Scope, bool arg_Exempt)
+		: previous(AllocationTracker::enterScope(arg_Scope, arg_Exempt))
+	{
+	}
+
+	~AllocationScope() { AllocationTracker::leaveScope(previous); }
+
+	AllocationScope(const AllocationScope&) = delete;
+	AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+	AllocationTracker::ScopeState previous;
+};
+
+#define ALLOC_SCOPE_CONCAT_IMPL(a, b) a##b
+#define ALLOC_SCOPE_CONCAT(a, b) ALLOC_SCOPE_CONCAT_IMPL(a, b)
+#define ALLOC_SCOPE(name) AllocationScope ALLOC_SCOPE_CONCAT(allocationScope, __LINE__)("" name, false)
+// For work that allocates by design and does not run every frame, like periodic exports.
+// Counted as usual, but not held against the zero-allocation gate.
+#define ALLOC_SCOPE_EXEMPT(name) AllocationScope ALLOC_SCOPE_CONCAT(allocationScope, __LINE__)("" name, true)
+
+// Per-frame allocation counts of the render thread.
+//   APP_ALLOC_TRACK    record allocations per frame and log them at exit (default off)
+//   APP_ALLOC_GATE     fail the run if a frame after warmup allocates outside exempt scopes
+//   APP_ALLOC_WARMUP   frames before the gate applies (default 120)
+// The gate is meant for headless test runs (APP_HEADLESS=1 APP_FRAMES=n), where it turns
+// a new allocation on the hot path into a failing exit code naming the scope it came from.
+class FrameAllocationMonitor
+{
+public:
+	struct Settings
+	{
+		bool enabled;
+		bool gate;
+		uint32_t warmupFrames;
+
+		static Settings fromConfig();
+	};
+
+	explicit FrameAllocationMonitor(Settings arg_Settings);
+
+	bool isEnabled() const { return settings.enabled || settings.gate; }
+
+	void beginFrame();
+	// Throws with the offending scopes if the gate is on and the frame allocated.
+	void endFrame();
+
+	uint64_t getFrameCount() const { return frames; }
+	const Histogram& getAllocationsPerFrame() const { return allocationsPerFrame; }
+
+	void logSummary() const;
+
+private:
+	[[noreturn]] void failGate(uint64_t arg_Allocations, uint64_t arg_Bytes) const;
+
+private:
+	Settings settings;
+	uint64_t frames = 0;
+	uint64_t framesWithAllocations = 0;
+
+	AllocationTracker::Counts frameStart{};
+	uint64_t exemptStart = 0;
+	AllocationTracker::ScopeCounts scopeStart[AllocationTracker::MAX_SCOPES]{};
+	size_t scopeStartCount = 0;
+
+	Histogram allocationsPerFrame;
+	Histogram bytesPerFrame;
+};
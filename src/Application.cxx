@@ -0,0 +1,1563 @@
+#include "Application.hxx"
+#include "GpuDebug.hxx"
+#include "Log.hxx"
+#include "Profiler.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+
+#include <glfw3webgpu.h>
+
+void wgpuPollEvents([[maybe_unused]] WGPUDevice device, [[maybe_unused]] bool yieldToWebBrowser) {
+#if defined(WEBGPU_BACKEND_DAWN)
+	wgpuDeviceTick(device);
+#elif defined(WEBGPU_BACKEND_WGPU)
+	wgpuDevicePoll(device, false, nullptr);
+#elif defined(WEBGPU_BACKEND_EMSCRIPTEN)
+	if (yieldToWebBrowser) {
+		emscripten_sleep(100);
+	}
+#endif
+}
+
+namespace WindowProperties
+{
+	const int WINDOW_WIDTH = 1280;
+	const int WINDOW_HEIGHT = 960;
+	const char* WINDOW_TITLE = "WebGPU C++ Hello Triangle";
+	WGPUColor clearColor = { 0.0, 0.0, 0.006, 1.0 };
+	GLFWmonitor* monitor = nullptr;
+	GLFWwindow* share = nullptr;
+
+	const float MIN_BLUE = 0.006f;
+	const float MAX_BLUE = 0.08f;
+	const float FADE_SPEED = 0.0004f;
+}
+
+namespace
+{
+	// Each overdraw layer covers the whole target, so this bounds the fill work per frame.
+	const uint32_t MAX_OVERDRAW_LAYERS = 4096;
+	// Staging chunks start at this size; larger uploads get a chunk of their own size.
+	const uint64_t STAGING_CHUNK_SIZE = 4 << 20;
+	// Longest step the scene animates in one frame, so a stall does not teleport rects.
+	const double MAX_SCENE_STEP_MS = 100.0;
+	// Zoom factor per scroll wheel notch, and rotation per key press (15 degrees).
+	const double CAMERA_ZOOM_STEP = 1.2;
+	const double CAMERA_ROTATE_STEP = 0.2617993877991494;
+	// Position and color of a vertex in vertex buffer 0.
+	const uint32_t VERTEX_FLOATS = 5;
+}
+
+namespace ShaderProperties
+{
+	const char* SHADER_PATH = RESOURCE_DIR "/shaders/rectangle.wgsl";
+	const char* UPSCALE_SHADER_PATH = RESOURCE_DIR "/shaders/upscale.wgsl";
+	const bool HOT_RELOAD = true;
+}
+
+Application::Options Application::Options::fromConfig()
+{
+	Options options{};
+	options.headless = Config::getBool("APP_HEADLESS", false);
+	options.frames = static_cast<uint64_t>(std::max(0LL, Config::getInt("APP_FRAMES", 0)));
+	options.width = static_cast<uint32_t>(std::clamp(Config::getInt("APP_WIDTH", WindowProperties::WINDOW_WIDTH), 1LL, 16384LL));
+	options.height = static_cast<uint32_t>(std::clamp(Config::getInt("APP_HEIGHT", WindowProperties::WINDOW_HEIGHT), 1LL, 16384LL));
+	options.drawsPerFrame = static_cast<uint32_t>(std::max(1LL, Config::getInt("APP_DRAWS_PER_FRAME", 1)));
+	options.instances = static_cast<uint32_t>(std::clamp(Config::getInt("APP_INSTANCES", 1), 1LL, static_cast<long long>(UINT32_MAX)));
+	options.capacitySearch = Config::getBool("APP_CAPACITY", false);
+	options.headless = options.headless || options.capacitySearch;
+	options.textureDirectory = Config::getString("APP_TEXTURE_DIR");
+
+	const std::string workload = Config::getString("APP_WORKLOAD", Config::getString("APP_SCENE_FILE").empty() ? "draws" : "scene");
+	if (!CapacitySearch::parseWorkload(workload, options.workload))
+		throw std::runtime_error("Unknown APP_WORKLOAD '" + workload + "', expected draws, instances, overdraw or scene");
+
+	return options;
+}
+
+Application::Application()
+	: Application(Options::fromConfig())
+{
+}
+
+Application::Application(Options arg_Options)
+	: options(arg_Options),
+	drawsPerFrame(std::max(1u, arg_Options.drawsPerFrame)),
+	workload(arg_Options.workload),
+	instanceCount(std::max(1u, arg_Options.instances))
+{
+}
+
+void Application::run()
+{
+	if (!options.headless)
+	{
+		initializeGLFW();
+		createWindow();
+	}
+	initializeWGPU();
+	windowLoop();
+	terminateApplication();
+}
+
+void Application::initializeGLFW()
+{
+	if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
+
+	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+	// Window size stays in logical units on high-DPI monitors; the surface follows the
+	// framebuffer size, which is in pixels, so a content scale change arrives as a resize.
+	glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
+	glfwWindowHint(GLFW_SCALE_FRAMEBUFFER, GLFW_TRUE);
+}
+
+void Application::initializeWGPU()
+{
+	createInstance();
+	getAdapter();
+	getDevice();
+	getQueue();
+	initializeRenderPipeline();
+	initializeBuffers();
+}
+
+void Application::createInstance()
+{
+	WGPUInstanceExtras instanceExtras = {};
+	instanceExtras.chain.next = nullptr;
+	instanceExtras.chain.sType = static_cast<WGPUSType>(WGPUSType_InstanceExtras);
+	instanceExtras.backends = adapterSelector.getInstanceBackends();
+	// Zero flags would let wgpu pick its own build-dependent defaults, so release builds
+	// ask for none of the debug layers explicitly.
+#if GPU_VALIDATION
+	instanceExtras.flags = WGPUInstanceFlag_Debug | WGPUInstanceFlag_Validation;
+#else
+	instanceExtras.flags = WGPUInstanceFlag_DiscardHalLabels;
+#endif
+	LOG_MSG_SUC("GPU validation " << (GPU_VALIDATION ? "on" : "off"));
+
+	Logger::instance().captureWgpuLogs();
+
+	WGPUInstanceDescriptor instanceDesc = {};
+	instanceDesc.nextInChain = &instanceExtras.chain;
+	instance = wgpuCreateInstance(&instanceDesc);
+
+	if (!instance)
+	{
+		glfwTerminate();
+		throw std::runtime_error("Could not initialize WebGPU");
+	}
+
+	LOG_MSG_SUC("WebGPU instance: " << instance);
+}
+
+void Application::createWindow()
+{
+	window = glfwCreateWindow(
+		WindowProperties::WINDOW_WIDTH,
+		WindowProperties::WINDOW_HEIGHT,
+		WindowProperties::WINDOW_TITLE,
+		WindowProperties::monitor,
+		WindowProperties::share
+	);
+
+	if (!window)
+	{
+		glfwTerminate();
+		throw std::runtime_error("Failed to create GLFW window");
+	}
+
+	glfwSetWindowUserPointer(window, this);
+
+	auto onFramebufferResized =
+		[](GLFWwindow* arg_Window, int arg_Width, int arg_Height)
+		{
+			Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window));
+			if (app->swapChain) app->swapChain->resize(static_cast<uint32_t>(arg_Width), static_cast<uint32_t>(arg_Height));
+		};
+
+	glfwSetFramebufferSizeCallback(window, onFramebufferResized);
+
+	// Every event is timed for input latency; some also steer the camera or pick a rect.
+	glfwSetKeyCallback(window,
+		[](GLFWwindow* arg_Window, int arg_Key, int, int arg_Action, int)
+		{
+			onInputEvent(arg_Window);
+			if (arg_Action == GLFW_RELEASE) return;
+			reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window))->onCameraKey(arg_Key);
+		});
+	glfwSetMouseButtonCallback(window,
+		[](GLFWwindow* arg_Window, int arg_Button, int arg_Action, int)
+		{
+			onInputEvent(arg_Window);
+			Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window));
+			app->onCameraButton(arg_Button, arg_Action);
+			if (arg_Button != GLFW_MOUSE_BUTTON_LEFT || arg_Action != GLFW_PRESS) return;
+
+			double cursorX = 0.0;
+			double cursorY = 0.0;
+			glfwGetCursorPos(arg_Window, &cursorX, &cursorY);
+			app->pickScene(cursorX, cursorY);
+		});
+	glfwSetCursorPosCallback(window,
+		[](GLFWwindow* arg_Window, double arg_CursorX, double arg_CursorY)
+		{
+			onInputEvent(arg_Window);
+			reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window))->onCameraCursor(arg_CursorX, arg_CursorY);
+		});
+	glfwSetScrollCallback(window,
+		[](GLFWwindow* arg_Window, double, double arg_OffsetY)
+		{
+			onInputEvent(arg_Window);
+			reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window))->onCameraScroll(arg_OffsetY);
+		});
+}
+
+void Application::onInputEvent(GLFWwindow* arg_Window)
+{
+	Application* app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(arg_Window));
+	if (app->inputLatency) app->inputLatency->onEvent(std::chrono::steady_clock::now());
+}
+
+void Application::onCameraKey(int arg_Key)
+{
+	if (arg_Key == GLFW_KEY_Q) camera.rotate(CAMERA_ROTATE_STEP);
+	else if (arg_Key == GLFW_KEY_E) camera.rotate(-CAMERA_ROTATE_STEP);
+	else if (arg_Key == GLFW_KEY_R) camera.reset();
+}
+
+void Application::onCameraButton(int arg_Button, int arg_Action)
+{
+	if (arg_Button != GLFW_MOUSE_BUTTON_RIGHT) return;
+
+	cameraDragging = arg_Action == GLFW_PRESS;
+	if (cameraDragging) glfwGetCursorPos(window, &dragCursorX, &dragCursorY);
+}
+
+void Application::onCameraCursor(double arg_CursorX, double arg_CursorY)
+{
+	if (!cameraDragging) return;
+
+	double fromX = 0.0;
+	double fromY = 0.0;
+	double toX = 0.0;
+	double toY = 0.0;
+	cursorToViewport(dragCursorX, dragCursorY, fromX, fromY);
+	cursorToViewport(arg_CursorX, arg_CursorY, toX, toY);
+	camera.pan(toX - fromX, toY - fromY);
+
+	dragCursorX = arg_CursorX;
+	dragCursorY = arg_CursorY;
+}
+
+void Application::onCameraScroll(double arg_Offset)
+{
+	double cursorX = 0.0;
+	double cursorY = 0.0;
+	glfwGetCursorPos(window, &cursorX, &cursorY);
+
+	double pixelX = 0.0;
+	double pixelY = 0.0;
+	cursorToViewport(cursorX, cursorY, pixelX, pixelY);
+	camera.zoomAt(std::pow(CAMERA_ZOOM_STEP, arg_Offset), pixelX, pixelY);
+}
+
+void Application::cursorToViewport(double arg_CursorX, double arg_CursorY, double& arg_PixelX, double& arg_PixelY) const
+{
+	int windowWidth = 0;
+	int windowHeight = 0;
+	glfwGetWindowSize(window, &windowWidth, &windowHeight);
+
+	arg_PixelX = windowWidth > 0 ? arg_CursorX * swapChain->getWidth() / windowWidth : 0.0;
+	arg_PixelY = windowHeight > 0 ? arg_CursorY * swapChain->getHeight() / windowHeight : 0.0;
+}
+
+void Application::windowLoop()
+{
+	Profiler::instance().setThreadName("render");
+	AllocationTracker::setThreadName("render");
+
+	frameTimes.clear();
+	frameTimes.reserve(options.frames);
+
+	for (uint64_t frame = 0; keepRunning(frame); ++frame)
+	{
+		allocationMonitor->beginFrame();
+		frameArena.beginFrame();
+
+		{
+			PROFILE_ZONE("framePacer");
+			ALLOC_SCOPE("framePacer");
+			framePacer->beginFrame();
+		}
+		auto frameBegin = std::chrono::steady_clock::now();
+
+		if (!options.headless)
+		{
+			// Polled after the pacing wait so a delayed frame start also means fresher input.
+			PROFILE_ZONE("glfwPollEvents");
+			ALLOC_SCOPE("pollEvents");
+			// Nothing is rendered while minimized, so block instead of spinning.
+			if (swapChain->isMinimized()) glfwWaitEvents();
+			else glfwPollEvents();
+		}
+		inputSampleTime = std::chrono::steady_clock::now();
+		inputLatency->injectSynthetic(inputSampleTime);
+
+		surfaceWaitNs = 0;
+		if (shaderReloader && shaderReloadsIssued < options.shaderReloadRequests && shaderReloadsDone())
+		{
+			shaderReloader->requestReload();
+			++shaderReloadsIssued;
+		}
+		swapReloadedPipeline();
+		renderFrame();
+
+		// Nothing throttles a headless loop, so each frame waits for its own GPU work.
+		if (options.headless)
+		{
+			PROFILE_ZONE("waitForGpu");
+			wgpuDevicePoll(device, true, nullptr);
+		}
+
+		framePacer->endFrame(surfaceWaitNs);
+		Profiler::instance().endFrame();
+
+		const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameBegin).count();
+		if (options.frames > 0) frameTimes.push_back(frameMs);
+		if (capacitySearch)
+		{
+			ALLOC_SCOPE_EXEMPT("capacitySearch");
+			if (capacitySearch->record(frameMs)) applyWorkload(capacitySearch->getWorkload(), capacitySearch->getSize());
+		}
+
+		allocationMonitor->endFrame();
+	}
+}
+
+bool Application::keepRunning(uint64_t arg_Frame) const
+{
+	if (capacitySearch) return !capacitySearch->isFinished();
+	if (shaderReloader && options.shaderReloadRequests > 0 && shaderReloadsIssued == options.shaderReloadRequests && shaderReloadsDone())
+		return false;
+	if (options.stopAfterTextures && texturesStreamed) return false;
+	if (options.frames > 0 && arg_Frame >= options.frames) return false;
+
+	return options.headless || !glfwWindowShouldClose(window);
+}
+
+bool Application::shaderReloadsDone() const
+{
+	// A file edited meanwhile adds a reload of its own, hence at least rather than exactly.
+	const ShaderHotReloader::Stats stats = shaderReloader->getStats();
+	return stats.swaps + stats.failures >= shaderReloadsIssued;
+}
+
+void Application::terminateApplication()
+{
+	Profiler::instance().stop();
+
+	if (shaderReloader)
+	{
+		shaderReloader->stop();
+		shaderReloadStats = shaderReloader->getStats();
+		shaderReloader.reset();
+	}
+
+#ifdef DEBUG_MODE
+	variantCache->logStats();
+#endif
+	variantCache->clear();
+	pipelineCounts = variantCache->getPipelineCounts();
+	variantCache.reset();
+	gpuTimer.reset();
+	telemetry.reset();
+	framePacer.reset();
+	if (allocationMonitor)
+	{
+		LOG_MSG_SUC("Frame arena high water " << frameArena.getHighWater() << " bytes, capacity "
+			<< frameArena.getCapacity() << " bytes, grew " << frameArena.getGrowCount() << " times");
+		allocationMonitor->logSummary();
+		allocationMonitor.reset();
+	}
+	if (capacitySearch)
+	{
+		capacitySearch->logSummary();
+		capacitySearch->writeReport();
+		capacitySearch.reset();
+	}
+	if (inputLatency)
+	{
+		if (inputLatency->hasInFlight()) wgpuDevicePoll(device, true, nullptr);
+		inputLatency->logSummary();
+		inputLatency->writeStats();
+		inputLatency.reset();
+	}
+	if (presentModeSelector) presentModeSelector->logSummary();
+	presentModeSelector.reset();
+	upscaler.reset();
+	resolutionController.reset();
+	if (sceneStreamer)
+	{
+		const SceneStreamer::Stats streamStats = sceneStreamer->getStats();
+		LOG_MSG_SUC("Scene stream: " << streamStats.chunksUploaded << " chunk uploads, " << (streamStats.bytesUploaded >> 20)
+			<< " MiB, " << streamStats.evictions << " evictions");
+		(void)streamStats;
+	}
+	sceneStreamer.reset();
+	sceneFile.reset();
+	if (textureStreamer)
+	{
+		textureStreamer->logSummary();
+		textureStats = textureStreamer->getStats();
+	}
+	textureStreamer.reset();
+	stagingBelt.reset();
+	scene.reset();
+	jobs.reset();
+	drawParameters.reset();
+	bindGroupCache.reset();
+
+	if (window)
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		window = nullptr;
+	}
+
+	wgpuQueueRelease(queue);
+	swapChain.reset();
+	if (surface) wgpuSurfaceRelease(surface);
+	wgpuBufferRelease(vertexBuffer);
+	if (instanceBuffer) wgpuBufferRelease(instanceBuffer);
+	// Last, after everything created from it; benchmarks run one Application per scene size.
+	wgpuDeviceRelease(device);
+	device = nullptr;
+}
+
+void Application::renderFrame()
+{
+	PROFILE_ZONE("renderFrame");
+	ALLOC_SCOPE("renderFrame");
+
+	auto frameStart = std::chrono::steady_clock::now();
+	if (lastFrameStart != std::chrono::steady_clock::time_point{})
+	{
+		telemetry->record(FrameMetric::Interval, frameStart - lastFrameStart);
+		lastIntervalMs = std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count();
+	}
+	lastFrameStart = frameStart;
+
+	SurfaceFrame surfaceFrame;
+	if (!getNextSurfaceViewData(surfaceFrame)) return;
+	if (instancesDirty) updateInstanceBuffer();
+	surfaceWaitNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - frameStart).count();
+	inputLatency->beginFrame();
+	WGPUTextureView targetView = surfaceFrame.view;
+
+	// CPU time excludes waiting for the surface texture, which is pacing rather than work.
+	auto encodeStart = std::chrono::steady_clock::now();
+
+	GPU_ERROR_SCOPE(device, "renderFrame");
+
+	WGPUCommandEncoderDescriptor encoderDesc = {};
+	encoderDesc.label = GPU_LABEL("Command Encoder");
+	WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
+
+	const double renderScale = resolutionController ? resolutionController->getScale() : 1.0;
+	const bool scaled = renderScale < 1.0;
+	camera.setViewport(swapChain->getWidth(), swapChain->getHeight());
+	if (workload == Workload::Scene) updateScene(encoder, renderScale);
+	if (textureStreamer)
+	{
+		textureStreamer->update(encoder, *stagingBelt);
+		if (!texturesStreamed && !textureStreamer->isBusy())
+		{
+			const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - textureStreamStart).count();
+			LOG_MSG_SUC("Textures streamed in " << elapsedMs << " ms");
+			(void)elapsedMs;
+			texturesStreamed = true;
+		}
+	}
+	if (scaled) upscaler->resize(swapChain->getWidth(), swapChain->getHeight());
+
+	WGPURenderPassColorAttachment renderPassColorAttachment = {};
+	renderPassColorAttachment.view = scaled ? upscaler->getTargetView() : targetView;
+	renderPassColorAttachment.loadOp = WGPULoadOp_Clear;
+	renderPassColorAttachment.storeOp = WGPUStoreOp_Store;
+	renderPassColorAttachment.clearValue = WindowProperties::clearColor;
+
+	if (bgFadingUp) {
+		WindowProperties::clearColor.b += WindowProperties::FADE_SPEED;
+		if (WindowProperties::clearColor.b >= WindowProperties::MAX_BLUE) {
+			WindowProperties::clearColor.b = WindowProperties::MAX_BLUE;
+			bgFadingUp = false;
+		}
+	}
+	else {
+		WindowProperties::clearColor.b -= WindowProperties::FADE_SPEED;
+		if (WindowProperties::clearColor.b <= WindowProperties::MIN_BLUE) {
+			WindowProperties::clearColor.b = WindowProperties::MIN_BLUE;
+			bgFadingUp = true; 
+		}
+	}
+
+	WGPURenderPassDescriptor renderPassDesc = {};
+	renderPassDesc.colorAttachmentCount = 1;
+	renderPassDesc.colorAttachments = &renderPassColorAttachment;
+
+	WGPURenderPassTimestampWrites timestampWrites = {};
+	if (gpuTimer && gpuTimer->beginPass(timestampWrites))
+		renderPassDesc.timestampWrites = &timestampWrites;
+
+	WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
+
+	wgpuRenderPassEncoderSetPipeline(renderPass, getWorkloadPipeline());
+	if (scaled)
+	{
+		uint32_t renderWidth = 0;
+		uint32_t renderHeight = 0;
+		upscaler->getRenderSize(renderScale, renderWidth, renderHeight);
+		wgpuRenderPassEncoderSetViewport(renderPass, 0.0f, 0.0f, static_cast<float>(renderWidth), static_cast<float>(renderHeight), 0.0f, 1.0f);
+		wgpuRenderPassEncoderSetScissorRect(renderPass, 0, 0, renderWidth, renderHeight);
+	}
+	wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, vertexBuffer, 0, wgpuBufferGetSize(vertexBuffer));
+	wgpuRenderPassEncoderSetVertexBuffer(renderPass, 1, instanceBuffer, 0, wgpuBufferGetSize(instanceBuffer));
+
+	// The other workloads are laid out in clip space.
+	drawParameters->setCamera(workload == Workload::Scene ? camera.getParams() : Camera::identity());
+	drawParameters->beginFrame(renderPass);
+	if (workload == Workload::Draws)
+	{
+		PROFILE_GPU_ZONE(renderPass, "drawGrid");
+
+		const uint32_t drawCount = std::min(drawsPerFrame, drawParameters->getMaxDrawsPerFrame());
+		for (uint32_t i = 0; i < drawCount; ++i)
+		{
+			DrawParams params;
+			makeGridDrawParams(i, drawCount, params);
+			if (!drawParameters->setDrawParams(renderPass, params)) break;
+
+			wgpuRenderPassEncoderDraw(renderPass, vertexCount, 1, 0, 0);
+			++drawsSinceReport;
+		}
+	}
+	else if (workload == Workload::Scene && sceneStreamer)
+	{
+		PROFILE_GPU_ZONE(renderPass, "drawStreamed");
+
+		// One draw per resident chunk: rects with the file's mesh, tiles as quads.
+		const std::vector<SceneStreamer::Draw>& draws = sceneStreamer->getDraws();
+		DrawParams params;
+		makeGridDrawParams(0, 1, params);
+		if (!draws.empty() && drawParameters->setDrawParams(renderPass, params))
+		{
+			WGPUBuffer chunkBuffer = sceneStreamer->getBuffer();
+			wgpuRenderPassEncoderSetVertexBuffer(renderPass, 1, chunkBuffer, 0, wgpuBufferGetSize(chunkBuffer));
+			for (const SceneStreamer::Draw& draw : draws)
+			{
+				if (draw.level == 0) wgpuRenderPassEncoderDraw(renderPass, vertexCount, draw.count, 0, draw.firstInstance);
+				else wgpuRenderPassEncoderDraw(renderPass, UNIT_QUAD_VERTEX_COUNT, draw.count, vertexCount, draw.firstInstance);
+			}
+			++drawsSinceReport;
+
+			if (!sceneStreamDrawn)
+			{
+				const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sceneStreamStart).count();
+				LOG_MSG_SUC("First streamed draw " << elapsedMs << " ms after opening the scene file");
+				(void)elapsedMs;
+				sceneStreamDrawn = true;
+			}
+		}
+	}
+	else
+	{
+		PROFILE_GPU_ZONE(renderPass, "drawInstanced");
+
+		// The instance buffer carries the layout; the draw itself is untransformed. LOD tiles
+		// follow the scene's single rects in it and are drawn first, underneath them.
+		const uint32_t drawInstances = workload == Workload::Scene ? sceneDrawCount : instanceCount;
+		const uint32_t tileInstances = workload == Workload::Scene ? sceneTileCount : 0;
+		DrawParams params;
+		makeGridDrawParams(0, 1, params);
+		if (drawInstances + tileInstances > 0 && drawParameters->setDrawParams(renderPass, params))
+		{
+			if (tileInstances > 0) wgpuRenderPassEncoderDraw(renderPass, UNIT_QUAD_VERTEX_COUNT, tileInstances, vertexCount, drawInstances);
+			if (drawInstances > 0) wgpuRenderPassEncoderDraw(renderPass, vertexCount, drawInstances, 0, 0);
+			++drawsSinceReport;
+		}
+	}
+
+	wgpuRenderPassEncoderEnd(renderPass);
+	wgpuRenderPassEncoderRelease(renderPass);
+	if (gpuTimer) gpuTimer->resolve(encoder);
+
+	if (scaled)
+	{
+		PROFILE_GPU_ZONE(encoder, "upscale");
+		upscaler->encode(encoder, targetView, renderScale);
+	}
+
+	WGPUCommandBufferDescriptor commandBufferDesc = {};
+	commandBufferDesc.label = GPU_LABEL("Command Buffer");
+	stagingBelt->finish();
+	WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(encoder, &commandBufferDesc);
+
+	auto submitStart = std::chrono::steady_clock::now();
+	{
+		PROFILE_ZONE("wgpuQueueSubmit");
+		drawParameters->flush(queue);
+		wgpuQueueSubmit(queue, 1, &commandBuffer);
+		stagingBelt->recall();
+	}
+	auto submitEnd = std::chrono::steady_clock::now();
+	inputLatency->markSubmitted(submitEnd);
+	inputLatency->trackGpuDone(queue);
+
+	{
+		PROFILE_ZONE("wgpuSurfacePresent");
+		swapChain->present();
+	}
+	auto presentEnd = std::chrono::steady_clock::now();
+	inputLatency->markPresented(presentEnd);
+
+	telemetry->record(FrameMetric::Cpu, submitEnd - encodeStart);
+	telemetry->record(FrameMetric::Submit, submitEnd - submitStart);
+	telemetry->record(FrameMetric::Present, presentEnd - submitEnd);
+	if (inputSampleTime != std::chrono::steady_clock::time_point{})
+		recordPresentLatency(presentEnd - inputSampleTime);
+
+	wgpuCommandBufferRelease(commandBuffer);
+	swapChain->release(surfaceFrame);
+	wgpuCommandEncoderRelease(encoder);
+
+	if (gpuTimer) gpuTimer->afterSubmit();
+	if (gpuTimer || inputLatency->hasInFlight() || stagingBelt->hasPendingMaps()) wgpuPollEvents(device, false);
+
+	if (gpuTimer)
+	{
+		gpuTimer->takeResults(gpuDurations);
+		for (uint64_t duration : gpuDurations) telemetry->record(FrameMetric::Gpu, duration);
+		if (!gpuDurations.empty()) lastGpuMs = static_cast<double>(gpuDurations.back()) / 1e6;
+		gpuDurations.clear();
+	}
+	telemetry->endFrame();
+
+	if (resolutionController)
+		updateRenderScale(std::chrono::duration<double, std::milli>(submitEnd - encodeStart).count());
+
+	reportDrawRate();
+}
+
+void Application::recordPresentLatency(std::chrono::steady_clock::duration arg_Latency)
+{
+	telemetry->record(FrameMetric::InputToPresent, arg_Latency);
+
+	const uint64_t latencyNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(arg_Latency).count());
+	if (presentModeSelector->record(latencyNs))
+		swapChain->setPresentMode(presentModeSelector->getMode());
+}
+
+void Application::updateRenderScale(double arg_CpuMs)
+{
+	// GPU time of the scene pass is what scaling affects. Without timestamp queries (headless
+	// only, see initializeRenderPipeline) the frame interval covers it, as each frame waits
+	// for its GPU work.
+	const double boundMs = gpuTimer ? lastGpuMs : lastIntervalMs;
+	if (!resolutionController->update(std::max(arg_CpuMs, boundMs))) return;
+
+	LOG_MSG_SUC("Render scale " << resolutionController->getScale()
+		<< " (smoothed frame " << resolutionController->getSmoothedMs() << " ms)");
+}
+
+void Application::reportDrawRate()
+{
+	if (drawsPerFrame <= 1) return;
+
+	auto now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - drawReportStart).count();
+	if (elapsed < 1.0) return;
+
+	BindGroupCache::Stats cacheStats = bindGroupCache->getStats();
+	LOG_MSG_SUC("Draws/sec ("
+		<< (drawParameterMode == DrawParameterMode::PushConstants ? "push constants" : "uniform ring")
+		<< "): " << static_cast<uint64_t>(drawsSinceReport / elapsed)
+		<< ", bind group cache " << cacheStats.hits << " hits / " << cacheStats.misses << " misses");
+	(void)elapsed;
+	(void)cacheStats;
+
+	drawsSinceReport = 0;
+	drawReportStart = now;
+}
+
+void Application::initializeBuffers()
+{
+	// The shape drawn for each rect: a streamed scene file's mesh, or the unit triangle.
+	std::vector<float> vertexData = {
+		-0.5,	-0.5, 1.0, 0.0, 0.0,
+		+0.5,	-0.5, 0.0, 1.0, 0.0,
+		+0.0,   +0.5, 0.0, 0.0, 1.0
+	};
+	const SceneFormat::ChunkRecord* mesh = sceneFile ? sceneFile->findChunk(SceneFormat::ChunkType::Mesh) : nullptr;
+	if (mesh && mesh->stride == VERTEX_FLOATS * sizeof(float) && mesh->count > 0)
+	{
+		const float* vertices = static_cast<const float*>(sceneFile->getChunkData(*mesh));
+		vertexData.assign(vertices, vertices + static_cast<size_t>(mesh->count) * VERTEX_FLOATS);
+	}
+	assert(vertexData.size() % VERTEX_FLOATS == 0);
+	vertexCount = static_cast<uint32_t>(vertexData.size() / VERTEX_FLOATS);
+
+	// The unit quad of the LOD tiles follows it.
+	vertexData.insert(vertexData.end(), UNIT_QUAD_VERTICES, UNIT_QUAD_VERTICES + UNIT_QUAD_VERTEX_COUNT * VERTEX_FLOATS);
+
+	WGPUBufferDescriptor vertexBufferDesc{};
+	vertexBufferDesc.nextInChain = nullptr;
+	vertexBufferDesc.label = "Vertex buffer";
+	vertexBufferDesc.size = vertexData.size() * sizeof(float);
+	vertexBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex;
+	vertexBufferDesc.mappedAtCreation = false;
+	vertexBuffer = wgpuDeviceCreateBuffer(device, &vertexBufferDesc);
+
+	wgpuQueueWriteBuffer(queue, vertexBuffer, 0, vertexData.data(), vertexBufferDesc.size);
+
+	WGPUCommandEncoderDescriptor encoderDesc{};
+	encoderDesc.nextInChain = nullptr;
+	encoderDesc.label = "Command encoder";
+	WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
+
+	WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, nullptr);
+	wgpuCommandEncoderRelease(encoder);
+	wgpuQueueSubmit(queue, 1, &command);
+	wgpuCommandBufferRelease(command);
+}
+
+void Application::applyWorkload(Workload arg_Workload, uint32_t arg_Size)
+{
+	workload = arg_Workload;
+	if (workload == Workload::Draws) drawsPerFrame = arg_Size;
+	else instanceCount = arg_Size;
+	instancesDirty = true;
+
+	if (workload == Workload::Scene) populateScene();
+}
+
+void Application::updateInstanceBuffer()
+{
+	instanceCount = std::min(instanceCount, getMaxInstances());
+
+	const uint32_t count = workload == Workload::Draws ? 1 : instanceCount;
+	ensureInstanceCapacity(count);
+	instancesDirty = false;
+
+	// The scene uploads its own instances every frame, see updateScene().
+	if (workload == Workload::Scene) return;
+
+	RectInstance* instances = frameArena.allocateArray<RectInstance>(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		DrawParams params;
+		if (workload == Workload::Instances) makeGridDrawParams(i, count, params);
+		else if (workload == Workload::Overdraw) makeLayerDrawParams(i, count, params);
+		else makeGridDrawParams(0, 1, params);
+		instances[i] = makeRectInstance(params);
+	}
+
+	wgpuQueueWriteBuffer(queue, instanceBuffer, 0, instances, static_cast<uint64_t>(count) * sizeof(RectInstance));
+}
+
+void Application::ensureInstanceCapacity(uint32_t arg_Count)
+{
+	const uint64_t size = static_cast<uint64_t>(arg_Count) * sizeof(RectInstance);
+	if (size <= instanceCapacity) return;
+
+	if (instanceBuffer) wgpuBufferRelease(instanceBuffer);
+
+	// Grows in powers of two so a capacity search does not reallocate on every probe.
+	instanceCapacity = sizeof(RectInstance);
+	while (instanceCapacity < size) instanceCapacity *= 2;
+	instanceCapacity = std::min(instanceCapacity, static_cast<uint64_t>(getMaxInstances()) * sizeof(RectInstance));
+
+	WGPUBufferDescriptor instanceBufferDesc{};
+	instanceBufferDesc.label = GPU_LABEL("Instance buffer");
+	instanceBufferDesc.size = instanceCapacity;
+	instanceBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex;
+	instanceBufferDesc.mappedAtCreation = false;
+	instanceBuffer = wgpuDeviceCreateBuffer(device, &instanceBufferDesc);
+}
+
+uint32_t Application::getMaxInstances() const
+{
+	return static_cast<uint32_t>(std::min<uint64_t>(UINT32_MAX, deviceSupportedLimits.limits.maxBufferSize / sizeof(RectInstance)));
+}
+
+void Application::populateScene()
+{
+	// A streamed scene comes from its file.
+	if (sceneStreamer) return;
+
+	instanceCount = std::min(instanceCount, getMaxInstances());
+
+	// Seeded, so that runs of the same size animate the same scene.
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	const float extent = static_cast<float>(sceneExtent);
+	// Rects shrink as the population grows, covering the scene about once in total.
+	const float side = 2.0f * extent / std::sqrt(static_cast<float>(instanceCount));
+
+	scene->clear();
+	scene->reserve(instanceCount);
+	scene->setBounds({ -extent, -extent, extent, extent });
+	for (uint32_t i = 0; i < instanceCount; ++i)
+	{
+		SceneStore::Rect rect{};
+		rect.x = (unit(random) * 2.0f - 1.0f) * extent;
+		rect.y = (unit(random) * 2.0f - 1.0f) * extent;
+		rect.width = side * (0.5f + unit(random));
+		rect.height = side * (0.5f + unit(random));
+		rect.rotation = unit(random) * 6.2831853f;
+		rect.layer = static_cast<float>(i) / static_cast<float>(instanceCount);
+		rect.color = packColor(unit(random), unit(random), unit(random), 1.0f);
+		rect.velocityX = (unit(random) - 0.5f) * 0.5f;
+		rect.velocityY = (unit(random) - 0.5f) * 0.5f;
+		rect.spin = (unit(random) - 0.5f) * 2.0f;
+		scene->add(rect);
+	}
+
+	// Sized for everything being visible, so culling never grows them mid-run.
+	visibleRects.reserve(instanceCount);
+	detailedRects.reserve(instanceCount);
+	// Ids are dense indices of the old scene, so the next sync builds afresh.
+	sceneGrid = SpatialGrid();
+	sceneGridStale = true;
+}
+
+void Application::updateScene(WGPUCommandEncoder arg_Encoder, double arg_RenderScale)
+{
+	PROFILE_ZONE("updateScene");
+
+	sceneDrawCount = 0;
+	sceneTileCount = 0;
+	if (sceneStreamer)
+	{
+		sceneStreamer->update(arg_Encoder, *stagingBelt, camera.getViewBox(), camera.getPixelSize() / arg_RenderScale);
+		return;
+	}
+	if (scene->size() == 0) return;
+
+	// The frame interval is the step, so rects move at the same speed whatever the frame rate.
+	const float dt = static_cast<float>(std::min(lastIntervalMs, MAX_SCENE_STEP_MS) / 1000.0);
+
+	// Rect centers stay inside the scene bounds, so a view containing them shows every rect
+	// and culling would only cost time.
+	const SpatialGrid::Box view = camera.getViewBox();
+	const SceneBounds& bounds = scene->getBounds();
+	const bool showsAll = !sceneCulling
+		|| (view.minX <= bounds.minX && view.minY <= bounds.minY && view.maxX >= bounds.maxX && view.maxY >= bounds.maxY);
+
+	if (showsAll && !sceneLod.isEnabled())
+	{
+		RectInstance* instances = static_cast<RectInstance*>(stagingBelt->write(arg_Encoder, instanceBuffer, 0, scene->size() * sizeof(RectInstance)));
+		scene->update(dt, instances, jobs.get());
+		sceneDrawCount = static_cast<uint32_t>(scene->size());
+		sceneGridStale = true;
+		return;
+	}
+
+	scene->animate(dt, jobs.get());
+
+	// Null selects every rect in dense order.
+	const uint32_t* selected = nullptr;
+	size_t selectedCount = scene->size();
+	if (showsAll)
+	{
+		sceneGridStale = true;
+	}
+	else
+	{
+		PROFILE_ZONE("cullScene");
+		syncSceneGrid();
+		visibleRects.clear();
+		sceneGrid.query(view, visibleRects);
+		selected = visibleRects.data();
+		selectedCount = visibleRects.size();
+	}
+
+	if (sceneLod.isEnabled())
+	{
+		PROFILE_ZONE("aggregateScene");
+		// Pixels grow as the render scale drops, and so does what counts as small.
+		detailedRects.clear();
+		sceneLod.aggregate(*scene, selected, selectedCount, view, camera.getPixelSize() / arg_RenderScale, detailedRects);
+		selected = detailedRects.data();
+		selectedCount = detailedRects.size();
+		sceneTileCount = static_cast<uint32_t>(sceneLod.getTileCount());
+	}
+
+	// Every tile holds at least one rect that is not drawn on its own, so both fit in the
+	// instance buffer sized for the whole scene.
+	const size_t instanceTotal = selectedCount + sceneTileCount;
+	if (instanceTotal == 0) return;
+
+	RectInstance* instances = static_cast<RectInstance*>(stagingBelt->write(arg_Encoder, instanceBuffer, 0, instanceTotal * sizeof(RectInstance)));
+	if (selected) scene->writeInstances(selected, selectedCount, instances, jobs.get());
+	else scene->writeInstances(instances, jobs.get());
+	if (sceneTileCount > 0) sceneLod.writeTiles(instances + selectedCount);
+	sceneDrawCount = static_cast<uint32_t>(selectedCount);
+}
+
+void Application::syncSceneGrid()
+{
+	const SceneBounds& bounds = scene->getBounds();
+	const bool rebuild = sceneGrid.size() != scene->size()
+		|| bounds.minX != sceneGridBounds.minX || bounds.minY != sceneGridBounds.minY
+		|| bounds.maxX != sceneGridBounds.maxX || bounds.maxY != sceneGridBounds.maxY;
+
+	if (rebuild)
+	{
+		sceneGrid.build(bounds, scene->size(), scene->getX(), scene->getY(), scene->getWidth(), scene->getHeight(), nullptr, jobs.get());
+		sceneGridBounds = bounds;
+	}
+	else
+	{
+		// Most rects stay in their cell from one frame to the next and are updated in place;
+		// the rest queue up until the grid rebuilds itself.
+		const float* x = scene->getX();
+		const float* y = scene->getY();
+		const float* width = scene->getWidth();
+		const float* height = scene->getHeight();
+		for (uint32_t i = 0; i < scene->size(); ++i) sceneGrid.move(i, x[i], y[i], width[i], height[i]);
+	}
+	sceneGridStale = false;
+}
+
+void Application::pickScene(double arg_CursorX, double arg_CursorY)
+{
+	// Streamed scenes keep no rects on the CPU to pick from.
+	if (workload != Workload::Scene || !scene || sceneStreamer) return;
+	ALLOC_SCOPE_EXEMPT("pickScene");
+
+	double pixelX = 0.0;
+	double pixelY = 0.0;
+	cursorToViewport(arg_CursorX, arg_CursorY, pixelX, pixelY);
+	float x = 0.0f;
+	float y = 0.0f;
+	camera.pixelToWorld(pixelX, pixelY, x, y);
+
+	if (sceneGridStale) syncSceneGrid();
+
+	pickCandidates.clear();
+	sceneGrid.queryPoint(x, y, pickCandidates);
+
+	SceneHandle handle;
+	if (scene->pick(pickCandidates.data(), pickCandidates.size(), x, y, handle))
+	{
+		LOG_MSG_SUC("Picked rect " << handle.slot << " (generation " << handle.generation << ") at "
+			<< x << ", " << y << " from " << pickCandidates.size() << " candidates");
+	}
+	else
+	{
+		LOG_MSG_SUC("No rect at " << x << ", " << y);
+	}
+	(void)handle;
+}
+
+void Application::getAdapter()
+{
+	surface = options.headless ? nullptr : glfwGetWGPUSurface(instance, window);
+
+	adapter = adapterSelector.select(instance, surface);
+	if (!adapter && adapterSelector.shouldRetry())
+	{
+		// The instance was limited to a stale cached backend; the surface belongs to it too.
+		if (surface) wgpuSurfaceRelease(surface);
+		wgpuInstanceRelease(instance);
+		createInstance();
+		surface = options.headless ? nullptr : glfwGetWGPUSurface(instance, window);
+		adapter = adapterSelector.select(instance, surface);
+	}
+
+	if (!adapter)
+	{
+		LOG_MSG_ERR("No enumerated adapter is usable, falling back to wgpuInstanceRequestAdapter");
+
+		WGPURequestAdapterOptions adapterOpts{};
+		adapterOpts.nextInChain = nullptr;
+		adapterOpts.compatibleSurface = surface;
+		adapterOpts.powerPreference = WGPUPowerPreference_HighPerformance;
+		adapter = requestAdapterSync(instance, adapterOpts);
+	}
+	wgpuInstanceRelease(instance);
+
+	if (!adapter)
+	{
+		glfwTerminate();
+		throw std::runtime_error("Couldn't get adapter");
+	}
+
+	LOG_MSG_SUC("\nGot adapter: " << adapter);
+
+	adapterFeatures = {};
+	size_t featureCount = wgpuAdapterEnumerateFeatures(adapter, nullptr);
+	adapterFeatures.resize(featureCount);
+	wgpuAdapterEnumerateFeatures(adapter, adapterFeatures.data());
+
+	adapterProperties = {};
+	adapterProperties.nextInChain = nullptr;
+	wgpuAdapterGetProperties(adapter, &adapterProperties);
+	adapterName = adapterProperties.name ? adapterProperties.name : "";
+
+	adapterNativeLimits = {};
+	adapterNativeLimits.chain.next = nullptr;
+	adapterNativeLimits.chain.sType = static_cast<WGPUSType>(WGPUSType_SupportedLimitsExtras);
+
+	adapterSupportedLimits = {};
+	adapterSupportedLimits.nextInChain = &adapterNativeLimits.chain;
+	wgpuAdapterGetLimits(adapter, &adapterSupportedLimits);
+	adapterSupportedLimits.nextInChain = nullptr;
+
+#ifdef DEBUG_MODE
+	logAdapter();
+#endif
+}
+
+void Application::getDevice()
+{
+	LimitsNegotiator negotiator(adapterProperties, adapterSupportedLimits, adapterNativeLimits, adapterFeatures);
+	deviceRequirements = negotiator.negotiate(getMaxSurfaceDimension());
+	tierProfile = deviceRequirements.profile;
+
+	selectDrawParameterMode();
+
+	WGPUDeviceDescriptor deviceDesc{};
+	deviceDesc.nextInChain = nullptr;
+	deviceDesc.label = "The device";
+	deviceRequirements.apply(deviceDesc);
+	deviceDesc.defaultQueue.label = "Default queue";
+	deviceDesc.defaultQueue.nextInChain = nullptr;
+	deviceDesc.deviceLostCallback =
+		[](WGPUDeviceLostReason arg_DeviceLostReason, char const* arg_Message, void*)
+		{
+			std::string err_msg = "Device lost: reason " + arg_DeviceLostReason;
+			arg_Message ? err_msg += arg_Message : err_msg;
+			LOG_MSG_SUC(err_msg);
+		};
+
+	device = requestDeviceSync(adapter, &deviceDesc);
+
+	if (!device)
+	{
+		wgpuAdapterRelease(adapter);
+		glfwTerminate();
+		throw std::runtime_error("Could not get device");
+	}
+
+	LOG_MSG_SUC("Got device: " << device);
+	
+	deviceFeatures = {};
+	size_t featureCount = wgpuDeviceEnumerateFeatures(device, nullptr);
+	deviceFeatures.resize(featureCount);
+	wgpuDeviceEnumerateFeatures(device, deviceFeatures.data());
+
+	deviceSupportedLimits = {};
+	deviceSupportedLimits.nextInChain = nullptr;
+	wgpuDeviceGetLimits(device, &deviceSupportedLimits);
+
+#ifdef DEBUG_MODE
+	logDevice();
+#endif
+}
+
+uint32_t Application::getMaxSurfaceDimension() const
+{
+	int largest = static_cast<int>(std::max(options.width, options.height));
+	if (!window) return static_cast<uint32_t>(largest);
+
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	largest = std::max({ framebufferWidth, framebufferHeight });
+
+	int monitorCount = 0;
+	GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
+	for (int i = 0; i < monitorCount; ++i)
+	{
+		// Video modes are in screen coordinates on some platforms; scaling by the content scale
+		// overestimates at worst, which the adapter limit caps.
+		const GLFWvidmode* mode = glfwGetVideoMode(monitors[i]);
+		float scaleX = 1.0f;
+		float scaleY = 1.0f;
+		glfwGetMonitorContentScale(monitors[i], &scaleX, &scaleY);
+		if (mode)
+		{
+			largest = std::max({ largest,
+				static_cast<int>(std::ceil(static_cast<float>(mode->width) * std::max(scaleX, 1.0f))),
+				static_cast<int>(std::ceil(static_cast<float>(mode->height) * std::max(scaleY, 1.0f))) });
+		}
+	}
+
+	return static_cast<uint32_t>(std::max(largest, 1));
+}
+
+void Application::selectDrawParameterMode()
+{
+	const bool pushConstantsSupported =
+		deviceRequirements.pushConstants &&
+		deviceRequirements.nativeLimits.limits.maxPushConstantSize >= sizeof(DrawParams);
+
+	if (drawParameterModeSetting == "uniform")
+		drawParameterMode = DrawParameterMode::UniformRing;
+	else if (drawParameterModeSetting == "push" && !pushConstantsSupported)
+		throw std::runtime_error("Push constants were requested but the adapter does not support them");
+	else
+		drawParameterMode = pushConstantsSupported ? DrawParameterMode::PushConstants : DrawParameterMode::UniformRing;
+
+	LOG_MSG_SUC("Per-draw parameters via "
+		<< (drawParameterMode == DrawParameterMode::PushConstants ? "push constants" : "dynamic-offset uniform ring"));
+}
+
+void Application::getQueue()
+{
+	queue = wgpuDeviceGetQueue(device);
+
+	auto onQueueWorkDone =
+		[](WGPUQueueWorkDoneStatus arg_WorkDoneStatus, void*)
+		{
+			LOG_MSG_DBG("Queue work finished with status: " << arg_WorkDoneStatus);
+			(void)arg_WorkDoneStatus;
+		};
+
+	wgpuQueueOnSubmittedWorkDone(queue, onQueueWorkDone, nullptr);
+}
+
+void Application::initializeRenderPipeline()
+{
+	surfaceFormat = surface ? wgpuSurfaceGetPreferredFormat(surface, adapter) : WGPUTextureFormat_RGBA8Unorm;
+	presentModeSelector = std::make_unique<PresentModeSelector>(
+		PresentModeSelector::Settings::fromConfig(),
+		SwapChain::queryPresentModes(surface, adapter)
+	);
+	wgpuAdapterRelease(adapter);
+
+	int framebufferWidth = static_cast<int>(options.width);
+	int framebufferHeight = static_cast<int>(options.height);
+	if (window) glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	swapChain = std::make_unique<SwapChain>(
+		device,
+		surface,
+		surfaceFormat,
+		static_cast<uint32_t>(framebufferWidth),
+		static_cast<uint32_t>(framebufferHeight),
+		presentModeSelector->getMode(),
+		presentModeSelector->getFrameLatency()
+	);
+
+	inputLatency = std::make_unique<InputLatencyTracker>(InputLatencyTracker::Settings::fromConfig());
+
+	const GLFWvidmode* videoMode = window ? glfwGetVideoMode(glfwGetPrimaryMonitor()) : nullptr;
+	framePacer = std::make_unique<FramePacer>(
+		FramePacer::Settings::fromConfig(videoMode ? videoMode->refreshRate : 60.0),
+		PacerClock::steady()
+	);
+	LOG_MSG_SUC("Frame pacing " << (framePacer->isEnabled() ? "on" : "off")
+		<< ", interval " << framePacer->getIntervalNs() / 1e6 << " ms");
+
+	bindGroupCache = std::make_unique<BindGroupCache>(device);
+	drawParameters = std::make_unique<DrawParameterPath>(
+		device,
+		*bindGroupCache,
+		drawParameterMode,
+		deviceSupportedLimits.limits.minUniformBufferOffsetAlignment,
+		tierProfile.maxDrawsPerFrame
+	);
+	drawReportStart = std::chrono::steady_clock::now();
+
+	telemetry = std::make_unique<FrameTelemetry>(FrameTelemetry::Settings::fromConfig());
+	allocationMonitor = std::make_unique<FrameAllocationMonitor>(FrameAllocationMonitor::Settings::fromConfig());
+
+	jobs = std::make_unique<JobSystem>(JobSystem::Settings::fromConfig());
+	scene = std::make_unique<SceneStore>(SceneStore::Settings::fromConfig());
+	stagingBelt = std::make_unique<StagingBelt>(device, STAGING_CHUNK_SIZE, GPU_LABEL("Staging belt"));
+	LOG_MSG_SUC("Scene kernels: " << scene->getKernelName() << ", " << jobs->getThreadCount() << " job thread(s)");
+
+	if (!sceneFilePath.empty())
+	{
+		sceneStreamStart = std::chrono::steady_clock::now();
+		sceneFile = std::make_unique<SceneFile>(sceneFilePath);
+		sceneStreamer = std::make_unique<SceneStreamer>(device, *sceneFile, SceneStreamer::Settings::fromConfig(), deviceSupportedLimits.limits.maxBufferSize);
+
+		const double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sceneStreamStart).count();
+		const SceneFormat::Header& header = sceneFile->getHeader();
+		if (Config::getString("APP_CAMERA_ZOOM").empty())
+			camera.fit({ header.bounds.minX, header.bounds.minY, header.bounds.maxX, header.bounds.maxY });
+		LOG_MSG_SUC("Scene file " << sceneFilePath << ": " << header.rectCount << " rects in " << header.chunkCount << " chunks on "
+			<< header.levelCount << " levels, " << sceneStreamer->getStats().slots << " GPU slots, opened in " << openMs << " ms");
+		(void)openMs;
+	}
+
+	if (!options.textureDirectory.empty())
+	{
+		textureStreamStart = std::chrono::steady_clock::now();
+		textureStreamer = std::make_unique<TextureStreamer>(device, TextureStreamer::Settings::fromConfig(), deviceSupportedLimits.limits.maxTextureDimension2D);
+
+		std::vector<std::filesystem::path> files;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options.textureDirectory))
+		{
+			const std::string extension = entry.path().extension().string();
+			if (entry.is_regular_file() && (extension == ".texture" || extension == ".qoi" || extension == ".ppm" || extension == ".pgm" || extension == ".pam"))
+				files.push_back(entry.path());
+		}
+		std::sort(files.begin(), files.end());
+		for (const std::filesystem::path& file : files) textureStreamer->request(file.string(), 0);
+		LOG_MSG_SUC("Streaming " << files.size() << " textures from " << options.textureDirectory);
+	}
+
+	if (options.capacitySearch)
+	{
+		CapacitySearch::Limits limits{};
+		limits.draws = drawParameters->getMaxDrawsPerFrame();
+		limits.instances = getMaxInstances();
+		limits.overdraw = MAX_OVERDRAW_LAYERS;
+		limits.scene = getMaxInstances();
+
+		capacitySearch = std::make_unique<CapacitySearch>(CapacitySearch::Settings::fromConfig(), limits);
+		capacitySearch->setContext("adapter", adapterName);
+		capacitySearch->setContext("resolution", std::to_string(options.width) + "x" + std::to_string(options.height));
+		applyWorkload(capacitySearch->getWorkload(), capacitySearch->getSize());
+	}
+	else if (workload == Workload::Scene)
+	{
+		populateScene();
+	}
+
+	if (deviceRequirements.timestampQuery)
+	{
+		gpuTimer = std::make_unique<GpuTimer>(device);
+		gpuDurations.reserve(GpuTimer::DEFAULT_SLOTS);
+		if (!gpuTimer->calibrate())
+		{
+			LOG_MSG_ERR("GPU timestamps do not track the wall clock; GPU timing disabled");
+			gpuTimer.reset();
+		}
+	}
+	// Without timestamp queries the frame interval is the only GPU signal, and a presenting
+	// loop can't tell load from vsync by it: under Fifo it sits at the refresh interval however
+	// idle the GPU is. Headless loops wait for the GPU every frame, so there it is usable.
+	if (dynamicResolution && (gpuTimer || options.headless))
+	{
+		resolutionController = std::make_unique<ResolutionController>(ResolutionController::Settings::fromConfig());
+		upscaler = std::make_unique<Upscaler>(device, queue, *bindGroupCache, surfaceFormat, ShaderProperties::UPSCALE_SHADER_PATH);
+	}
+	else if (dynamicResolution)
+	{
+		LOG_MSG_ERR("Dynamic resolution needs timestamp queries when presenting; disabled");
+	}
+
+	const bool srgbTarget =
+		surfaceFormat == WGPUTextureFormat_BGRA8UnormSrgb ||
+		surfaceFormat == WGPUTextureFormat_RGBA8UnormSrgb;
+
+	activeVariant.defines["SRGB_TARGET"] = srgbTarget ? "1" : "0";
+	activeVariant.defines["PUSH_CONSTANTS"] = drawParameterMode == DrawParameterMode::PushConstants ? "1" : "0";
+	activeVariant.blending = true;
+	activeVariant.colorFormat = surfaceFormat;
+	activeVariant.sampleCount = 1;
+
+	variantCache = std::make_unique<ShaderVariantCache>(
+		device,
+		ShaderProperties::SHADER_PATH,
+		[this](WGPUShaderModule arg_ShaderModule, const ShaderVariantKey& arg_Key) { return createRenderPipeline(arg_ShaderModule, arg_Key); }
+	);
+	const std::string cookedShaderPath = cookedDir + "/rectangle.shader";
+	if (!cookedDir.empty() && std::filesystem::exists(cookedShaderPath))
+	{
+		variantCache->setCookedShaders(std::make_unique<CookedBlob>(cookedShaderPath, CookedFormat::BlobType::Shader));
+		LOG_MSG_SUC("Cooked shaders " << cookedShaderPath);
+	}
+	pipeline = variantCache->getPipeline(activeVariant);
+
+	opaqueVariant = activeVariant;
+	opaqueVariant.blending = false;
+	opaquePipeline = variantCache->getPipeline(opaqueVariant);
+
+	if (ShaderProperties::HOT_RELOAD && (!options.headless || options.shaderReloadRequests > 0))
+	{
+		shaderReloader = std::make_unique<ShaderHotReloader>(
+			device,
+			ShaderProperties::SHADER_PATH,
+			[this]() { return variantCache->preprocess(activeVariant); },
+			[this](WGPUShaderModule arg_ShaderModule) { return createRenderPipeline(arg_ShaderModule, activeVariant); }
+		);
+		shaderReloader->start();
+	}
+}
+
+void Application::swapReloadedPipeline()
+{
+	if (!shaderReloader) return;
+
+	WGPURenderPipeline fresh = shaderReloader->takePendingPipeline();
+	if (!fresh) return;
+
+	ALLOC_SCOPE_EXEMPT("shaderReload");
+
+	variantCache->adopt(activeVariant, fresh);
+	pipeline = fresh;
+	opaquePipeline = nullptr;
+}
+
+WGPURenderPipeline Application::getWorkloadPipeline()
+{
+	// The scene's coverage alpha and the overdraw layers blend; the grids are opaque and
+	// skip the destination read.
+	if (workload != Workload::Draws && workload != Workload::Instances) return pipeline;
+
+	if (!opaquePipeline)
+	{
+		ALLOC_SCOPE_EXEMPT("shaderReload");
+		opaquePipeline = variantCache->getPipeline(opaqueVariant);
+	}
+	return opaquePipeline;
+}
+
+// Called from the render thread at startup and from the shader watcher thread on reload,
+// so it must only read state that is fixed after initialization.
+WGPURenderPipeline Application::createRenderPipeline(WGPUShaderModule arg_ShaderModule, const ShaderVariantKey& arg_Key) const
+{
+	std::vector<WGPUVertexAttribute> vertexAttrib(2);
+
+	vertexAttrib[0].shaderLocation = 0;
+	vertexAttrib[0].format = WGPUVertexFormat_Float32x2;
+	vertexAttrib[0].offset = 0;
+
+	vertexAttrib[1].shaderLocation = 1;
+	vertexAttrib[1].format = WGPUVertexFormat_Float32x3;
+	vertexAttrib[1].offset = 2 * sizeof(float);
+
+	// Per-instance RectInstance: center, size, rotation and layer, packed color.
+	std::vector<WGPUVertexAttribute> instanceAttrib(4);
+
+	instanceAttrib[0].shaderLocation = 2;
+	instanceAttrib[0].format = WGPUVertexFormat_Float32x2;
+	instanceAttrib[0].offset = offsetof(RectInstance, center);
+
+	instanceAttrib[1].shaderLocation = 3;
+	instanceAttrib[1].format = WGPUVertexFormat_Float32x2;
+	instanceAttrib[1].offset = offsetof(RectInstance, size);
+
+	instanceAttrib[2].shaderLocation = 4;
+	instanceAttrib[2].format = WGPUVertexFormat_Float32x2;
+	instanceAttrib[2].offset = offsetof(RectInstance, rotation);
+
+	instanceAttrib[3].shaderLocation = 5;
+	instanceAttrib[3].format = WGPUVertexFormat_Unorm8x4;
+	instanceAttrib[3].offset = offsetof(RectInstance, color);
+
+	std::vector<WGPUVertexBufferLayout> vertexBufferLayouts(2);
+	vertexBufferLayouts[0].attributeCount = 2;
+	vertexBufferLayouts[0].attributes = vertexAttrib.data();
+	vertexBufferLayouts[0].arrayStride = VERTEX_FLOATS * sizeof(float);
+	vertexBufferLayouts[0].stepMode = WGPUVertexStepMode_Vertex;
+
+	vertexBufferLayouts[1].attributeCount = 4;
+	vertexBufferLayouts[1].attributes = instanceAttrib.data();
+	vertexBufferLayouts[1].arrayStride = sizeof(RectInstance);
+	vertexBufferLayouts[1].stepMode = WGPUVertexStepMode_Instance;
+
+	WGPUBlendState blendState{};
+	blendState.color.srcFactor = WGPUBlendFactor_SrcAlpha;
+	blendState.color.dstFactor = WGPUBlendFactor_OneMinusSrcAlpha;
+	blendState.color.operation = WGPUBlendOperation_Add;
+
+	blendState.alpha.srcFactor = WGPUBlendFactor_Zero;
+	blendState.alpha.dstFactor = WGPUBlendFactor_One;
+	blendState.alpha.operation = WGPUBlendOperation_Add;
+
+	WGPUColorTargetState colorTarget{};
+	colorTarget.format = arg_Key.colorFormat;
+	colorTarget.blend = arg_Key.blending ? &blendState : nullptr;
+	colorTarget.writeMask = WGPUColorWriteMask_All;
+
+	WGPURenderPipelineDescriptor pipelineDesc{};
+	pipelineDesc.nextInChain = nullptr;
+	pipelineDesc.layout = drawParameters->getPipelineLayout();
+	pipelineDesc.vertex.bufferCount = vertexBufferLayouts.size();
+	pipelineDesc.vertex.buffers = vertexBufferLayouts.data();
+	pipelineDesc.vertex.module = arg_ShaderModule;
+	pipelineDesc.vertex.entryPoint = "vs_main";
+	pipelineDesc.vertex.constantCount = 0;
+	pipelineDesc.vertex.constants = nullptr;
+
+	pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+	pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+	pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+	pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+
+	WGPUFragmentState fragmentState{};
+	fragmentState.module = arg_ShaderModule;
+	fragmentState.entryPoint = "fs_main";
+	fragmentState.constantCount = 0;
+	fragmentState.constants = nullptr;
+	fragmentState.targetCount = 1;
+	fragmentState.targets = &colorTarget;
+
+	pipelineDesc.fragment = &fragmentState;
+	pipelineDesc.depthStencil = nullptr;
+
+	pipelineDesc.multisample.count = arg_Key.sampleCount;
+	pipelineDesc.multisample.mask = ~0u;
+	pipelineDesc.multisample.alphaToCoverageEnabled = false;
+	
+	return wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
+}
+
+void Application::logAdapter()
+{
+#ifdef DEBUG_MODE
+	LOG_MSG_SUC("Adapter features:");
+	for (const WGPUFeatureName feature : adapterFeatures)
+		LOG_MSG_SUC(" - 0x" << std::hex << feature);
+
+	LOG_MSG_SUC("\nAdapter properties:");
+
+	LOG_MSG_SUC(" - vendorID: "			<< adapterProperties.vendorID);
+	LOG_MSG_SUC(" - vendorName: "			<< adapterProperties.vendorName);
+	LOG_MSG_SUC(" - architecture: "		<< adapterProperties.architecture);
+	LOG_MSG_SUC(" - name: "				<< adapterProperties.name);
+	LOG_MSG_SUC(" - driverDescription: " 	<< adapterProperties.driverDescription);
+	LOG_MSG_SUC(" - backendType: " 		<< adapterProperties.backendType);
+
+	LOG_MSG_SUC("\nAdapter limits:");
+	
+	LOG_MSG_SUC(" - maxTextureDimension1D: " << adapterSupportedLimits.limits.maxTextureDimension1D);
+	LOG_MSG_SUC(" - maxTextureDimension2D: " << adapterSupportedLimits.limits.maxTextureDimension2D);
+	LOG_MSG_SUC(" - maxTextureDimension3D: " << adapterSupportedLimits.limits.maxTextureDimension3D);
+	LOG_MSG_SUC(" - maxTextureArrayLayers: " << adapterSupportedLimits.limits.maxTextureArrayLayers);
+#endif
+}
+
+void Application::logDevice()
+{
+#ifdef DEBUG_MODE
+	LOG_MSG_SUC("Device features:");
+
+	for (const WGPUFeatureName feature : deviceFeatures)
+		LOG_MSG_SUC(" - 0x" << std::hex << feature);
+
+	LOG_MSG_SUC("\nPerformance tier: " << LimitsNegotiator::tierName(tierProfile.tier));
+	LOG_MSG_SUC(" - maxDrawsPerFrame: " << tierProfile.maxDrawsPerFrame);
+	LOG_MSG_SUC(" - maxInstancesPerBatch: " << tierProfile.maxInstancesPerBatch);
+	LOG_MSG_SUC(" - maxBatchBytes: " << tierProfile.maxBatchBytes);
+	LOG_MSG_SUC(" - computeWorkgroupSize: " << tierProfile.computeWorkgroupSize);
+
+	LOG_MSG_SUC("\nDevice limits:");
+
+	LOG_MSG_SUC(" - maxTextureDimension1D: " << deviceSupportedLimits.limits.maxTextureDimension1D);
+	LOG_MSG_SUC(" - maxTextureDimension2D: " << deviceSupportedLimits.limits.maxTextureDimension2D);
+	LOG_MSG_SUC(" - maxTextureDimension3D: " << deviceSupportedLimits.limits.maxTextureDimension3D);
+	LOG_MSG_SUC(" - maxTextureArrayLayers: " << deviceSupportedLimits.limits.maxTextureArrayLayers);
+	LOG_MSG_SUC(" - maxBufferSize: " << deviceSupportedLimits.limits.maxBufferSize);
+	LOG_MSG_SUC(" - maxStorageBufferBindingSize: " << deviceSupportedLimits.limits.maxStorageBufferBindingSize);
+	LOG_MSG_SUC(" - maxComputeInvocationsPerWorkgroup: " << deviceSupportedLimits.limits.maxComputeInvocationsPerWorkgroup);
+#endif
+}
+
+bool Application::getNextSurfaceViewData(SurfaceFrame& arg_Frame)
+{
+	PROFILE_ZONE("getNextSurfaceViewData");
+
+	return swapChain->acquire(arg_Frame);
+}
+
+WGPUAdapter Application::requestAdapterSync(WGPUInstance arg_Instance, WGPURequestAdapterOptions arg_RequestAdapterOpts)
+{
+	struct UserData
+	{
+		WGPUAdapter adapter;
+		bool requestEnded;
+	};
+	UserData userData{};
+	userData.adapter = nullptr;
+	userData.requestEnded = false;
+
+	auto onAdapterRequestEnded =
+		[](WGPURequestAdapterStatus arg_RequestAdapterStatus, WGPUAdapter arg_Adapter, char const* arg_Message, void* arg_UserData)
+		{
+			// Runs inside wgpu's C frames, so failures come back as a null adapter rather
+			// than an exception unwinding through them.
+			UserData& userData = *reinterpret_cast<UserData*>(arg_UserData);
+
+			if (arg_RequestAdapterStatus == WGPURequestAdapterStatus_Success)
+			{
+				userData.adapter = arg_Adapter;
+				LOG_MSG_SUC("Got adapter successfully");
+			}
+			else
+			{
+				LOG_MSG_ERR("WebGPU Adapter request denied: " << (arg_Message ? arg_Message : ""));
+				(void)arg_Message;
+			}
+
+			userData.requestEnded = true;
+		};
+
+	wgpuInstanceRequestAdapter(
+		arg_Instance,
+		&arg_RequestAdapterOpts,
+		onAdapterRequestEnded,
+		(void*)&userData
+	);
+
+	assert(userData.requestEnded);
+
+	return userData.adapter;
+}
+
+WGPUDevice Application::requestDeviceSync(WGPUAdapter arg_Adapter, WGPUDeviceDescriptor const* arg_DeviceDescriptor)
+{
+	struct UserData
+	{
+		WGPUDevice device;
+		bool requestEnded;
+	};
+	UserData userData;
+	userData.device = nullptr;
+	userData.requestEnded = false;
+
+	auto onDeviceRequestEnded =
+		[](WGPURequestDeviceStatus arg_RequestDeviceStatus, WGPUDevice arg_Device, char const* arg_Message, void* arg_UserData)
+		{
+			UserData& userData = *reinterpret_cast<UserData*>(arg_UserData);
+
+			// As for the adapter, a failure is a null device; callers throw once back in C++.
+			if (arg_RequestDeviceStatus == WGPURequestDeviceStatus_Success)
+			{
+				userData.device = arg_Device;
+				LOG_MSG_SUC("\nGot device successfully");
+			}
+			else
+			{
+				LOG_MSG_ERR("WebGPU Device request denied: " << (arg_Message ? arg_Message : ""));
+				(void)arg_Message;
+			}
+
+			userData.requestEnded = true;
+		};
+
+	wgpuAdapterRequestDevice(
+		arg_Adapter,
+		arg_DeviceDescriptor,
+		onDeviceRequestEnded,
+		(void*)&userData
+	);
+
+	assert(userData.requestEnded);
+
+	return userData.device;
+}
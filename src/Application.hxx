@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GLFW/glfw3.h>
+#include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
+
+#include "AdapterSelector.hxx"
+#include "AllocationTracker.hxx"
+#include "BindGroupCache.hxx"
+#include "Camera.hxx"
+#include "CapacitySearch.hxx"
+#include "Config.hxx"
+#include "DeviceLimits.hxx"
+#include "DrawParameters.hxx"
+#include "FrameArena.hxx"
+#include "FramePacer.hxx"
+#include "FrameTelemetry.hxx"
+#include "GpuTimer.hxx"
+#include "InputLatency.hxx"
+#include "JobSystem.hxx"
+#include "PresentModeSelector.hxx"
+#include "ResolutionController.hxx"
+#include "SceneFile.hxx"
+#include "SceneLod.hxx"
+#include "SceneStore.hxx"
+#include "SceneStreamer.hxx"
+#include "SpatialGrid.hxx"
+#include "ShaderHotReload.hxx"
+#include "ShaderVariants.hxx"
+#include "StagingBelt.hxx"
+#include "SwapChain.hxx"
+#include "TextureStreamer.hxx"
+#include "Upscaler.hxx"
+
+class Application
+{
+public:
+	// Headless runs render into an offscreen texture instead of a window surface and wait for
+	// the GPU at the end of every frame, so recorded frame times cover the whole frame.
+	//   APP_HEADLESS         render without a window (default off)
+	//   APP_FRAMES           stop after this many frames, 0 runs until the window closes
+	//   APP_WIDTH/APP_HEIGHT headless target size (default 1280x960)
+	//   APP_DRAWS_PER_FRAME  grid draws per frame (default 1)
+	//   APP_WORKLOAD         draws, instances, overdraw or scene, see Workload (default draws,
+	//                        scene when APP_SCENE_FILE is set)
+	//   APP_INSTANCES        instances, overdraw layers or scene rects in the single draw
+	//                        (default 1)
+	//   APP_CAPACITY         run a CapacitySearch and write its report; implies headless, as
+	//                        a presenting loop would measure the display's refresh instead
+	struct Options
+	{
+		bool headless;
+		uint64_t frames;
+		uint32_t width;
+		uint32_t height;
+		uint32_t drawsPerFrame;
+		Workload workload;
+		uint32_t instances;
+		bool capacitySearch;
+		// Requests this many shader reloads one at a time, each once the previous one was
+		// swapped in or rejected, and stops when all are done (or after frames); hot reloads
+		// even when headless. Set by the APP_SHADER_RELOAD_STRESS self-check.
+		uint32_t shaderReloadRequests;
+		// Every image and cooked .texture blob in this directory is streamed in at startup.
+		//   APP_TEXTURE_DIR  directory of textures to load (default none)
+		std::string textureDirectory;
+		// Stops once every texture is ready or failed (or after frames). Set by the texture
+		// upload benchmark.
+		bool stopAfterTextures;
+
+		static Options fromConfig();
+	};
+
+	Application();
+	explicit Application(Options arg_Options);
+
+	void run();
+
+	// Per-frame wall time in ms, recorded when a frame count was set.
+	const std::vector<double>& getFrameTimes() const { return frameTimes; }
+	const std::string& getAdapterName() const { return adapterName; }
+	uint32_t getDrawsPerFrame() const { return drawsPerFrame; }
+	// Final hot reload and pipeline counters, available once run() returns.
+	const ShaderHotReloader::Stats& getShaderReloadStats() const { return shaderReloadStats; }
+	const ShaderVariantCache::PipelineCounts& getPipelineCounts() const { return pipelineCounts; }
+	// Final texture streaming counters, available once run() returns.
+	const TextureStreamer::Stats& getTextureStats() const { return textureStats; }
+
+private:
+	void initializeGLFW();
+	void initializeWGPU();
+	void createInstance();
+	void createWindow();
+	static void onInputEvent(GLFWwindow* arg_Window);
+	// Scroll zooms at the cursor, right drag pans, Q and E rotate and R resets the camera.
+	void onCameraKey(int arg_Key);
+	void onCameraButton(int arg_Button, int arg_Action);
+	void onCameraCursor(double arg_CursorX, double arg_CursorY);
+	void onCameraScroll(double arg_Offset);
+	// Window coordinates, as GLFW reports the cursor, to framebuffer pixels.
+	void cursorToViewport(double arg_CursorX, double arg_CursorY, double& arg_PixelX, double& arg_PixelY) const;
+	void windowLoop();
+	bool keepRunning(uint64_t arg_Frame) const;
+	// Whether every reload of options.shaderReloadRequests was swapped in or rejected.
+	bool shaderReloadsDone() const;
+	void terminateApplication();
+	void renderFrame();
+	void recordPresentLatency(std::chrono::steady_clock::duration arg_Latency);
+	void updateRenderScale(double arg_CpuMs);
+	void reportDrawRate();
+	void initializeBuffers();
+	void applyWorkload(Workload arg_Workload, uint32_t arg_Size);
+	void updateInstanceBuffer();
+	void ensureInstanceCapacity(uint32_t arg_Count);
+	uint32_t getMaxInstances() const;
+	void populateScene();
+	void updateScene(WGPUCommandEncoder arg_Encoder, double arg_RenderScale);
+	void pickScene(double arg_CursorX, double arg_CursorY);
+	// Brings sceneGrid up to the rects' current positions.
+	void syncSceneGrid();
+	void getAdapter();
+	void getDevice();
+	// Largest width or height the surface can take: the framebuffer, or any monitor it could
+	// be maximized on.
+	uint32_t getMaxSurfaceDimension() const;
+	void selectDrawParameterMode();
+	void getQueue();
+	void initializeRenderPipeline();
+	void swapReloadedPipeline();
+	WGPURenderPipeline getWorkloadPipeline();
+	// Called from the render thread at startup and from the shader watcher thread on reload,
+	// so it must only read state that is fixed after initialization.
+	WGPURenderPipeline createRenderPipeline(WGPUShaderModule arg_ShaderModule, const ShaderVariantKey& arg_Key) const;
+	void logAdapter();
+	void logDevice();
+	bool getNextSurfaceViewData(SurfaceFrame& arg_Frame);
+	WGPUAdapter requestAdapterSync(WGPUInstance arg_Instance, WGPURequestAdapterOptions arg_RequestAdapterOpts);
+	WGPUDevice requestDeviceSync(WGPUAdapter arg_Adapter, WGPUDeviceDescriptor const* arg_DeviceDescriptor);
+
+private:
+	Options options;
+	GLFWwindow* window = nullptr;
+
+	// Vertices of the shape drawn for each rect; the quad of the LOD tiles follows them.
+	uint32_t vertexCount;
+	bool bgFadingUp = true;
+
+	std::vector<WGPUFeatureName> adapterFeatures;
+	std::vector<WGPUFeatureName> deviceFeatures;
+	WGPUAdapterProperties adapterProperties;
+	WGPUSupportedLimits adapterSupportedLimits;
+	WGPUSupportedLimitsExtras adapterNativeLimits;
+	DeviceRequirements deviceRequirements;
+	TierProfile tierProfile;
+	WGPUSupportedLimits deviceSupportedLimits;
+	WGPUTextureFormat surfaceFormat;
+	std::unique_ptr<SwapChain> swapChain;
+	std::unique_ptr<PresentModeSelector> presentModeSelector;
+	// End of the event poll whose input the next frame renders.
+	std::chrono::steady_clock::time_point inputSampleTime;
+	std::unique_ptr<FramePacer> framePacer;
+	std::unique_ptr<InputLatencyTracker> inputLatency;
+	// Time the current frame spent waiting for a surface texture, excluded from pacing work.
+	int64_t surfaceWaitNs = 0;
+	WGPUBuffer vertexBuffer;
+	// Per-instance RectInstances, applied before the per-draw DrawParams. Draws use a single
+	// identity instance; the instanced workloads write one entry per instance, the scene
+	// workload through the staging belt every frame.
+	WGPUBuffer instanceBuffer = nullptr;
+	uint64_t instanceCapacity = 0;
+	bool instancesDirty = true;
+
+	WGPUInstance instance;
+	WGPUAdapter adapter;
+	WGPUDevice device;
+	WGPUQueue queue;
+	WGPUSurface surface = nullptr;
+	WGPURenderPipeline pipeline;
+	std::string adapterName;
+
+	ShaderVariantKey activeVariant;
+	// activeVariant without blending, for the grid workloads whose instances are all opaque.
+	// Null after a hot reload until the next frame rebuilds it from the new source.
+	ShaderVariantKey opaqueVariant;
+	WGPURenderPipeline opaquePipeline = nullptr;
+	// Shader modules come from <dir>/rectangle.shader when the cook target wrote one; variants
+	// it lacks are preprocessed from the sources. Re-run the cook target after editing shaders.
+	//   APP_COOKED_DIR  output directory of asset_cooker (default none)
+	const std::string cookedDir = Config::getString("APP_COOKED_DIR");
+	std::unique_ptr<ShaderVariantCache> variantCache;
+	std::unique_ptr<ShaderHotReloader> shaderReloader;
+	ShaderHotReloader::Stats shaderReloadStats{};
+	ShaderVariantCache::PipelineCounts pipelineCounts{};
+	uint32_t shaderReloadsIssued = 0;
+
+	// More than one draw per frame tiles the triangle in a grid and logs draws/sec.
+	uint32_t drawsPerFrame;
+	Workload workload;
+	uint32_t instanceCount;
+	std::unique_ptr<CapacitySearch> capacitySearch;
+
+	// Rects of the scene workload, animated on the job system straight into staging memory.
+	std::unique_ptr<JobSystem> jobs;
+	std::unique_ptr<SceneStore> scene;
+	std::unique_ptr<StagingBelt> stagingBelt;
+	// Rebuilt from the scene every frame the camera shows only part of it; only rects it
+	// finds in the view are uploaded. Rects below the LOD detail size are drawn as tiles.
+	//   APP_SCENE_CULL    cull the scene to the view before upload (default on)
+	//   APP_SCENE_EXTENT  half size of the square the scene spans, 1 filling the initial view
+	//                     vertically (default 1)
+	const bool sceneCulling = Config::getBool("APP_SCENE_CULL", true);
+	const double sceneExtent = std::clamp(Config::getDouble("APP_SCENE_EXTENT", 1.0), 0.01, 1000.0);
+	Camera camera{ Camera::Settings::fromConfig() };
+	// Built once, then kept up to date with per-rect moves; rebuilt when the scene or its
+	// bounds change. Not updated while the whole scene is in view; picking catches it up then.
+	SpatialGrid sceneGrid;
+	SceneBounds sceneGridBounds{};
+	bool sceneGridStale = true;
+	// A scene file streamed in place of the generated rects; the camera starts fitted to its
+	// bounds unless APP_CAMERA_ZOOM is set.
+	//   APP_SCENE_FILE  scene file written by scene_convert (default none)
+	const std::string sceneFilePath = Config::getString("APP_SCENE_FILE");
+	std::unique_ptr<SceneFile> sceneFile;
+	std::unique_ptr<SceneStreamer> sceneStreamer;
+	std::chrono::steady_clock::time_point sceneStreamStart;
+	bool sceneStreamDrawn = false;
+	// Streams options.textureDirectory; the time until all are resident is logged, and upload
+	// stats at teardown.
+	std::unique_ptr<TextureStreamer> textureStreamer;
+	TextureStreamer::Stats textureStats{};
+	std::chrono::steady_clock::time_point textureStreamStart;
+	bool texturesStreamed = false;
+	SceneLod sceneLod{ SceneLod::Settings::fromConfig() };
+	std::vector<uint32_t> visibleRects;
+	std::vector<uint32_t> detailedRects;
+	std::vector<uint32_t> pickCandidates;
+	uint32_t sceneDrawCount = 0;
+	uint32_t sceneTileCount = 0;
+	bool cameraDragging = false;
+	double dragCursorX = 0.0;
+	double dragCursorY = 0.0;
+
+	// Scratch memory for the current frame, reset at frame start.
+	FrameArena frameArena;
+	std::unique_ptr<FrameAllocationMonitor> allocationMonitor;
+	// Read at construction rather than static init so that command line overrides apply.
+	// "push" or "uniform" to force a per-draw parameter path, empty to pick in getDevice().
+	const std::string drawParameterModeSetting = Config::getString("APP_DRAW_PARAM_MODE");
+
+	AdapterSelector adapterSelector{ AdapterSelector::Preferences::fromConfig() };
+
+	DrawParameterMode drawParameterMode = DrawParameterMode::UniformRing;
+	std::unique_ptr<BindGroupCache> bindGroupCache;
+	std::unique_ptr<DrawParameterPath> drawParameters;
+	uint64_t drawsSinceReport = 0;
+	std::chrono::steady_clock::time_point drawReportStart;
+
+	std::unique_ptr<FrameTelemetry> telemetry;
+	std::unique_ptr<GpuTimer> gpuTimer;
+	std::vector<uint64_t> gpuDurations;
+	std::chrono::steady_clock::time_point lastFrameStart;
+	double lastIntervalMs = 0.0;
+	double lastGpuMs = 0.0;
+	std::vector<double> frameTimes;
+
+	// Renders the scene below surface resolution when frames run over APP_DYNRES_BUDGET_MS.
+	// Needs timestamp queries unless headless.
+	const bool dynamicResolution = Config::getBool("APP_DYNRES", false);
+	std::unique_ptr<ResolutionController> resolutionController;
+	std::unique_ptr<Upscaler> upscaler;
+};
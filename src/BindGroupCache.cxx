@@ -0,0 +1,166 @@
+#include "BindGroupCache.hxx"
+#include "GpuDebug.hxx"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+	const uint64_t FNV_OFFSET = 14695981039346656037ull;
+	const uint64_t FNV_PRIME = 1099511628211ull;
+
+	template <typename T>
+	void hashValue(uint64_t& arg_Hash, T arg_Value)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&arg_Value);
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			arg_Hash ^= bytes[i];
+			arg_Hash *= FNV_PRIME;
+		}
+	}
+}
+
+BindGroupCache::BindGroupCache(WGPUDevice arg_Device)
+	: device(arg_Device)
+{
+}
+
+BindGroupCache::~BindGroupCache()
+{
+	clear();
+}
+
+WGPUBindGroup BindGroupCache::get(WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount)
+{
+	const uint64_t hash = hashDescriptor(arg_Layout, arg_Entries, arg_EntryCount);
+
+	std::vector<Cached>& bucket = buckets[hash];
+	for (const Cached& cached : bucket)
+	{
+		if (matches(cached, arg_Layout, arg_Entries, arg_EntryCount))
+		{
+			++hits;
+			return cached.bindGroup;
+		}
+	}
+
+	WGPUBindGroupDescriptor bindGroupDesc{};
+	bindGroupDesc.nextInChain = nullptr;
+	bindGroupDesc.label = GPU_LABEL("Cached bind group");
+	bindGroupDesc.layout = arg_Layout;
+	bindGroupDesc.entryCount = arg_EntryCount;
+	bindGroupDesc.entries = arg_Entries;
+
+	WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(device, &bindGroupDesc);
+	if (!bindGroup) throw std::runtime_error("Could not create bind group");
+
+	Cached cached{};
+	cached.layout = arg_Layout;
+	cached.entries.assign(arg_Entries, arg_Entries + arg_EntryCount);
+	cached.bindGroup = bindGroup;
+	bucket.push_back(std::move(cached));
+
+	++misses;
+	++size;
+
+	return bindGroup;
+}
+
+void BindGroupCache::evictBuffer(WGPUBuffer arg_Buffer)
+{
+	evictWhere([arg_Buffer](const Cached& arg_Cached)
+		{
+			return std::any_of(arg_Cached.entries.begin(), arg_Cached.entries.end(),
+				[arg_Buffer](const WGPUBindGroupEntry& arg_Entry) { return arg_Entry.buffer == arg_Buffer; });
+		});
+}
+
+void BindGroupCache::evictTextureView(WGPUTextureView arg_TextureView)
+{
+	evictWhere([arg_TextureView](const Cached& arg_Cached)
+		{
+			return std::any_of(arg_Cached.entries.begin(), arg_Cached.entries.end(),
+				[arg_TextureView](const WGPUBindGroupEntry& arg_Entry) { return arg_Entry.textureView == arg_TextureView; });
+		});
+}
+
+void BindGroupCache::evictLayout(WGPUBindGroupLayout arg_Layout)
+{
+	evictWhere([arg_Layout](const Cached& arg_Cached) { return arg_Cached.layout == arg_Layout; });
+}
+
+void BindGroupCache::clear()
+{
+	for (auto& bucket : buckets)
+	{
+		for (Cached& cached : bucket.second)
+			wgpuBindGroupRelease(cached.bindGroup);
+	}
+
+	buckets.clear();
+	size = 0;
+}
+
+template <typename Predicate>
+void BindGroupCache::evictWhere(Predicate arg_Predicate)
+{
+	for (auto bucket = buckets.begin(); bucket != buckets.end();)
+	{
+		std::vector<Cached>& cachedList = bucket->second;
+		for (size_t i = 0; i < cachedList.size();)
+		{
+			if (!arg_Predicate(cachedList[i]))
+			{
+				++i;
+				continue;
+			}
+
+			wgpuBindGroupRelease(cachedList[i].bindGroup);
+			cachedList[i] = std::move(cachedList.back());
+			cachedList.pop_back();
+			--size;
+		}
+
+		// Hashes of released resources never come back, so empty buckets would only pile up.
+		bucket = cachedList.empty() ? buckets.erase(bucket) : std::next(bucket);
+	}
+}
+
+uint64_t BindGroupCache::hashDescriptor(WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount)
+{
+	uint64_t hash = FNV_OFFSET;
+	hashValue(hash, arg_Layout);
+
+	for (size_t i = 0; i < arg_EntryCount; ++i)
+	{
+		hashValue(hash, arg_Entries[i].binding);
+		hashValue(hash, arg_Entries[i].buffer);
+		hashValue(hash, arg_Entries[i].offset);
+		hashValue(hash, arg_Entries[i].size);
+		hashValue(hash, arg_Entries[i].sampler);
+		hashValue(hash, arg_Entries[i].textureView);
+	}
+
+	return hash;
+}
+
+bool BindGroupCache::matches(const Cached& arg_Cached, WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount)
+{
+	if (arg_Cached.layout != arg_Layout || arg_Cached.entries.size() != arg_EntryCount) return false;
+
+	for (size_t i = 0; i < arg_EntryCount; ++i)
+	{
+		const WGPUBindGroupEntry& a = arg_Cached.entries[i];
+		const WGPUBindGroupEntry& b = arg_Entries[i];
+
+		if (a.binding != b.binding || a.buffer != b.buffer || a.offset != b.offset || a.size != b.size ||
+			a.sampler != b.sampler || a.textureView != b.textureView)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+// Creates each distinct (layout, entries) bind group once. Lookups hash the descriptor in
+// place and compare against the stored entries, so a hit performs no allocation and no
+// WebGPU call. Entries referencing a resource must be evicted before it is released, since a
+// handle created later may reuse its address.
+class BindGroupCache
+{
+public:
+	struct Stats
+	{
+		uint64_t hits;
+		uint64_t misses;
+		size_t size;
+	};
+
+	explicit BindGroupCache(WGPUDevice arg_Device);
+	~BindGroupCache();
+
+	BindGroupCache(const BindGroupCache&) = delete;
+	BindGroupCache& operator=(const BindGroupCache&) = delete;
+
+	// The returned bind group stays owned by the cache.
+	WGPUBindGroup get(WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount);
+
+	void evictBuffer(WGPUBuffer arg_Buffer);
+	void evictTextureView(WGPUTextureView arg_TextureView);
+	void evictLayout(WGPUBindGroupLayout arg_Layout);
+	void clear();
+
+	Stats getStats() const { return { hits, misses, size }; }
+
+private:
+	struct Cached
+	{
+		WGPUBindGroupLayout layout;
+		std::vector<WGPUBindGroupEntry> entries;
+		WGPUBindGroup bindGroup;
+	};
+
+	static uint64_t hashDescriptor(WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount);
+	static bool matches(const Cached& arg_Cached, WGPUBindGroupLayout arg_Layout, const WGPUBindGroupEntry* arg_Entries, size_t arg_EntryCount);
+	// Releases every entry arg_Predicate(const Cached&) is true for.
+	template <typename Predicate>
+	void evictWhere(Predicate arg_Predicate);
+
+private:
+	WGPUDevice device;
+	std::unordered_map<uint64_t, std::vector<Cached>> buckets;
+
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	size_t size = 0;
+};
@@ -0,0 +1,165 @@
+#include "Camera.hxx"
+#include "Config.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Beyond these the float positions of the scene no longer resolve a pixel, or a single
+	// pixel spans the whole scene many times over.
+	const double MIN_ZOOM = 1e-3;
+	const double MAX_ZOOM = 1e5;
+	const double PI = 3.14159265358979323846;
+}
+
+Camera::Settings Camera::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.x = Config::getDouble("APP_CAMERA_X", 0.0);
+	settings.y = Config::getDouble("APP_CAMERA_Y", 0.0);
+	settings.zoom = std::clamp(Config::getDouble("APP_CAMERA_ZOOM", 1.0), MIN_ZOOM, MAX_ZOOM);
+	settings.rotation = Config::getDouble("APP_CAMERA_ROTATION", 0.0) * PI / 180.0;
+
+	return settings;
+}
+
+Camera::Camera(Settings arg_Settings)
+	: settings(arg_Settings)
+{
+	reset();
+}
+
+void Camera::setViewport(uint32_t arg_Width, uint32_t arg_Height)
+{
+	width = std::max(1u, arg_Width);
+	height = std::max(1u, arg_Height);
+}
+
+void Camera::pan(double arg_DeltaX, double arg_DeltaY)
+{
+	// Pixels run down the viewport while world y runs up.
+	const double x = arg_DeltaX * getPixelSize();
+	const double y = -arg_DeltaY * getPixelSize();
+	const double c = std::cos(rotation);
+	const double s = std::sin(rotation);
+	centerX -= c * x - s * y;
+	centerY -= s * x + c * y;
+}
+
+void Camera::zoomAt(double arg_Factor, double arg_PixelX, double arg_PixelY)
+{
+	double beforeX = 0.0;
+	double beforeY = 0.0;
+	locate(arg_PixelX, arg_PixelY, beforeX, beforeY);
+
+	zoom = std::clamp(zoom * arg_Factor, MIN_ZOOM, MAX_ZOOM);
+
+	double afterX = 0.0;
+	double afterY = 0.0;
+	locate(arg_PixelX, arg_PixelY, afterX, afterY);
+	centerX += beforeX - afterX;
+	centerY += beforeY - afterY;
+}
+
+void Camera::rotate(double arg_Radians)
+{
+	rotation = std::fmod(rotation + arg_Radians, 2.0 * PI);
+}
+
+void Camera::reset()
+{
+	centerX = settings.x;
+	centerY = settings.y;
+	zoom = settings.zoom;
+	rotation = settings.rotation;
+}
+
+void Camera::fit(const SpatialGrid::Box& arg_Box)
+{
+	// A zoom of 1 shows two world units across the height.
+	const double extent = 0.5 * std::max(arg_Box.maxX - arg_Box.minX, arg_Box.maxY - arg_Box.minY);
+	settings.x = 0.5 * (static_cast<double>(arg_Box.minX) + arg_Box.maxX);
+	settings.y = 0.5 * (static_cast<double>(arg_Box.minY) + arg_Box.maxY);
+	settings.zoom = extent > 0.0 ? std::clamp(1.0 / extent, MIN_ZOOM, MAX_ZOOM) : 1.0;
+	reset();
+}
+
+void Camera::pixelToWorld(double arg_PixelX, double arg_PixelY, float& arg_X, float& arg_Y) const
+{
+	double x = 0.0;
+	double y = 0.0;
+	locate(arg_PixelX, arg_PixelY, x, y);
+	arg_X = static_cast<float>(x);
+	arg_Y = static_cast<float>(y);
+}
+
+SpatialGrid::Box Camera::getViewBox() const
+{
+	const double c = std::abs(std::cos(rotation));
+	const double s = std::abs(std::sin(rotation));
+	const double extentX = c * halfWidth() + s * halfHeight();
+	const double extentY = s * halfWidth() + c * halfHeight();
+
+	return {
+		static_cast<float>(centerX - extentX),
+		static_cast<float>(centerY - extentY),
+		static_cast<float>(centerX + extentX),
+		static_cast<float>(centerY + extentY)
+	};
+}
+
+double Camera::getPixelSize() const
+{
+	return 2.0 * halfHeight() / height;
+}
+
+CameraParams Camera::getParams() const
+{
+	// Rotate by -rotation about the center, then scale the visible half extents to one.
+	const double c = std::cos(rotation);
+	const double s = std::sin(rotation);
+	const double scaleX = 1.0 / halfWidth();
+	const double scaleY = 1.0 / halfHeight();
+	const double m00 = scaleX * c;
+	const double m01 = scaleX * s;
+	const double m10 = -scaleY * s;
+	const double m11 = scaleY * c;
+
+	CameraParams params{};
+	params.matrix[0] = static_cast<float>(m00);
+	params.matrix[1] = static_cast<float>(m10);
+	params.matrix[2] = static_cast<float>(m01);
+	params.matrix[3] = static_cast<float>(m11);
+	params.offset[0] = static_cast<float>(-(m00 * centerX + m01 * centerY));
+	params.offset[1] = static_cast<float>(-(m10 * centerX + m11 * centerY));
+	return params;
+}
+
+CameraParams Camera::identity()
+{
+	CameraParams params{};
+	params.matrix[0] = 1.0f;
+	params.matrix[3] = 1.0f;
+	return params;
+}
+
+void Camera::locate(double arg_PixelX, double arg_PixelY, double& arg_X, double& arg_Y) const
+{
+	const double viewX = (2.0 * arg_PixelX / width - 1.0) * halfWidth();
+	const double viewY = (1.0 - 2.0 * arg_PixelY / height) * halfHeight();
+	const double c = std::cos(rotation);
+	const double s = std::sin(rotation);
+	arg_X = centerX + c * viewX - s * viewY;
+	arg_Y = centerY + s * viewX + c * viewY;
+}
+
+double Camera::halfWidth() const
+{
+	return halfHeight() * width / height;
+}
+
+double Camera::halfHeight() const
+{
+	return 1.0 / zoom;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+
+#include "DrawParameters.hxx"
+#include "SpatialGrid.hxx"
+
+// 2D view onto the scene: the world point at the viewport center, a zoom, where 1 shows two
+// world units across the viewport height, and a counterclockwise rotation. World units are
+// square on screen whatever the viewport aspect. State is kept in double so that panning at
+// deep zoom does not drift; the CameraParams handed to the shader are float.
+//   APP_CAMERA_X/APP_CAMERA_Y  world point at the viewport center (default 0, 0)
+//   APP_CAMERA_ZOOM            initial zoom (default 1)
+//   APP_CAMERA_ROTATION        initial rotation in degrees (default 0)
+class Camera
+{
+public:
+	struct Settings
+	{
+		double x;
+		double y;
+		double zoom;
+		double rotation;
+
+		static Settings fromConfig();
+	};
+
+	explicit Camera(Settings arg_Settings);
+
+	// Viewport size in pixels; the aspect ratio and the pixel size follow it.
+	void setViewport(uint32_t arg_Width, uint32_t arg_Height);
+
+	// Moves the view by a drag of the given pixels, so the content follows the cursor.
+	void pan(double arg_DeltaX, double arg_DeltaY);
+	// Multiplies the zoom by arg_Factor, keeping the world point under the pixel in place.
+	void zoomAt(double arg_Factor, double arg_PixelX, double arg_PixelY);
+	void rotate(double arg_Radians);
+	// Back to the initial settings.
+	void reset();
+	// Makes the initial view the one centered on the box that fits it into the viewport
+	// height, and resets to it.
+	void fit(const SpatialGrid::Box& arg_Box);
+
+	// World point under a viewport pixel, measured from the top left.
+	void pixelToWorld(double arg_PixelX, double arg_PixelY, float& arg_X, float& arg_Y) const;
+	// Bounding box of the visible part of the world, which is larger than the view itself
+	// while rotated.
+	SpatialGrid::Box getViewBox() const;
+	// World units per viewport pixel.
+	double getPixelSize() const;
+
+	CameraParams getParams() const;
+	// Passes positions through as clip space, for the workloads laid out in clip space.
+	static CameraParams identity();
+
+	double getZoom() const { return zoom; }
+	double getRotation() const { return rotation; }
+
+private:
+	// pixelToWorld() without rounding to float.
+	void locate(double arg_PixelX, double arg_PixelY, double& arg_X, double& arg_Y) const;
+	// Half the visible width and height in world units.
+	double halfWidth() const;
+	double halfHeight() const;
+
+private:
+	Settings settings;
+	double centerX;
+	double centerY;
+	double zoom;
+	double rotation;
+	uint32_t width = 1;
+	uint32_t height = 1;
+};
@@ -0,0 +1,325 @@
+#include "CapacitySearch.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+	double toMs(uint64_t arg_Ns)
+	{
+		return static_cast<double>(arg_Ns) / 1e6;
+	}
+
+	std::string escapeJson(const std::string& arg_Text)
+	{
+		std::string escaped;
+		escaped.reserve(arg_Text.size());
+		for (char c : arg_Text)
+		{
+			if (c == '"' || c == '\\') escaped += '\\';
+			escaped += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+		}
+		return escaped;
+	}
+}
+
+CapacitySearch::Settings CapacitySearch::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.budgetMs = std::max(0.1, Config::getDouble("APP_CAPACITY_BUDGET_MS", 1000.0 / 60.0));
+	settings.percentile = std::clamp(Config::getDouble("APP_CAPACITY_PERCENTILE", 99.0), 1.0, 100.0);
+	settings.warmupFrames = static_cast<uint32_t>(std::clamp(Config::getInt("APP_CAPACITY_WARMUP", 10), 0LL, 10000LL));
+	settings.sampleFrames = static_cast<uint32_t>(std::clamp(Config::getInt("APP_CAPACITY_FRAMES", 120), 10LL, 100000LL));
+	settings.tolerance = std::clamp(Config::getDouble("APP_CAPACITY_TOLERANCE", 0.05), 0.0, 1.0);
+	settings.reportPath = Config::getString("APP_CAPACITY_OUT");
+
+	std::stringstream names(Config::getString("APP_CAPACITY_WORKLOADS", "draws,instances,overdraw"));
+	std::string name;
+	while (std::getline(names, name, ','))
+	{
+		Workload workload;
+		if (parseWorkload(name, workload))
+		{
+			settings.workloads.push_back(workload);
+		}
+		else
+		{
+			LOG_MSG_ERR("Unknown capacity workload '" << name << "', skipping it");
+		}
+	}
+
+	return settings;
+}
+
+CapacitySearch::CapacitySearch(Settings arg_Settings, Limits arg_Limits)
+	: settings(std::move(arg_Settings)),
+	limits(arg_Limits)
+{
+	finished = settings.workloads.empty();
+	if (!finished) startWorkload();
+}
+
+bool CapacitySearch::record(double arg_FrameMs)
+{
+	if (finished) return false;
+
+	++current.frames;
+	if (frameInProbe++ < settings.warmupFrames) return false;
+
+	probeFrames.record(static_cast<uint64_t>(std::max(0.0, arg_FrameMs) * 1e6));
+	if (probeFrames.getCount() < settings.sampleFrames) return false;
+
+	finishProbe();
+	return !finished;
+}
+
+void CapacitySearch::startWorkload()
+{
+	current = Result{};
+	current.workload = settings.workloads[workloadIndex];
+	current.limit = std::max(1u, getLimit(current.workload));
+
+	ramping = true;
+	size = 1;
+	frameInProbe = 0;
+	probeFrames.reset();
+}
+
+void CapacitySearch::finishProbe()
+{
+	Probe probe{};
+	probe.size = size;
+	probe.percentileMs = toMs(probeFrames.percentile(settings.percentile));
+	probe.meanMs = probeFrames.getMean() / 1e6;
+	probe.passed = probe.percentileMs <= settings.budgetMs;
+	current.probes.push_back(probe);
+
+	LOG_MSG_SUC("Capacity " << workloadName(current.workload) << " " << size
+		<< ": p" << settings.percentile << " " << probe.percentileMs << " ms, "
+		<< (probe.passed ? "within" : "over") << " budget");
+
+	if (probe.passed)
+	{
+		current.ceiling = size;
+		current.ceilingMs = probe.percentileMs;
+	}
+	else
+	{
+		current.failSize = size;
+		current.failMs = probe.percentileMs;
+		ramping = false;
+	}
+
+	frameInProbe = 0;
+	probeFrames.reset();
+
+	if (ramping)
+	{
+		if (size >= current.limit)
+		{
+			finishWorkload();
+			return;
+		}
+		size = static_cast<uint32_t>(std::min<uint64_t>(current.limit, static_cast<uint64_t>(size) * 2));
+		return;
+	}
+
+	const uint32_t gap = current.failSize - current.ceiling;
+	const uint32_t resolution = std::max(1u, static_cast<uint32_t>(current.ceiling * settings.tolerance));
+	if (gap <= resolution)
+	{
+		finishWorkload();
+		return;
+	}
+	size = current.ceiling + gap / 2;
+}
+
+void CapacitySearch::finishWorkload()
+{
+	LOG_MSG_SUC("Capacity " << workloadName(current.workload) << ": " << current.ceiling
+		<< (current.failSize == 0 ? " (renderer limit)" : "") << " within " << settings.budgetMs << " ms");
+
+	results.push_back(current);
+	if (++workloadIndex < settings.workloads.size()) startWorkload();
+	else finished = true;
+}
+
+uint32_t CapacitySearch::getLimit(Workload arg_Workload) const
+{
+	switch (arg_Workload)
+	{
+	case Workload::Draws: return limits.draws;
+	case Workload::Instances: return limits.instances;
+	case Workload::Overdraw: return limits.overdraw;
+	case Workload::Scene: return limits.scene;
+	}
+	return 1;
+}
+
+std::string CapacitySearch::toJson() const
+{
+	std::ostringstream out;
+	out << std::setprecision(9);
+
+	out << "{\n  \"context\": {";
+	bool first = true;
+	for (const auto& [key, value] : context)
+	{
+		out << (first ? "\n" : ",\n") << "    \"" << escapeJson(key) << "\": \"" << escapeJson(value) << '"';
+		first = false;
+	}
+	out << "\n  },\n  \"budgetMs\": " << settings.budgetMs
+		<< ",\n  \"percentile\": " << settings.percentile
+		<< ",\n  \"sampleFrames\": " << settings.sampleFrames
+		<< ",\n  \"workloads\": [";
+
+	first = true;
+	for (const Result& result : results)
+	{
+		out << (first ? "\n" : ",\n") << "    { \"workload\": \"" << workloadName(result.workload) << '"'
+			<< ", \"ceiling\": " << result.ceiling
+			<< ", \"ceilingMs\": " << result.ceilingMs
+			<< ", \"failSize\": " << result.failSize
+			<< ", \"failMs\": " << result.failMs
+			<< ", \"limit\": " << result.limit
+			<< ", \"frames\": " << result.frames
+			<< ",\n      \"probes\": [";
+		first = false;
+
+		for (size_t i = 0; i < result.probes.size(); ++i)
+		{
+			const Probe& probe = result.probes[i];
+			out << (i == 0 ? " " : ", ") << "{ \"size\": " << probe.size
+				<< ", \"percentileMs\": " << probe.percentileMs
+				<< ", \"meanMs\": " << probe.meanMs
+				<< ", \"passed\": " << (probe.passed ? "true" : "false") << " }";
+		}
+		out << " ] }";
+	}
+	out << "\n  ]\n}\n";
+
+	return out.str();
+}
+
+void CapacitySearch::writeReport() const
+{
+	const std::string json = toJson();
+	if (settings.reportPath.empty())
+	{
+		std::cout << json;
+		return;
+	}
+
+	std::ofstream file(settings.reportPath, std::ios::trunc);
+	if (!file)
+	{
+		LOG_MSG_ERR("Could not write capacity report to " << settings.reportPath);
+		return;
+	}
+	file << json;
+}
+
+void CapacitySearch::logSummary() const
+{
+	for (const Result& result : results)
+	{
+		LOG_MSG_SUC("Sustainable " << workloadName(result.workload) << " per frame: " << result.ceiling
+			<< " (p" << settings.percentile << " " << result.ceilingMs << " ms"
+			<< (result.failSize == 0 ? ", renderer limit reached" : "")
+			<< ", " << result.probes.size() << " probes)");
+		(void)result;
+	}
+}
+
+const char* CapacitySearch::workloadName(Workload arg_Workload)
+{
+	switch (arg_Workload)
+	{
+	case Workload::Draws: return "draws";
+	case Workload::Instances: return "instances";
+	case Workload::Overdraw: return "overdraw";
+	case Workload::Scene: return "scene";
+	}
+	return "unknown";
+}
+
+bool CapacitySearch::parseWorkload(const std::string& arg_Name, Workload& arg_Workload)
+{
+	if (arg_Name == "draws") arg_Workload = Workload::Draws;
+	else if (arg_Name == "instances") arg_Workload = Workload::Instances;
+	else if (arg_Name == "overdraw") arg_Workload = Workload::Overdraw;
+	else if (arg_Name == "scene") arg_Workload = Workload::Scene;
+	else return false;
+
+	return true;
+}
+
+std::vector<CapacitySearch::SimulationResult> CapacitySearch::simulate(const Settings& arg_Settings)
+{
+	struct Curve
+	{
+		const char* name;
+		double fixedMs;
+		double perItemMs;
+		uint32_t limit;
+	};
+
+	const double budget = arg_Settings.budgetMs;
+	const double noiseRatio = 0.03;
+
+	const std::vector<Curve> curves = {
+		{ "draw bound", budget * 0.05, budget / 4000.0, 65536 },
+		{ "vertex bound", budget * 0.05, budget / 800000.0, 1u << 22 },
+		{ "fill bound", budget * 0.02, budget / 17.5, 1024 },
+		{ "renderer limit", budget * 0.05, budget / 1e9, 4096 },
+		{ "over budget", budget * 1.2, budget / 1000.0, 4096 },
+	};
+
+	std::vector<SimulationResult> results;
+	for (const Curve& curve : curves)
+	{
+		Settings settings = arg_Settings;
+		settings.workloads = { Workload::Draws };
+		CapacitySearch search(settings, Limits{ curve.limit, curve.limit, curve.limit, curve.limit });
+
+		std::mt19937 rng(1234);
+		std::normal_distribution<double> noise(0.0, noiseRatio);
+
+		SimulationResult result{};
+		result.name = curve.name;
+
+		while (!search.isFinished() && result.frames < 1000000)
+		{
+			const double frameMs = (curve.fixedMs + curve.perItemMs * search.getSize()) * std::max(0.5, 1.0 + noise(rng));
+			search.record(frameMs);
+			++result.frames;
+		}
+
+		// Where the percentile of the noisy frame time meets the budget; the z-score is an
+		// approximation that is close enough at the percentiles a budget is checked against.
+		const double z = arg_Settings.percentile >= 99.0 ? 2.33 : arg_Settings.percentile >= 95.0 ? 1.64 : 0.0;
+		const double fitted = (budget / (1.0 + z * noiseRatio) - curve.fixedMs) / curve.perItemMs;
+		result.expected = static_cast<uint32_t>(std::clamp(fitted, 0.0, static_cast<double>(curve.limit)));
+
+		if (!search.getResults().empty())
+		{
+			result.found = search.getResults().front().ceiling;
+			result.probes = search.getResults().front().probes.size();
+		}
+
+		// Sampling noise moves the measured percentile by a few percent on its own.
+		const double allowed = result.expected * (arg_Settings.tolerance + 0.05) + 1.0;
+		result.passed = search.isFinished() && std::abs(static_cast<double>(result.found) - result.expected) <= allowed;
+
+		results.push_back(result);
+	}
+
+	return results;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Histogram.hxx"
+
+// What a frame's scene is scaled by.
+//  - Draws: grid rects, one draw call each; measures per-draw CPU and driver cost.
+//  - Instances: grid rects in a single instanced draw; measures vertex throughput.
+//  - Overdraw: full-target layers in a single instanced draw; measures fill rate.
+//  - Scene: moving rects in a SceneStore, animated and uploaded every frame before a single
+//    instanced draw; measures CPU update and upload throughput.
+enum class Workload
+{
+	Draws,
+	Instances,
+	Overdraw,
+	Scene
+};
+
+// Finds the largest scene size each workload sustains within a frame budget. Every probe
+// renders one size for warmupFrames + sampleFrames frames and passes if the percentile of
+// the sampled frame times is within the budget. Sizes double from 1 until a probe fails,
+// then a binary search between the last pass and the first failure narrows the ceiling to
+// within `tolerance` of itself. Frame time is assumed to grow with size; a noisy probe can
+// only move the ceiling inside the bracket it already established.
+class CapacitySearch
+{
+public:
+	struct Settings
+	{
+		double budgetMs;
+		double percentile;
+		uint32_t warmupFrames;
+		uint32_t sampleFrames;
+		double tolerance;
+		std::vector<Workload> workloads;
+		std::string reportPath;
+
+		// APP_CAPACITY_BUDGET_MS (default 16.667), APP_CAPACITY_PERCENTILE (99),
+		// APP_CAPACITY_WARMUP (10), APP_CAPACITY_FRAMES (120), APP_CAPACITY_TOLERANCE (0.05),
+		// APP_CAPACITY_WORKLOADS (draws,instances,overdraw), APP_CAPACITY_OUT (default stdout).
+		static Settings fromConfig();
+	};
+
+	// Largest size the renderer can issue per workload, the upper end of each search.
+	struct Limits
+	{
+		uint32_t draws;
+		uint32_t instances;
+		uint32_t overdraw;
+		uint32_t scene;
+	};
+
+	struct Probe
+	{
+		uint32_t size;
+		double percentileMs;
+		double meanMs;
+		bool passed;
+	};
+
+	struct Result
+	{
+		Workload workload;
+		// Largest size that passed, 0 if a single item was already over budget.
+		uint32_t ceiling;
+		double ceilingMs;
+		// Smallest size that failed, 0 if the search reached the limit first.
+		uint32_t failSize;
+		double failMs;
+		uint32_t limit;
+		uint64_t frames;
+		std::vector<Probe> probes;
+	};
+
+	CapacitySearch(Settings arg_Settings, Limits arg_Limits);
+
+	bool isFinished() const { return finished; }
+	Workload getWorkload() const { return current.workload; }
+	uint32_t getSize() const { return size; }
+	const std::vector<Result>& getResults() const { return results; }
+
+	// Feeds one frame's time; returns true if the workload or size to render changed.
+	bool record(double arg_FrameMs);
+
+	void setContext(const std::string& arg_Key, const std::string& arg_Value) { context[arg_Key] = arg_Value; }
+	std::string toJson() const;
+	void writeReport() const;
+	void logSummary() const;
+
+	static const char* workloadName(Workload arg_Workload);
+	static bool parseWorkload(const std::string& arg_Name, Workload& arg_Workload);
+
+	// Headless check: searches synthetic cost curves, where a frame costs
+	// fixed + perItem * size ms plus noise, and reports whether the ceiling found matches the
+	// analytic one within the tolerance.
+	struct SimulationResult
+	{
+		std::string name;
+		uint32_t expected;
+		uint32_t found;
+		size_t probes;
+		uint64_t frames;
+		bool passed;
+	};
+
+	static std::vector<SimulationResult> simulate(const Settings& arg_Settings);
+
+private:
+	void startWorkload();
+	void finishProbe();
+	void finishWorkload();
+	uint32_t getLimit(Workload arg_Workload) const;
+
+private:
+	Settings settings;
+	Limits limits;
+	std::map<std::string, std::string> context;
+
+	size_t workloadIndex = 0;
+	bool finished = false;
+	bool ramping = true;
+	uint32_t size = 1;
+	uint32_t frameInProbe = 0;
+	Histogram probeFrames;
+
+	Result current{};
+	std::vector<Result> results;
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <string>
+
+// Runtime switches are read from APP_* environment variables so that benchmark and
+// profiling runs can be configured without rebuilding. Command line flags of the form
+// --some-name=value override the matching APP_SOME_NAME variable.
+namespace Config
+{
+	inline std::map<std::string, std::string>& overrides()
+	{
+		static std::map<std::string, std::string> values;
+		return values;
+	}
+
+	inline void parseCommandLine(int arg_Argc, char** arg_Argv)
+	{
+		for (int i = 1; i < arg_Argc; ++i)
+		{
+			std::string flag = arg_Argv[i];
+			if (flag.compare(0, 2, "--") != 0) continue;
+
+			size_t equals = flag.find('=');
+			std::string name = "APP_" + flag.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+			std::string value = equals == std::string::npos ? "1" : flag.substr(equals + 1);
+
+			std::transform(name.begin(), name.end(), name.begin(),
+				[](unsigned char arg_Char) { return arg_Char == '-' ? '_' : static_cast<char>(std::toupper(arg_Char)); });
+
+			overrides()[name] = value;
+		}
+	}
+
+	inline std::string getString(const char* arg_Name, const std::string& arg_Default = {})
+	{
+		auto found = overrides().find(arg_Name);
+		if (found != overrides().end()) return found->second;
+
+		const char* value = std::getenv(arg_Name);
+		return (value && *value) ? std::string(value) : arg_Default;
+	}
+
+	inline long long getInt(const char* arg_Name, long long arg_Default)
+	{
+		std::string value = getString(arg_Name);
+		if (value.empty()) return arg_Default;
+
+		char* end = nullptr;
+		long long parsed = std::strtoll(value.c_str(), &end, 10);
+		return (end && *end == '\0') ? parsed : arg_Default;
+	}
+
+	inline double getDouble(const char* arg_Name, double arg_Default)
+	{
+		std::string value = getString(arg_Name);
+		if (value.empty()) return arg_Default;
+
+		char* end = nullptr;
+		double parsed = std::strtod(value.c_str(), &end);
+		return (end && *end == '\0') ? parsed : arg_Default;
+	}
+
+	inline bool getBool(const char* arg_Name, bool arg_Default)
+	{
+		std::string value = getString(arg_Name);
+		if (value.empty()) return arg_Default;
+
+		return value == "1" || value == "true" || value == "on" || value == "yes";
+	}
+}
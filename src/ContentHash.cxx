@@ -0,0 +1,89 @@
+#include "ContentHash.hxx"
+
+#include <cstring>
+
+namespace
+{
+	const uint64_t PRIME1 = 11400714785074694791ULL;
+	const uint64_t PRIME2 = 14029467366897019727ULL;
+	const uint64_t PRIME3 = 1609587929392839161ULL;
+	const uint64_t PRIME4 = 9650029242287828579ULL;
+	const uint64_t PRIME5 = 2870177450012600261ULL;
+
+	uint64_t rotateLeft(uint64_t arg_Value, int arg_Bits)
+	{
+		return (arg_Value << arg_Bits) | (arg_Value >> (64 - arg_Bits));
+	}
+
+	// Unaligned little-endian loads; memcpy compiles to a plain load.
+	uint64_t read64(const uint8_t* arg_Data)
+	{
+		uint64_t value;
+		std::memcpy(&value, arg_Data, sizeof(value));
+		return value;
+	}
+
+	uint32_t read32(const uint8_t* arg_Data)
+	{
+		uint32_t value;
+		std::memcpy(&value, arg_Data, sizeof(value));
+		return value;
+	}
+
+	uint64_t mixRound(uint64_t arg_Accumulator, uint64_t arg_Input)
+	{
+		arg_Accumulator += arg_Input * PRIME2;
+		return rotateLeft(arg_Accumulator, 31) * PRIME1;
+	}
+
+	uint64_t mergeRound(uint64_t arg_Accumulator, uint64_t arg_Value)
+	{
+		arg_Accumulator ^= mixRound(0, arg_Value);
+		return arg_Accumulator * PRIME1 + PRIME4;
+	}
+}
+
+uint64_t hashContent(const void* arg_Data, size_t arg_Size, uint64_t arg_Seed)
+{
+	const uint8_t* data = static_cast<const uint8_t*>(arg_Data);
+	const uint8_t* end = data + arg_Size;
+	uint64_t hash;
+
+	if (arg_Size >= 32)
+	{
+		// Four independent lanes over 32-byte stripes.
+		uint64_t lanes[4] = { arg_Seed + PRIME1 + PRIME2, arg_Seed + PRIME2, arg_Seed, arg_Seed - PRIME1 };
+		const uint8_t* limit = end - 32;
+		do
+		{
+			for (int lane = 0; lane < 4; ++lane)
+				lanes[lane] = mixRound(lanes[lane], read64(data + 8 * lane));
+			data += 32;
+		} while (data <= limit);
+
+		hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+		for (uint64_t lane : lanes) hash = mergeRound(hash, lane);
+	}
+	else
+	{
+		hash = arg_Seed + PRIME5;
+	}
+
+	hash += static_cast<uint64_t>(arg_Size);
+	for (; data + 8 <= end; data += 8)
+		hash = rotateLeft(hash ^ mixRound(0, read64(data)), 27) * PRIME1 + PRIME4;
+	if (data + 4 <= end)
+	{
+		hash = rotateLeft(hash ^ (static_cast<uint64_t>(read32(data)) * PRIME1), 23) * PRIME2 + PRIME3;
+		data += 4;
+	}
+	for (; data < end; ++data)
+		hash = rotateLeft(hash ^ (*data * PRIME5), 11) * PRIME1;
+
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
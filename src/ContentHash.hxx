@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit XXH64 content hash, for telling whether cooked data is still current. Not
+// cryptographic; runs at memory bandwidth, so hashing an input costs about as much as
+// reading it.
+uint64_t hashContent(const void* arg_Data, size_t arg_Size, uint64_t arg_Seed = 0);
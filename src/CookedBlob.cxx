@@ -0,0 +1,85 @@
+#include "CookedBlob.hxx"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+using namespace CookedFormat;
+
+CookedBlob::CookedBlob(const std::string& arg_Path, BlobType arg_Type)
+	: mapping(arg_Path)
+{
+	auto fail = [&](const char* arg_Reason) { throw std::runtime_error(arg_Path + " is not a valid cooked blob: " + arg_Reason); };
+
+	if (mapping.size() < sizeof(Header)) fail("too short");
+	header = reinterpret_cast<const Header*>(mapping.data());
+	if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("bad magic");
+	if (header->version != VERSION) fail("unsupported version");
+	if (header->type != arg_Type) fail("unexpected blob type");
+	if (header->fileSize != mapping.size()) fail("truncated");
+	if (header->payloadOffset % PAYLOAD_ALIGNMENT != 0 || header->payloadOffset > mapping.size()
+		|| header->payloadSize > mapping.size() - header->payloadOffset)
+		fail("payload outside the file");
+
+	const uint64_t payloadSize = header->payloadSize;
+	if (header->type == BlobType::Texture)
+	{
+		if (header->bytesPerRow % PAYLOAD_ALIGNMENT != 0 || static_cast<uint64_t>(header->width) * 4 > header->bytesPerRow)
+			fail("bad row pitch");
+		if (static_cast<uint64_t>(header->bytesPerRow) * header->height > payloadSize) fail("texture larger than the payload");
+	}
+	else if (header->type == BlobType::Shader)
+	{
+		if (static_cast<uint64_t>(header->variantCount) * sizeof(ShaderVariant) > payloadSize) fail("variants outside the payload");
+
+		const ShaderVariant* variants = reinterpret_cast<const ShaderVariant*>(getPayload());
+		for (uint32_t i = 0; i < header->variantCount; ++i)
+		{
+			const ShaderVariant& variant = variants[i];
+			if (variant.keyOffset > payloadSize || variant.keySize > payloadSize - variant.keyOffset) fail("variant key outside the payload");
+			if (variant.sourceOffset > payloadSize || variant.sourceSize >= payloadSize - variant.sourceOffset) fail("variant source outside the payload");
+			if (getPayload()[variant.sourceOffset + variant.sourceSize] != '\0') fail("variant source not terminated");
+		}
+	}
+}
+
+const char* CookedBlob::findShaderSource(const std::string& arg_ModuleKey) const
+{
+	if (header->type != BlobType::Shader) return nullptr;
+
+	const ShaderVariant* variants = reinterpret_cast<const ShaderVariant*>(getPayload());
+	for (uint32_t i = 0; i < header->variantCount; ++i)
+	{
+		const ShaderVariant& variant = variants[i];
+		if (variant.keySize == arg_ModuleKey.size() && std::memcmp(getPayload() + variant.keyOffset, arg_ModuleKey.data(), variant.keySize) == 0)
+			return reinterpret_cast<const char*>(getPayload() + variant.sourceOffset);
+	}
+	return nullptr;
+}
+
+void writeCookedBlob(const std::string& arg_Path, Header arg_Header, const void* arg_Payload, uint64_t arg_Size)
+{
+	static const char zeros[PAYLOAD_ALIGNMENT] = {};
+
+	std::memcpy(arg_Header.magic, MAGIC, sizeof(MAGIC));
+	arg_Header.version = VERSION;
+	arg_Header.payloadOffset = PAYLOAD_ALIGNMENT;
+	arg_Header.payloadSize = arg_Size;
+	arg_Header.fileSize = PAYLOAD_ALIGNMENT + arg_Size;
+
+	const std::string temporary = arg_Path + ".tmp";
+	{
+		std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+		stream.write(reinterpret_cast<const char*>(&arg_Header), sizeof(Header));
+		stream.write(zeros, PAYLOAD_ALIGNMENT - sizeof(Header));
+		stream.write(static_cast<const char*>(arg_Payload), static_cast<std::streamsize>(arg_Size));
+		stream.close();
+		if (!stream) throw std::runtime_error("Could not write " + temporary);
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, arg_Path, error);
+	if (error) throw std::runtime_error("Could not replace " + arg_Path + ": " + error.message());
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.hxx"
+
+// Binary blob written by the asset cooker (tools/AssetCooker.cxx): a header and a payload
+// ready for the GPU, loaded by mapping the file. All values are little endian.
+namespace CookedFormat
+{
+	constexpr char MAGIC[8] = { 'W', 'G', 'C', 'O', 'O', 'K', '\0', '\0' };
+	constexpr uint32_t VERSION = 1;
+	// The payload starts here, and texture rows are padded to it: it is the row pitch
+	// buffer-to-texture copies need, so a texture payload goes to staging memory in one copy.
+	constexpr uint64_t PAYLOAD_ALIGNMENT = 256;
+
+	enum class BlobType : uint32_t
+	{
+		// RGBA8 texels, height rows of bytesPerRow.
+		Texture = 1,
+		// ShaderVariant[variantCount], then the keys and sources they point at.
+		Shader = 2
+	};
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		BlobType type;
+		// hashContent() over every source the blob was cooked from.
+		uint64_t sourceHash;
+		uint64_t payloadOffset;
+		uint64_t payloadSize;
+		uint64_t fileSize;
+		uint32_t width;
+		uint32_t height;
+		uint32_t bytesPerRow;
+		uint32_t variantCount;
+	};
+	static_assert(sizeof(Header) == 64, "Header layout is part of the file format");
+
+	// A preprocessed shader module. The key is ShaderVariantKey::moduleKey() of the defines it
+	// was preprocessed with; the source is followed by a zero byte, so it is handed to wgpu in
+	// place. Offsets are from the start of the payload.
+	struct ShaderVariant
+	{
+		uint64_t keyOffset;
+		uint64_t sourceOffset;
+		uint32_t keySize;
+		uint32_t sourceSize;
+	};
+	static_assert(sizeof(ShaderVariant) == 24, "ShaderVariant layout is part of the file format");
+}
+
+// A cooked blob opened by mapping it into memory. The header and, for shaders, the variant
+// records are validated on open so that everything they point at lies inside the payload.
+class CookedBlob
+{
+public:
+	// Throws std::runtime_error if the file cannot be mapped or is not a valid blob of the type.
+	CookedBlob(const std::string& arg_Path, CookedFormat::BlobType arg_Type);
+
+	const CookedFormat::Header& getHeader() const { return *header; }
+	// Points into the mapping; valid while the CookedBlob lives.
+	const uint8_t* getPayload() const { return mapping.data() + header->payloadOffset; }
+	const MappedFile& getMapping() const { return mapping; }
+
+	// The zero-terminated source cooked for a module key, or null.
+	const char* findShaderSource(const std::string& arg_ModuleKey) const;
+
+private:
+	MappedFile mapping;
+	const CookedFormat::Header* header = nullptr;
+};
+
+// Writes a blob of the payload. Magic, version, offsets and sizes of arg_Header are filled
+// in; the rest is the caller's. The file is written beside arg_Path and renamed over it, so
+// readers never see it half written. Throws std::runtime_error on write errors.
+void writeCookedBlob(const std::string& arg_Path, CookedFormat::Header arg_Header, const void* arg_Payload, uint64_t arg_Size);
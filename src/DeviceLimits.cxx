@@ -0,0 +1,274 @@
+#include "DeviceLimits.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+
+namespace
+{
+	const uint32_t PUSH_CONSTANT_BYTES = 128;
+
+	// Limits where a larger value is more capable; clamped down to what the adapter offers.
+	uint32_t WGPULimits::* const U32_MAX_LIMITS[] = {
+		&WGPULimits::maxTextureDimension1D,
+		&WGPULimits::maxTextureDimension2D,
+		&WGPULimits::maxTextureDimension3D,
+		&WGPULimits::maxTextureArrayLayers,
+		&WGPULimits::maxBindGroups,
+		&WGPULimits::maxBindGroupsPlusVertexBuffers,
+		&WGPULimits::maxBindingsPerBindGroup,
+		&WGPULimits::maxDynamicUniformBuffersPerPipelineLayout,
+		&WGPULimits::maxDynamicStorageBuffersPerPipelineLayout,
+		&WGPULimits::maxSampledTexturesPerShaderStage,
+		&WGPULimits::maxSamplersPerShaderStage,
+		&WGPULimits::maxStorageBuffersPerShaderStage,
+		&WGPULimits::maxStorageTexturesPerShaderStage,
+		&WGPULimits::maxUniformBuffersPerShaderStage,
+		&WGPULimits::maxVertexBuffers,
+		&WGPULimits::maxVertexAttributes,
+		&WGPULimits::maxVertexBufferArrayStride,
+		&WGPULimits::maxInterStageShaderComponents,
+		&WGPULimits::maxInterStageShaderVariables,
+		&WGPULimits::maxColorAttachments,
+		&WGPULimits::maxColorAttachmentBytesPerSample,
+		&WGPULimits::maxComputeWorkgroupStorageSize,
+		&WGPULimits::maxComputeInvocationsPerWorkgroup,
+		&WGPULimits::maxComputeWorkgroupSizeX,
+		&WGPULimits::maxComputeWorkgroupSizeY,
+		&WGPULimits::maxComputeWorkgroupSizeZ,
+		&WGPULimits::maxComputeWorkgroupsPerDimension,
+	};
+
+	uint64_t WGPULimits::* const U64_MAX_LIMITS[] = {
+		&WGPULimits::maxUniformBufferBindingSize,
+		&WGPULimits::maxStorageBufferBindingSize,
+		&WGPULimits::maxBufferSize,
+	};
+
+	// Limits where a smaller value is more capable.
+	uint32_t WGPULimits::* const U32_MIN_LIMITS[] = {
+		&WGPULimits::minUniformBufferOffsetAlignment,
+		&WGPULimits::minStorageBufferOffsetAlignment,
+	};
+
+	// The WebGPU spec defaults, which every conformant adapter supports.
+	WGPULimits specDefaultLimits()
+	{
+		WGPULimits limits{};
+		limits.maxTextureDimension1D = 8192;
+		limits.maxTextureDimension2D = 8192;
+		limits.maxTextureDimension3D = 2048;
+		limits.maxTextureArrayLayers = 256;
+		limits.maxBindGroups = 4;
+		limits.maxBindGroupsPlusVertexBuffers = 24;
+		limits.maxBindingsPerBindGroup = 1000;
+		limits.maxDynamicUniformBuffersPerPipelineLayout = 8;
+		limits.maxDynamicStorageBuffersPerPipelineLayout = 4;
+		limits.maxSampledTexturesPerShaderStage = 16;
+		limits.maxSamplersPerShaderStage = 16;
+		limits.maxStorageBuffersPerShaderStage = 8;
+		limits.maxStorageTexturesPerShaderStage = 4;
+		limits.maxUniformBuffersPerShaderStage = 12;
+		limits.maxUniformBufferBindingSize = 64ull << 10;
+		limits.maxStorageBufferBindingSize = 128ull << 20;
+		limits.minUniformBufferOffsetAlignment = 256;
+		limits.minStorageBufferOffsetAlignment = 256;
+		limits.maxVertexBuffers = 8;
+		limits.maxBufferSize = 256ull << 20;
+		limits.maxVertexAttributes = 16;
+		limits.maxVertexBufferArrayStride = 2048;
+		limits.maxInterStageShaderComponents = 60;
+		limits.maxInterStageShaderVariables = 16;
+		limits.maxColorAttachments = 8;
+		limits.maxColorAttachmentBytesPerSample = 32;
+		limits.maxComputeWorkgroupStorageSize = 16384;
+		limits.maxComputeInvocationsPerWorkgroup = 256;
+		limits.maxComputeWorkgroupSizeX = 256;
+		limits.maxComputeWorkgroupSizeY = 256;
+		limits.maxComputeWorkgroupSizeZ = 64;
+		limits.maxComputeWorkgroupsPerDimension = 65535;
+		return limits;
+	}
+}
+
+void DeviceRequirements::apply(WGPUDeviceDescriptor& arg_DeviceDesc)
+{
+	nativeLimits.chain.next = nullptr;
+	nativeLimits.chain.sType = static_cast<WGPUSType>(WGPUSType_RequiredLimitsExtras);
+	requiredLimits.nextInChain = &nativeLimits.chain;
+
+	arg_DeviceDesc.requiredLimits = &requiredLimits;
+	arg_DeviceDesc.requiredFeatureCount = features.size();
+	arg_DeviceDesc.requiredFeatures = features.data();
+}
+
+LimitsNegotiator::LimitsNegotiator(
+	const WGPUAdapterProperties& arg_AdapterProperties,
+	const WGPUSupportedLimits& arg_AdapterLimits,
+	const WGPUSupportedLimitsExtras& arg_AdapterNativeLimits,
+	const std::vector<WGPUFeatureName>& arg_AdapterFeatures
+)
+	: adapterProperties(arg_AdapterProperties),
+	adapterLimits(arg_AdapterLimits.limits),
+	adapterNativeLimits(arg_AdapterNativeLimits.limits),
+	adapterFeatures(arg_AdapterFeatures)
+{
+}
+
+PerformanceTier LimitsNegotiator::selectTier() const
+{
+	PerformanceTier tier = PerformanceTier::Low;
+
+	// Software rasterizers report generous limits but nowhere near the throughput.
+	if (adapterProperties.adapterType != WGPUAdapterType_CPU)
+	{
+		if (adapterMeets(tierLimits(PerformanceTier::High))) tier = PerformanceTier::High;
+		else if (adapterMeets(tierLimits(PerformanceTier::Medium))) tier = PerformanceTier::Medium;
+	}
+
+	const std::string cap = Config::getString("APP_PERF_TIER");
+	if (cap == "low") tier = PerformanceTier::Low;
+	else if (cap == "medium") tier = std::min(tier, PerformanceTier::Medium);
+
+	return tier;
+}
+
+DeviceRequirements LimitsNegotiator::negotiate(uint32_t arg_SurfaceDimension) const
+{
+	DeviceRequirements requirements{};
+	requirements.profile = getProfile(selectTier());
+	requirements.requiredLimits.nextInChain = nullptr;
+	requirements.requiredLimits.limits = clampToAdapter(tierLimits(requirements.profile.tier));
+
+	// Tier limits only decide which tier an adapter qualifies for; surface textures must fit.
+	uint32_t& maxTextureDimension2D = requirements.requiredLimits.limits.maxTextureDimension2D;
+	maxTextureDimension2D = std::min(std::max(maxTextureDimension2D, arg_SurfaceDimension), adapterLimits.maxTextureDimension2D);
+	if (maxTextureDimension2D < arg_SurfaceDimension)
+	{
+		LOG_MSG_ERR("Surfaces up to " << arg_SurfaceDimension << " pixels exceed the adapter's texture limit of " << maxTextureDimension2D);
+	}
+
+	requirements.profile.maxTextureDimension = std::min(
+		requirements.profile.maxTextureDimension,
+		requirements.requiredLimits.limits.maxTextureDimension2D
+	);
+	requirements.profile.maxBatchBytes = std::min(
+		requirements.profile.maxBatchBytes,
+		requirements.requiredLimits.limits.maxBufferSize
+	);
+	requirements.profile.computeWorkgroupSize = std::min(
+		requirements.profile.computeWorkgroupSize,
+		requirements.requiredLimits.limits.maxComputeInvocationsPerWorkgroup
+	);
+
+	const WGPUFeatureName pushConstants = static_cast<WGPUFeatureName>(WGPUNativeFeature_PushConstants);
+	requirements.pushConstants = adapterHasFeature(pushConstants) && adapterNativeLimits.maxPushConstantSize > 0;
+	if (requirements.pushConstants)
+	{
+		requirements.features.push_back(pushConstants);
+		requirements.nativeLimits.limits.maxPushConstantSize = std::min(PUSH_CONSTANT_BYTES, adapterNativeLimits.maxPushConstantSize);
+	}
+	requirements.nativeLimits.limits.maxNonSamplerBindings = adapterNativeLimits.maxNonSamplerBindings;
+
+	requirements.timestampQuery = adapterHasFeature(WGPUFeatureName_TimestampQuery);
+	if (requirements.timestampQuery)
+		requirements.features.push_back(WGPUFeatureName_TimestampQuery);
+
+	LOG_MSG_SUC("Performance tier: " << tierName(requirements.profile.tier)
+		<< " (push constants " << requirements.pushConstants
+		<< ", timestamp queries " << requirements.timestampQuery << ")");
+
+	return requirements;
+}
+
+TierProfile LimitsNegotiator::getProfile(PerformanceTier arg_Tier)
+{
+	switch (arg_Tier)
+	{
+	case PerformanceTier::High:
+		return { PerformanceTier::High, 16384, 262144, 128ull << 20, 256, 16384 };
+	case PerformanceTier::Medium:
+		return { PerformanceTier::Medium, 4096, 65536, 32ull << 20, 128, 8192 };
+	case PerformanceTier::Low:
+	default:
+		return { PerformanceTier::Low, 1024, 16384, 4ull << 20, 64, 4096 };
+	}
+}
+
+const char* LimitsNegotiator::tierName(PerformanceTier arg_Tier)
+{
+	switch (arg_Tier)
+	{
+	case PerformanceTier::High: return "high";
+	case PerformanceTier::Medium: return "medium";
+	case PerformanceTier::Low:
+	default: return "low";
+	}
+}
+
+bool LimitsNegotiator::adapterHasFeature(WGPUFeatureName arg_Feature) const
+{
+	return std::find(adapterFeatures.begin(), adapterFeatures.end(), arg_Feature) != adapterFeatures.end();
+}
+
+bool LimitsNegotiator::adapterMeets(const WGPULimits& arg_Limits) const
+{
+	for (uint32_t WGPULimits::* limit : U32_MAX_LIMITS)
+		if (adapterLimits.*limit < arg_Limits.*limit) return false;
+
+	for (uint64_t WGPULimits::* limit : U64_MAX_LIMITS)
+		if (adapterLimits.*limit < arg_Limits.*limit) return false;
+
+	for (uint32_t WGPULimits::* limit : U32_MIN_LIMITS)
+		if (adapterLimits.*limit > arg_Limits.*limit) return false;
+
+	return true;
+}
+
+WGPULimits LimitsNegotiator::tierLimits(PerformanceTier arg_Tier)
+{
+	WGPULimits limits = specDefaultLimits();
+
+	if (arg_Tier == PerformanceTier::Low)
+	{
+		// Only what the renderer itself needs, so GL and software adapters qualify.
+		limits.maxTextureDimension2D = 4096;
+		limits.maxBufferSize = 64ull << 20;
+		limits.maxStorageBufferBindingSize = 64ull << 20;
+		limits.maxUniformBufferBindingSize = 16ull << 10;
+		limits.maxComputeInvocationsPerWorkgroup = 128;
+		limits.maxComputeWorkgroupSizeX = 128;
+		limits.maxComputeWorkgroupSizeY = 128;
+		limits.maxStorageBuffersPerShaderStage = 4;
+		limits.maxVertexAttributes = 8;
+	}
+	else if (arg_Tier == PerformanceTier::High)
+	{
+		limits.maxTextureDimension2D = 16384;
+		limits.maxBufferSize = 1ull << 30;
+		limits.maxStorageBufferBindingSize = 1ull << 30;
+		limits.maxComputeInvocationsPerWorkgroup = 1024;
+		limits.maxComputeWorkgroupSizeX = 1024;
+		limits.maxComputeWorkgroupSizeY = 1024;
+		limits.maxComputeWorkgroupStorageSize = 32768;
+	}
+
+	return limits;
+}
+
+WGPULimits LimitsNegotiator::clampToAdapter(const WGPULimits& arg_Limits) const
+{
+	WGPULimits limits = arg_Limits;
+
+	for (uint32_t WGPULimits::* limit : U32_MAX_LIMITS)
+		limits.*limit = std::min(limits.*limit, adapterLimits.*limit);
+
+	for (uint64_t WGPULimits::* limit : U64_MAX_LIMITS)
+		limits.*limit = std::min(limits.*limit, adapterLimits.*limit);
+
+	// Alignments are requested as the adapter reports them: the finest granularity it offers.
+	for (uint32_t WGPULimits::* limit : U32_MIN_LIMITS)
+		limits.*limit = adapterLimits.*limit;
+
+	return limits;
+}
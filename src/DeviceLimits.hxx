@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
+
+enum class PerformanceTier
+{
+	Low,
+	Medium,
+	High
+};
+
+// Workload sizing derived from the negotiated tier. Renderer code scales with these instead
+// of hard-coding sizes, so the same build behaves sensibly on a software adapter and on a
+// discrete GPU.
+struct TierProfile
+{
+	PerformanceTier tier;
+	uint32_t maxDrawsPerFrame;
+	uint32_t maxInstancesPerBatch;
+	uint64_t maxBatchBytes;
+	uint32_t computeWorkgroupSize;
+	uint32_t maxTextureDimension;
+};
+
+// Device creation inputs produced by LimitsNegotiator. apply() links the descriptor to
+// storage inside this object, so it must outlive the wgpuAdapterRequestDevice call.
+struct DeviceRequirements
+{
+	TierProfile profile;
+	WGPURequiredLimits requiredLimits;
+	WGPURequiredLimitsExtras nativeLimits;
+	std::vector<WGPUFeatureName> features;
+	bool pushConstants;
+	bool timestampQuery;
+
+	void apply(WGPUDeviceDescriptor& arg_DeviceDesc);
+};
+
+// Picks a performance tier from what the adapter reports and requests exactly the limits
+// and optional features that tier needs, clamped to the adapter so device creation can't
+// fail on an over-ask. APP_PERF_TIER=low|medium|high caps the automatic choice.
+class LimitsNegotiator
+{
+public:
+	LimitsNegotiator(
+		const WGPUAdapterProperties& arg_AdapterProperties,
+		const WGPUSupportedLimits& arg_AdapterLimits,
+		const WGPUSupportedLimitsExtras& arg_AdapterNativeLimits,
+		const std::vector<WGPUFeatureName>& arg_AdapterFeatures
+	);
+
+	PerformanceTier selectTier() const;
+	// arg_SurfaceDimension is the largest width or height the surface can reach. The tier's
+	// maxTextureDimension2D is raised to it, up to the adapter's limit, so a large surface
+	// still fits on a low tier.
+	DeviceRequirements negotiate(uint32_t arg_SurfaceDimension) const;
+
+	static TierProfile getProfile(PerformanceTier arg_Tier);
+	static const char* tierName(PerformanceTier arg_Tier);
+
+private:
+	bool adapterHasFeature(WGPUFeatureName arg_Feature) const;
+	bool adapterMeets(const WGPULimits& arg_Limits) const;
+	static WGPULimits tierLimits(PerformanceTier arg_Tier);
+	WGPULimits clampToAdapter(const WGPULimits& arg_Limits) const;
+
+private:
+	WGPUAdapterProperties adapterProperties;
+	WGPULimits adapterLimits;
+	WGPUNativeLimits adapterNativeLimits;
+	std::vector<WGPUFeatureName> adapterFeatures;
+};
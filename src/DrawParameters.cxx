@@ -0,0 +1,226 @@
+#include "DrawParameters.hxx"
+#include "BindGroupCache.hxx"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <webgpu/wgpu.h>
+
+const float UNIT_QUAD_VERTICES[UNIT_QUAD_VERTEX_COUNT * 5] = {
+	-0.5f, -0.5f, 1.0f, 1.0f, 1.0f,
+	+0.5f, -0.5f, 1.0f, 1.0f, 1.0f,
+	+0.5f, +0.5f, 1.0f, 1.0f, 1.0f,
+	-0.5f, -0.5f, 1.0f, 1.0f, 1.0f,
+	+0.5f, +0.5f, 1.0f, 1.0f, 1.0f,
+	-0.5f, +0.5f, 1.0f, 1.0f, 1.0f
+};
+
+void makeGridDrawParams(uint32_t arg_Index, uint32_t arg_Count, DrawParams& arg_Params)
+{
+	uint32_t columns = 1;
+	while (columns * columns < arg_Count) ++columns;
+
+	float cell = 2.0f / static_cast<float>(columns);
+	float x = static_cast<float>(arg_Index % columns);
+	float y = static_cast<float>(arg_Index / columns);
+	float shade = arg_Count > 1 ? static_cast<float>(arg_Index) / static_cast<float>(arg_Count - 1) : 1.0f;
+
+	arg_Params.offset[0] = arg_Count > 1 ? -1.0f + cell * (x + 0.5f) : 0.0f;
+	arg_Params.offset[1] = arg_Count > 1 ? 1.0f - cell * (y + 0.5f) : 0.0f;
+	arg_Params.scale[0] = arg_Count > 1 ? cell : 1.0f;
+	arg_Params.scale[1] = arg_Count > 1 ? cell : 1.0f;
+	arg_Params.color[0] = 1.0f;
+	arg_Params.color[1] = arg_Count > 1 ? 1.0f - 0.5f * shade : 1.0f;
+	arg_Params.color[2] = arg_Count > 1 ? 0.5f + 0.5f * shade : 1.0f;
+	arg_Params.color[3] = 1.0f;
+}
+
+void makeLayerDrawParams(uint32_t arg_Index, uint32_t arg_Count, DrawParams& arg_Params)
+{
+	// The unit triangle spans [-0.5, 0.5] and narrows to a point at the top; at 6x its
+	// edges pass through the clip space corners, so 8x leaves some margin.
+	const float FULL_COVER_SCALE = 8.0f;
+	float shade = arg_Count > 1 ? static_cast<float>(arg_Index) / static_cast<float>(arg_Count - 1) : 1.0f;
+
+	arg_Params.offset[0] = 0.0f;
+	arg_Params.offset[1] = 0.0f;
+	arg_Params.scale[0] = FULL_COVER_SCALE;
+	arg_Params.scale[1] = FULL_COVER_SCALE;
+	arg_Params.color[0] = 0.5f + 0.5f * shade;
+	arg_Params.color[1] = 0.5f;
+	arg_Params.color[2] = 1.0f - 0.5f * shade;
+	arg_Params.color[3] = 1.0f;
+}
+
+RectInstance makeRectInstance(const DrawParams& arg_Params)
+{
+	RectInstance instance{};
+	instance.center[0] = arg_Params.offset[0];
+	instance.center[1] = arg_Params.offset[1];
+	instance.size[0] = arg_Params.scale[0];
+	instance.size[1] = arg_Params.scale[1];
+	instance.color = packColor(arg_Params.color[0], arg_Params.color[1], arg_Params.color[2], arg_Params.color[3]);
+	return instance;
+}
+
+DrawParameterPath::DrawParameterPath(WGPUDevice arg_Device, BindGroupCache& arg_BindGroupCache, DrawParameterMode arg_Mode, uint32_t arg_UniformAlignment, uint32_t arg_MaxDrawsPerFrame)
+	: device(arg_Device),
+	bindGroupCache(arg_BindGroupCache),
+	mode(arg_Mode),
+	maxDrawsPerFrame(arg_MaxDrawsPerFrame)
+{
+	// Identity until the first setCamera().
+	camera.matrix[0] = 1.0f;
+	camera.matrix[3] = 1.0f;
+
+	WGPUBufferDescriptor cameraBufferDesc{};
+	cameraBufferDesc.label = "Camera uniform";
+	cameraBufferDesc.size = sizeof(CameraParams);
+	cameraBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform;
+	cameraBufferDesc.mappedAtCreation = false;
+	cameraBuffer = wgpuDeviceCreateBuffer(device, &cameraBufferDesc);
+
+	WGPUBindGroupLayoutEntry cameraLayoutEntry{};
+	cameraLayoutEntry.binding = 0;
+	cameraLayoutEntry.visibility = WGPUShaderStage_Vertex;
+	cameraLayoutEntry.buffer.type = WGPUBufferBindingType_Uniform;
+	cameraLayoutEntry.buffer.hasDynamicOffset = false;
+	cameraLayoutEntry.buffer.minBindingSize = sizeof(CameraParams);
+
+	WGPUBindGroupLayoutDescriptor cameraLayoutDesc{};
+	cameraLayoutDesc.label = "Camera layout";
+	cameraLayoutDesc.entryCount = 1;
+	cameraLayoutDesc.entries = &cameraLayoutEntry;
+	cameraLayout = wgpuDeviceCreateBindGroupLayout(device, &cameraLayoutDesc);
+
+	if (mode == DrawParameterMode::PushConstants)
+	{
+		WGPUPushConstantRange pushConstantRange{};
+		pushConstantRange.stages = WGPUShaderStage_Vertex;
+		pushConstantRange.start = 0;
+		pushConstantRange.end = sizeof(DrawParams);
+
+		WGPUPipelineLayoutExtras layoutExtras{};
+		layoutExtras.chain.next = nullptr;
+		layoutExtras.chain.sType = static_cast<WGPUSType>(WGPUSType_PipelineLayoutExtras);
+		layoutExtras.pushConstantRangeCount = 1;
+		layoutExtras.pushConstantRanges = &pushConstantRange;
+
+		cameraGroup = 0;
+
+		WGPUPipelineLayoutDescriptor layoutDesc{};
+		layoutDesc.nextInChain = &layoutExtras.chain;
+		layoutDesc.label = "Push constant pipeline layout";
+		layoutDesc.bindGroupLayoutCount = 1;
+		layoutDesc.bindGroupLayouts = &cameraLayout;
+		pipelineLayout = wgpuDeviceCreatePipelineLayout(device, &layoutDesc);
+	}
+	else
+	{
+		ring = std::make_unique<UniformRing>(
+			device,
+			arg_UniformAlignment,
+			ringSize(arg_UniformAlignment, maxDrawsPerFrame),
+			"Draw parameter ring"
+		);
+
+		WGPUBindGroupLayoutEntry layoutEntry{};
+		layoutEntry.binding = 0;
+		layoutEntry.visibility = WGPUShaderStage_Vertex;
+		layoutEntry.buffer.type = WGPUBufferBindingType_Uniform;
+		layoutEntry.buffer.hasDynamicOffset = true;
+		layoutEntry.buffer.minBindingSize = sizeof(DrawParams);
+
+		WGPUBindGroupLayoutDescriptor bindGroupLayoutDesc{};
+		bindGroupLayoutDesc.label = "Draw parameter layout";
+		bindGroupLayoutDesc.entryCount = 1;
+		bindGroupLayoutDesc.entries = &layoutEntry;
+		bindGroupLayout = wgpuDeviceCreateBindGroupLayout(device, &bindGroupLayoutDesc);
+
+		cameraGroup = 1;
+		WGPUBindGroupLayout layouts[] = { bindGroupLayout, cameraLayout };
+
+		WGPUPipelineLayoutDescriptor layoutDesc{};
+		layoutDesc.nextInChain = nullptr;
+		layoutDesc.label = "Uniform ring pipeline layout";
+		layoutDesc.bindGroupLayoutCount = 2;
+		layoutDesc.bindGroupLayouts = layouts;
+		pipelineLayout = wgpuDeviceCreatePipelineLayout(device, &layoutDesc);
+	}
+
+	if (!pipelineLayout) throw std::runtime_error("Could not create draw parameter pipeline layout");
+}
+
+DrawParameterPath::~DrawParameterPath()
+{
+	if (ring) bindGroupCache.evictBuffer(ring->getBuffer());
+	bindGroupCache.evictBuffer(cameraBuffer);
+	if (bindGroupLayout) bindGroupCache.evictLayout(bindGroupLayout);
+	if (cameraLayout) bindGroupCache.evictLayout(cameraLayout);
+	if (pipelineLayout) wgpuPipelineLayoutRelease(pipelineLayout);
+	if (bindGroupLayout) wgpuBindGroupLayoutRelease(bindGroupLayout);
+	if (cameraLayout) wgpuBindGroupLayoutRelease(cameraLayout);
+	if (cameraBuffer) wgpuBufferRelease(cameraBuffer);
+}
+
+void DrawParameterPath::beginFrame(WGPURenderPassEncoder arg_RenderPass)
+{
+	drawsThisFrame = 0;
+
+	if (ring)
+	{
+		ring->beginFrame();
+		bindGroup = ring->getBindGroup(bindGroupCache, bindGroupLayout, 0, sizeof(DrawParams));
+	}
+
+	WGPUBindGroupEntry cameraEntry{};
+	cameraEntry.binding = 0;
+	cameraEntry.buffer = cameraBuffer;
+	cameraEntry.offset = 0;
+	cameraEntry.size = sizeof(CameraParams);
+	wgpuRenderPassEncoderSetBindGroup(arg_RenderPass, cameraGroup, bindGroupCache.get(cameraLayout, &cameraEntry, 1), 0, nullptr);
+}
+
+void DrawParameterPath::setCamera(const CameraParams& arg_Camera)
+{
+	if (std::memcmp(&camera, &arg_Camera, sizeof(CameraParams)) == 0) return;
+
+	camera = arg_Camera;
+	cameraDirty = true;
+}
+
+bool DrawParameterPath::setDrawParams(WGPURenderPassEncoder arg_RenderPass, const DrawParams& arg_Params)
+{
+	if (drawsThisFrame >= maxDrawsPerFrame) return false;
+
+	if (mode == DrawParameterMode::PushConstants)
+	{
+		wgpuRenderPassEncoderSetPushConstants(arg_RenderPass, WGPUShaderStage_Vertex, 0, sizeof(DrawParams), &arg_Params);
+	}
+	else
+	{
+		uint32_t offset = 0;
+		if (!ring->push(&arg_Params, sizeof(DrawParams), offset)) return false;
+		wgpuRenderPassEncoderSetBindGroup(arg_RenderPass, 0, bindGroup, 1, &offset);
+	}
+
+	++drawsThisFrame;
+	return true;
+}
+
+void DrawParameterPath::flush(WGPUQueue arg_Queue)
+{
+	if (ring) ring->flush(arg_Queue);
+
+	if (cameraDirty)
+	{
+		wgpuQueueWriteBuffer(arg_Queue, cameraBuffer, 0, &camera, sizeof(CameraParams));
+		cameraDirty = false;
+	}
+}
+
+uint64_t DrawParameterPath::ringSize(uint32_t arg_UniformAlignment, uint32_t arg_MaxDrawsPerFrame)
+{
+	uint32_t stride = UniformRing::alignUp(sizeof(DrawParams), arg_UniformAlignment ? arg_UniformAlignment : 256);
+	return static_cast<uint64_t>(stride) * (arg_MaxDrawsPerFrame ? arg_MaxDrawsPerFrame : 1);
+}
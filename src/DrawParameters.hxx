@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <webgpu/webgpu.h>
+
+#include "UniformRing.hxx"
+
+class BindGroupCache;
+
+// Per-draw data consumed by vs_main. Layout matches `struct DrawParams` in common.wgsl.
+struct DrawParams
+{
+	float offset[2];
+	float scale[2];
+	float color[4];
+};
+static_assert(sizeof(DrawParams) == 32, "DrawParams must match the WGSL struct layout");
+
+// Per-frame view transform consumed by vs_main, applied after DrawParams: clip = matrix *
+// position + offset, with the 2x2 matrix stored column by column as WGSL's mat2x2f. Layout
+// matches `struct CameraParams` in common.wgsl.
+struct CameraParams
+{
+	float matrix[4];
+	float offset[2];
+	float padding[2];
+};
+static_assert(sizeof(CameraParams) == 32, "CameraParams must match the WGSL struct layout");
+
+// Per-instance vertex data of the rectangle pipeline (vertex buffer 1, stepped per instance).
+// The unit triangle is scaled by size, rotated by rotation (radians, counterclockwise) and
+// moved to center before the per-draw DrawParams apply. Layer is carried for ordering and
+// is not used by the shader yet.
+struct RectInstance
+{
+	float center[2];
+	float size[2];
+	float rotation;
+	float layer;
+	// RGBA8, red in the lowest byte.
+	uint32_t color;
+	uint32_t padding;
+};
+static_assert(sizeof(RectInstance) == 32, "RectInstance must match the instance buffer layout");
+
+inline uint32_t packColor(float arg_Red, float arg_Green, float arg_Blue, float arg_Alpha)
+{
+	auto channel = [](float arg_Value) { return static_cast<uint32_t>((arg_Value < 0.0f ? 0.0f : arg_Value > 1.0f ? 1.0f : arg_Value) * 255.0f + 0.5f); };
+	return channel(arg_Red) | channel(arg_Green) << 8 | channel(arg_Blue) << 16 | channel(arg_Alpha) << 24;
+}
+
+// Unit square as two triangles, in the layout of vertex buffer 0 (position, then color),
+// white so that the instance color shows as is.
+constexpr uint32_t UNIT_QUAD_VERTEX_COUNT = 6;
+extern const float UNIT_QUAD_VERTICES[UNIT_QUAD_VERTEX_COUNT * 5];
+
+// The same rect as an unrotated instance, for the grid and layer layouts.
+RectInstance makeRectInstance(const DrawParams& arg_Params);
+
+// One queued draw. The key packs pipeline, bind group and depth so that sorting by it groups
+// state changes and orders each group front to back.
+struct DrawRecord
+{
+	DrawParams params;
+	uint64_t sortKey;
+	uint32_t firstVertex;
+	uint32_t vertexCount;
+};
+
+// Parameters of draw arg_Index of arg_Count, tiled in a square grid over clip space.
+void makeGridDrawParams(uint32_t arg_Index, uint32_t arg_Count, DrawParams& arg_Params);
+
+// Parameters of layer arg_Index of arg_Count, each scaled to cover the whole target.
+void makeLayerDrawParams(uint32_t arg_Index, uint32_t arg_Count, DrawParams& arg_Params);
+
+enum class DrawParameterMode
+{
+	PushConstants,
+	UniformRing
+};
+
+// Delivers DrawParams to each draw without a bind group or buffer write per draw. With
+// WGPUNativeFeature_PushConstants the data is recorded inline in the render pass; otherwise
+// each draw gets a slot in a UniformRing addressed by dynamic offset through one cached
+// bind group, and the whole frame's slots are uploaded with a single write in flush().
+// CameraParams live in a small uniform buffer of their own, bound once per pass after the
+// draw parameter group and rewritten in flush() only when they change.
+class DrawParameterPath
+{
+public:
+	DrawParameterPath(WGPUDevice arg_Device, BindGroupCache& arg_BindGroupCache, DrawParameterMode arg_Mode, uint32_t arg_UniformAlignment, uint32_t arg_MaxDrawsPerFrame);
+	~DrawParameterPath();
+
+	DrawParameterPath(const DrawParameterPath&) = delete;
+	DrawParameterPath& operator=(const DrawParameterPath&) = delete;
+
+	DrawParameterMode getMode() const { return mode; }
+	WGPUPipelineLayout getPipelineLayout() const { return pipelineLayout; }
+	uint32_t getMaxDrawsPerFrame() const { return maxDrawsPerFrame; }
+
+	// Binds the camera group, so it must be called inside the render pass.
+	void beginFrame(WGPURenderPassEncoder arg_RenderPass);
+
+	void setCamera(const CameraParams& arg_Camera);
+
+	// Returns false once the per-frame capacity is exhausted; the draw should be skipped.
+	bool setDrawParams(WGPURenderPassEncoder arg_RenderPass, const DrawParams& arg_Params);
+
+	// Must be called after encoding and before the frame's wgpuQueueSubmit.
+	void flush(WGPUQueue arg_Queue);
+
+	static uint64_t ringSize(uint32_t arg_UniformAlignment, uint32_t arg_MaxDrawsPerFrame);
+
+private:
+	WGPUDevice device;
+	BindGroupCache& bindGroupCache;
+	DrawParameterMode mode;
+	uint32_t maxDrawsPerFrame;
+	uint32_t drawsThisFrame = 0;
+
+	std::unique_ptr<UniformRing> ring;
+	WGPUBindGroupLayout bindGroupLayout = nullptr;
+	WGPUBindGroup bindGroup = nullptr;
+	WGPUPipelineLayout pipelineLayout = nullptr;
+
+	WGPUBindGroupLayout cameraLayout = nullptr;
+	WGPUBuffer cameraBuffer = nullptr;
+	uint32_t cameraGroup = 0;
+	CameraParams camera{};
+	bool cameraDirty = true;
+};
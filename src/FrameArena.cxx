@@ -0,0 +1,65 @@
+#include "FrameArena.hxx"
+
+#include <algorithm>
+
+LinearArena::LinearArena(size_t arg_Capacity)
+	: block(new uint8_t[arg_Capacity]),
+	capacity(arg_Capacity)
+{
+}
+
+void LinearArena::reset()
+{
+	if (!overflow.empty())
+	{
+		overflow.clear();
+		// Room for the worst use so far, padding included, and some growth.
+		capacity = highWater + highWater / 4;
+		block.reset(new uint8_t[capacity]);
+		++grows;
+	}
+
+	head = 0;
+	used = 0;
+}
+
+void* LinearArena::allocate(size_t arg_Bytes, size_t arg_Alignment)
+{
+	const uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+	const uintptr_t aligned = (base + head + arg_Alignment - 1) & ~(static_cast<uintptr_t>(arg_Alignment) - 1);
+	const size_t end = static_cast<size_t>(aligned - base) + arg_Bytes;
+
+	// Padding counts, as the block grown to the high-water mark has to hold it too. Past the
+	// block's own alignment the padding depends on its address, so take the worst case.
+	const size_t baseAlignment = std::min(arg_Alignment, alignof(std::max_align_t));
+	const size_t worstPadding = arg_Alignment - baseAlignment;
+	used = (used + baseAlignment - 1) / baseAlignment * baseAlignment + worstPadding + arg_Bytes;
+	if (used > highWater) highWater = used;
+
+	if (end <= capacity)
+	{
+		head = end;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	// operator new[] of uint8_t only guarantees fundamental alignment, so pad for more.
+	overflow.emplace_back(new uint8_t[arg_Bytes + arg_Alignment]);
+	const uintptr_t spill = reinterpret_cast<uintptr_t>(overflow.back().get());
+	return reinterpret_cast<void*>((spill + arg_Alignment - 1) & ~(static_cast<uintptr_t>(arg_Alignment) - 1));
+}
+
+FrameArena::FrameArena(size_t arg_Capacity)
+	: arenas{ LinearArena(arg_Capacity), LinearArena(arg_Capacity) }
+{
+}
+
+void FrameArena::beginFrame()
+{
+	index ^= 1;
+	arenas[index].reset();
+}
+
+size_t FrameArena::getHighWater() const
+{
+	return std::max(arenas[0].getHighWater(), arenas[1].getHighWater());
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump allocator for CPU scratch data, reset as a whole. Allocations are never freed
+// individually. When the block runs out, the excess comes from overflow blocks and the next
+// reset replaces everything with one block large enough for the worst use so far, so the
+// heap is only touched while the high-water mark still grows.
+class LinearArena
+{
+public:
+	explicit LinearArena(size_t arg_Capacity = 64 * 1024);
+
+	LinearArena(const LinearArena&) = delete;
+	LinearArena& operator=(const LinearArena&) = delete;
+
+	void reset();
+
+	void* allocate(size_t arg_Bytes, size_t arg_Alignment = alignof(std::max_align_t));
+
+	// Uninitialized storage for arg_Count objects; only for types the arena never has to destroy.
+	template <typename T>
+	T* allocateArray(size_t arg_Count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "LinearArena never runs destructors");
+		return static_cast<T*>(allocate(sizeof(T) * arg_Count, alignof(T)));
+	}
+
+	size_t getCapacity() const { return capacity; }
+	// Since the last reset, and the most in any cycle; both include alignment padding.
+	size_t getBytesUsed() const { return used; }
+	size_t getHighWater() const { return highWater; }
+	// Resets that had to grow the block, i.e. heap allocations after the first.
+	uint64_t getGrowCount() const { return grows; }
+
+private:
+	std::unique_ptr<uint8_t[]> block;
+	size_t capacity;
+	size_t head = 0;
+	size_t used = 0;
+	size_t highWater = 0;
+	uint64_t grows = 0;
+	std::vector<std::unique_ptr<uint8_t[]>> overflow;
+};
+
+// Per-frame scratch memory: two LinearArenas used on alternate frames, so whatever a frame
+// allocates stays valid until the end of the next one, e.g. for comparing against the
+// previous frame or for data that is consumed a frame late.
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t arg_Capacity = 64 * 1024);
+
+	// Switches to the other arena and resets it, which ends the lifetime of what was
+	// allocated two frames ago.
+	void beginFrame();
+
+	LinearArena& current() { return arenas[index]; }
+	const LinearArena& previous() const { return arenas[index ^ 1]; }
+
+	void* allocate(size_t arg_Bytes, size_t arg_Alignment = alignof(std::max_align_t)) { return current().allocate(arg_Bytes, arg_Alignment); }
+
+	template <typename T>
+	T* allocateArray(size_t arg_Count) { return current().allocateArray<T>(arg_Count); }
+
+	size_t getCapacity() const { return arenas[0].getCapacity() + arenas[1].getCapacity(); }
+	size_t getHighWater() const;
+	uint64_t getGrowCount() const { return arenas[0].getGrowCount() + arenas[1].getGrowCount(); }
+
+private:
+	LinearArena arenas[2];
+	size_t index = 0;
+};
+
+// STL allocator drawing from a LinearArena, for containers that live at most as long as the
+// arena's current reset cycle. deallocate() is a no-op, so a growing std::vector leaves its
+// old buffers behind in the arena; reserve up front where the size is known.
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit ArenaAllocator(LinearArena& arg_Arena) noexcept : arena(&arg_Arena) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& arg_Other) noexcept : arena(arg_Other.getArena()) {}
+
+	T* allocate(size_t arg_Count)
+	{
+		if (arg_Count > SIZE_MAX / sizeof(T)) throw std::bad_alloc();
+		return static_cast<T*>(arena->allocate(sizeof(T) * arg_Count, alignof(T)));
+	}
+
+	void deallocate(T*, size_t) noexcept {}
+
+	LinearArena* getArena() const noexcept { return arena; }
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& arg_Other) const noexcept { return arena == arg_Other.getArena(); }
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U>& arg_Other) const noexcept { return arena != arg_Other.getArena(); }
+
+private:
+	LinearArena* arena;
+};
@@ -0,0 +1,322 @@
+#include "FramePacer.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+namespace
+{
+	const int64_t MIN_SPIN_NS = 100000;
+	const int64_t MAX_SPIN_NS = 4000000;
+	const double OVERSHOOT_SMOOTHING = 0.1;
+
+	class SteadyClock : public PacerClock
+	{
+	public:
+		int64_t now() override
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		void sleepFor(int64_t arg_Nanoseconds) override
+		{
+			std::this_thread::sleep_for(std::chrono::nanoseconds(arg_Nanoseconds));
+		}
+
+		void spin() override
+		{
+			std::this_thread::yield();
+		}
+	};
+
+	// Sleeps overshoot by 50 us plus an exponential tail, as a loaded desktop scheduler does.
+	class VirtualClock : public PacerClock
+	{
+	public:
+		int64_t now() override { return time; }
+
+		void sleepFor(int64_t arg_Nanoseconds) override
+		{
+			time += arg_Nanoseconds + 50000 + static_cast<int64_t>(overshoot(random));
+		}
+
+		void spin() override { time += 2000; }
+
+		void advance(int64_t arg_Nanoseconds) { time += arg_Nanoseconds; }
+
+		std::mt19937 random{ 7 };
+
+	private:
+		int64_t time = 1000000000;
+		std::exponential_distribution<double> overshoot{ 1.0 / 150000.0 };
+	};
+
+	double toMs(int64_t arg_Nanoseconds)
+	{
+		return static_cast<double>(arg_Nanoseconds) / 1e6;
+	}
+}
+
+PacerClock& PacerClock::steady()
+{
+	static SteadyClock clock;
+	return clock;
+}
+
+FramePacer::Settings FramePacer::Settings::fromConfig(double arg_RefreshHz)
+{
+	Settings settings{};
+	settings.mode = PacingMode::Off;
+	const std::string mode = Config::getString("APP_PACING", "off");
+	if (!parseMode(mode, settings.mode))
+	{
+		LOG_MSG_ERR("Unknown pacing mode \"" << mode << "\", pacing is off");
+	}
+
+	settings.frameLimit = std::max(0.0, Config::getDouble("APP_FRAME_LIMIT", 0.0));
+	if (settings.frameLimit == 0.0 && settings.mode == PacingMode::JustInTime) settings.frameLimit = arg_RefreshHz;
+	settings.marginMs = std::clamp(Config::getDouble("APP_PACING_MARGIN_MS", 1.0), 0.0, 50.0);
+	settings.historyFrames = 32;
+
+	return settings;
+}
+
+FramePacer::FramePacer(Settings arg_Settings, PacerClock& arg_Clock)
+	: settings(arg_Settings),
+	clock(arg_Clock),
+	workHistory(std::max(1u, arg_Settings.historyFrames), 0)
+{
+	if (settings.frameLimit > 0.0) intervalNs = static_cast<int64_t>(1e9 / settings.frameLimit);
+
+	// Pessimistic until the first sleeps have been measured.
+	overshootMean = 1e6;
+	spinThresholdNs = 2000000;
+
+	if (settings.mode != PacingMode::Off && intervalNs == 0)
+	{
+		LOG_MSG_ERR("Pacing " << modeName(settings.mode) << " needs APP_FRAME_LIMIT, pacing is off");
+	}
+}
+
+void FramePacer::beginFrame()
+{
+	if (!isEnabled() || lastFrameStart == 0)
+	{
+		frameStart = clock.now();
+		lastFrameStart = frameStart;
+		lastLatenessNs = 0;
+		return;
+	}
+
+	const int64_t planned = nextStart();
+	waitUntil(planned);
+
+	frameStart = clock.now();
+	lastLatenessNs = std::max<int64_t>(0, frameStart - planned);
+	lastFrameStart = settings.mode == PacingMode::Limit ? planned : frameStart;
+}
+
+void FramePacer::endFrame(int64_t arg_WaitNs)
+{
+	const int64_t end = clock.now();
+	const int64_t work = std::max<int64_t>(0, end - frameStart - arg_WaitNs);
+
+	workHistory[workCursor] = work;
+	workCursor = (workCursor + 1) % workHistory.size();
+	predictedWorkNs = *std::max_element(workHistory.begin(), workHistory.end());
+
+	if (isEnabled())
+	{
+		const bool missed = settings.mode == PacingMode::JustInTime
+			? lastPresentEnd != 0 && end - lastPresentEnd > intervalNs + intervalNs / 2
+			: work > intervalNs;
+		if (missed) ++missedDeadlines;
+	}
+
+	lastPresentEnd = end;
+}
+
+int64_t FramePacer::nextStart() const
+{
+	const int64_t now = clock.now();
+
+	if (settings.mode == PacingMode::Limit)
+	{
+		// Spaced from the previous planned start so wake-up lateness does not accumulate, but
+		// a frame that fell a whole interval behind restarts the schedule instead of bursting.
+		const int64_t planned = lastFrameStart + intervalNs;
+		return planned < now - intervalNs ? now : planned;
+	}
+
+	const int64_t margin = static_cast<int64_t>(settings.marginMs * 1e6);
+	return lastPresentEnd + intervalNs - predictedWorkNs - margin;
+}
+
+void FramePacer::waitUntil(int64_t arg_Deadline)
+{
+	for (;;)
+	{
+		const int64_t start = clock.now();
+		const int64_t remaining = arg_Deadline - start;
+		if (remaining <= 0) break;
+
+		if (remaining > spinThresholdNs)
+		{
+			const int64_t request = remaining - spinThresholdNs;
+			clock.sleepFor(request);
+			recordOvershoot(clock.now() - start - request);
+		}
+		else
+		{
+			clock.spin();
+		}
+	}
+}
+
+void FramePacer::recordOvershoot(int64_t arg_OvershootNs)
+{
+	const double diff = static_cast<double>(arg_OvershootNs) - overshootMean;
+	overshootMean += OVERSHOOT_SMOOTHING * diff;
+	overshootVariance = (1.0 - OVERSHOOT_SMOOTHING) * (overshootVariance + OVERSHOOT_SMOOTHING * diff * diff);
+
+	const double threshold = overshootMean + 3.0 * std::sqrt(overshootVariance);
+	spinThresholdNs = std::clamp(static_cast<int64_t>(threshold), MIN_SPIN_NS, MAX_SPIN_NS);
+}
+
+bool FramePacer::parseMode(const std::string& arg_Name, PacingMode& arg_Mode)
+{
+	if (arg_Name == "off") arg_Mode = PacingMode::Off;
+	else if (arg_Name == "limit") arg_Mode = PacingMode::Limit;
+	else if (arg_Name == "jit") arg_Mode = PacingMode::JustInTime;
+	else return false;
+
+	return true;
+}
+
+const char* FramePacer::modeName(PacingMode arg_Mode)
+{
+	switch (arg_Mode)
+	{
+	case PacingMode::Off: return "off";
+	case PacingMode::Limit: return "limit";
+	case PacingMode::JustInTime: return "jit";
+	default: return "unknown";
+	}
+}
+
+std::vector<FramePacer::SimulationResult> FramePacer::simulate()
+{
+	const uint32_t FRAMES = 3000;
+	const uint32_t WARMUP = 100;
+	const double REFRESH_HZ = 60.0;
+
+	struct Scenario
+	{
+		const char* name;
+		PacingMode mode;
+		double frameLimit;
+		bool vsync;
+		std::function<double(uint32_t, std::mt19937&)> workMs;
+	};
+
+	const Scenario scenarios[] = {
+		{ "limit 144 fps", PacingMode::Limit, 144.0, false,
+			[](uint32_t, std::mt19937& arg_Random) { return std::normal_distribution<double>(2.0, 0.3)(arg_Random); } },
+		{ "limit 60 fps overloaded", PacingMode::Limit, 60.0, false,
+			[](uint32_t, std::mt19937& arg_Random) { return std::normal_distribution<double>(20.0, 1.0)(arg_Random); } },
+		{ "vsync 60 Hz unpaced", PacingMode::Off, 0.0, true,
+			[](uint32_t, std::mt19937& arg_Random) { return std::normal_distribution<double>(5.0, 0.5)(arg_Random); } },
+		{ "vsync 60 Hz jit", PacingMode::JustInTime, REFRESH_HZ, true,
+			[](uint32_t, std::mt19937& arg_Random) { return std::normal_distribution<double>(5.0, 0.5)(arg_Random); } },
+		{ "vsync 60 Hz jit with spikes", PacingMode::JustInTime, REFRESH_HZ, true,
+			[](uint32_t arg_Frame, std::mt19937& arg_Random) { return (arg_Frame % 200 == 0 ? 12.0 : 5.0) + std::normal_distribution<double>(0.0, 0.5)(arg_Random); } },
+	};
+
+	const int64_t refreshNs = static_cast<int64_t>(1e9 / REFRESH_HZ);
+	std::vector<SimulationResult> results;
+	double unpacedLatencyMs = 0.0;
+
+	for (const Scenario& scenario : scenarios)
+	{
+		Settings settings{};
+		settings.mode = scenario.mode;
+		settings.frameLimit = scenario.frameLimit;
+		settings.marginMs = 1.0;
+		settings.historyFrames = 32;
+
+		VirtualClock clock;
+		FramePacer pacer(settings, clock);
+
+		std::vector<double> intervalErrors;
+		double intervalSum = 0.0;
+		double latencySum = 0.0;
+		uint32_t measured = 0;
+		int64_t previousStart = 0;
+
+		for (uint32_t frame = 0; frame < FRAMES; ++frame)
+		{
+			pacer.beginFrame();
+			const int64_t start = clock.now();
+
+			clock.advance(static_cast<int64_t>(std::max(0.1, scenario.workMs(frame, clock.random)) * 1e6));
+
+			// Present blocks until the next vblank, as a FIFO swapchain one frame deep does.
+			int64_t wait = 0;
+			if (scenario.vsync)
+			{
+				wait = (refreshNs - clock.now() % refreshNs) % refreshNs;
+				clock.advance(wait);
+			}
+			pacer.endFrame(wait);
+
+			if (frame > WARMUP)
+			{
+				const double intervalMs = toMs(start - previousStart);
+				intervalSum += intervalMs;
+				if (pacer.getIntervalNs() > 0) intervalErrors.push_back(std::abs(intervalMs - toMs(pacer.getIntervalNs())));
+				latencySum += toMs(clock.now() - start);
+				++measured;
+			}
+			previousStart = start;
+		}
+
+		SimulationResult result{};
+		result.name = scenario.name;
+		result.meanIntervalMs = intervalSum / measured;
+		result.meanLatencyMs = latencySum / measured;
+		result.missedDeadlines = pacer.getMissedDeadlines();
+
+		if (!intervalErrors.empty())
+		{
+			std::sort(intervalErrors.begin(), intervalErrors.end());
+			result.intervalErrorP99Ms = intervalErrors[intervalErrors.size() * 99 / 100];
+		}
+
+		switch (scenario.mode)
+		{
+		case PacingMode::Limit:
+			// Sub-millisecond spacing when there is headroom; no added delay when there is none.
+			result.passed = scenario.frameLimit > 100.0
+				? result.intervalErrorP99Ms < 0.5
+				: result.meanIntervalMs < 21.0;
+			break;
+		case PacingMode::JustInTime:
+			result.passed = result.missedDeadlines <= FRAMES / 100 && result.meanLatencyMs < unpacedLatencyMs * 0.6;
+			break;
+		case PacingMode::Off:
+		default:
+			unpacedLatencyMs = result.meanLatencyMs;
+			result.passed = true;
+			break;
+		}
+
+		results.push_back(result);
+	}
+
+	return results;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Time source for FramePacer, in nanoseconds. The steady clock is used by the application;
+// the simulation substitutes a virtual one so pacing decisions are reproducible.
+class PacerClock
+{
+public:
+	virtual ~PacerClock() = default;
+
+	virtual int64_t now() = 0;
+	virtual void sleepFor(int64_t arg_Nanoseconds) = 0;
+	// One iteration of the busy-wait tail.
+	virtual void spin() = 0;
+
+	static PacerClock& steady();
+};
+
+enum class PacingMode
+{
+	Off,
+	// Frame starts are spaced one interval apart.
+	Limit,
+	// Frame starts are delayed so the frame finishes margin before the next present deadline.
+	JustInTime
+};
+
+// Decides when the render loop may start the next frame and waits for it. Waits sleep while
+// the deadline is far and spin for the last stretch; the spin threshold follows the measured
+// sleep overshoot (mean + 3 deviations), so the wake-up is sub-millisecond without spinning a
+// core for the whole interval.
+//   APP_PACING         off (default) | limit | jit
+//   APP_FRAME_LIMIT    frames per second; jit falls back to the monitor refresh rate
+//   APP_PACING_MARGIN_MS  slack jit leaves before the deadline (default 1)
+// Just-in-time assumes present deadlines one interval after the previous present returned,
+// which holds once FIFO presentation is vsync-locked, and predicts the frame's work from the
+// slowest of the recent frames with the surface wait excluded.
+class FramePacer
+{
+public:
+	struct Settings
+	{
+		PacingMode mode;
+		double frameLimit;
+		double marginMs;
+		uint32_t historyFrames;
+
+		// arg_RefreshHz is used by jit when no frame limit is set.
+		static Settings fromConfig(double arg_RefreshHz);
+	};
+
+	FramePacer(Settings arg_Settings, PacerClock& arg_Clock);
+
+	// Waits until the next frame may start.
+	void beginFrame();
+	// Call after present; arg_WaitNs is time spent blocked on the surface, which is not work.
+	void endFrame(int64_t arg_WaitNs);
+
+	bool isEnabled() const { return settings.mode != PacingMode::Off && intervalNs > 0; }
+	int64_t getIntervalNs() const { return intervalNs; }
+	int64_t getPredictedWorkNs() const { return predictedWorkNs; }
+	int64_t getSpinThresholdNs() const { return spinThresholdNs; }
+	// Time the last frame started after its planned start.
+	int64_t getLastLatenessNs() const { return lastLatenessNs; }
+	uint64_t getMissedDeadlines() const { return missedDeadlines; }
+
+	static bool parseMode(const std::string& arg_Name, PacingMode& arg_Mode);
+	static const char* modeName(PacingMode arg_Mode);
+
+	// Headless check against a virtual clock with noisy sleeps and a vsync-locked present.
+	struct SimulationResult
+	{
+		std::string name;
+		bool passed;
+		double meanIntervalMs;
+		double intervalErrorP99Ms;
+		double meanLatencyMs;
+		uint64_t missedDeadlines;
+	};
+
+	static std::vector<SimulationResult> simulate();
+
+private:
+	void waitUntil(int64_t arg_Deadline);
+	void recordOvershoot(int64_t arg_OvershootNs);
+	int64_t nextStart() const;
+
+private:
+	Settings settings;
+	PacerClock& clock;
+	int64_t intervalNs = 0;
+
+	int64_t frameStart = 0;
+	int64_t lastFrameStart = 0;
+	int64_t lastPresentEnd = 0;
+	int64_t lastLatenessNs = 0;
+	uint64_t missedDeadlines = 0;
+
+	std::vector<int64_t> workHistory;
+	size_t workCursor = 0;
+	int64_t predictedWorkNs = 0;
+
+	double overshootMean = 0.0;
+	double overshootVariance = 0.0;
+	int64_t spinThresholdNs = 0;
+};
@@ -0,0 +1,305 @@
+#include "FrameTelemetry.hxx"
+#include "AllocationTracker.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+	#define TELEMETRY_HAS_UNIX_SOCKET 1
+
+	// A client that disconnects early must not take the process down with SIGPIPE.
+	#ifdef MSG_NOSIGNAL
+		#define SEND_FLAGS MSG_NOSIGNAL
+	#else
+		#define SEND_FLAGS 0
+	#endif
+#endif
+
+namespace
+{
+	const char* SOCKET_PREFIX = "unix:";
+	const int ACCEPT_POLL_MS = 200;
+
+	bool isSocketTarget(const std::string& arg_Target)
+	{
+		return arg_Target.rfind(SOCKET_PREFIX, 0) == 0;
+	}
+
+	// Only the debug log uses it.
+	[[maybe_unused]] double toMs(uint64_t arg_Nanoseconds)
+	{
+		return static_cast<double>(arg_Nanoseconds) / 1e6;
+	}
+
+	double toSeconds(uint64_t arg_Nanoseconds)
+	{
+		return static_cast<double>(arg_Nanoseconds) / 1e9;
+	}
+}
+
+FrameTelemetry::Settings FrameTelemetry::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.target = Config::getString("APP_TELEMETRY");
+	settings.windowSeconds = Config::getDouble("APP_TELEMETRY_WINDOW", 5.0);
+	if (settings.windowSeconds <= 0.0) settings.windowSeconds = 5.0;
+
+	return settings;
+}
+
+FrameTelemetry::FrameTelemetry(Settings arg_Settings)
+	: settings(std::move(arg_Settings)),
+	windowStart(std::chrono::steady_clock::now())
+{
+	if (settings.target.empty()) return;
+
+	if (isSocketTarget(settings.target))
+	{
+#ifdef TELEMETRY_HAS_UNIX_SOCKET
+		const std::string path = settings.target.substr(std::string(SOCKET_PREFIX).size());
+
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(address.sun_path))
+			throw std::runtime_error("Invalid telemetry socket path: " + path);
+		path.copy(address.sun_path, path.size());
+
+		listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listenFd < 0) throw std::runtime_error("Could not create telemetry socket");
+
+		::unlink(path.c_str());
+		if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 4) != 0)
+		{
+			::close(listenFd);
+			throw std::runtime_error("Could not listen on telemetry socket " + path);
+		}
+#else
+		throw std::runtime_error("Unix domain sockets are not available for telemetry on this platform");
+#endif
+	}
+
+	running.store(true);
+	exportThread = std::thread(&FrameTelemetry::exportThreadMain, this);
+}
+
+FrameTelemetry::~FrameTelemetry()
+{
+	if (running.exchange(false))
+	{
+		snapshotCondition.notify_all();
+		exportThread.join();
+	}
+
+#ifdef TELEMETRY_HAS_UNIX_SOCKET
+	if (listenFd >= 0)
+	{
+		::close(listenFd);
+		::unlink(settings.target.substr(std::string(SOCKET_PREFIX).size()).c_str());
+	}
+#endif
+}
+
+void FrameTelemetry::record(FrameMetric arg_Metric, uint64_t arg_Nanoseconds)
+{
+	window[static_cast<size_t>(arg_Metric)].record(arg_Nanoseconds);
+}
+
+void FrameTelemetry::record(FrameMetric arg_Metric, std::chrono::steady_clock::duration arg_Duration)
+{
+	record(arg_Metric, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(arg_Duration).count()));
+}
+
+void FrameTelemetry::endFrame()
+{
+	++frames;
+
+	auto now = std::chrono::steady_clock::now();
+	if (std::chrono::duration<double>(now - windowStart).count() >= settings.windowSeconds)
+		closeWindow(now);
+}
+
+const FrameTelemetry::Summary& FrameTelemetry::getSummary(FrameMetric arg_Metric) const
+{
+	return summaries[static_cast<size_t>(arg_Metric)];
+}
+
+const Histogram& FrameTelemetry::getTotal(FrameMetric arg_Metric) const
+{
+	return total[static_cast<size_t>(arg_Metric)];
+}
+
+const char* FrameTelemetry::metricName(FrameMetric arg_Metric)
+{
+	switch (arg_Metric)
+	{
+	case FrameMetric::Interval: return "interval";
+	case FrameMetric::Cpu: return "cpu";
+	case FrameMetric::Submit: return "submit";
+	case FrameMetric::Present: return "present";
+	case FrameMetric::Gpu: return "gpu";
+	case FrameMetric::InputToPresent: return "input_to_present";
+	default: return "unknown";
+	}
+}
+
+void FrameTelemetry::closeWindow(std::chrono::steady_clock::time_point arg_Now)
+{
+	for (size_t i = 0; i < METRIC_COUNT; ++i)
+	{
+		const Histogram& histogram = window[i];
+		Summary& summary = summaries[i];
+		summary.count = histogram.getCount();
+		summary.p50 = histogram.percentile(50.0);
+		summary.p95 = histogram.percentile(95.0);
+		summary.p99 = histogram.percentile(99.0);
+		summary.max = histogram.getMax();
+		summary.mean = histogram.getMean();
+
+		if (summary.count > 0)
+		{
+			LOG_MSG_SUC("Frame " << metricName(static_cast<FrameMetric>(i)) << " ms: p50 " << toMs(summary.p50)
+				<< ", p95 " << toMs(summary.p95)
+				<< ", p99 " << toMs(summary.p99)
+				<< ", max " << toMs(summary.max)
+				<< " (" << summary.count << " samples)");
+		}
+
+		total[i].merge(histogram);
+		window[i].reset();
+	}
+
+	windowStart = arg_Now;
+
+	if (!running.load()) return;
+
+	ALLOC_SCOPE_EXEMPT("telemetryExport");
+	std::string text = formatPrometheus();
+	{
+		std::lock_guard<std::mutex> lock(snapshotMutex);
+		snapshot.swap(text);
+		snapshotDirty = true;
+	}
+	snapshotCondition.notify_one();
+}
+
+std::string FrameTelemetry::formatPrometheus() const
+{
+	std::ostringstream out;
+
+	out << "# HELP app_frame_time_seconds Frame phase durations over the last window.\n";
+	out << "# TYPE app_frame_time_seconds summary\n";
+	for (size_t i = 0; i < METRIC_COUNT; ++i)
+	{
+		const Summary& summary = summaries[i];
+		const char* phase = metricName(static_cast<FrameMetric>(i));
+		if (summary.count == 0 && total[i].getCount() == 0) continue;
+
+		out << "app_frame_time_seconds{phase=\"" << phase << "\",quantile=\"0.5\"} " << toSeconds(summary.p50) << '\n';
+		out << "app_frame_time_seconds{phase=\"" << phase << "\",quantile=\"0.95\"} " << toSeconds(summary.p95) << '\n';
+		out << "app_frame_time_seconds{phase=\"" << phase << "\",quantile=\"0.99\"} " << toSeconds(summary.p99) << '\n';
+		out << "app_frame_time_seconds_sum{phase=\"" << phase << "\"} " << toSeconds(total[i].getSum()) << '\n';
+		out << "app_frame_time_seconds_count{phase=\"" << phase << "\"} " << total[i].getCount() << '\n';
+	}
+
+	out << "# HELP app_frame_time_max_seconds Longest frame phase in the last window.\n";
+	out << "# TYPE app_frame_time_max_seconds gauge\n";
+	for (size_t i = 0; i < METRIC_COUNT; ++i)
+	{
+		if (summaries[i].count == 0) continue;
+		out << "app_frame_time_max_seconds{phase=\"" << metricName(static_cast<FrameMetric>(i)) << "\"} " << toSeconds(summaries[i].max) << '\n';
+	}
+
+	out << "# HELP app_frames_total Frames rendered since start.\n";
+	out << "# TYPE app_frames_total counter\n";
+	out << "app_frames_total " << frames << '\n';
+
+	out << "# HELP app_telemetry_window_seconds Length of the window the quantiles cover.\n";
+	out << "# TYPE app_telemetry_window_seconds gauge\n";
+	out << "app_telemetry_window_seconds " << settings.windowSeconds << '\n';
+
+	return out.str();
+}
+
+void FrameTelemetry::exportThreadMain()
+{
+	while (running.load())
+	{
+		if (listenFd >= 0)
+		{
+			serveSocket();
+			continue;
+		}
+
+		std::string text;
+		{
+			std::unique_lock<std::mutex> lock(snapshotMutex);
+			snapshotCondition.wait(lock, [this]() { return !running.load() || snapshotDirty; });
+			if (!snapshotDirty) continue;
+			text = snapshot;
+			snapshotDirty = false;
+		}
+		writeFile(text);
+	}
+}
+
+void FrameTelemetry::writeFile(const std::string& arg_Text) const
+{
+	// Written next to the target and renamed over it, so readers never see a partial file.
+	const std::string temporary = settings.target + ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		if (!file)
+		{
+			LOG_MSG_ERR("Could not write telemetry to " << temporary);
+			return;
+		}
+		file << arg_Text;
+	}
+
+	std::error_code err;
+	std::filesystem::rename(temporary, settings.target, err);
+	if (err)
+	{
+		LOG_MSG_ERR("Could not replace " << settings.target << ": " << err.message());
+	}
+}
+
+void FrameTelemetry::serveSocket()
+{
+#ifdef TELEMETRY_HAS_UNIX_SOCKET
+	pollfd descriptor{};
+	descriptor.fd = listenFd;
+	descriptor.events = POLLIN;
+	if (poll(&descriptor, 1, ACCEPT_POLL_MS) <= 0) return;
+
+	int client = accept(listenFd, nullptr, nullptr);
+	if (client < 0) return;
+#ifdef SO_NOSIGPIPE
+	int noSigPipe = 1;
+	setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+	std::string text;
+	{
+		std::lock_guard<std::mutex> lock(snapshotMutex);
+		text = snapshot;
+	}
+
+	size_t written = 0;
+	while (written < text.size())
+	{
+		ssize_t result = send(client, text.data() + written, text.size() - written, SEND_FLAGS);
+		if (result <= 0) break;
+		written += static_cast<size_t>(result);
+	}
+	::close(client);
+#endif
+}
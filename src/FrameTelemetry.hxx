@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Histogram.hxx"
+
+enum class FrameMetric
+{
+	Interval,
+	Cpu,
+	Submit,
+	Present,
+	Gpu,
+	InputToPresent,
+	Count
+};
+
+// Per-frame timing telemetry. The render thread records durations into one histogram per
+// metric; every window (APP_TELEMETRY_WINDOW seconds, default 5) the histograms are reduced
+// to p50/p95/p99/max, logged, and handed to an exporter thread as Prometheus text.
+//   APP_TELEMETRY=<path>         the snapshot file, replaced atomically each window
+//                                (suits node_exporter's textfile collector)
+//   APP_TELEMETRY=unix:<path>    a Unix domain socket that sends the latest snapshot to
+//                                every client that connects, then closes
+// Without APP_TELEMETRY nothing is exported and no thread is started.
+class FrameTelemetry
+{
+public:
+	struct Settings
+	{
+		std::string target;
+		double windowSeconds;
+
+		static Settings fromConfig();
+	};
+
+	struct Summary
+	{
+		uint64_t count;
+		uint64_t p50;
+		uint64_t p95;
+		uint64_t p99;
+		uint64_t max;
+		double mean;
+	};
+
+	explicit FrameTelemetry(Settings arg_Settings);
+	~FrameTelemetry();
+
+	FrameTelemetry(const FrameTelemetry&) = delete;
+	FrameTelemetry& operator=(const FrameTelemetry&) = delete;
+
+	void record(FrameMetric arg_Metric, uint64_t arg_Nanoseconds);
+	void record(FrameMetric arg_Metric, std::chrono::steady_clock::duration arg_Duration);
+
+	// Call once per frame after all of its metrics were recorded.
+	void endFrame();
+
+	// Summaries of the last completed window.
+	const Summary& getSummary(FrameMetric arg_Metric) const;
+	const Histogram& getTotal(FrameMetric arg_Metric) const;
+	uint64_t getFrameCount() const { return frames; }
+
+	static const char* metricName(FrameMetric arg_Metric);
+
+private:
+	static const size_t METRIC_COUNT = static_cast<size_t>(FrameMetric::Count);
+
+	void closeWindow(std::chrono::steady_clock::time_point arg_Now);
+	std::string formatPrometheus() const;
+
+	void exportThreadMain();
+	void writeFile(const std::string& arg_Text) const;
+	void serveSocket();
+
+private:
+	Settings settings;
+
+	std::array<Histogram, METRIC_COUNT> window;
+	std::array<Histogram, METRIC_COUNT> total;
+	std::array<Summary, METRIC_COUNT> summaries{};
+	uint64_t frames = 0;
+	std::chrono::steady_clock::time_point windowStart;
+
+	std::thread exportThread;
+	std::mutex snapshotMutex;
+	std::condition_variable snapshotCondition;
+	std::string snapshot;
+	bool snapshotDirty = false;
+	std::atomic<bool> running{ false };
+	int listenFd = -1;
+};
@@ -0,0 +1,52 @@
+#include "GpuDebug.hxx"
+#include "Log.hxx"
+
+GpuDebug::ValidationScope::ValidationScope(WGPUDevice arg_Device, bool arg_Wait)
+	: device(arg_Device)
+{
+	if (arg_Wait) lock = std::unique_lock<std::mutex>(errorScopeMutex());
+	else lock = std::unique_lock<std::mutex>(errorScopeMutex(), std::try_to_lock);
+
+	if (lock.owns_lock()) wgpuDevicePushErrorScope(device, WGPUErrorFilter_Validation);
+}
+
+GpuDebug::ValidationScope::~ValidationScope()
+{
+	auto ignore = [](WGPUErrorType, char const*, void*) {};
+	pop(ignore, nullptr);
+}
+
+void GpuDebug::ValidationScope::pop(WGPUErrorCallback arg_Callback, void* arg_UserData)
+{
+	if (!lock.owns_lock()) return;
+
+	wgpuDevicePopErrorScope(device, arg_Callback, arg_UserData);
+	lock.unlock();
+}
+
+#if GPU_VALIDATION
+
+ScopedErrorScope::ScopedErrorScope(WGPUDevice arg_Device, const char* arg_Label)
+	: label(arg_Label), scope(arg_Device, false)
+{
+}
+
+ScopedErrorScope::~ScopedErrorScope()
+{
+	auto onErrorScopePopped =
+		[](WGPUErrorType arg_ErrorType, char const* arg_Message, void* arg_UserData)
+		{
+			const char* label = reinterpret_cast<const char*>(arg_UserData);
+
+			if (arg_ErrorType != WGPUErrorType_NoError)
+			{
+				LOG_MSG_ERR("Validation error in " << label << ": " << (arg_Message ? arg_Message : ""));
+			}
+			(void)label;
+			(void)arg_Message;
+		};
+
+	scope.pop(onErrorScopePopped, const_cast<char*>(label));
+}
+
+#endif
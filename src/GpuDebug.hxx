@@ -0,0 +1,84 @@
+#pragma once
+
+#include <mutex>
+
+#include <webgpu/webgpu.h>
+
+// GPU_VALIDATION controls everything that only helps while debugging the GPU side: wgpu
+// validation and debug instance flags, object labels on per-frame objects and error scopes.
+// It follows DEBUG_MODE unless set explicitly (-DGPU_VALIDATION=1 for a validated release).
+#ifndef GPU_VALIDATION
+	#ifdef DEBUG_MODE
+		#define GPU_VALIDATION 1
+	#else
+		#define GPU_VALIDATION 0
+	#endif
+#endif
+
+#if GPU_VALIDATION
+	#define GPU_LABEL(text) text
+#else
+	#define GPU_LABEL(text) nullptr
+#endif
+
+namespace GpuDebug
+{
+	// wgpu-native keeps a single error scope stack per device rather than per thread, so a
+	// push/pop pair on one thread must not interleave with another thread's pair.
+	inline std::mutex& errorScopeMutex()
+	{
+		static std::mutex mutex;
+		return mutex;
+	}
+
+	// One validation error scope, pushed and popped under errorScopeMutex(). All pushes and
+	// pops go through here, whatever thread they run on. A waiting scope blocks until the
+	// stack is free; a non-waiting one is simply inactive if another thread holds it.
+	class ValidationScope
+	{
+	public:
+		ValidationScope(WGPUDevice arg_Device, bool arg_Wait);
+		// Pops without looking at the result if pop() was not called.
+		~ValidationScope();
+
+		ValidationScope(const ValidationScope&) = delete;
+		ValidationScope& operator=(const ValidationScope&) = delete;
+
+		bool isActive() const { return lock.owns_lock(); }
+		// arg_Callback runs before this returns; does nothing if the scope is inactive.
+		void pop(WGPUErrorCallback arg_Callback, void* arg_UserData);
+
+	private:
+		WGPUDevice device;
+		std::unique_lock<std::mutex> lock;
+	};
+}
+
+#if GPU_VALIDATION
+
+// Wraps a region in a validation error scope and reports anything caught when it ends. If
+// another thread currently owns the device's scope stack, the region runs unscoped rather
+// than waiting, so the render thread never blocks on e.g. a shader reload.
+class ScopedErrorScope
+{
+public:
+	ScopedErrorScope(WGPUDevice arg_Device, const char* arg_Label);
+	~ScopedErrorScope();
+
+	ScopedErrorScope(const ScopedErrorScope&) = delete;
+	ScopedErrorScope& operator=(const ScopedErrorScope&) = delete;
+
+private:
+	const char* label;
+	GpuDebug::ValidationScope scope;
+};
+
+#define GPU_ERROR_SCOPE_CONCAT_IMPL(a, b) a##b
+#define GPU_ERROR_SCOPE_CONCAT(a, b) GPU_ERROR_SCOPE_CONCAT_IMPL(a, b)
+#define GPU_ERROR_SCOPE(device, label) ScopedErrorScope GPU_ERROR_SCOPE_CONCAT(gpuErrorScope, __LINE__)(device, label)
+
+#else
+
+#define GPU_ERROR_SCOPE(device, label)
+
+#endif
@@ -0,0 +1,200 @@
+#include "GpuTimer.hxx"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <webgpu/wgpu.h>
+
+namespace
+{
+	const uint64_t TIMESTAMP_BYTES = 2 * sizeof(uint64_t);
+	// Query resolves must land on 256-byte aligned offsets.
+	const uint64_t RESOLVE_STRIDE = 256;
+
+	// Submits an empty compute pass that writes one timestamp, and waits for it.
+	void writeTimestamp(WGPUDevice arg_Device, WGPUQueue arg_Queue, WGPUQuerySet arg_QuerySet, uint32_t arg_Index)
+	{
+		WGPUComputePassTimestampWrites writes{};
+		writes.querySet = arg_QuerySet;
+		writes.beginningOfPassWriteIndex = arg_Index;
+		writes.endOfPassWriteIndex = WGPU_QUERY_SET_INDEX_UNDEFINED;
+
+		WGPUComputePassDescriptor passDesc{};
+		passDesc.timestampWrites = &writes;
+
+		WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(arg_Device, nullptr);
+		WGPUComputePassEncoder pass = wgpuCommandEncoderBeginComputePass(encoder, &passDesc);
+		wgpuComputePassEncoderEnd(pass);
+		wgpuComputePassEncoderRelease(pass);
+		WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, nullptr);
+		wgpuCommandEncoderRelease(encoder);
+
+		wgpuQueueSubmit(arg_Queue, 1, &command);
+		wgpuCommandBufferRelease(command);
+		wgpuDevicePoll(arg_Device, true, nullptr);
+	}
+}
+
+GpuTimer::GpuTimer(WGPUDevice arg_Device, uint32_t arg_Slots)
+	: device(arg_Device)
+{
+	if (arg_Slots == 0) arg_Slots = 1;
+
+	WGPUQuerySetDescriptor querySetDesc{};
+	querySetDesc.nextInChain = nullptr;
+	querySetDesc.label = "Frame timestamps";
+	querySetDesc.type = WGPUQueryType_Timestamp;
+	querySetDesc.count = 2 * arg_Slots;
+	querySet = wgpuDeviceCreateQuerySet(device, &querySetDesc);
+
+	WGPUBufferDescriptor resolveDesc{};
+	resolveDesc.nextInChain = nullptr;
+	resolveDesc.label = "Timestamp resolve";
+	resolveDesc.usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc;
+	resolveDesc.size = RESOLVE_STRIDE * arg_Slots;
+	resolveDesc.mappedAtCreation = false;
+	resolveBuffer = wgpuDeviceCreateBuffer(device, &resolveDesc);
+
+	if (!querySet || !resolveBuffer) throw std::runtime_error("Could not create GPU timer resources");
+
+	slots.resize(arg_Slots);
+	for (Slot& slot : slots)
+	{
+		WGPUBufferDescriptor readbackDesc{};
+		readbackDesc.nextInChain = nullptr;
+		readbackDesc.label = "Timestamp readback";
+		readbackDesc.usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst;
+		readbackDesc.size = TIMESTAMP_BYTES;
+		readbackDesc.mappedAtCreation = false;
+
+		slot.owner = this;
+		slot.readback = wgpuDeviceCreateBuffer(device, &readbackDesc);
+		slot.state = SlotState::Free;
+		if (!slot.readback) throw std::runtime_error("Could not create GPU timer readback buffer");
+	}
+
+	completed.reserve(arg_Slots);
+}
+
+GpuTimer::~GpuTimer()
+{
+	// Pending map callbacks point at the slots, so let them run before the slots go away.
+	bool mapping = false;
+	for (const Slot& slot : slots) mapping = mapping || slot.state == SlotState::Mapping;
+	if (mapping) wgpuDevicePoll(device, true, nullptr);
+
+	for (Slot& slot : slots)
+	{
+		if (slot.readback) wgpuBufferRelease(slot.readback);
+	}
+	if (resolveBuffer) wgpuBufferRelease(resolveBuffer);
+	if (querySet) wgpuQuerySetRelease(querySet);
+}
+
+bool GpuTimer::calibrate()
+{
+	WGPUQueue queue = wgpuDeviceGetQueue(device);
+
+	writeTimestamp(device, queue, querySet, 0);
+	auto start = std::chrono::steady_clock::now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(CALIBRATION_MS));
+	auto end = std::chrono::steady_clock::now();
+	writeTimestamp(device, queue, querySet, 1);
+
+	// Slot 0 is free until the first frame, so its readback carries the pair.
+	Slot& slot = slots[0];
+	WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
+	wgpuCommandEncoderResolveQuerySet(encoder, querySet, 0, 2, resolveBuffer, 0);
+	wgpuCommandEncoderCopyBufferToBuffer(encoder, resolveBuffer, 0, slot.readback, 0, TIMESTAMP_BYTES);
+	WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, nullptr);
+	wgpuCommandEncoderRelease(encoder);
+	wgpuQueueSubmit(queue, 1, &command);
+	wgpuCommandBufferRelease(command);
+	wgpuQueueRelease(queue);
+
+	bool mapped = false;
+	wgpuBufferMapAsync(slot.readback, WGPUMapMode_Read, 0, TIMESTAMP_BYTES,
+		[](WGPUBufferMapAsyncStatus arg_Status, void* arg_UserData) { *reinterpret_cast<bool*>(arg_UserData) = arg_Status == WGPUBufferMapAsyncStatus_Success; },
+		&mapped);
+	wgpuDevicePoll(device, true, nullptr);
+	if (!mapped) return false;
+
+	uint64_t timestamps[2];
+	std::memcpy(timestamps, wgpuBufferGetConstMappedRange(slot.readback, 0, TIMESTAMP_BYTES), TIMESTAMP_BYTES);
+	wgpuBufferUnmap(slot.readback);
+	if (timestamps[1] <= timestamps[0]) return false;
+
+	// The sleep dominates the gap; submission and polling only add to the GPU side.
+	const double wallNs = std::chrono::duration<double, std::nano>(end - start).count();
+	const double ratio = static_cast<double>(timestamps[1] - timestamps[0]) / wallNs;
+	return ratio > 0.5 && ratio < 2.0;
+}
+
+bool GpuTimer::beginPass(WGPURenderPassTimestampWrites& arg_Writes)
+{
+	recording = false;
+
+	for (uint32_t i = 0; i < slots.size(); ++i)
+	{
+		uint32_t index = (current + i) % static_cast<uint32_t>(slots.size());
+		if (slots[index].state != SlotState::Free) continue;
+
+		current = index;
+		slots[current].state = SlotState::Recording;
+		recording = true;
+
+		arg_Writes.querySet = querySet;
+		arg_Writes.beginningOfPassWriteIndex = 2 * current;
+		arg_Writes.endOfPassWriteIndex = 2 * current + 1;
+		return true;
+	}
+
+	return false;
+}
+
+void GpuTimer::resolve(WGPUCommandEncoder arg_Encoder)
+{
+	if (!recording) return;
+
+	Slot& slot = slots[current];
+	wgpuCommandEncoderResolveQuerySet(arg_Encoder, querySet, 2 * current, 2, resolveBuffer, RESOLVE_STRIDE * current);
+	wgpuCommandEncoderCopyBufferToBuffer(arg_Encoder, resolveBuffer, RESOLVE_STRIDE * current, slot.readback, 0, TIMESTAMP_BYTES);
+	slot.state = SlotState::Resolved;
+}
+
+void GpuTimer::afterSubmit()
+{
+	if (!recording) return;
+	recording = false;
+
+	Slot& slot = slots[current];
+	slot.state = SlotState::Mapping;
+	wgpuBufferMapAsync(slot.readback, WGPUMapMode_Read, 0, TIMESTAMP_BYTES, &GpuTimer::onMapped, &slot);
+
+	current = (current + 1) % static_cast<uint32_t>(slots.size());
+}
+
+void GpuTimer::takeResults(std::vector<uint64_t>& arg_Durations)
+{
+	arg_Durations.insert(arg_Durations.end(), completed.begin(), completed.end());
+	completed.clear();
+}
+
+void GpuTimer::onMapped(WGPUBufferMapAsyncStatus arg_Status, void* arg_UserData)
+{
+	Slot& slot = *reinterpret_cast<Slot*>(arg_UserData);
+
+	if (arg_Status == WGPUBufferMapAsyncStatus_Success)
+	{
+		uint64_t timestamps[2];
+		std::memcpy(timestamps, wgpuBufferGetConstMappedRange(slot.readback, 0, TIMESTAMP_BYTES), TIMESTAMP_BYTES);
+		wgpuBufferUnmap(slot.readback);
+
+		// A reset or wrapped counter shows up as end before begin; those frames are skipped.
+		if (timestamps[1] > timestamps[0]) slot.owner->completed.push_back(timestamps[1] - timestamps[0]);
+	}
+
+	slot.state = SlotState::Free;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+// Measures GPU time of one render pass per frame with timestamp queries. Each frame uses its
+// own slot (two queries, a resolve range and a small readback buffer), and a slot is only
+// reused once its readback has been mapped, so measuring never stalls the CPU on the GPU.
+// Results arrive a few frames late through takeResults(); the device has to be polled for
+// the map callbacks to run. Timestamps are treated as nanoseconds, as WebGPU specifies, but
+// wgpu 0.19 passes some backends' raw ticks through, so calibrate() checks them first.
+class GpuTimer
+{
+public:
+	static const uint32_t DEFAULT_SLOTS = 4;
+	static const uint32_t CALIBRATION_MS = 50;
+
+	GpuTimer(WGPUDevice arg_Device, uint32_t arg_Slots = DEFAULT_SLOTS);
+	~GpuTimer();
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	// Blocks for about CALIBRATION_MS, timing an idle gap with two timestamped passes. Returns
+	// false if the GPU's timestamps disagree with the wall clock by more than 2x, in which
+	// case the durations are not nanoseconds and the timer should not be used.
+	bool calibrate();
+
+	// Fills in the pass's timestamp writes. Returns false if every slot is still in flight,
+	// in which case the pass should run untimed and the rest of the frame calls are no-ops.
+	bool beginPass(WGPURenderPassTimestampWrites& arg_Writes);
+
+	// After the pass has ended, before the encoder is finished.
+	void resolve(WGPUCommandEncoder arg_Encoder);
+
+	// After the command buffer has been submitted.
+	void afterSubmit();
+
+	// Appends completed GPU durations in nanoseconds and clears them.
+	void takeResults(std::vector<uint64_t>& arg_Durations);
+
+private:
+	enum class SlotState
+	{
+		Free,
+		Recording,
+		Resolved,
+		Mapping
+	};
+
+	struct Slot
+	{
+		GpuTimer* owner;
+		WGPUBuffer readback;
+		SlotState state;
+	};
+
+	static void onMapped(WGPUBufferMapAsyncStatus arg_Status, void* arg_UserData);
+
+private:
+	WGPUDevice device;
+	WGPUQuerySet querySet = nullptr;
+	WGPUBuffer resolveBuffer = nullptr;
+	std::vector<Slot> slots;
+	uint32_t current = 0;
+	bool recording = false;
+	std::vector<uint64_t> completed;
+};
@@ -0,0 +1,80 @@
+#include "Histogram.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	uint32_t magnitude(uint64_t arg_Value)
+	{
+		uint32_t result = 0;
+		while (arg_Value >>= 1) ++result;
+		return result;
+	}
+}
+
+void Histogram::record(uint64_t arg_Value)
+{
+	if (arg_Value > MAX_VALUE) arg_Value = MAX_VALUE;
+
+	++buckets[bucketIndex(arg_Value)];
+	++count;
+	sum += arg_Value;
+	min = std::min(min, arg_Value);
+	max = std::max(max, arg_Value);
+}
+
+void Histogram::merge(const Histogram& arg_Other)
+{
+	for (uint32_t i = 0; i < BUCKET_COUNT; ++i) buckets[i] += arg_Other.buckets[i];
+	count += arg_Other.count;
+	sum += arg_Other.sum;
+	min = std::min(min, arg_Other.min);
+	max = std::max(max, arg_Other.max);
+}
+
+void Histogram::reset()
+{
+	buckets.fill(0);
+	count = 0;
+	sum = 0;
+	min = UINT64_MAX;
+	max = 0;
+}
+
+uint64_t Histogram::percentile(double arg_Percentile) const
+{
+	if (count == 0) return 0;
+
+	const double clamped = std::clamp(arg_Percentile, 0.0, 100.0);
+	const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count))));
+
+	uint64_t seen = 0;
+	for (uint32_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += buckets[i];
+		if (seen >= target) return std::min(bucketHighestValue(i), max);
+	}
+
+	return max;
+}
+
+uint32_t Histogram::bucketIndex(uint64_t arg_Value)
+{
+	if (arg_Value < SUB_BUCKETS) return static_cast<uint32_t>(arg_Value);
+
+	// Values of magnitude m keep their top SUB_BUCKET_BITS bits; each extra bit of magnitude
+	// adds another half-range of sub-buckets.
+	const uint32_t shift = magnitude(arg_Value) - (SUB_BUCKET_BITS - 1);
+	const uint32_t subBucket = static_cast<uint32_t>(arg_Value >> shift);
+	return shift * (SUB_BUCKETS / 2) + subBucket;
+}
+
+uint64_t Histogram::bucketHighestValue(uint32_t arg_Index)
+{
+	if (arg_Index < SUB_BUCKETS) return arg_Index;
+
+	const uint32_t shift = arg_Index / (SUB_BUCKETS / 2) - 1;
+	const uint64_t subBucket = arg_Index - shift * (SUB_BUCKETS / 2);
+	return ((subBucket + 1) << shift) - 1;
+}
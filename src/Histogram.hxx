@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Log-linear histogram in the style of HdrHistogram: every power of two is split into
+// SUB_BUCKETS / 2 linear sub-buckets, so any recorded value is reproduced within 1/64 (about
+// 1.6%) while covering 1 ns to 18 minutes in a fixed array. Recording is a few integer
+// operations and never allocates, so it is safe on the render thread.
+class Histogram
+{
+public:
+	static const uint32_t SUB_BUCKET_BITS = 7;
+	static const uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+	static const uint32_t MAX_MAGNITUDE = 40;
+	static const uint32_t BUCKET_COUNT = (MAX_MAGNITUDE - SUB_BUCKET_BITS + 2) * (SUB_BUCKETS / 2);
+	static const uint64_t MAX_VALUE = (1ull << MAX_MAGNITUDE) - 1;
+
+	void record(uint64_t arg_Value);
+	void merge(const Histogram& arg_Other);
+	void reset();
+
+	// Highest value equivalent to the one at the given percentile (0-100).
+	uint64_t percentile(double arg_Percentile) const;
+
+	uint64_t getCount() const { return count; }
+	uint64_t getMax() const { return max; }
+	uint64_t getMin() const { return count ? min : 0; }
+	double getMean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+	uint64_t getSum() const { return sum; }
+
+	static uint32_t bucketIndex(uint64_t arg_Value);
+	static uint64_t bucketHighestValue(uint32_t arg_Index);
+
+private:
+	std::array<uint64_t, BUCKET_COUNT> buckets{};
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t min = UINT64_MAX;
+	uint64_t max = 0;
+};
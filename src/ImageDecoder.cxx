@@ -0,0 +1,341 @@
+#include "ImageDecoder.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	const size_t QOI_HEADER_SIZE = 14;
+	// The stream ends in seven zero bytes and a one.
+	const size_t QOI_END_SIZE = 8;
+
+	const uint8_t QOI_OP_RGB = 0xfe;
+	const uint8_t QOI_OP_RGBA = 0xff;
+	const uint8_t QOI_OP_INDEX = 0x00;
+	const uint8_t QOI_OP_DIFF = 0x40;
+	const uint8_t QOI_OP_LUMA = 0x80;
+	const uint8_t QOI_MASK = 0xc0;
+
+	enum class Format
+	{
+		Unknown,
+		Qoi,
+		Netpbm
+	};
+
+	struct NetpbmHeader
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t channels;
+		uint32_t maxValue;
+		size_t dataOffset;
+	};
+
+	[[noreturn]] void fail(const std::string& arg_Message)
+	{
+		throw std::runtime_error("Image decode: " + arg_Message);
+	}
+
+	uint32_t readBigEndian32(const uint8_t* arg_Data)
+	{
+		return static_cast<uint32_t>(arg_Data[0]) << 24 | static_cast<uint32_t>(arg_Data[1]) << 16
+			| static_cast<uint32_t>(arg_Data[2]) << 8 | arg_Data[3];
+	}
+
+	Format detect(const uint8_t* arg_Data, size_t arg_Size)
+	{
+		if (arg_Size >= QOI_HEADER_SIZE && std::memcmp(arg_Data, "qoif", 4) == 0) return Format::Qoi;
+		if (arg_Size >= 3 && arg_Data[0] == 'P' && (arg_Data[1] == '5' || arg_Data[1] == '6' || arg_Data[1] == '7')) return Format::Netpbm;
+		return Format::Unknown;
+	}
+
+	void checkSize(uint32_t arg_Width, uint32_t arg_Height)
+	{
+		if (arg_Width == 0 || arg_Height == 0 || arg_Width > ImageDecoder::MAX_DIMENSION || arg_Height > ImageDecoder::MAX_DIMENSION)
+			fail(std::to_string(arg_Width) + "x" + std::to_string(arg_Height) + " is outside 1 to " + std::to_string(ImageDecoder::MAX_DIMENSION));
+	}
+
+	// Reads the whitespace-separated header tokens of netpbm files.
+	class NetpbmTokenizer
+	{
+	public:
+		NetpbmTokenizer(const uint8_t* arg_Data, size_t arg_Size, size_t arg_Position)
+			: data(arg_Data), size(arg_Size), position(arg_Position)
+		{
+		}
+
+		// Skips whitespace and comments up to the next token.
+		void skipSpace()
+		{
+			while (position < size)
+			{
+				if (data[position] == '#')
+					while (position < size && data[position] != '\n') ++position;
+				else if (isSpace(data[position])) ++position;
+				else break;
+			}
+		}
+
+		std::string word()
+		{
+			skipSpace();
+			std::string token;
+			while (position < size && !isSpace(data[position]) && token.size() < 32) token += static_cast<char>(data[position++]);
+			return token;
+		}
+
+		uint32_t number()
+		{
+			const std::string token = word();
+			if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos || token.size() > 9) fail("bad netpbm header");
+			return static_cast<uint32_t>(std::stoul(token));
+		}
+
+		// Past the single whitespace character that ends a P5/P6 header.
+		size_t endOfHeader()
+		{
+			if (position >= size || !isSpace(data[position])) fail("bad netpbm header");
+			return position + 1;
+		}
+
+		size_t getPosition() const { return position; }
+
+	private:
+		static bool isSpace(uint8_t arg_Char)
+		{
+			return arg_Char == ' ' || arg_Char == '\t' || arg_Char == '\r' || arg_Char == '\n' || arg_Char == '\v' || arg_Char == '\f';
+		}
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t position;
+	};
+
+	NetpbmHeader readNetpbmHeader(const uint8_t* arg_Data, size_t arg_Size)
+	{
+		NetpbmHeader header{};
+		NetpbmTokenizer tokens(arg_Data, arg_Size, 2);
+
+		if (arg_Data[1] == '7')
+		{
+			// PAM: KEY value lines up to ENDHDR.
+			for (std::string key = tokens.word(); key != "ENDHDR"; key = tokens.word())
+			{
+				if (key == "WIDTH") header.width = tokens.number();
+				else if (key == "HEIGHT") header.height = tokens.number();
+				else if (key == "DEPTH") header.channels = tokens.number();
+				else if (key == "MAXVAL") header.maxValue = tokens.number();
+				else if (key == "TUPLTYPE") tokens.word();
+				else fail("bad PAM header key '" + key + "'");
+			}
+			while (tokens.getPosition() < arg_Size && arg_Data[tokens.getPosition()] != '\n') tokens.word();
+			header.dataOffset = tokens.endOfHeader();
+		}
+		else
+		{
+			header.channels = arg_Data[1] == '5' ? 1 : 3;
+			header.width = tokens.number();
+			header.height = tokens.number();
+			header.maxValue = tokens.number();
+			header.dataOffset = tokens.endOfHeader();
+		}
+
+		checkSize(header.width, header.height);
+		if (header.channels < 1 || header.channels > 4) fail("netpbm images need one to four channels");
+		if (header.maxValue < 1 || header.maxValue > 65535) fail("bad netpbm MAXVAL");
+
+		const uint64_t sampleBytes = header.maxValue > 255 ? 2 : 1;
+		const uint64_t dataSize = static_cast<uint64_t>(header.width) * header.height * header.channels * sampleBytes;
+		if (header.dataOffset > arg_Size || dataSize > arg_Size - header.dataOffset) fail("truncated netpbm image");
+		return header;
+	}
+
+	void decodeNetpbm(const uint8_t* arg_Data, size_t arg_Size, uint8_t* arg_Out, size_t arg_RowPitch)
+	{
+		const NetpbmHeader header = readNetpbmHeader(arg_Data, arg_Size);
+		const uint32_t channels = header.channels;
+		const bool wide = header.maxValue > 255;
+
+		// Samples scaled to 8 bits through a table when they are 8 bits wide already, and with
+		// the division by maxValue done as a multiplication when they are 16: the dividend stays
+		// below 2^24, so a 40-bit rounded-up reciprocal gives the exact quotient.
+		uint8_t scale[256];
+		for (uint32_t value = 0; value < 256; ++value)
+			scale[value] = static_cast<uint8_t>(std::min<uint32_t>(255, (value * 255 + header.maxValue / 2) / header.maxValue));
+		const uint64_t reciprocal = ((1ull << 40) + header.maxValue - 1) / header.maxValue;
+
+		const uint8_t* source = arg_Data + header.dataOffset;
+		for (uint32_t y = 0; y < header.height; ++y)
+		{
+			uint8_t* row = arg_Out + static_cast<size_t>(y) * arg_RowPitch;
+			if (!wide && header.maxValue == 255 && channels >= 3)
+			{
+				// Full-range color needs no scaling: a row copy, or an alpha byte added per pixel.
+				if (channels == 4)
+				{
+					std::memcpy(row, source, static_cast<size_t>(header.width) * 4);
+				}
+				else
+				{
+					for (uint32_t x = 0; x < header.width; ++x)
+					{
+						row[x * 4] = source[x * 3];
+						row[x * 4 + 1] = source[x * 3 + 1];
+						row[x * 4 + 2] = source[x * 3 + 2];
+						row[x * 4 + 3] = 255;
+					}
+				}
+				source += static_cast<size_t>(header.width) * channels;
+				continue;
+			}
+
+			for (uint32_t x = 0; x < header.width; ++x)
+			{
+				uint8_t samples[4] = { 0, 0, 0, 255 };
+				for (uint32_t channel = 0; channel < channels; ++channel)
+				{
+					if (wide)
+					{
+						const uint32_t value = static_cast<uint32_t>(source[0]) << 8 | source[1];
+						samples[channel] = static_cast<uint8_t>(std::min<uint64_t>(255, (static_cast<uint64_t>(value) * 255 + header.maxValue / 2) * reciprocal >> 40));
+						source += 2;
+					}
+					else
+					{
+						samples[channel] = scale[*source++];
+					}
+				}
+
+				// Gray (and alpha) spreads over the color channels.
+				uint8_t* pixel = row + static_cast<size_t>(x) * 4;
+				if (channels <= 2)
+				{
+					pixel[0] = pixel[1] = pixel[2] = samples[0];
+					pixel[3] = channels == 2 ? samples[1] : 255;
+				}
+				else
+				{
+					std::memcpy(pixel, samples, 4);
+				}
+			}
+		}
+	}
+
+	ImageDecoder::Info readQoiInfo(const uint8_t* arg_Data, size_t arg_Size)
+	{
+		if (arg_Size < QOI_HEADER_SIZE + QOI_END_SIZE) fail("truncated QOI image");
+
+		ImageDecoder::Info info{ readBigEndian32(arg_Data + 4), readBigEndian32(arg_Data + 8) };
+		checkSize(info.width, info.height);
+		if (arg_Data[12] != 3 && arg_Data[12] != 4) fail("bad QOI channel count");
+		return info;
+	}
+
+	void decodeQoi(const uint8_t* arg_Data, size_t arg_Size, uint8_t* arg_Out, size_t arg_RowPitch)
+	{
+		const ImageDecoder::Info info = readQoiInfo(arg_Data, arg_Size);
+
+		uint8_t index[64][4] = {};
+		uint8_t pixel[4] = { 0, 0, 0, 255 };
+		uint32_t run = 0;
+		size_t position = QOI_HEADER_SIZE;
+		const size_t chunksEnd = arg_Size - QOI_END_SIZE;
+		auto need = [&](size_t arg_Bytes) { if (position + arg_Bytes > chunksEnd) fail("truncated QOI image"); };
+
+		for (uint32_t y = 0; y < info.height; ++y)
+		{
+			uint8_t* row = arg_Out + static_cast<size_t>(y) * arg_RowPitch;
+			for (uint32_t x = 0; x < info.width; ++x)
+			{
+				if (run > 0)
+				{
+					--run;
+				}
+				else
+				{
+					need(1);
+					const uint8_t op = arg_Data[position++];
+					if (op == QOI_OP_RGB)
+					{
+						need(3);
+						std::memcpy(pixel, arg_Data + position, 3);
+						position += 3;
+					}
+					else if (op == QOI_OP_RGBA)
+					{
+						need(4);
+						std::memcpy(pixel, arg_Data + position, 4);
+						position += 4;
+					}
+					else if ((op & QOI_MASK) == QOI_OP_INDEX)
+					{
+						std::memcpy(pixel, index[op], 4);
+					}
+					else if ((op & QOI_MASK) == QOI_OP_DIFF)
+					{
+						pixel[0] = static_cast<uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+						pixel[1] = static_cast<uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+						pixel[2] = static_cast<uint8_t>(pixel[2] + (op & 3) - 2);
+					}
+					else if ((op & QOI_MASK) == QOI_OP_LUMA)
+					{
+						need(1);
+						const uint8_t next = arg_Data[position++];
+						const int green = (op & 0x3f) - 32;
+						pixel[0] = static_cast<uint8_t>(pixel[0] + green - 8 + ((next >> 4) & 0x0f));
+						pixel[1] = static_cast<uint8_t>(pixel[1] + green);
+						pixel[2] = static_cast<uint8_t>(pixel[2] + green - 8 + (next & 0x0f));
+					}
+					else
+					{
+						run = op & 0x3f;
+					}
+					std::memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+				}
+				std::memcpy(row + static_cast<size_t>(x) * 4, pixel, 4);
+			}
+		}
+	}
+}
+
+bool ImageDecoder::canDecode(const void* arg_Data, size_t arg_Size)
+{
+	return detect(static_cast<const uint8_t*>(arg_Data), arg_Size) != Format::Unknown;
+}
+
+ImageDecoder::Info ImageDecoder::probe(const void* arg_Data, size_t arg_Size)
+{
+	const uint8_t* data = static_cast<const uint8_t*>(arg_Data);
+	switch (detect(data, arg_Size))
+	{
+	case Format::Qoi:
+		return readQoiInfo(data, arg_Size);
+	case Format::Netpbm:
+	{
+		const NetpbmHeader header = readNetpbmHeader(data, arg_Size);
+		return { header.width, header.height };
+	}
+	default:
+		fail("unknown image format");
+	}
+}
+
+void ImageDecoder::decode(const void* arg_Data, size_t arg_Size, uint8_t* arg_Out, size_t arg_RowPitch)
+{
+	const uint8_t* data = static_cast<const uint8_t*>(arg_Data);
+	switch (detect(data, arg_Size))
+	{
+	case Format::Qoi:
+		decodeQoi(data, arg_Size, arg_Out, arg_RowPitch);
+		break;
+	case Format::Netpbm:
+		decodeNetpbm(data, arg_Size, arg_Out, arg_RowPitch);
+		break;
+	default:
+		fail("unknown image format");
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decodes images into RGBA8: QOI, and binary netpbm (P5 grayscale, P6 RGB and P7 PAM with
+// one to four channels) at 8 or 16 bits, 16-bit samples rounded to 8. probe() reads only the
+// header, so the caller can size the destination first and decode() straight into it at any
+// row pitch, such as staging memory at the 256-byte pitch texture copies need. Malformed or
+// truncated data throws std::runtime_error.
+namespace ImageDecoder
+{
+	// Larger images are rejected; it is the common maxTextureDimension2D.
+	constexpr uint32_t MAX_DIMENSION = 16384;
+
+	struct Info
+	{
+		uint32_t width;
+		uint32_t height;
+	};
+
+	// True if the data starts like a format decode() reads.
+	bool canDecode(const void* arg_Data, size_t arg_Size);
+	Info probe(const void* arg_Data, size_t arg_Size);
+	// arg_Out holds height rows of arg_RowPitch bytes, each at least width * 4; padding past
+	// the pixels of a row is left alone.
+	void decode(const void* arg_Data, size_t arg_Size, uint8_t* arg_Out, size_t arg_RowPitch);
+}
@@ -0,0 +1,178 @@
+#include "InputLatency.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <fstream>
+
+namespace
+{
+	double toMs(uint64_t arg_Nanoseconds)
+	{
+		return static_cast<double>(arg_Nanoseconds) / 1e6;
+	}
+}
+
+InputLatencyTracker::Settings InputLatencyTracker::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.injectHz = std::clamp(Config::getDouble("APP_INPUT_INJECT_HZ", 0.0), 0.0, 10000.0);
+	settings.statsPath = Config::getString("APP_INPUT_LATENCY_STATS");
+
+	return settings;
+}
+
+InputLatencyTracker::InputLatencyTracker(Settings arg_Settings)
+	: settings(std::move(arg_Settings))
+{
+	if (settings.injectHz > 0.0)
+	{
+		injectInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.injectHz));
+		nextInjection = Clock::now() + injectInterval;
+		LOG_MSG_SUC("Injecting synthetic input at " << settings.injectHz << " Hz");
+	}
+}
+
+InputLatencyTracker::~InputLatencyTracker()
+{
+	// The work-done callbacks hold pointers into tags; the owner drains the queue first.
+	if (inFlight > 0)
+	{
+		LOG_MSG_ERR(inFlight << " input latency tags still in flight at shutdown");
+	}
+}
+
+void InputLatencyTracker::onEvent(Clock::time_point arg_Time)
+{
+	++events;
+	if (!hasPending || arg_Time < oldestPending) oldestPending = arg_Time;
+	hasPending = true;
+}
+
+void InputLatencyTracker::injectSynthetic(Clock::time_point arg_Now)
+{
+	if (injectInterval == Clock::duration::zero()) return;
+
+	// After a long stall only the backlog's first event matters for the oldest-event tag.
+	if (arg_Now - nextInjection > injectInterval * 64) nextInjection = arg_Now - injectInterval * 64;
+
+	while (nextInjection <= arg_Now)
+	{
+		onEvent(nextInjection);
+		nextInjection += injectInterval;
+	}
+}
+
+bool InputLatencyTracker::beginFrame()
+{
+	currentTag = nullptr;
+	if (!hasPending) return false;
+
+	hasPending = false;
+
+	FrameTag& tag = tags[nextTag];
+	if (tag.inUse)
+	{
+		++untracked;
+		return false;
+	}
+
+	nextTag = (nextTag + 1) % MAX_IN_FLIGHT;
+	tag.tracker = this;
+	tag.eventTime = oldestPending;
+	tag.inUse = true;
+	currentTag = &tag;
+
+	return true;
+}
+
+void InputLatencyTracker::markSubmitted(Clock::time_point arg_Time)
+{
+	if (currentTag) record(LatencyStage::Submit, currentTag->eventTime, arg_Time);
+}
+
+void InputLatencyTracker::markPresented(Clock::time_point arg_Time)
+{
+	if (currentTag) record(LatencyStage::Present, currentTag->eventTime, arg_Time);
+}
+
+void InputLatencyTracker::trackGpuDone(WGPUQueue arg_Queue)
+{
+	if (!currentTag) return;
+
+	auto onWorkDone =
+		[](WGPUQueueWorkDoneStatus arg_Status, void* arg_UserData)
+		{
+			FrameTag* tag = static_cast<FrameTag*>(arg_UserData);
+			InputLatencyTracker* tracker = tag->tracker;
+
+			if (arg_Status == WGPUQueueWorkDoneStatus_Success)
+				tracker->record(LatencyStage::GpuDone, tag->eventTime, Clock::now());
+
+			tag->inUse = false;
+			--tracker->inFlight;
+		};
+
+	++inFlight;
+	wgpuQueueOnSubmittedWorkDone(arg_Queue, onWorkDone, currentTag);
+	currentTag = nullptr;
+}
+
+void InputLatencyTracker::record(LatencyStage arg_Stage, Clock::time_point arg_EventTime, Clock::time_point arg_Time)
+{
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(arg_Time - arg_EventTime).count();
+	latency[static_cast<size_t>(arg_Stage)].record(static_cast<uint64_t>(std::max<int64_t>(0, elapsed)));
+}
+
+void InputLatencyTracker::logSummary() const
+{
+	LOG_MSG_SUC("Input events: " << events << ", frames without a free tag: " << untracked);
+
+	for (size_t i = 0; i < STAGE_COUNT; ++i)
+	{
+		const Histogram& histogram = latency[i];
+		if (histogram.getCount() == 0) continue;
+
+		LOG_MSG_SUC("Input to " << stageName(static_cast<LatencyStage>(i)) << " ms: p50 " << toMs(histogram.percentile(50.0))
+			<< ", p95 " << toMs(histogram.percentile(95.0))
+			<< ", p99 " << toMs(histogram.percentile(99.0))
+			<< ", max " << toMs(histogram.getMax())
+			<< " (" << histogram.getCount() << " frames)");
+	}
+}
+
+void InputLatencyTracker::writeStats() const
+{
+	if (settings.statsPath.empty()) return;
+
+	std::ofstream file(settings.statsPath, std::ios::trunc);
+	if (!file)
+	{
+		LOG_MSG_ERR("Could not write input latency stats to " << settings.statsPath);
+		return;
+	}
+
+	file << "stage,frames,p50_ms,p95_ms,p99_ms,max_ms,mean_ms\n";
+	for (size_t i = 0; i < STAGE_COUNT; ++i)
+	{
+		const Histogram& histogram = latency[i];
+		file << stageName(static_cast<LatencyStage>(i))
+			<< ',' << histogram.getCount()
+			<< ',' << toMs(histogram.percentile(50.0))
+			<< ',' << toMs(histogram.percentile(95.0))
+			<< ',' << toMs(histogram.percentile(99.0))
+			<< ',' << toMs(histogram.getMax())
+			<< ',' << histogram.getMean() / 1e6 << '\n';
+	}
+}
+
+const char* InputLatencyTracker::stageName(LatencyStage arg_Stage)
+{
+	switch (arg_Stage)
+	{
+	case LatencyStage::Submit: return "submit";
+	case LatencyStage::Present: return "present";
+	case LatencyStage::GpuDone: return "gpu_done";
+	default: return "unknown";
+	}
+}
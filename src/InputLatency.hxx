@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <webgpu/webgpu.h>
+
+#include "Histogram.hxx"
+
+enum class LatencyStage
+{
+	Submit,
+	Present,
+	GpuDone,
+	Count
+};
+
+// Input-to-photon instrumentation. GLFW reports no event times, so input callbacks stamp each
+// event when it is polled; the frame encoded next consumes everything pending and is tagged
+// with the oldest event, so the recorded latency is the worst case within the frame. The tag
+// follows the frame through submit and present and ends at wgpuQueueOnSubmittedWorkDone,
+// the last point WebGPU reports: the frame is rendered and handed to the compositor. Scanout
+// adds at most the present queue depth in refresh intervals on top.
+//   APP_INPUT_INJECT_HZ         synthetic events per second for runs without a user; they
+//                               carry the time they were scheduled, so poll delay is included
+//   APP_INPUT_LATENCY_STATS     file the final summary is written to
+class InputLatencyTracker
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Settings
+	{
+		double injectHz;
+		std::string statsPath;
+
+		static Settings fromConfig();
+	};
+
+	explicit InputLatencyTracker(Settings arg_Settings);
+	~InputLatencyTracker();
+
+	InputLatencyTracker(const InputLatencyTracker&) = delete;
+	InputLatencyTracker& operator=(const InputLatencyTracker&) = delete;
+
+	// From GLFW input callbacks, which run inside glfwPollEvents.
+	void onEvent(Clock::time_point arg_Time);
+	// Emits the synthetic events due by arg_Now; call right after polling.
+	void injectSynthetic(Clock::time_point arg_Now);
+
+	// Tags the frame about to be encoded with the pending input; false if there is none or
+	// too many tagged frames are still on the GPU.
+	bool beginFrame();
+	void markSubmitted(Clock::time_point arg_Time);
+	void markPresented(Clock::time_point arg_Time);
+	// Completes the tag through the queue's work-done callback; call after the submit.
+	void trackGpuDone(WGPUQueue arg_Queue);
+	bool hasInFlight() const { return inFlight > 0; }
+
+	const Histogram& getLatency(LatencyStage arg_Stage) const { return latency[static_cast<size_t>(arg_Stage)]; }
+	uint64_t getEventCount() const { return events; }
+	uint64_t getUntrackedFrames() const { return untracked; }
+
+	void logSummary() const;
+	void writeStats() const;
+
+	static const char* stageName(LatencyStage arg_Stage);
+
+private:
+	static const size_t STAGE_COUNT = static_cast<size_t>(LatencyStage::Count);
+	static const size_t MAX_IN_FLIGHT = 16;
+
+	struct FrameTag
+	{
+		InputLatencyTracker* tracker;
+		Clock::time_point eventTime;
+		bool inUse;
+	};
+
+	void record(LatencyStage arg_Stage, Clock::time_point arg_EventTime, Clock::time_point arg_Time);
+
+private:
+	Settings settings;
+	std::array<Histogram, STAGE_COUNT> latency;
+	std::array<FrameTag, MAX_IN_FLIGHT> tags{};
+	size_t nextTag = 0;
+	size_t inFlight = 0;
+	FrameTag* currentTag = nullptr;
+
+	bool hasPending = false;
+	Clock::time_point oldestPending;
+	uint64_t events = 0;
+	uint64_t untracked = 0;
+
+	Clock::duration injectInterval{};
+	Clock::time_point nextInjection;
+};
@@ -0,0 +1,98 @@
+#include "JobSystem.hxx"
+#include "AllocationTracker.hxx"
+#include "Config.hxx"
+#include "Profiler.hxx"
+
+#include <algorithm>
+
+JobSystem::Settings JobSystem::Settings::fromConfig()
+{
+	const long long hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	Settings settings{};
+	settings.workerCount = static_cast<uint32_t>(std::clamp(Config::getInt("APP_JOB_THREADS", hardwareThreads - 1), 0LL, 256LL));
+
+	return settings;
+}
+
+JobSystem::JobSystem(Settings arg_Settings)
+{
+	workers.reserve(arg_Settings.workerCount);
+	for (uint32_t i = 0; i < arg_Settings.workerCount; ++i) workers.emplace_back(&JobSystem::workerMain, this);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers) worker.join();
+}
+
+void JobSystem::run(Loop& arg_Loop)
+{
+	std::lock_guard<std::mutex> submitLock(submitMutex);
+
+	const size_t chunks = (arg_Loop.count + arg_Loop.grain - 1) / arg_Loop.grain;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		loop = &arg_Loop;
+		chunksDone = 0;
+		++generation;
+	}
+	wake.notify_all();
+
+	const size_t ran = work(arg_Loop);
+
+	// The loop lives on the caller's stack, so wait until no worker can still touch it.
+	std::unique_lock<std::mutex> lock(mutex);
+	chunksDone += ran;
+	done.wait(lock, [&]() { return chunksDone == chunks && activeWorkers == 0; });
+	loop = nullptr;
+}
+
+size_t JobSystem::work(Loop& arg_Loop)
+{
+	size_t ran = 0;
+	for (;;)
+	{
+		const size_t begin = arg_Loop.next.fetch_add(arg_Loop.grain, std::memory_order_relaxed);
+		if (begin >= arg_Loop.count) return ran;
+
+		arg_Loop.invoke(arg_Loop.context, begin, std::min(begin + arg_Loop.grain, arg_Loop.count));
+		++ran;
+	}
+}
+
+void JobSystem::workerMain()
+{
+	Profiler::instance().setThreadName("job");
+	AllocationTracker::setThreadName("job");
+
+	uint64_t seen = 0;
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		wake.wait(lock, [&]() { return stopping || (loop && generation != seen); });
+		if (stopping) return;
+
+		seen = generation;
+		Loop& current = *loop;
+		++activeWorkers;
+		lock.unlock();
+
+		size_t ran = 0;
+		{
+			PROFILE_ZONE("job");
+			ran = work(current);
+		}
+
+		lock.lock();
+		chunksDone += ran;
+		--activeWorkers;
+		if (activeWorkers == 0) done.notify_one();
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed pool of worker threads for data-parallel loops. parallelFor() splits [0, count) into
+// chunks of `grain` items, which the workers and the calling thread take in turn until none
+// are left, and returns once every chunk has run. One loop runs at a time; concurrent callers
+// queue up behind it. Submitting a loop does not allocate.
+//   APP_JOB_THREADS   worker threads besides the caller (default: hardware threads - 1)
+class JobSystem
+{
+public:
+	struct Settings
+	{
+		uint32_t workerCount;
+
+		static Settings fromConfig();
+	};
+
+	explicit JobSystem(Settings arg_Settings);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Threads that run a loop, including the caller.
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()) + 1; }
+
+	// arg_Body(begin, end) is called for disjoint ranges covering [0, arg_Count).
+	template <typename Body>
+	void parallelFor(size_t arg_Count, size_t arg_Grain, Body&& arg_Body)
+	{
+		if (arg_Count == 0) return;
+		if (workers.empty() || arg_Count <= arg_Grain)
+		{
+			arg_Body(size_t(0), arg_Count);
+			return;
+		}
+
+		using Callable = std::remove_reference_t<Body>;
+		Loop loop{};
+		loop.invoke = [](void* arg_Context, size_t arg_Begin, size_t arg_End) { (*static_cast<Callable*>(arg_Context))(arg_Begin, arg_End); };
+		loop.context = const_cast<void*>(static_cast<const void*>(&arg_Body));
+		loop.count = arg_Count;
+		loop.grain = arg_Grain == 0 ? 1 : arg_Grain;
+		run(loop);
+	}
+
+private:
+	struct Loop
+	{
+		void (*invoke)(void*, size_t, size_t);
+		void* context;
+		size_t count;
+		size_t grain;
+		std::atomic<size_t> next{ 0 };
+	};
+
+	void run(Loop& arg_Loop);
+	// Takes chunks until none are left; returns how many this thread ran.
+	static size_t work(Loop& arg_Loop);
+	void workerMain();
+
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex submitMutex;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	Loop* loop = nullptr;
+	uint64_t generation = 0;
+	size_t chunksDone = 0;
+	uint32_t activeWorkers = 0;
+	bool stopping = false;
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Logger.hxx"
+
+#ifdef DEBUG_MODE
+
+#define LOG_MSG_DBG(msg) LOG_MSG_AT(LogLevel::Debug, msg);
+#define LOG_MSG_SUC(msg) LOG_MSG_AT(LogLevel::Info, msg);
+#define LOG_MSG_ERR(msg) LOG_MSG_AT(LogLevel::Error, msg);
+
+#else
+
+#define LOG_MSG_DBG(msg)
+#define LOG_MSG_SUC(msg)
+#define LOG_MSG_ERR(msg)
+
+#endif
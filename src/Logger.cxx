@@ -0,0 +1,430 @@
+#include "Logger.hxx"
+#include "Config.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <webgpu/webgpu.h>
+#include <webgpu/wgpu.h>
+
+namespace
+{
+	const size_t RING_BYTES = 64 << 10;
+	const auto IDLE_WAIT = std::chrono::milliseconds(5);
+
+	// Records are 8-byte aligned in the ring. A header with size 0 marks the unused space at
+	// the end of the ring when the next record did not fit there and wrapped to the start.
+	struct RecordHeader
+	{
+		uint32_t size;
+		uint16_t payloadSize;
+		LogLevel level;
+		uint8_t reserved;
+		int64_t timestampNs;
+	};
+	static_assert(sizeof(RecordHeader) == 16);
+
+	size_t alignRecord(size_t arg_Size)
+	{
+		return (arg_Size + 7) & ~size_t(7);
+	}
+
+	int64_t nowNs()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	template<typename T>
+	T read(const uint8_t*& arg_Cursor)
+	{
+		T value;
+		std::memcpy(&value, arg_Cursor, sizeof(T));
+		arg_Cursor += sizeof(T);
+		return value;
+	}
+
+	const char* levelPrefix(LogLevel arg_Level)
+	{
+		switch (arg_Level)
+		{
+		case LogLevel::Trace: return "TRACE: ";
+		case LogLevel::Debug: return "DEBUG: ";
+		case LogLevel::Warn: return "WARNING: ";
+		case LogLevel::Error: return "ERROR: ";
+		default: return "";
+		}
+	}
+
+	LogLevel fromWgpuLevel(WGPULogLevel arg_Level)
+	{
+		switch (arg_Level)
+		{
+		case WGPULogLevel_Error: return LogLevel::Error;
+		case WGPULogLevel_Warn: return LogLevel::Warn;
+		case WGPULogLevel_Info: return LogLevel::Info;
+		case WGPULogLevel_Debug: return LogLevel::Debug;
+		default: return LogLevel::Trace;
+		}
+	}
+
+	WGPULogLevel toWgpuLevel(LogLevel arg_Level)
+	{
+		switch (arg_Level)
+		{
+		case LogLevel::Trace: return WGPULogLevel_Trace;
+		case LogLevel::Debug: return WGPULogLevel_Debug;
+		case LogLevel::Info: return WGPULogLevel_Info;
+		case LogLevel::Warn: return WGPULogLevel_Warn;
+		case LogLevel::Error: return WGPULogLevel_Error;
+		default: return WGPULogLevel_Off;
+		}
+	}
+}
+
+struct Logger::ThreadRing
+{
+	alignas(64) std::atomic<uint64_t> head{ 0 };
+	alignas(64) std::atomic<uint64_t> tail{ 0 };
+	std::atomic<uint64_t> dropped{ 0 };
+	uint32_t index = 0;
+	std::unique_ptr<uint8_t[]> data{ new uint8_t[RING_BYTES] };
+};
+
+struct Logger::Entry
+{
+	int64_t timestampNs;
+	uint32_t thread;
+	LogLevel level;
+	std::string text;
+};
+
+std::atomic<uint8_t> Logger::threshold{ static_cast<uint8_t>(LogLevel::Info) };
+
+LogRecord::~LogRecord()
+{
+	Logger::instance().write(level, payload, size);
+}
+
+LogRecord& LogRecord::operator<<(const char* arg_Text)
+{
+	if (!arg_Text) arg_Text = "(null)";
+	put(Tag::String, arg_Text, std::strlen(arg_Text));
+	return *this;
+}
+
+LogRecord& LogRecord::operator<<(const std::string& arg_Text)
+{
+	put(Tag::String, arg_Text.data(), arg_Text.size());
+	return *this;
+}
+
+LogRecord& LogRecord::operator<<(char arg_Char)
+{
+	put(Tag::Char, arg_Char);
+	return *this;
+}
+
+LogRecord& LogRecord::operator<<(bool arg_Value)
+{
+	put(Tag::Bool, static_cast<uint8_t>(arg_Value));
+	return *this;
+}
+
+LogRecord& LogRecord::operator<<(const void* arg_Pointer)
+{
+	put(Tag::Pointer, reinterpret_cast<uintptr_t>(arg_Pointer));
+	return *this;
+}
+
+LogRecord& LogRecord::operator<<(std::ios_base& (*arg_Manipulator)(std::ios_base&))
+{
+	// Only the integer base is carried over; other manipulators are ignored.
+	if (arg_Manipulator == static_cast<std::ios_base& (*)(std::ios_base&)>(std::hex)) put(Tag::Hex, nullptr, 0);
+	else if (arg_Manipulator == static_cast<std::ios_base& (*)(std::ios_base&)>(std::dec)) put(Tag::Dec, nullptr, 0);
+	return *this;
+}
+
+void LogRecord::put(Tag arg_Tag, const void* arg_Data, size_t arg_Size)
+{
+	const bool isString = arg_Tag == Tag::String;
+	const size_t overhead = 1 + (isString ? sizeof(uint16_t) : 0);
+	if (size + overhead > MAX_PAYLOAD) return;
+
+	// Strings are cut to whatever room is left; fixed-size values are all or nothing.
+	size_t dataSize = arg_Size;
+	if (size + overhead + dataSize > MAX_PAYLOAD)
+	{
+		if (!isString) return;
+		dataSize = MAX_PAYLOAD - size - overhead;
+	}
+
+	payload[size++] = static_cast<uint8_t>(arg_Tag);
+	if (isString)
+	{
+		uint16_t length = static_cast<uint16_t>(dataSize);
+		std::memcpy(payload + size, &length, sizeof(length));
+		size += sizeof(length);
+	}
+	if (dataSize > 0) std::memcpy(payload + size, arg_Data, dataSize);
+	size += dataSize;
+}
+
+Logger& Logger::instance()
+{
+	static Logger* logger = new Logger();
+	return *logger;
+}
+
+Logger::Logger()
+{
+#ifdef DEBUG_MODE
+	const LogLevel defaultLevel = LogLevel::Info;
+#else
+	const LogLevel defaultLevel = LogLevel::Warn;
+#endif
+	threshold.store(static_cast<uint8_t>(parseLevel(Config::getString("APP_LOG_LEVEL"), defaultLevel)));
+
+	running.store(true);
+	thread = std::thread(&Logger::run, this);
+	std::atexit([]() { Logger::instance().shutdown(); });
+}
+
+void Logger::setLevel(LogLevel arg_Level)
+{
+	threshold.store(static_cast<uint8_t>(arg_Level), std::memory_order_relaxed);
+	wgpuSetLogLevel(toWgpuLevel(arg_Level));
+}
+
+void Logger::captureWgpuLogs()
+{
+	auto onWgpuLog =
+		[](WGPULogLevel arg_Level, char const* arg_Message, void*)
+		{
+			LOG_MSG_AT(fromWgpuLevel(arg_Level), "[wgpu] " << arg_Message);
+		};
+
+	wgpuSetLogCallback(onWgpuLog, nullptr);
+	wgpuSetLogLevel(toWgpuLevel(static_cast<LogLevel>(threshold.load())));
+}
+
+Logger::ThreadRing& Logger::threadRing()
+{
+	thread_local ThreadRing* ring = nullptr;
+	if (!ring)
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		rings.push_back(std::make_unique<ThreadRing>());
+		ring = rings.back().get();
+		ring->index = static_cast<uint32_t>(rings.size() - 1);
+	}
+	return *ring;
+}
+
+void Logger::write(LogLevel arg_Level, const uint8_t* arg_Payload, size_t arg_Size)
+{
+	ThreadRing& ring = threadRing();
+
+	const uint64_t head = ring.head.load(std::memory_order_relaxed);
+	const uint64_t tail = ring.tail.load(std::memory_order_acquire);
+	const size_t recordSize = alignRecord(sizeof(RecordHeader) + arg_Size);
+	const size_t offset = head % RING_BYTES;
+	const size_t untilEnd = RING_BYTES - offset;
+	const size_t needed = recordSize > untilEnd ? untilEnd + recordSize : recordSize;
+
+	if (RING_BYTES - (head - tail) < needed)
+	{
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	uint64_t position = head;
+	if (recordSize > untilEnd)
+	{
+		RecordHeader padding{};
+		std::memcpy(ring.data.get() + offset, &padding, sizeof(padding));
+		position += untilEnd;
+	}
+
+	RecordHeader header{};
+	header.size = static_cast<uint32_t>(recordSize);
+	header.payloadSize = static_cast<uint16_t>(arg_Size);
+	header.level = arg_Level;
+	header.timestampNs = nowNs();
+
+	uint8_t* destination = ring.data.get() + position % RING_BYTES;
+	std::memcpy(destination, &header, sizeof(header));
+	std::memcpy(destination + sizeof(header), arg_Payload, arg_Size);
+
+	ring.head.store(position + recordSize, std::memory_order_release);
+}
+
+bool Logger::drain(std::vector<Entry>& arg_Entries)
+{
+	std::vector<ThreadRing*> snapshot;
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		for (const std::unique_ptr<ThreadRing>& ring : rings) snapshot.push_back(ring.get());
+	}
+
+	std::ostringstream text;
+	const size_t before = arg_Entries.size();
+
+	for (ThreadRing* ring : snapshot)
+	{
+		uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+		const uint64_t head = ring->head.load(std::memory_order_acquire);
+
+		while (tail < head)
+		{
+			const uint8_t* record = ring->data.get() + tail % RING_BYTES;
+			RecordHeader header;
+			std::memcpy(&header, record, sizeof(header));
+
+			if (header.size == 0)
+			{
+				tail += RING_BYTES - tail % RING_BYTES;
+				continue;
+			}
+
+			text.str({});
+			text.clear();
+			text << std::dec;
+
+			const uint8_t* cursor = record + sizeof(header);
+			const uint8_t* end = cursor + header.payloadSize;
+			while (cursor < end)
+			{
+				LogRecord::Tag tag = static_cast<LogRecord::Tag>(*cursor++);
+				switch (tag)
+				{
+				case LogRecord::Tag::Int: text << read<int64_t>(cursor); break;
+				case LogRecord::Tag::UInt: text << read<uint64_t>(cursor); break;
+				case LogRecord::Tag::Float: text << read<double>(cursor); break;
+				case LogRecord::Tag::Bool: text << (read<uint8_t>(cursor) != 0); break;
+				case LogRecord::Tag::Char: text << read<char>(cursor); break;
+				case LogRecord::Tag::Pointer: text << reinterpret_cast<const void*>(read<uintptr_t>(cursor)); break;
+				case LogRecord::Tag::Hex: text << std::hex; break;
+				case LogRecord::Tag::Dec: text << std::dec; break;
+				case LogRecord::Tag::String:
+				{
+					uint16_t length = read<uint16_t>(cursor);
+					text.write(reinterpret_cast<const char*>(cursor), length);
+					cursor += length;
+					break;
+				}
+				default: cursor = end; break;
+				}
+			}
+
+			arg_Entries.push_back({ header.timestampNs, ring->index, header.level, text.str() });
+			tail += header.size;
+		}
+
+		ring->tail.store(tail, std::memory_order_release);
+	}
+
+	return arg_Entries.size() > before;
+}
+
+void Logger::output(std::vector<Entry>& arg_Entries)
+{
+	uint64_t dropped = getDroppedCount();
+	if (dropped != droppedReported)
+	{
+		arg_Entries.push_back({ nowNs(), 0, LogLevel::Warn, std::to_string(dropped - droppedReported) + " log records dropped, ring full" });
+		droppedReported = dropped;
+	}
+
+	if (arg_Entries.empty()) return;
+
+	std::stable_sort(arg_Entries.begin(), arg_Entries.end(),
+		[](const Entry& arg_A, const Entry& arg_B) { return arg_A.timestampNs < arg_B.timestampNs; });
+
+	bool wroteOut = false;
+	bool wroteErr = false;
+	for (const Entry& entry : arg_Entries)
+	{
+		if (entry.level >= LogLevel::Warn)
+		{
+			std::cerr << levelPrefix(entry.level) << entry.text << '\n';
+			wroteErr = true;
+		}
+		else
+		{
+			std::cout << levelPrefix(entry.level) << entry.text << '\n';
+			wroteOut = true;
+		}
+	}
+
+	if (wroteOut) std::cout.flush();
+	if (wroteErr) std::cerr.flush();
+
+	arg_Entries.clear();
+}
+
+void Logger::run()
+{
+	std::vector<Entry> entries;
+
+	while (running.load())
+	{
+		uint64_t requested = flushRequests.load();
+
+		if (!drain(entries))
+		{
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.wait_for(lock, IDLE_WAIT, [this, requested]()
+				{ return !running.load() || flushRequests.load() != requested; });
+		}
+		output(entries);
+
+		flushesDone.store(requested);
+		wakeCondition.notify_all();
+	}
+
+	drain(entries);
+	output(entries);
+}
+
+void Logger::flush()
+{
+	if (!running.load()) return;
+
+	uint64_t request = flushRequests.fetch_add(1) + 1;
+	std::unique_lock<std::mutex> lock(wakeMutex);
+	wakeCondition.notify_all();
+	wakeCondition.wait(lock, [this, request]()
+		{ return !running.load() || flushesDone.load() >= request; });
+}
+
+void Logger::shutdown()
+{
+	if (!running.exchange(false)) return;
+
+	wakeCondition.notify_all();
+	if (thread.joinable()) thread.join();
+}
+
+uint64_t Logger::getDroppedCount() const
+{
+	uint64_t dropped = 0;
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	for (const std::unique_ptr<ThreadRing>& ring : rings) dropped += ring->dropped.load(std::memory_order_relaxed);
+	return dropped;
+}
+
+LogLevel Logger::parseLevel(const std::string& arg_Name, LogLevel arg_Default)
+{
+	if (arg_Name == "trace") return LogLevel::Trace;
+	if (arg_Name == "debug") return LogLevel::Debug;
+	if (arg_Name == "info") return LogLevel::Info;
+	if (arg_Name == "warn") return LogLevel::Warn;
+	if (arg_Name == "error") return LogLevel::Error;
+	if (arg_Name == "off") return LogLevel::Off;
+	return arg_Default;
+}
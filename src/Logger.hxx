@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel : uint8_t
+{
+	Trace,
+	Debug,
+	Info,
+	Warn,
+	Error,
+	Off
+};
+
+// One log statement. Arguments are appended as tagged binary values rather than formatted;
+// the record is copied into the calling thread's ring when it goes out of scope and turned
+// into text later on the logger thread.
+class LogRecord
+{
+public:
+	static const size_t MAX_PAYLOAD = 1024;
+
+	enum class Tag : uint8_t
+	{
+		Int,
+		UInt,
+		Float,
+		Bool,
+		Char,
+		String,
+		Pointer,
+		Hex,
+		Dec
+	};
+
+	explicit LogRecord(LogLevel arg_Level) : level(arg_Level) {}
+	~LogRecord();
+
+	LogRecord(const LogRecord&) = delete;
+	LogRecord& operator=(const LogRecord&) = delete;
+
+	LogRecord& operator<<(const char* arg_Text);
+	LogRecord& operator<<(const std::string& arg_Text);
+	LogRecord& operator<<(char arg_Char);
+	LogRecord& operator<<(bool arg_Value);
+	LogRecord& operator<<(const void* arg_Pointer);
+	LogRecord& operator<<(std::ios_base& (*arg_Manipulator)(std::ios_base&));
+
+	template<typename T>
+	std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>, LogRecord&> operator<<(T arg_Value)
+	{
+		if constexpr (std::is_enum_v<T>)
+			return *this << static_cast<std::underlying_type_t<T>>(arg_Value);
+		else if constexpr (std::is_signed_v<T>)
+			put(Tag::Int, static_cast<int64_t>(arg_Value));
+		else
+			put(Tag::UInt, static_cast<uint64_t>(arg_Value));
+		return *this;
+	}
+
+	template<typename T>
+	std::enable_if_t<std::is_floating_point_v<T>, LogRecord&> operator<<(T arg_Value)
+	{
+		put(Tag::Float, static_cast<double>(arg_Value));
+		return *this;
+	}
+
+private:
+	template<typename T>
+	void put(Tag arg_Tag, const T& arg_Value)
+	{
+		put(arg_Tag, &arg_Value, sizeof(T));
+	}
+
+	void put(Tag arg_Tag, const void* arg_Data, size_t arg_Size);
+
+private:
+	LogLevel level;
+	size_t size = 0;
+	uint8_t payload[MAX_PAYLOAD];
+};
+
+// Asynchronous logger. Each producing thread owns a single-producer/single-consumer byte ring,
+// so writing a record is a bounded copy plus two atomic operations and never waits on I/O or
+// on other threads. A background thread drains all rings, orders the records by time and
+// writes them out. A full ring drops records and counts them instead of blocking.
+// APP_LOG_LEVEL=trace|debug|info|warn|error|off sets the threshold, which also applies to
+// the wgpu-native messages routed here by captureWgpuLogs().
+class Logger
+{
+public:
+	// Intentionally never destroyed, so records written from static destructors or late
+	// wgpu callbacks are still safe. The logger thread is drained and joined at exit.
+	static Logger& instance();
+
+	static bool isEnabled(LogLevel arg_Level)
+	{
+		return static_cast<uint8_t>(arg_Level) >= threshold.load(std::memory_order_relaxed);
+	}
+
+	void setLevel(LogLevel arg_Level);
+	void captureWgpuLogs();
+
+	void write(LogLevel arg_Level, const uint8_t* arg_Payload, size_t arg_Size);
+
+	// Blocks until everything written so far has been output.
+	void flush();
+	void shutdown();
+
+	uint64_t getDroppedCount() const;
+
+	static LogLevel parseLevel(const std::string& arg_Name, LogLevel arg_Default);
+
+private:
+	struct ThreadRing;
+	struct Entry;
+
+	Logger();
+
+	ThreadRing& threadRing();
+	bool drain(std::vector<Entry>& arg_Entries);
+	void output(std::vector<Entry>& arg_Entries);
+	void run();
+
+private:
+	static std::atomic<uint8_t> threshold;
+
+	mutable std::mutex ringsMutex;
+	std::vector<std::unique_ptr<ThreadRing>> rings;
+
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+	std::atomic<bool> running{ false };
+	std::atomic<uint64_t> flushRequests{ 0 };
+	std::atomic<uint64_t> flushesDone{ 0 };
+	uint64_t droppedReported = 0;
+	std::thread thread;
+};
+
+#define LOG_MSG_AT(level, msg) \
+	do \
+	{ \
+		if (Logger::isEnabled(level)) \
+		{ \
+			LogRecord logRecord(level); \
+			logRecord << msg; \
+		} \
+	} while (0)
@@ -0,0 +1,124 @@
+#include "MappedFile.hxx"
+
+#include <stdexcept>
+
+namespace
+{
+	// The smallest page size in use; touching more often than the real page size is harmless.
+	const uint64_t FAULT_STRIDE = 4096;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#elif defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#endif
+
+MappedFile::MappedFile(const std::string& arg_Path)
+	: path(arg_Path)
+{
+#if defined(__unix__) || defined(__APPLE__)
+	const int descriptor = ::open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) throw std::runtime_error("Could not open " + path);
+
+	struct stat status{};
+	if (::fstat(descriptor, &status) != 0)
+	{
+		::close(descriptor);
+		throw std::runtime_error("Could not stat " + path);
+	}
+	length = static_cast<uint64_t>(status.st_size);
+
+	// The mapping keeps the file referenced, so the descriptor is not needed past this.
+	void* mapping = length > 0 ? ::mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0) : nullptr;
+	::close(descriptor);
+	if (mapping == MAP_FAILED) throw std::runtime_error("Could not map " + path);
+	base = static_cast<const uint8_t*>(mapping);
+#elif defined(_WIN32)
+	HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("Could not open " + path);
+
+	LARGE_INTEGER fileSize{};
+	if (!::GetFileSizeEx(file, &fileSize))
+	{
+		::CloseHandle(file);
+		throw std::runtime_error("Could not read the size of " + path);
+	}
+	length = static_cast<uint64_t>(fileSize.QuadPart);
+	fileHandle = file;
+	if (length == 0) return;
+
+	HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view)
+	{
+		if (mapping) ::CloseHandle(mapping);
+		::CloseHandle(file);
+		throw std::runtime_error("Could not map " + path);
+	}
+	mappingHandle = mapping;
+	base = static_cast<const uint8_t*>(view);
+#else
+	throw std::runtime_error("Memory mapped files are not available on this platform");
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	if (base) ::munmap(const_cast<uint8_t*>(base), length);
+#elif defined(_WIN32)
+	if (base) ::UnmapViewOfFile(base);
+	if (mappingHandle) ::CloseHandle(mappingHandle);
+	if (fileHandle) ::CloseHandle(fileHandle);
+#endif
+}
+
+void MappedFile::prefetch(uint64_t arg_Offset, uint64_t arg_Size) const
+{
+	if (!base || arg_Offset >= length) return;
+	if (arg_Size > length - arg_Offset) arg_Size = length - arg_Offset;
+
+#if defined(__unix__) || defined(__APPLE__)
+	// madvise() wants a page aligned start.
+	const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+	const uint64_t start = arg_Offset / page * page;
+	::madvise(const_cast<uint8_t*>(base) + start, arg_Size + (arg_Offset - start), MADV_WILLNEED);
+#elif defined(_WIN32) && _WIN32_WINNT >= 0x0602
+	WIN32_MEMORY_RANGE_ENTRY range{};
+	range.VirtualAddress = const_cast<uint8_t*>(base) + arg_Offset;
+	range.NumberOfBytes = static_cast<SIZE_T>(arg_Size);
+	::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+#endif
+}
+
+void MappedFile::release(uint64_t arg_Offset, uint64_t arg_Size) const
+{
+	if (!base || arg_Offset >= length) return;
+	if (arg_Size > length - arg_Offset) arg_Size = length - arg_Offset;
+
+#if defined(__unix__) || defined(__APPLE__)
+	// Only whole pages inside the range, so neighbouring data stays mapped in.
+	const uint64_t page = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+	const uint64_t start = (arg_Offset + page - 1) / page * page;
+	const uint64_t end = (arg_Offset + arg_Size) / page * page;
+	if (end > start) ::madvise(const_cast<uint8_t*>(base) + start, end - start, MADV_DONTNEED);
+#endif
+}
+
+void MappedFile::fault(uint64_t arg_Offset, uint64_t arg_Size) const
+{
+	if (!base || arg_Offset >= length) return;
+	if (arg_Size > length - arg_Offset) arg_Size = length - arg_Offset;
+
+	// Volatile, so the reads are not dropped for their unused results.
+	const volatile uint8_t* bytes = base;
+	for (uint64_t offset = arg_Offset; offset < arg_Offset + arg_Size; offset += FAULT_STRIDE) (void)bytes[offset];
+	(void)bytes[arg_Offset + arg_Size - 1];
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are read from disk on first touch, so
+// opening costs the same for a kilobyte and for gigabytes; prefetch() asks the OS to start
+// reading a range ahead of use and release() lets it drop a range that is no longer needed.
+class MappedFile
+{
+public:
+	// Throws std::runtime_error if the file cannot be opened or mapped.
+	explicit MappedFile(const std::string& arg_Path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return base; }
+	uint64_t size() const { return length; }
+	const std::string& getPath() const { return path; }
+
+	// Hints only; both may do nothing on platforms without an equivalent.
+	void prefetch(uint64_t arg_Offset, uint64_t arg_Size) const;
+	void release(uint64_t arg_Offset, uint64_t arg_Size) const;
+	// Reads a byte of every page in the range, so the caller takes the page faults instead of
+	// whoever reads it next. Blocks until the range is resident.
+	void fault(uint64_t arg_Offset, uint64_t arg_Size) const;
+
+private:
+	std::string path;
+	const uint8_t* base = nullptr;
+	uint64_t length = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
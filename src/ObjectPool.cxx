@@ -0,0 +1,139 @@
+#include "ObjectPool.hxx"
+
+#include <algorithm>
+#include <iterator>
+
+FixedBlockPool::FixedBlockPool(size_t arg_BlockSize, size_t arg_BlockAlignment, size_t arg_BlocksPerSlab)
+	: blockAlignment(std::max(arg_BlockAlignment, alignof(FreeBlock))),
+	blocksPerSlab(std::max<size_t>(1, arg_BlocksPerSlab))
+{
+	// Every block must hold the free list link and keep the next block aligned.
+	blockSize = std::max(arg_BlockSize, sizeof(FreeBlock));
+	blockSize = (blockSize + blockAlignment - 1) / blockAlignment * blockAlignment;
+}
+
+void* FixedBlockPool::allocate()
+{
+	if (!freeList) addSlab();
+
+	FreeBlock* block = freeList;
+	freeList = block->next;
+
+	++allocations;
+	if (++live > peakLive) peakLive = live;
+	return block;
+}
+
+void FixedBlockPool::deallocate(void* arg_Block)
+{
+	if (!arg_Block) return;
+
+	FreeBlock* block = static_cast<FreeBlock*>(arg_Block);
+	block->next = freeList;
+	freeList = block;
+	--live;
+}
+
+void FixedBlockPool::addSlab()
+{
+	// operator new[] of uint8_t only guarantees fundamental alignment, so pad for more.
+	slabs.emplace_back(new uint8_t[blockSize * blocksPerSlab + blockAlignment]);
+	const uintptr_t raw = reinterpret_cast<uintptr_t>(slabs.back().get());
+	const uintptr_t first = (raw + blockAlignment - 1) & ~(static_cast<uintptr_t>(blockAlignment) - 1);
+	slabStarts.push_back(first);
+
+	// Linked back to front so blocks are handed out in address order.
+	for (size_t i = blocksPerSlab; i-- > 0;)
+	{
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(first + i * blockSize);
+		block->next = freeList;
+		freeList = block;
+	}
+}
+
+FixedBlockPool::Stats FixedBlockPool::getStats() const
+{
+	Stats stats{};
+	stats.blockSize = blockSize;
+	stats.slabs = slabs.size();
+	stats.capacity = slabs.size() * blocksPerSlab;
+	stats.live = live;
+	stats.peakLive = peakLive;
+	stats.allocations = allocations;
+	return stats;
+}
+
+FixedBlockPool::FragmentationReport FixedBlockPool::getFragmentationReport() const
+{
+	FragmentationReport report{};
+	report.stats = getStats();
+	if (report.stats.capacity == 0) return report;
+
+	std::vector<std::pair<uintptr_t, size_t>> ranges;
+	ranges.reserve(slabStarts.size());
+	for (size_t i = 0; i < slabStarts.size(); ++i) ranges.emplace_back(slabStarts[i], i);
+	std::sort(ranges.begin(), ranges.end());
+
+	std::vector<size_t> freePerSlab(slabs.size(), 0);
+	for (const FreeBlock* block = freeList; block; block = block->next)
+	{
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block);
+		auto slab = std::upper_bound(ranges.begin(), ranges.end(), std::make_pair(address, SIZE_MAX));
+		++freePerSlab[std::prev(slab)->second];
+	}
+
+	for (size_t freeBlocks : freePerSlab)
+	{
+		const size_t used = blocksPerSlab - freeBlocks;
+		if (used == 0) ++report.emptySlabs;
+		else if (used * 4 <= blocksPerSlab) ++report.sparseSlabs;
+		if (freeBlocks == 0) ++report.fullSlabs;
+	}
+
+	report.freeRatio = 1.0 - static_cast<double>(report.stats.live) / static_cast<double>(report.stats.capacity);
+	return report;
+}
+
+BlockPoolSet::BlockPoolSet(size_t arg_BlocksPerSlab)
+{
+	for (size_t i = 0; i < CLASS_COUNT; ++i)
+	{
+		const size_t size = MIN_BLOCK << i;
+		pools[i] = std::make_unique<FixedBlockPool>(size, std::min<size_t>(size, alignof(std::max_align_t)), arg_BlocksPerSlab);
+	}
+}
+
+size_t BlockPoolSet::sizeClass(size_t arg_Bytes, size_t arg_Alignment)
+{
+	size_t index = 0;
+	size_t size = MIN_BLOCK;
+	while (size < arg_Bytes && index < CLASS_COUNT)
+	{
+		size <<= 1;
+		++index;
+	}
+
+	if (index < CLASS_COUNT && arg_Alignment > std::min<size_t>(size, alignof(std::max_align_t))) return CLASS_COUNT;
+	return index;
+}
+
+void* BlockPoolSet::allocate(size_t arg_Bytes, size_t arg_Alignment)
+{
+	const size_t index = sizeClass(arg_Bytes, arg_Alignment);
+	if (index < CLASS_COUNT) return pools[index]->allocate();
+
+	++heapFallbacks;
+	return ::operator new(arg_Bytes, std::align_val_t(arg_Alignment));
+}
+
+void BlockPoolSet::deallocate(void* arg_Block, size_t arg_Bytes, size_t arg_Alignment)
+{
+	const size_t index = sizeClass(arg_Bytes, arg_Alignment);
+	if (index < CLASS_COUNT)
+	{
+		pools[index]->deallocate(arg_Block);
+		return;
+	}
+
+	::operator delete(arg_Block, std::align_val_t(arg_Alignment));
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Fixed-size blocks carved from slabs of blocksPerSlab, handed out through an intrusive free
+// list. Allocation and release are a pointer swap; slabs are only added, never returned, so
+// after warmup a pool with a stable peak no longer touches the heap. Not thread safe.
+class FixedBlockPool
+{
+public:
+	struct Stats
+	{
+		size_t blockSize;
+		size_t slabs;
+		size_t capacity;
+		size_t live;
+		size_t peakLive;
+		uint64_t allocations;
+	};
+
+	// Where the free blocks sit. Memory held by a pool is fragmented when many slabs are
+	// mostly free but none is entirely free, since the pool cannot give any of it back.
+	struct FragmentationReport
+	{
+		Stats stats;
+		// Fraction of held blocks that are free, 0 when every block is in use.
+		double freeRatio;
+		size_t emptySlabs;
+		// Slabs with at most a quarter of their blocks in use.
+		size_t sparseSlabs;
+		size_t fullSlabs;
+	};
+
+	FixedBlockPool(size_t arg_BlockSize, size_t arg_BlockAlignment, size_t arg_BlocksPerSlab = 256);
+
+	FixedBlockPool(const FixedBlockPool&) = delete;
+	FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+	void* allocate();
+	void deallocate(void* arg_Block);
+
+	size_t getBlockSize() const { return blockSize; }
+	size_t getBlockAlignment() const { return blockAlignment; }
+	Stats getStats() const;
+
+	// Walks the free list, so it costs O(free blocks); meant for reports, not every frame.
+	FragmentationReport getFragmentationReport() const;
+
+private:
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	void addSlab();
+
+private:
+	size_t blockSize;
+	size_t blockAlignment;
+	size_t blocksPerSlab;
+	std::vector<std::unique_ptr<uint8_t[]>> slabs;
+	// First block of each slab, in the order slabs were added.
+	std::vector<uintptr_t> slabStarts;
+	FreeBlock* freeList = nullptr;
+	size_t live = 0;
+	size_t peakLive = 0;
+	uint64_t allocations = 0;
+};
+
+// Typed front end of a FixedBlockPool, e.g. for draw records that come and go every frame.
+template <typename T>
+class ObjectPool
+{
+public:
+	explicit ObjectPool(size_t arg_ObjectsPerSlab = 256)
+		: pool(sizeof(T), alignof(T), arg_ObjectsPerSlab)
+	{
+	}
+
+	template <typename... Args>
+	T* create(Args&&... arg_Args)
+	{
+		void* block = pool.allocate();
+		try
+		{
+			return new (block) T(std::forward<Args>(arg_Args)...);
+		}
+		catch (...)
+		{
+			pool.deallocate(block);
+			throw;
+		}
+	}
+
+	void destroy(T* arg_Object)
+	{
+		if (!arg_Object) return;
+
+		arg_Object->~T();
+		pool.deallocate(arg_Object);
+	}
+
+	FixedBlockPool::Stats getStats() const { return pool.getStats(); }
+	FixedBlockPool::FragmentationReport getFragmentationReport() const { return pool.getFragmentationReport(); }
+
+private:
+	FixedBlockPool pool;
+};
+
+// One FixedBlockPool per power-of-two size class from MIN_BLOCK to MAX_BLOCK bytes. Requests
+// above MAX_BLOCK, or aligned beyond their size class, go to the general heap.
+class BlockPoolSet
+{
+public:
+	static const size_t MIN_BLOCK = 16;
+	static const size_t MAX_BLOCK = 512;
+	static const size_t CLASS_COUNT = 6;
+
+	explicit BlockPoolSet(size_t arg_BlocksPerSlab = 256);
+
+	void* allocate(size_t arg_Bytes, size_t arg_Alignment);
+	void deallocate(void* arg_Block, size_t arg_Bytes, size_t arg_Alignment);
+
+	const FixedBlockPool& getPool(size_t arg_Class) const { return *pools[arg_Class]; }
+	uint64_t getHeapFallbacks() const { return heapFallbacks; }
+
+private:
+	// CLASS_COUNT when the request does not fit a pool.
+	static size_t sizeClass(size_t arg_Bytes, size_t arg_Alignment);
+
+private:
+	std::unique_ptr<FixedBlockPool> pools[CLASS_COUNT];
+	uint64_t heapFallbacks = 0;
+};
+
+// STL allocator over a BlockPoolSet, meant for node-based containers (std::map, std::list,
+// std::unordered_map nodes) whose elements are allocated one at a time. The set must outlive
+// every container using it.
+template <typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	explicit PoolAllocator(BlockPoolSet& arg_Pools) noexcept : pools(&arg_Pools) {}
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>& arg_Other) noexcept : pools(arg_Other.getPools()) {}
+
+	T* allocate(size_t arg_Count)
+	{
+		if (arg_Count > SIZE_MAX / sizeof(T)) throw std::bad_alloc();
+		return static_cast<T*>(pools->allocate(sizeof(T) * arg_Count, alignof(T)));
+	}
+
+	void deallocate(T* arg_Pointer, size_t arg_Count) noexcept
+	{
+		pools->deallocate(arg_Pointer, sizeof(T) * arg_Count, alignof(T));
+	}
+
+	BlockPoolSet* getPools() const noexcept { return pools; }
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>& arg_Other) const noexcept { return pools == arg_Other.getPools(); }
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>& arg_Other) const noexcept { return pools != arg_Other.getPools(); }
+
+private:
+	BlockPoolSet* pools;
+};
@@ -0,0 +1,173 @@
+#include "PresentModeSelector.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+
+namespace
+{
+	// Probe order for auto, lowest expected latency first.
+	const WGPUPresentMode AUTO_ORDER[] = {
+		WGPUPresentMode_Immediate,
+		WGPUPresentMode_Mailbox,
+		WGPUPresentMode_FifoRelaxed,
+		WGPUPresentMode_Fifo,
+	};
+
+	double toMs(uint64_t arg_Nanoseconds)
+	{
+		return static_cast<double>(arg_Nanoseconds) / 1e6;
+	}
+}
+
+PresentModeSelector::Settings PresentModeSelector::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.requested = Config::getString("APP_PRESENT_MODE", "fifo");
+	settings.frameLatency = static_cast<uint32_t>(std::clamp(Config::getInt("APP_FRAME_LATENCY", 0), 0LL, 16LL));
+	settings.probeFrames = static_cast<uint32_t>(std::clamp(Config::getInt("APP_PRESENT_PROBE_FRAMES", 120), 10LL, 10000LL));
+	settings.settleFrames = 15;
+	settings.tearFreeMarginMs = 0.25;
+
+	return settings;
+}
+
+PresentModeSelector::PresentModeSelector(Settings arg_Settings, std::vector<WGPUPresentMode> arg_Supported)
+	: settings(std::move(arg_Settings)),
+	supported(std::move(arg_Supported))
+{
+	std::string names;
+	for (WGPUPresentMode supportedMode : supported)
+		names += std::string(names.empty() ? "" : ", ") + modeName(supportedMode);
+	LOG_MSG_SUC("Supported present modes: " << names);
+
+	if (settings.requested == "auto")
+	{
+		for (WGPUPresentMode autoMode : AUTO_ORDER)
+			if (isSupported(autoMode)) candidates.push_back(autoMode);
+
+		probing = candidates.size() > 1;
+		if (!candidates.empty()) mode = candidates.front();
+		return;
+	}
+
+	WGPUPresentMode requested = WGPUPresentMode_Fifo;
+	if (!parseMode(settings.requested, requested))
+	{
+		LOG_MSG_ERR("Unknown present mode \"" << settings.requested << "\", using fifo");
+	}
+	else if (!isSupported(requested))
+	{
+		LOG_MSG_ERR("Present mode " << modeName(requested) << " is not supported by the surface, using fifo");
+	}
+	else
+	{
+		mode = requested;
+	}
+}
+
+bool PresentModeSelector::record(uint64_t arg_LatencyNs)
+{
+	// The first frames after a reconfigure include the swapchain rebuild and a refilling queue.
+	if (++framesInMode > settings.settleFrames)
+		latency[static_cast<size_t>(mode) % MODE_COUNT].record(arg_LatencyNs);
+
+	if (!probing || framesInMode < settings.settleFrames + settings.probeFrames) return false;
+
+	framesInMode = 0;
+	if (++candidate < candidates.size())
+	{
+		mode = candidates[candidate];
+		return true;
+	}
+
+	probing = false;
+	logSummary();
+
+	WGPUPresentMode chosen = pickLowestLatency();
+	LOG_MSG_SUC("Present mode " << modeName(chosen) << " has the lowest latency, keeping it");
+	if (chosen == mode) return false;
+
+	mode = chosen;
+	return true;
+}
+
+const Histogram& PresentModeSelector::getLatency(WGPUPresentMode arg_Mode) const
+{
+	return latency[static_cast<size_t>(arg_Mode) % MODE_COUNT];
+}
+
+void PresentModeSelector::logSummary() const
+{
+	for (WGPUPresentMode autoMode : AUTO_ORDER)
+	{
+		const Histogram& histogram = getLatency(autoMode);
+		if (histogram.getCount() == 0) continue;
+
+		LOG_MSG_SUC("Input to present, " << modeName(autoMode) << " ms: p50 " << toMs(histogram.percentile(50.0))
+			<< ", p99 " << toMs(histogram.percentile(99.0))
+			<< ", max " << toMs(histogram.getMax())
+			<< " (" << histogram.getCount() << " frames)");
+	}
+}
+
+WGPUPresentMode PresentModeSelector::pickLowestLatency() const
+{
+	WGPUPresentMode best = WGPUPresentMode_Fifo;
+	double bestMs = 0.0;
+	bool found = false;
+
+	for (WGPUPresentMode autoMode : candidates)
+	{
+		const Histogram& histogram = getLatency(autoMode);
+		if (histogram.getCount() == 0) continue;
+
+		const double medianMs = toMs(histogram.percentile(50.0));
+		double margin = 0.0;
+		if (isTearFree(autoMode) != isTearFree(best))
+			margin = isTearFree(autoMode) ? settings.tearFreeMarginMs : -settings.tearFreeMarginMs;
+
+		if (!found || medianMs < bestMs + margin)
+		{
+			best = autoMode;
+			bestMs = medianMs;
+			found = true;
+		}
+	}
+
+	return best;
+}
+
+bool PresentModeSelector::isSupported(WGPUPresentMode arg_Mode) const
+{
+	// Fifo is required of every surface, even if the capabilities list came back empty.
+	return arg_Mode == WGPUPresentMode_Fifo || std::find(supported.begin(), supported.end(), arg_Mode) != supported.end();
+}
+
+const char* PresentModeSelector::modeName(WGPUPresentMode arg_Mode)
+{
+	switch (arg_Mode)
+	{
+	case WGPUPresentMode_Fifo: return "fifo";
+	case WGPUPresentMode_FifoRelaxed: return "fifo-relaxed";
+	case WGPUPresentMode_Immediate: return "immediate";
+	case WGPUPresentMode_Mailbox: return "mailbox";
+	default: return "unknown";
+	}
+}
+
+bool PresentModeSelector::parseMode(const std::string& arg_Name, WGPUPresentMode& arg_Mode)
+{
+	if (arg_Name == "fifo") arg_Mode = WGPUPresentMode_Fifo;
+	else if (arg_Name == "fifo-relaxed") arg_Mode = WGPUPresentMode_FifoRelaxed;
+	else if (arg_Name == "immediate") arg_Mode = WGPUPresentMode_Immediate;
+	else if (arg_Name == "mailbox") arg_Mode = WGPUPresentMode_Mailbox;
+	else return false;
+
+	return true;
+}
+
+bool PresentModeSelector::isTearFree(WGPUPresentMode arg_Mode)
+{
+	return arg_Mode == WGPUPresentMode_Fifo || arg_Mode == WGPUPresentMode_Mailbox;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+#include "Histogram.hxx"
+
+// Chooses the surface present mode and keeps per-mode input-to-present latency, measured from
+// the end of the event poll whose input a frame renders to wgpuSurfacePresent returning. That
+// span includes any wait for a free surface texture, which is where queued FIFO frames show up.
+//   APP_PRESENT_MODE         fifo (default) | fifo-relaxed | mailbox | immediate | auto
+//   APP_FRAME_LATENCY        wgpu's desired maximum frame latency, 0 keeps wgpu's default
+//   APP_PRESENT_PROBE_FRAMES frames measured per mode in auto (default 120)
+// A requested mode the surface does not support falls back to fifo, which always is. In auto
+// every supported mode is run for settleFrames + probeFrames frames and the one with the
+// lowest median latency is kept; a tear-free mode wins a near tie (within tearFreeMarginMs).
+class PresentModeSelector
+{
+public:
+	struct Settings
+	{
+		std::string requested;
+		uint32_t frameLatency;
+		uint32_t probeFrames;
+		uint32_t settleFrames;
+		double tearFreeMarginMs;
+
+		static Settings fromConfig();
+	};
+
+	PresentModeSelector(Settings arg_Settings, std::vector<WGPUPresentMode> arg_Supported);
+
+	// Feeds one frame's latency for the current mode; returns true if the mode changed.
+	bool record(uint64_t arg_LatencyNs);
+
+	WGPUPresentMode getMode() const { return mode; }
+	bool isProbing() const { return probing; }
+	uint32_t getFrameLatency() const { return settings.frameLatency; }
+	const Histogram& getLatency(WGPUPresentMode arg_Mode) const;
+
+	void logSummary() const;
+
+	static const char* modeName(WGPUPresentMode arg_Mode);
+	static bool parseMode(const std::string& arg_Name, WGPUPresentMode& arg_Mode);
+	static bool isTearFree(WGPUPresentMode arg_Mode);
+
+private:
+	static const size_t MODE_COUNT = 4;
+
+	bool isSupported(WGPUPresentMode arg_Mode) const;
+	WGPUPresentMode pickLowestLatency() const;
+
+private:
+	Settings settings;
+	std::vector<WGPUPresentMode> supported;
+	std::vector<WGPUPresentMode> candidates;
+	Histogram latency[MODE_COUNT];
+
+	WGPUPresentMode mode = WGPUPresentMode_Fifo;
+	bool probing = false;
+	size_t candidate = 0;
+	uint32_t framesInMode = 0;
+};
@@ -0,0 +1,173 @@
+#include "Profiler.hxx"
+#include "AllocationTracker.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+	void writeJsonString(std::ostream& arg_Out, const char* arg_Text)
+	{
+		arg_Out << '"';
+		for (const char* c = arg_Text; *c; ++c)
+		{
+			if (*c == '"' || *c == '\\') arg_Out << '\\';
+			arg_Out << *c;
+		}
+		arg_Out << '"';
+	}
+}
+
+struct Profiler::ThreadBuffer
+{
+	// Allocated by the owning thread on its first zone.
+	std::unique_ptr<Zone[]> zones;
+	std::atomic<uint64_t> count{ 0 };
+	// Set while the owning thread is inside record(); stop() waits for it to clear.
+	std::atomic<bool> writing{ false };
+	uint32_t threadId = 0;
+	std::string name;
+};
+
+std::atomic<bool> Profiler::active{ false };
+
+Profiler& Profiler::instance()
+{
+	static Profiler* profiler = new Profiler();
+	return *profiler;
+}
+
+Profiler::Profiler()
+	: path(Config::getString("APP_PROFILE")),
+	frameLimit(static_cast<uint64_t>(std::max(0LL, Config::getInt("APP_PROFILE_FRAMES", 0))))
+{
+	active.store(!path.empty());
+}
+
+uint64_t Profiler::now()
+{
+	static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+	// Never 0, which ProfileZone uses for "not recording".
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - epoch).count()) + 1;
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer()
+{
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (!buffer)
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		buffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = buffers.back().get();
+		buffer->threadId = static_cast<uint32_t>(buffers.size());
+	}
+	return *buffer;
+}
+
+void Profiler::record(const char* arg_Name, uint64_t arg_BeginNs, uint64_t arg_EndNs)
+{
+	ThreadBuffer& buffer = threadBuffer();
+
+	// Announced before active is checked again, and stop() clears active before it checks
+	// writing (both sequentially consistent), so either this sees the capture stopped or
+	// stop() waits for this write.
+	buffer.writing.store(true);
+	if (active.load())
+	{
+		if (!buffer.zones)
+		{
+			ALLOC_SCOPE_EXEMPT("profilerRing");
+			buffer.zones.reset(new Zone[ZONES_PER_THREAD]);
+		}
+
+		const uint64_t index = buffer.count.load(std::memory_order_relaxed);
+		buffer.zones[index % ZONES_PER_THREAD] = { arg_Name, arg_BeginNs, arg_EndNs };
+		buffer.count.store(index + 1, std::memory_order_release);
+	}
+	buffer.writing.store(false, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* arg_Name)
+{
+	ThreadBuffer& buffer = threadBuffer();
+	std::lock_guard<std::mutex> lock(buffersMutex);
+	buffer.name = arg_Name;
+}
+
+void Profiler::endFrame()
+{
+	if (!isActive()) return;
+
+	++frames;
+	if (frameLimit > 0 && frames >= frameLimit) stop();
+}
+
+void Profiler::stop()
+{
+	if (!active.exchange(false)) return;
+
+	ALLOC_SCOPE_EXEMPT("profilerWrite");
+
+	{
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+		{
+			while (buffer->writing.load(std::memory_order_acquire)) std::this_thread::yield();
+		}
+	}
+
+	if (writeChromeTrace(path))
+	{
+		LOG_MSG_SUC("Wrote CPU trace of " << frames << " frames to " << path);
+	}
+	else
+	{
+		LOG_MSG_ERR("Could not write CPU trace to " << path);
+	}
+}
+
+bool Profiler::writeChromeTrace(const std::string& arg_Path)
+{
+	std::ofstream out(arg_Path, std::ios::trunc);
+	if (!out) return false;
+
+	std::lock_guard<std::mutex> lock(buffersMutex);
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+
+	for (const std::unique_ptr<ThreadBuffer>& buffer : buffers)
+	{
+		if (!buffer->name.empty())
+		{
+			out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->threadId << ",\"args\":{\"name\":";
+			writeJsonString(out, buffer->name.c_str());
+			out << "}}";
+			first = false;
+		}
+
+		const uint64_t count = buffer->count.load(std::memory_order_acquire);
+		const uint64_t begin = count > ZONES_PER_THREAD ? count - ZONES_PER_THREAD : 0;
+
+		for (uint64_t i = begin; i < count; ++i)
+		{
+			const Zone& zone = buffer->zones[i % ZONES_PER_THREAD];
+			out << (first ? "" : ",\n") << "{\"ph\":\"X\",\"cat\":\"cpu\",\"name\":";
+			writeJsonString(out, zone.name);
+			out << ",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << static_cast<double>(zone.beginNs) / 1000.0
+				<< ",\"dur\":" << static_cast<double>(zone.endNs - zone.beginNs) / 1000.0 << '}';
+			first = false;
+		}
+	}
+
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+#include "GpuDebug.hxx"
+
+// PROFILE_ZONES=0 compiles every marker away; otherwise a marker costs one relaxed load while
+// no capture is running.
+#ifndef PROFILE_ZONES
+	#define PROFILE_ZONES 1
+#endif
+
+// CPU zone profiler writing Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//   APP_PROFILE=<path>          capture from startup and write the trace to <path>
+//   APP_PROFILE_FRAMES=<n>      stop and write after n frames instead of at shutdown
+// Every thread appends finished zones to its own ring, which only that thread writes, so
+// recording takes no locks. When a ring wraps, the oldest zones are overwritten. Rings are
+// allocated on a thread's first zone, so threads of a run without a capture cost nothing.
+class Profiler
+{
+public:
+	struct Zone
+	{
+		const char* name;
+		uint64_t beginNs;
+		uint64_t endNs;
+	};
+
+	static const size_t ZONES_PER_THREAD = 1 << 16;
+
+	// Never destroyed, like Logger, so zones closing during static destruction are safe.
+	static Profiler& instance();
+
+	static bool isActive() { return active.load(std::memory_order_relaxed); }
+	static uint64_t now();
+
+	void record(const char* arg_Name, uint64_t arg_BeginNs, uint64_t arg_EndNs);
+	void setThreadName(const char* arg_Name);
+
+	// Counts a frame towards APP_PROFILE_FRAMES.
+	void endFrame();
+
+	// Stops capturing and writes the trace if one was being captured, once every thread has
+	// left record().
+	void stop();
+
+private:
+	struct ThreadBuffer;
+
+	Profiler();
+	ThreadBuffer& threadBuffer();
+	// Only after stop() has waited out the writers, as it reads every thread's ring.
+	bool writeChromeTrace(const std::string& arg_Path);
+
+private:
+	static std::atomic<bool> active;
+
+	std::string path;
+	uint64_t frameLimit = 0;
+	uint64_t frames = 0;
+
+	std::mutex buffersMutex;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+#if PROFILE_ZONES
+
+// Times the enclosing scope. The name must be a string literal (see PROFILE_ZONE), so only
+// the pointer is stored.
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* arg_Name)
+		: name(arg_Name), beginNs(Profiler::isActive() ? Profiler::now() : 0)
+	{
+	}
+
+	~ProfileZone()
+	{
+		if (beginNs != 0 && Profiler::isActive()) Profiler::instance().record(name, beginNs, Profiler::now());
+	}
+
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* name;
+	uint64_t beginNs;
+};
+
+// A CPU zone that also opens a debug group of the same name on the encoder, so GPU captures
+// (RenderDoc, Xcode, PIX) show the same structure as the CPU trace. Debug groups are only
+// emitted when GPU labels are kept, i.e. with GPU_VALIDATION.
+template<typename Encoder>
+class GpuProfileZone
+{
+public:
+	GpuProfileZone(Encoder arg_Encoder, const char* arg_Name)
+		: zone(arg_Name), encoder(arg_Encoder)
+	{
+#if GPU_VALIDATION
+		pushDebugGroup(encoder, arg_Name);
+#endif
+	}
+
+	~GpuProfileZone()
+	{
+#if GPU_VALIDATION
+		popDebugGroup(encoder);
+#endif
+	}
+
+	GpuProfileZone(const GpuProfileZone&) = delete;
+	GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+private:
+	static void pushDebugGroup(WGPURenderPassEncoder arg_Encoder, const char* arg_Name) { wgpuRenderPassEncoderPushDebugGroup(arg_Encoder, arg_Name); }
+	static void pushDebugGroup(WGPUCommandEncoder arg_Encoder, const char* arg_Name) { wgpuCommandEncoderPushDebugGroup(arg_Encoder, arg_Name); }
+	static void popDebugGroup(WGPURenderPassEncoder arg_Encoder) { wgpuRenderPassEncoderPopDebugGroup(arg_Encoder); }
+	static void popDebugGroup(WGPUCommandEncoder arg_Encoder) { wgpuCommandEncoderPopDebugGroup(arg_Encoder); }
+
+private:
+	ProfileZone zone;
+	[[maybe_unused]] Encoder encoder;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)("" name)
+#define PROFILE_GPU_ZONE(encoder, name) GpuProfileZone<decltype(encoder)> PROFILE_CONCAT(profileZone, __LINE__)(encoder, "" name)
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_GPU_ZONE(encoder, name)
+
+#endif
@@ -0,0 +1,353 @@
+#include "RectListReader.hxx"
+#include "MappedFile.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+	// Longest CSV row considered; anything longer is not a rect row.
+	const size_t MAX_ROW = 256;
+	// Longest JSON number, which is far more digits than a float holds.
+	const size_t MAX_NUMBER = 64;
+
+	size_t lineAt(const char* arg_Begin, const char* arg_Position)
+	{
+		size_t line = 1;
+		for (const char* c = arg_Begin; c < arg_Position; ++c) line += *c == '\n';
+		return line;
+	}
+
+	uint32_t paletteColor(const std::vector<uint32_t>& arg_Palette, unsigned long arg_Index, const std::string& arg_Location)
+	{
+		if (arg_Index >= arg_Palette.size())
+			throw std::runtime_error(arg_Location + ": palette index " + std::to_string(arg_Index) + " out of range");
+		return arg_Palette[arg_Index];
+	}
+
+	void assignLayers(std::vector<RectInstance>& arg_Rects)
+	{
+		for (size_t i = 0; i < arg_Rects.size(); ++i) arg_Rects[i].layer = static_cast<float>(i) / static_cast<float>(arg_Rects.size());
+	}
+
+	// Just enough JSON for rect lists, read straight from the source text.
+	class JsonRectParser
+	{
+	public:
+		JsonRectParser(const char* arg_Text, size_t arg_Size, const std::string& arg_Name)
+			: begin(arg_Text), position(arg_Text), end(arg_Text + arg_Size), name(arg_Name)
+		{
+		}
+
+		RectListReader::Result parse()
+		{
+			RectListReader::Result result;
+
+			skipSpace();
+			if (peek() == '[')
+			{
+				parseRects(result);
+			}
+			else
+			{
+				expect('{');
+				while (!consume('}'))
+				{
+					const std::string key = parseString();
+					expect(':');
+					if (key == "rects") parseRects(result);
+					else if (key == "palette") parsePalette(result);
+					else skipValue();
+					consume(',');
+				}
+			}
+			skipSpace();
+			if (position != end) fail("trailing data");
+
+			// The palette may follow the rects.
+			for (const auto& [rect, index] : indexed)
+				result.rects[rect].color = paletteColor(result.palette, index, name);
+			assignLayers(result.rects);
+			return result;
+		}
+
+	private:
+		[[noreturn]] void fail(const std::string& arg_Message) const
+		{
+			throw std::runtime_error(name + ":" + std::to_string(lineAt(begin, position)) + ": " + arg_Message);
+		}
+
+		char peek()
+		{
+			skipSpace();
+			return position < end ? *position : '\0';
+		}
+
+		void skipSpace()
+		{
+			while (position < end && (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n')) ++position;
+		}
+
+		bool consume(char arg_Char)
+		{
+			if (peek() != arg_Char) return false;
+			++position;
+			return true;
+		}
+
+		void expect(char arg_Char)
+		{
+			if (!consume(arg_Char)) fail(std::string("expected '") + arg_Char + "'");
+		}
+
+		std::string parseString()
+		{
+			expect('"');
+			std::string value;
+			while (position < end && *position != '"')
+			{
+				// Escapes are kept verbatim; keys and colors never need them.
+				if (*position == '\\' && position + 1 < end) value += *position++;
+				value += *position++;
+			}
+			if (position == end) fail("unterminated string");
+			++position;
+			return value;
+		}
+
+		double parseNumber()
+		{
+			skipSpace();
+			char digits[MAX_NUMBER + 1];
+			size_t length = 0;
+			while (position < end && length < MAX_NUMBER && std::strchr("+-0123456789.eE", *position)) digits[length++] = *position++;
+			digits[length] = '\0';
+
+			char* parsed = nullptr;
+			const double value = std::strtod(digits, &parsed);
+			if (length == 0 || *parsed != '\0') fail("expected a number");
+			return value;
+		}
+
+		void skipValue()
+		{
+			const char next = peek();
+			if (next == '{' || next == '[')
+			{
+				const char close = next == '{' ? '}' : ']';
+				++position;
+				while (!consume(close))
+				{
+					if (next == '{')
+					{
+						parseString();
+						expect(':');
+					}
+					skipValue();
+					consume(',');
+				}
+			}
+			else if (next == '"')
+			{
+				parseString();
+			}
+			else if (next == 't' || next == 'f' || next == 'n')
+			{
+				while (position < end && std::isalpha(static_cast<unsigned char>(*position))) ++position;
+			}
+			else
+			{
+				parseNumber();
+			}
+		}
+
+		void parsePalette(RectListReader::Result& arg_Result)
+		{
+			expect('[');
+			while (!consume(']'))
+			{
+				arg_Result.palette.push_back(parseColorAt(parseString()));
+				consume(',');
+			}
+		}
+
+		void parseRects(RectListReader::Result& arg_Result)
+		{
+			expect('[');
+			while (!consume(']'))
+			{
+				RectInstance rect{};
+				rect.color = 0xffffffff;
+				uint32_t fields = 0;
+
+				expect('{');
+				while (!consume('}'))
+				{
+					const std::string key = parseString();
+					expect(':');
+					if (key == "x") { rect.center[0] = static_cast<float>(parseNumber()); fields |= 1; }
+					else if (key == "y") { rect.center[1] = static_cast<float>(parseNumber()); fields |= 2; }
+					else if (key == "width") { rect.size[0] = static_cast<float>(parseNumber()); fields |= 4; }
+					else if (key == "height") { rect.size[1] = static_cast<float>(parseNumber()); fields |= 8; }
+					else if (key == "rotation") rect.rotation = static_cast<float>(parseNumber());
+					else if (key == "color" && peek() == '"') rect.color = parseColorAt(parseString());
+					else if (key == "color") indexed.emplace_back(arg_Result.rects.size(), static_cast<unsigned long>(parseNumber()));
+					else skipValue();
+					consume(',');
+				}
+				if (fields != 15) fail("rect without x, y, width and height");
+
+				arg_Result.rects.push_back(rect);
+				consume(',');
+			}
+		}
+
+		uint32_t parseColorAt(const std::string& arg_Text)
+		{
+			try
+			{
+				return RectListReader::parseColor(arg_Text);
+			}
+			catch (const std::runtime_error& err)
+			{
+				fail(err.what());
+			}
+		}
+
+	private:
+		const char* begin;
+		const char* position;
+		const char* end;
+		std::string name;
+		// Rects colored by palette index, resolved once the palette is known.
+		std::vector<std::pair<size_t, unsigned long>> indexed;
+	};
+}
+
+uint32_t RectListReader::parseColor(const std::string& arg_Text)
+{
+	const size_t digits = arg_Text.empty() ? 0 : arg_Text.size() - 1;
+	if (arg_Text.empty() || arg_Text[0] != '#' || (digits != 6 && digits != 8))
+		throw std::runtime_error("Bad color '" + arg_Text + "', expected #RRGGBB or #RRGGBBAA");
+
+	char* end = nullptr;
+	const unsigned long value = std::strtoul(arg_Text.c_str() + 1, &end, 16);
+	if (*end != '\0') throw std::runtime_error("Bad color '" + arg_Text + "'");
+
+	// Text runs red to alpha, the packed color alpha to red.
+	const uint32_t rgba = digits == 6 ? static_cast<uint32_t>(value) << 8 | 0xff : static_cast<uint32_t>(value);
+	return (rgba >> 24 & 0xff) | (rgba >> 16 & 0xff) << 8 | (rgba >> 8 & 0xff) << 16 | (rgba & 0xff) << 24;
+}
+
+std::vector<uint32_t> RectListReader::parsePalette(const std::string& arg_Text)
+{
+	std::vector<uint32_t> palette;
+	size_t start = 0;
+	while (start < arg_Text.size())
+	{
+		size_t comma = arg_Text.find(',', start);
+		if (comma == std::string::npos) comma = arg_Text.size();
+		palette.push_back(parseColor(arg_Text.substr(start, comma - start)));
+		start = comma + 1;
+	}
+	return palette;
+}
+
+RectListReader::Result RectListReader::readCsv(const char* arg_Text, size_t arg_Size, const std::vector<uint32_t>& arg_Palette, const std::string& arg_Name)
+{
+	Result result;
+	result.palette = arg_Palette;
+
+	const char* end = arg_Text + arg_Size;
+	size_t lineNumber = 0;
+	for (const char* line = arg_Text; line < end;)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+		if (!lineEnd) lineEnd = end;
+		const char* next = lineEnd < end ? lineEnd + 1 : end;
+		++lineNumber;
+		if (lineEnd > line && lineEnd[-1] == '\r') --lineEnd;
+
+		const size_t length = static_cast<size_t>(lineEnd - line);
+		if (length == 0 || line[0] == '#' || length > MAX_ROW)
+		{
+			line = next;
+			continue;
+		}
+
+		// The mapping is not terminated, so fields are parsed from a copy of the row.
+		char row[MAX_ROW + 1];
+		std::memcpy(row, line, length);
+		row[length] = '\0';
+		line = next;
+
+		char* fields[6];
+		size_t fieldCount = 0;
+		fields[fieldCount++] = row;
+		for (char* c = row; *c && fieldCount <= 6; ++c)
+		{
+			if (*c != ',') continue;
+			*c = '\0';
+			if (fieldCount < 6) fields[fieldCount] = c + 1;
+			++fieldCount;
+		}
+		if (fieldCount < 4 || fieldCount > 6) continue;
+
+		float numbers[5] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+		bool valid = true;
+		for (size_t i = 0; i < std::min<size_t>(fieldCount, 5); ++i)
+		{
+			char* parsed = nullptr;
+			numbers[i] = std::strtof(fields[i], &parsed);
+			valid = valid && parsed != fields[i] && *parsed == '\0';
+		}
+		if (!valid) continue;
+
+		RectInstance rect{};
+		rect.center[0] = numbers[0];
+		rect.center[1] = numbers[1];
+		rect.size[0] = numbers[2];
+		rect.size[1] = numbers[3];
+		rect.rotation = numbers[4];
+		rect.color = 0xffffffff;
+		if (fieldCount == 6 && fields[5][0] == '#')
+		{
+			try
+			{
+				rect.color = parseColor(fields[5]);
+			}
+			catch (const std::runtime_error& err)
+			{
+				throw std::runtime_error(arg_Name + ":" + std::to_string(lineNumber) + ": " + err.what());
+			}
+		}
+		else if (fieldCount == 6)
+		{
+			const unsigned long index = std::strtoul(fields[5], nullptr, 10);
+			rect.color = index < arg_Palette.size() ? arg_Palette[index] : paletteColor(arg_Palette, index, arg_Name + ":" + std::to_string(lineNumber));
+		}
+		result.rects.push_back(rect);
+	}
+
+	assignLayers(result.rects);
+	return result;
+}
+
+RectListReader::Result RectListReader::readJson(const char* arg_Text, size_t arg_Size, const std::string& arg_Name)
+{
+	return JsonRectParser(arg_Text, arg_Size, arg_Name).parse();
+}
+
+RectListReader::Result RectListReader::readFile(const std::string& arg_Path, const std::vector<uint32_t>& arg_Palette)
+{
+	const MappedFile file(arg_Path);
+	const char* text = reinterpret_cast<const char*>(file.data());
+
+	if (std::filesystem::path(arg_Path).extension() == ".json") return readJson(text, static_cast<size_t>(file.size()), arg_Path);
+	return readCsv(text, static_cast<size_t>(file.size()), arg_Palette, arg_Path);
+}
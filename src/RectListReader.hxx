@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DrawParameters.hxx"
+
+// Rect lists as scene sources, parsed from text in memory (usually a MappedFile) into
+// RectInstances with resolved RGBA8 colors. Later rects get higher layers. Malformed input
+// throws std::runtime_error naming the source and line.
+//
+// CSV: rows of x,y,width,height[,rotation[,color]], rotation in radians. Empty lines, lines
+// starting with # and rows that do not parse, such as a header, are skipped.
+//
+// JSON: an array of rect objects, or an object with a "rects" array and an optional
+// "palette" array of color strings. Rect objects need x, y, width and height and may have
+// rotation and color; other keys are ignored.
+//
+// Colors are "#RRGGBB" or "#RRGGBBAA", or an index into the palette; rects without one are
+// white.
+namespace RectListReader
+{
+	struct Result
+	{
+		std::vector<RectInstance> rects;
+		std::vector<uint32_t> palette;
+	};
+
+	// Packed like RectInstance::color, red in the lowest byte.
+	uint32_t parseColor(const std::string& arg_Text);
+	// Comma-separated colors.
+	std::vector<uint32_t> parsePalette(const std::string& arg_Text);
+
+	// arg_Palette resolves color indices in the last column.
+	Result readCsv(const char* arg_Text, size_t arg_Size, const std::vector<uint32_t>& arg_Palette, const std::string& arg_Name);
+	Result readJson(const char* arg_Text, size_t arg_Size, const std::string& arg_Name);
+
+	// Maps the file and picks the parser by extension, .json or else CSV.
+	Result readFile(const std::string& arg_Path, const std::vector<uint32_t>& arg_Palette = {});
+}
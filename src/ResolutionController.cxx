@@ -0,0 +1,176 @@
+#include "ResolutionController.hxx"
+#include "Config.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+ResolutionController::Settings ResolutionController::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.budgetMs = Config::getDouble("APP_DYNRES_BUDGET_MS", 16.0);
+	settings.minScale = std::clamp(Config::getDouble("APP_DYNRES_MIN_SCALE", 0.5), 0.1, 1.0);
+	settings.maxScale = std::clamp(Config::getDouble("APP_DYNRES_MAX_SCALE", 1.0), settings.minScale, 1.0);
+	settings.step = 0.05;
+	settings.lowerRatio = 0.8;
+	settings.targetRatio = 0.9;
+	settings.smoothing = 0.2;
+	settings.downFrames = 3;
+	settings.upFrames = 60;
+	settings.cooldownFrames = 10;
+
+	return settings;
+}
+
+ResolutionController::ResolutionController(Settings arg_Settings)
+	: settings(arg_Settings),
+	scale(arg_Settings.maxScale)
+{
+}
+
+void ResolutionController::reset(double arg_Scale)
+{
+	scale = clampScale(arg_Scale);
+	smoothedMs = 0.0;
+	overBudgetFrames = 0;
+	underBudgetFrames = 0;
+	cooldown = 0;
+}
+
+bool ResolutionController::update(double arg_FrameMs)
+{
+	smoothedMs = smoothedMs == 0.0 ? arg_FrameMs : smoothedMs + settings.smoothing * (arg_FrameMs - smoothedMs);
+
+	if (cooldown > 0)
+	{
+		--cooldown;
+		return false;
+	}
+
+	if (smoothedMs > settings.budgetMs)
+	{
+		++overBudgetFrames;
+		underBudgetFrames = 0;
+	}
+	else if (smoothedMs < settings.budgetMs * settings.lowerRatio)
+	{
+		++underBudgetFrames;
+		overBudgetFrames = 0;
+	}
+	else
+	{
+		overBudgetFrames = 0;
+		underBudgetFrames = 0;
+	}
+
+	double next = scale;
+	if (overBudgetFrames >= settings.downFrames)
+	{
+		next = quantize(scale * std::sqrt(settings.budgetMs * settings.targetRatio / smoothedMs));
+		// Always make progress, even when the quantized prediction rounds back to the current scale.
+		if (next >= scale) next = scale - settings.step;
+	}
+	else if (underBudgetFrames >= settings.upFrames)
+	{
+		double candidate = quantize(scale + settings.step);
+		double ratio = candidate / scale;
+		if (smoothedMs * ratio * ratio < settings.budgetMs * settings.targetRatio) next = candidate;
+		underBudgetFrames = 0;
+	}
+
+	next = clampScale(next);
+	if (next == scale) return false;
+
+	// Carry the prediction into the smoothed value so the next decisions don't act on a
+	// frame time measured at the old scale.
+	double ratio = next / scale;
+	smoothedMs *= ratio * ratio;
+
+	scale = next;
+	overBudgetFrames = 0;
+	underBudgetFrames = 0;
+	cooldown = settings.cooldownFrames;
+	return true;
+}
+
+double ResolutionController::quantize(double arg_Scale) const
+{
+	// Rounds down; the epsilon keeps exact multiples from losing a step to rounding error.
+	return std::floor(arg_Scale / settings.step + 1e-6) * settings.step;
+}
+
+double ResolutionController::clampScale(double arg_Scale) const
+{
+	return std::clamp(arg_Scale, settings.minScale, settings.maxScale);
+}
+
+std::vector<ResolutionController::CurveResult> ResolutionController::simulateLoadCurves(const Settings& arg_Settings)
+{
+	struct Curve
+	{
+		const char* name;
+		// Full-resolution cost of the scalable part of the frame, in ms.
+		std::function<double(uint32_t)> load;
+	};
+
+	const double budget = arg_Settings.budgetMs;
+	const uint32_t frames = 1200;
+	const uint32_t settleWindow = 240;
+	const double fixedMs = budget * 0.1;
+
+	const std::vector<Curve> curves = {
+		{ "light", [=](uint32_t) { return budget * 0.5; } },
+		{ "heavy", [=](uint32_t) { return budget * 2.5; } },
+		{ "step up", [=](uint32_t arg_Frame) { return arg_Frame < 300 ? budget * 0.6 : budget * 2.0; } },
+		{ "step down", [=](uint32_t arg_Frame) { return arg_Frame < 300 ? budget * 3.0 : budget * 0.9; } },
+		{ "ramp", [=](uint32_t arg_Frame) { return budget * (0.5 + 2.0 * std::min(1.0, arg_Frame / 600.0)); } },
+		{ "sine", [=](uint32_t arg_Frame) { return budget * (1.5 + 0.3 * std::sin(arg_Frame / 200.0)); } },
+	};
+
+	std::vector<CurveResult> results;
+	for (const Curve& curve : curves)
+	{
+		ResolutionController controller(arg_Settings);
+		std::mt19937 rng(1234);
+		std::normal_distribution<double> noise(0.0, budget * 0.03);
+
+		CurveResult result{};
+		result.name = curve.name;
+
+		std::vector<double> frameMs(frames);
+		std::vector<bool> changed(frames);
+		for (uint32_t frame = 0; frame < frames; ++frame)
+		{
+			const double s = controller.getScale();
+			frameMs[frame] = std::max(0.1, fixedMs + curve.load(frame) * s * s + noise(rng));
+			changed[frame] = controller.update(frameMs[frame]);
+		}
+
+		// Settled: no changes in the last settleWindow frames except at most one, and the
+		// frame time there is within budget unless the scale is pinned at the minimum.
+		uint32_t lastChange = 0;
+		for (uint32_t frame = 0; frame < frames; ++frame)
+			if (changed[frame]) lastChange = frame;
+
+		double tailMs = 0.0;
+		for (uint32_t frame = frames - settleWindow; frame < frames; ++frame)
+		{
+			tailMs += frameMs[frame];
+			if (changed[frame]) ++result.changesAfterSettle;
+		}
+		tailMs /= settleWindow;
+
+		result.settleFrame = lastChange;
+		result.finalScale = controller.getScale();
+		result.finalMs = tailMs;
+
+		const bool pinned = result.finalScale <= arg_Settings.minScale + 1e-9;
+		const double fitsAtNextStep = fixedMs + curve.load(frames - 1) * std::pow(std::min(arg_Settings.maxScale, result.finalScale + arg_Settings.step), 2.0);
+		const bool tooLow = result.finalScale < arg_Settings.maxScale && fitsAtNextStep < budget * arg_Settings.lowerRatio * 0.9;
+		result.converged = result.changesAfterSettle <= 1 && (tailMs <= budget * 1.05 || pinned) && !tooLow;
+
+		results.push_back(result);
+	}
+
+	return results;
+}
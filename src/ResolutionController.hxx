@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Picks the render scale (fraction of the surface size per axis) from measured frame times.
+// Frame time is assumed to grow with the pixel count, i.e. with scale squared, which is what
+// makes both the step down and the step up predictive instead of trial and error.
+//  - Down: the smoothed frame time stays above the budget for downFrames frames; the scale
+//    drops straight to where the prediction lands at targetRatio of the budget.
+//  - Up: the smoothed frame time stays below lowerRatio of the budget for upFrames frames and
+//    the next step up is predicted to stay under the budget with margin.
+// Scales are quantized to `step`, and every change is followed by cooldownFrames frames
+// without further changes so the measurement can catch up. The asymmetric thresholds and
+// the predicted check on the way up are what keep it from oscillating.
+class ResolutionController
+{
+public:
+	struct Settings
+	{
+		double budgetMs;
+		double minScale;
+		double maxScale;
+		double step;
+		double lowerRatio;
+		double targetRatio;
+		double smoothing;
+		uint32_t downFrames;
+		uint32_t upFrames;
+		uint32_t cooldownFrames;
+
+		// APP_DYNRES_BUDGET_MS (default 16), APP_DYNRES_MIN_SCALE (0.5), APP_DYNRES_MAX_SCALE (1).
+		static Settings fromConfig();
+	};
+
+	explicit ResolutionController(Settings arg_Settings);
+
+	// Feeds one frame's time; returns true if the scale changed.
+	bool update(double arg_FrameMs);
+
+	double getScale() const { return scale; }
+	double getSmoothedMs() const { return smoothedMs; }
+	const Settings& getSettings() const { return settings; }
+
+	void reset(double arg_Scale);
+
+	// Headless check: runs the controller against synthetic load curves, where a frame costs
+	// fixed + load(frame) * scale^2 ms plus noise, and reports per curve whether it settled
+	// within the budget without oscillating or leaving easy headroom unused.
+	struct CurveResult
+	{
+		std::string name;
+		bool converged;
+		uint32_t settleFrame;
+		uint32_t changesAfterSettle;
+		double finalScale;
+		double finalMs;
+	};
+
+	static std::vector<CurveResult> simulateLoadCurves(const Settings& arg_Settings);
+
+private:
+	double quantize(double arg_Scale) const;
+	double clampScale(double arg_Scale) const;
+
+private:
+	Settings settings;
+	double scale;
+	double smoothedMs = 0.0;
+	uint32_t overBudgetFrames = 0;
+	uint32_t underBudgetFrames = 0;
+	uint32_t cooldown = 0;
+};
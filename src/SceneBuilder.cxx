@@ -0,0 +1,212 @@
+#include "SceneBuilder.hxx"
+#include "Config.hxx"
+#include "SceneFile.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace SceneFormat;
+
+namespace
+{
+	// Bits per axis of the Z-order curve; cells finer than 1/65536 of the scene are not told
+	// apart, which only affects the order within a chunk.
+	const uint32_t CURVE_BITS = 16;
+
+	uint32_t spreadBits(uint32_t arg_Value)
+	{
+		arg_Value &= 0x0000ffff;
+		arg_Value = (arg_Value | arg_Value << 8) & 0x00ff00ff;
+		arg_Value = (arg_Value | arg_Value << 4) & 0x0f0f0f0f;
+		arg_Value = (arg_Value | arg_Value << 2) & 0x33333333;
+		arg_Value = (arg_Value | arg_Value << 1) & 0x55555555;
+		return arg_Value;
+	}
+
+	uint32_t compactBits(uint32_t arg_Value)
+	{
+		arg_Value &= 0x55555555;
+		arg_Value = (arg_Value | arg_Value >> 1) & 0x33333333;
+		arg_Value = (arg_Value | arg_Value >> 2) & 0x0f0f0f0f;
+		arg_Value = (arg_Value | arg_Value >> 4) & 0x00ff00ff;
+		arg_Value = (arg_Value | arg_Value >> 8) & 0x0000ffff;
+		return arg_Value;
+	}
+
+	// Area-weighted color sums, in 8-bit units, of the rects in the tile at a curve position.
+	struct TileSum
+	{
+		uint32_t code;
+		float red;
+		float green;
+		float blue;
+		float area;
+	};
+
+	void addTo(std::vector<TileSum>& arg_Sums, uint32_t arg_Code, float arg_Red, float arg_Green, float arg_Blue, float arg_Area)
+	{
+		if (arg_Sums.empty() || arg_Sums.back().code != arg_Code) arg_Sums.push_back({ arg_Code, 0.0f, 0.0f, 0.0f, 0.0f });
+
+		TileSum& sum = arg_Sums.back();
+		sum.red += arg_Red;
+		sum.green += arg_Green;
+		sum.blue += arg_Blue;
+		sum.area += arg_Area;
+	}
+
+	SceneBounds boundsOf(const RectInstance* arg_Rects, size_t arg_Count)
+	{
+		SceneBounds bounds{ INFINITY, INFINITY, -INFINITY, -INFINITY };
+		for (size_t i = 0; i < arg_Count; ++i)
+		{
+			const RectInstance& rect = arg_Rects[i];
+			const float c = std::abs(std::cos(rect.rotation));
+			const float s = std::abs(std::sin(rect.rotation));
+			const float extentX = 0.5f * (c * rect.size[0] + s * rect.size[1]);
+			const float extentY = 0.5f * (s * rect.size[0] + c * rect.size[1]);
+			bounds.minX = std::min(bounds.minX, rect.center[0] - extentX);
+			bounds.minY = std::min(bounds.minY, rect.center[1] - extentY);
+			bounds.maxX = std::max(bounds.maxX, rect.center[0] + extentX);
+			bounds.maxY = std::max(bounds.maxY, rect.center[1] + extentY);
+		}
+		return bounds;
+	}
+}
+
+SceneBuilder::Settings SceneBuilder::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.chunkRects = static_cast<uint32_t>(std::clamp(Config::getInt("APP_SCENE_CHUNK_RECTS", 65536), 256LL, 1LL << 24));
+
+	return settings;
+}
+
+SceneBuilder::SceneBuilder(Settings arg_Settings)
+	: settings(arg_Settings)
+{
+}
+
+SceneBuilder::Stats SceneBuilder::write(std::vector<RectInstance>& arg_Rects, const std::string& arg_Path) const
+{
+	const size_t count = arg_Rects.size();
+
+	// The curve spans the square around all centers.
+	SceneBounds centers{ 0.0f, 0.0f, 0.0f, 0.0f };
+	if (count > 0) centers = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+	double meanSize = 0.0;
+	for (const RectInstance& rect : arg_Rects)
+	{
+		centers.minX = std::min(centers.minX, rect.center[0]);
+		centers.minY = std::min(centers.minY, rect.center[1]);
+		centers.maxX = std::max(centers.maxX, rect.center[0]);
+		centers.maxY = std::max(centers.maxY, rect.center[1]);
+		meanSize += std::max(rect.size[0], rect.size[1]);
+	}
+	meanSize = count > 0 ? meanSize / static_cast<double>(count) : 0.0;
+
+	const double side = std::max({ static_cast<double>(centers.maxX) - centers.minX, static_cast<double>(centers.maxY) - centers.minY, 1e-6 });
+	const double cellScale = static_cast<double>(1u << CURVE_BITS) / side;
+	const uint32_t lastCell = (1u << CURVE_BITS) - 1;
+
+	// Sort keys carry the curve position above the rect's index.
+	std::vector<uint64_t> keys(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint32_t cellX = static_cast<uint32_t>(std::min<double>(lastCell, (arg_Rects[i].center[0] - centers.minX) * cellScale));
+		const uint32_t cellY = static_cast<uint32_t>(std::min<double>(lastCell, (arg_Rects[i].center[1] - centers.minY) * cellScale));
+		keys[i] = static_cast<uint64_t>(spreadBits(cellX) | spreadBits(cellY) << 1) << 32 | i;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<uint32_t> codes(count);
+	{
+		std::vector<RectInstance> sorted(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			sorted[i] = arg_Rects[keys[i] & 0xffffffffu];
+			codes[i] = static_cast<uint32_t>(keys[i] >> 32);
+		}
+		arg_Rects.swap(sorted);
+	}
+	std::vector<uint64_t>().swap(keys);
+
+	// Coarser levels while the one below does not fit a single chunk. The finest tiles are
+	// about twice the mean rect, so each covers a few rects.
+	std::vector<std::vector<RectInstance>> levels;
+	std::vector<float> levelSizes{ static_cast<float>(meanSize) };
+	if (count > settings.chunkRects)
+	{
+		int depth = meanSize > 0.0 ? static_cast<int>(std::floor(std::log2(side / (2.0 * meanSize)))) : 0;
+		depth = std::clamp(depth, 0, static_cast<int>(CURVE_BITS));
+
+		std::vector<TileSum> sums;
+		const uint32_t shift = 2 * (CURVE_BITS - static_cast<uint32_t>(depth));
+		for (size_t i = 0; i < count; ++i)
+		{
+			const RectInstance& rect = arg_Rects[i];
+			const float area = rect.size[0] * rect.size[1];
+			addTo(sums, shift < 32 ? codes[i] >> shift : 0, area * static_cast<float>(rect.color & 0xff),
+				area * static_cast<float>(rect.color >> 8 & 0xff), area * static_cast<float>(rect.color >> 16 & 0xff), area);
+		}
+
+		size_t below = count;
+		while (below > settings.chunkRects && levels.size() + 1 < MAX_LEVELS)
+		{
+			const double tileSide = side / static_cast<double>(1u << depth);
+			const float tileArea = static_cast<float>(tileSide * tileSide);
+
+			std::vector<RectInstance> tiles(sums.size());
+			for (size_t i = 0; i < sums.size(); ++i)
+			{
+				const TileSum& sum = sums[i];
+				const float scale = sum.area > 0.0f ? 1.0f / (255.0f * sum.area) : 0.0f;
+				tiles[i].center[0] = static_cast<float>(centers.minX + (compactBits(sum.code) + 0.5) * tileSide);
+				tiles[i].center[1] = static_cast<float>(centers.minY + (compactBits(sum.code >> 1) + 0.5) * tileSide);
+				tiles[i].size[0] = static_cast<float>(tileSide);
+				tiles[i].size[1] = static_cast<float>(tileSide);
+				tiles[i].color = packColor(sum.red * scale, sum.green * scale, sum.blue * scale, 1.0f - std::exp(-sum.area / tileArea));
+			}
+			levels.push_back(std::move(tiles));
+			levelSizes.push_back(static_cast<float>(tileSide));
+			below = sums.size();
+			if (depth == 0) break;
+
+			// Four tiles make one of the next level, and they are adjacent on the curve.
+			std::vector<TileSum> merged;
+			merged.reserve(sums.size() / 4 + 1);
+			for (const TileSum& sum : sums) addTo(merged, sum.code >> 2, sum.red, sum.green, sum.blue, sum.area);
+			sums.swap(merged);
+			--depth;
+		}
+	}
+
+	SceneFileWriter writer(arg_Path);
+	writer.setBounds(centers);
+	for (uint32_t level = 0; level < levelSizes.size(); ++level) writer.setLevelSize(level, levelSizes[level]);
+
+	const SceneBounds quadBounds{ -0.5f, -0.5f, 0.5f, 0.5f };
+	writer.addChunk(ChunkType::Mesh, 0, UNIT_QUAD_VERTICES, 5 * sizeof(float), UNIT_QUAD_VERTEX_COUNT, quadBounds);
+	if (!palette.empty())
+		writer.addChunk(ChunkType::Palette, 0, palette.data(), sizeof(uint32_t), static_cast<uint32_t>(palette.size()), centers);
+
+	// Coarsest first, so a zoomed-out start reads from the front of the file.
+	Stats stats{};
+	auto writeLevel = [&](uint32_t arg_Level, const std::vector<RectInstance>& arg_Instances)
+	{
+		for (size_t first = 0; first < arg_Instances.size(); first += settings.chunkRects)
+		{
+			const size_t chunkCount = std::min<size_t>(settings.chunkRects, arg_Instances.size() - first);
+			writer.addChunk(ChunkType::Rects, arg_Level, arg_Instances.data() + first, sizeof(RectInstance),
+				static_cast<uint32_t>(chunkCount), boundsOf(arg_Instances.data() + first, chunkCount));
+			++stats.chunks;
+		}
+	};
+	for (size_t level = levels.size(); level > 0; --level) writeLevel(static_cast<uint32_t>(level), levels[level - 1]);
+	writeLevel(0, arg_Rects);
+	writer.finish();
+
+	stats.rects = count;
+	stats.levels = static_cast<uint32_t>(levelSizes.size());
+	stats.bytes = writer.getBytesWritten();
+	return stats;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "DrawParameters.hxx"
+
+// Turns a list of rects into a scene file (see SceneFile.hxx). Rects are sorted along a
+// Z-order curve over the square around their centers and cut into chunks of chunkRects.
+// While a level has more than chunkRects entries, a coarser level is added on top that sums
+// it into square tiles of twice the side, starting at about twice the mean rect size; tiles
+// carry the area-weighted mean color and their expected coverage as alpha, as SceneLod's do.
+// The file also gets a unit quad as the mesh drawn per rect.
+//   APP_SCENE_CHUNK_RECTS  rects per chunk (default 65536, 2 MiB)
+class SceneBuilder
+{
+public:
+	struct Settings
+	{
+		uint32_t chunkRects;
+
+		static Settings fromConfig();
+	};
+
+	struct Stats
+	{
+		uint64_t rects;
+		uint32_t levels;
+		uint32_t chunks;
+		uint64_t bytes;
+	};
+
+	explicit SceneBuilder(Settings arg_Settings);
+
+	// Colors the source indexed into, stored as a palette chunk.
+	void setPalette(std::vector<uint32_t> arg_Palette) { palette = std::move(arg_Palette); }
+
+	// Reorders arg_Rects along the curve while writing.
+	Stats write(std::vector<RectInstance>& arg_Rects, const std::string& arg_Path) const;
+
+private:
+	Settings settings;
+	std::vector<uint32_t> palette;
+};
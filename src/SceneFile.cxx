@@ -0,0 +1,118 @@
+#include "SceneFile.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace SceneFormat;
+
+SceneFile::SceneFile(const std::string& arg_Path)
+	: mapping(arg_Path)
+{
+	auto fail = [&](const char* arg_Reason) { throw std::runtime_error(arg_Path + " is not a valid scene file: " + arg_Reason); };
+
+	if (mapping.size() < sizeof(Header)) fail("too short");
+	header = reinterpret_cast<const Header*>(mapping.data());
+	if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) fail("bad magic");
+	if (header->version != VERSION) fail("unsupported version");
+	if (header->fileSize != mapping.size()) fail("truncated");
+	if (header->levelCount == 0 || header->levelCount > MAX_LEVELS) fail("bad level count");
+
+	const uint64_t indexSize = static_cast<uint64_t>(header->chunkCount) * sizeof(ChunkRecord);
+	if (header->indexOffset % alignof(ChunkRecord) != 0 || header->indexOffset > mapping.size()
+		|| indexSize > mapping.size() - header->indexOffset)
+		fail("index outside the file");
+	chunks = reinterpret_cast<const ChunkRecord*>(mapping.data() + header->indexOffset);
+
+	for (size_t i = 0; i < header->chunkCount; ++i)
+	{
+		const ChunkRecord& chunk = chunks[i];
+		if (chunk.offset % CHUNK_ALIGNMENT != 0) fail("misaligned chunk");
+		if (chunk.offset > mapping.size() || chunk.size > mapping.size() - chunk.offset) fail("chunk outside the file");
+		if (static_cast<uint64_t>(chunk.stride) * chunk.count > chunk.size) fail("chunk shorter than its elements");
+		if (chunk.level >= header->levelCount) fail("chunk on a missing level");
+		if (chunk.type == ChunkType::Rects && chunk.stride != sizeof(RectInstance)) fail("rect chunk with a foreign stride");
+	}
+}
+
+const ChunkRecord* SceneFile::findChunk(ChunkType arg_Type) const
+{
+	const ChunkRecord* end = chunks + header->chunkCount;
+	const ChunkRecord* found = std::find_if(chunks, end, [&](const ChunkRecord& arg_Chunk) { return arg_Chunk.type == arg_Type; });
+	return found != end ? found : nullptr;
+}
+
+SceneFileWriter::SceneFileWriter(const std::string& arg_Path)
+	: path(arg_Path),
+	stream(arg_Path, std::ios::binary | std::ios::trunc)
+{
+	if (!stream) throw std::runtime_error("Could not create " + path);
+
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.bounds = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	// The real header goes in last, once the index is known.
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	offset = sizeof(Header);
+}
+
+void SceneFileWriter::setLevelSize(uint32_t arg_Level, float arg_Size)
+{
+	if (arg_Level >= MAX_LEVELS) throw std::out_of_range("Scene files hold at most 16 levels");
+
+	header.levelSizes[arg_Level] = arg_Size;
+	header.levelCount = std::max(header.levelCount, arg_Level + 1);
+}
+
+void SceneFileWriter::addChunk(ChunkType arg_Type, uint32_t arg_Level, const void* arg_Data, uint32_t arg_Stride,
+	uint32_t arg_Count, const SceneBounds& arg_Bounds)
+{
+	if (arg_Level >= MAX_LEVELS) throw std::out_of_range("Scene files hold at most 16 levels");
+
+	pad();
+
+	ChunkRecord record{};
+	record.type = arg_Type;
+	record.level = arg_Level;
+	record.offset = offset;
+	record.size = static_cast<uint64_t>(arg_Stride) * arg_Count;
+	record.count = arg_Count;
+	record.stride = arg_Stride;
+	record.bounds = arg_Bounds;
+	records.push_back(record);
+
+	stream.write(static_cast<const char*>(arg_Data), static_cast<std::streamsize>(record.size));
+	offset += record.size;
+	header.levelCount = std::max(header.levelCount, arg_Level + 1);
+	if (arg_Type == ChunkType::Rects && arg_Level == 0) header.rectCount += arg_Count;
+
+	if (!stream) throw std::runtime_error("Could not write " + path);
+}
+
+void SceneFileWriter::finish()
+{
+	pad();
+
+	header.chunkCount = static_cast<uint32_t>(records.size());
+	header.indexOffset = offset;
+	stream.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(ChunkRecord)));
+	offset += records.size() * sizeof(ChunkRecord);
+	header.fileSize = offset;
+	header.levelCount = std::max(header.levelCount, 1u);
+
+	stream.seekp(0);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	stream.close();
+
+	if (!stream) throw std::runtime_error("Could not write " + path);
+}
+
+void SceneFileWriter::pad()
+{
+	static const char zeros[CHUNK_ALIGNMENT] = {};
+
+	const uint64_t padding = (CHUNK_ALIGNMENT - offset % CHUNK_ALIGNMENT) % CHUNK_ALIGNMENT;
+	stream.write(zeros, static_cast<std::streamsize>(padding));
+	offset += padding;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hxx"
+#include "SceneKernels.hxx"
+
+// Binary scene file: a header, chunks of GPU-ready data each aligned to CHUNK_ALIGNMENT, and
+// an index of the chunks at the end. Rect chunks hold RectInstances as the instance buffer
+// takes them, so a chunk goes from the mapping to a staging buffer in one copy. Rects come
+// in levels of detail: level 0 holds the rects themselves and every further level holds
+// tiles aggregating the level below, each level sorted along a Z-order curve and cut into
+// chunks so that every chunk covers a compact area. All values are little endian.
+namespace SceneFormat
+{
+	constexpr char MAGIC[8] = { 'W', 'G', 'S', 'C', 'E', 'N', 'E', '\0' };
+	constexpr uint32_t VERSION = 1;
+	// Page sized, so a chunk can be prefetched and released without touching its neighbours.
+	constexpr uint64_t CHUNK_ALIGNMENT = 4096;
+	constexpr uint32_t MAX_LEVELS = 16;
+
+	enum class ChunkType : uint32_t
+	{
+		// RectInstance[count].
+		Rects = 1,
+		// Vertices of the shape drawn per rect, in the layout of vertex buffer 0: position
+		// (2 floats) and color (3 floats).
+		Mesh = 2,
+		// RGBA8 colors the source data indexed into; the rects carry the resolved colors.
+		Palette = 3
+	};
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t chunkCount;
+		uint64_t indexOffset;
+		uint64_t fileSize;
+		// Rect centers lie within these bounds.
+		SceneBounds bounds;
+		uint64_t rectCount;
+		uint32_t levelCount;
+		uint32_t reserved;
+		// Size in world units of the features of each level: the mean side of the rects on
+		// level 0, the tile side above.
+		float levelSizes[MAX_LEVELS];
+	};
+	static_assert(sizeof(Header) == 128, "Header layout is part of the file format");
+
+	struct ChunkRecord
+	{
+		ChunkType type;
+		uint32_t level;
+		uint64_t offset;
+		uint64_t size;
+		uint32_t count;
+		uint32_t stride;
+		// Bounding box of everything drawn from the chunk.
+		SceneBounds bounds;
+	};
+	static_assert(sizeof(ChunkRecord) == 48, "ChunkRecord layout is part of the file format");
+}
+
+// A scene file opened by mapping it into memory. Only the header and the index are read on
+// open, and they are validated so that every chunk lies inside the file; chunk data is read
+// from the mapping when first touched.
+class SceneFile
+{
+public:
+	// Throws std::runtime_error if the file cannot be mapped or is not a valid scene file.
+	explicit SceneFile(const std::string& arg_Path);
+
+	const SceneFormat::Header& getHeader() const { return *header; }
+	const SceneFormat::ChunkRecord* getChunks() const { return chunks; }
+	size_t getChunkCount() const { return header->chunkCount; }
+	// The first chunk of the type, or null.
+	const SceneFormat::ChunkRecord* findChunk(SceneFormat::ChunkType arg_Type) const;
+
+	// Points into the mapping; valid while the SceneFile lives.
+	const void* getChunkData(const SceneFormat::ChunkRecord& arg_Chunk) const { return mapping.data() + arg_Chunk.offset; }
+	const MappedFile& getMapping() const { return mapping; }
+
+private:
+	MappedFile mapping;
+	const SceneFormat::Header* header = nullptr;
+	const SceneFormat::ChunkRecord* chunks = nullptr;
+};
+
+// Writes a scene file front to back: chunks as they are added, then the index and the final
+// header. Throws std::runtime_error on write errors.
+class SceneFileWriter
+{
+public:
+	explicit SceneFileWriter(const std::string& arg_Path);
+
+	void setBounds(const SceneBounds& arg_Bounds) { header.bounds = arg_Bounds; }
+	void setLevelSize(uint32_t arg_Level, float arg_Size);
+
+	// Copies arg_Count elements of arg_Stride bytes into a new chunk. Rect chunks also count
+	// towards the header's rect total when they are on level 0.
+	void addChunk(SceneFormat::ChunkType arg_Type, uint32_t arg_Level, const void* arg_Data, uint32_t arg_Stride,
+		uint32_t arg_Count, const SceneBounds& arg_Bounds);
+
+	// Writes the index and the header; the file is complete after this returns.
+	void finish();
+
+	uint64_t getBytesWritten() const { return offset; }
+
+private:
+	void pad();
+
+private:
+	std::string path;
+	std::ofstream stream;
+	SceneFormat::Header header{};
+	std::vector<SceneFormat::ChunkRecord> records;
+	uint64_t offset = 0;
+};
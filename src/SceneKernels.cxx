@@ -0,0 +1,442 @@
+#include "SceneKernels.hxx"
+
+#include <cmath>
+
+// AVX2 kernels are compiled per function with a target attribute and picked at runtime, so
+// the rest of the build keeps its baseline ISA. Compilers other than GCC and Clang use the
+// scalar set on x86. NEON is part of the AArch64 baseline and needs no check.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCENE_KERNELS_AVX2 1
+#define SCENE_AVX2 __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SCENE_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+	const float TWO_PI = 6.28318530717958647692f;
+
+	// One wrapped axis. A degenerate extent gets a zero inverse, which disables wrapping.
+	struct WrapAxis
+	{
+		float min;
+		float extent;
+		float inverse;
+	};
+
+	WrapAxis makeWrapAxis(float arg_Min, float arg_Max)
+	{
+		const float extent = arg_Max - arg_Min;
+		return { arg_Min, extent, extent > 0.0f ? 1.0f / extent : 0.0f };
+	}
+
+	inline float wrap(float arg_Value, const WrapAxis& arg_Axis)
+	{
+		return arg_Value - arg_Axis.extent * std::floor((arg_Value - arg_Axis.min) * arg_Axis.inverse);
+	}
+
+	inline void packOne(const SceneColumns& arg_Columns, size_t arg_Index, RectInstance& arg_Out)
+	{
+		arg_Out.center[0] = arg_Columns.x[arg_Index];
+		arg_Out.center[1] = arg_Columns.y[arg_Index];
+		arg_Out.size[0] = arg_Columns.width[arg_Index];
+		arg_Out.size[1] = arg_Columns.height[arg_Index];
+		arg_Out.rotation = arg_Columns.rotation[arg_Index];
+		arg_Out.layer = arg_Columns.layer[arg_Index];
+		arg_Out.color = arg_Columns.color[arg_Index];
+		arg_Out.padding = 0;
+	}
+
+	void animateScalar(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds)
+	{
+		const WrapAxis axisX = makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX);
+		const WrapAxis axisY = makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY);
+		const WrapAxis angle = makeWrapAxis(0.0f, TWO_PI);
+
+		for (size_t i = arg_Begin; i < arg_End; ++i)
+		{
+			arg_Columns.x[i] = wrap(arg_Columns.x[i] + arg_Columns.velocityX[i] * arg_Dt, axisX);
+			arg_Columns.y[i] = wrap(arg_Columns.y[i] + arg_Columns.velocityY[i] * arg_Dt, axisY);
+			arg_Columns.rotation[i] = wrap(arg_Columns.rotation[i] + arg_Columns.spin[i] * arg_Dt, angle);
+		}
+	}
+
+	void transformScalar(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, const SceneTransform& arg_Transform)
+	{
+		const float cosine = std::cos(arg_Transform.rotation) * arg_Transform.scale;
+		const float sine = std::sin(arg_Transform.rotation) * arg_Transform.scale;
+		const WrapAxis angle = makeWrapAxis(0.0f, TWO_PI);
+
+		for (size_t i = arg_Begin; i < arg_End; ++i)
+		{
+			const float x = arg_Columns.x[i];
+			const float y = arg_Columns.y[i];
+			arg_Columns.x[i] = cosine * x - sine * y + arg_Transform.translateX;
+			arg_Columns.y[i] = sine * x + cosine * y + arg_Transform.translateY;
+			arg_Columns.width[i] *= arg_Transform.scale;
+			arg_Columns.height[i] *= arg_Transform.scale;
+			arg_Columns.rotation[i] = wrap(arg_Columns.rotation[i] + arg_Transform.rotation, angle);
+		}
+	}
+
+	void packScalar(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out)
+	{
+		for (size_t i = arg_Begin; i < arg_End; ++i) packOne(arg_Columns, i, arg_Out[i - arg_Begin]);
+	}
+
+	void packIndexedScalar(const SceneColumns& arg_Columns, const uint32_t* arg_Indices, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out)
+	{
+		for (size_t i = arg_Begin; i < arg_End; ++i) packOne(arg_Columns, arg_Indices[i], arg_Out[i - arg_Begin]);
+	}
+
+	void animateAndPackScalar(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds, RectInstance* arg_Out)
+	{
+		const WrapAxis axisX = makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX);
+		const WrapAxis axisY = makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY);
+		const WrapAxis angle = makeWrapAxis(0.0f, TWO_PI);
+
+		for (size_t i = arg_Begin; i < arg_End; ++i)
+		{
+			arg_Columns.x[i] = wrap(arg_Columns.x[i] + arg_Columns.velocityX[i] * arg_Dt, axisX);
+			arg_Columns.y[i] = wrap(arg_Columns.y[i] + arg_Columns.velocityY[i] * arg_Dt, axisY);
+			arg_Columns.rotation[i] = wrap(arg_Columns.rotation[i] + arg_Columns.spin[i] * arg_Dt, angle);
+			packOne(arg_Columns, i, arg_Out[i - arg_Begin]);
+		}
+	}
+
+	const SceneKernelSet scalarSet = { "scalar", &animateScalar, &transformScalar, &packScalar, &packIndexedScalar, &animateAndPackScalar };
+
+#if SCENE_KERNELS_AVX2
+	struct WrapAxis8
+	{
+		__m256 min;
+		__m256 extent;
+		__m256 inverse;
+	};
+
+	SCENE_AVX2 WrapAxis8 broadcast(const WrapAxis& arg_Axis)
+	{
+		return { _mm256_set1_ps(arg_Axis.min), _mm256_set1_ps(arg_Axis.extent), _mm256_set1_ps(arg_Axis.inverse) };
+	}
+
+	SCENE_AVX2 inline __m256 wrap8(__m256 arg_Value, const WrapAxis8& arg_Axis)
+	{
+		const __m256 turns = _mm256_floor_ps(_mm256_mul_ps(_mm256_sub_ps(arg_Value, arg_Axis.min), arg_Axis.inverse));
+		return _mm256_fnmadd_ps(arg_Axis.extent, turns, arg_Value);
+	}
+
+	// Transposes eight columns of eight rects into eight 32-byte RectInstances. Mapped upload
+	// memory is usually write-combined, so aligned output bypasses the cache.
+	SCENE_AVX2 inline void pack8(const __m256 arg_Rows[8], float* arg_Out, bool arg_Stream)
+	{
+		const __m256 t0 = _mm256_unpacklo_ps(arg_Rows[0], arg_Rows[1]);
+		const __m256 t1 = _mm256_unpackhi_ps(arg_Rows[0], arg_Rows[1]);
+		const __m256 t2 = _mm256_unpacklo_ps(arg_Rows[2], arg_Rows[3]);
+		const __m256 t3 = _mm256_unpackhi_ps(arg_Rows[2], arg_Rows[3]);
+		const __m256 t4 = _mm256_unpacklo_ps(arg_Rows[4], arg_Rows[5]);
+		const __m256 t5 = _mm256_unpackhi_ps(arg_Rows[4], arg_Rows[5]);
+		const __m256 t6 = _mm256_unpacklo_ps(arg_Rows[6], arg_Rows[7]);
+		const __m256 t7 = _mm256_unpackhi_ps(arg_Rows[6], arg_Rows[7]);
+
+		const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+		const __m256 out[8] = {
+			_mm256_permute2f128_ps(s0, s4, 0x20),
+			_mm256_permute2f128_ps(s1, s5, 0x20),
+			_mm256_permute2f128_ps(s2, s6, 0x20),
+			_mm256_permute2f128_ps(s3, s7, 0x20),
+			_mm256_permute2f128_ps(s0, s4, 0x31),
+			_mm256_permute2f128_ps(s1, s5, 0x31),
+			_mm256_permute2f128_ps(s2, s6, 0x31),
+			_mm256_permute2f128_ps(s3, s7, 0x31)
+		};
+
+		if (arg_Stream)
+		{
+			for (int i = 0; i < 8; ++i) _mm256_stream_ps(arg_Out + 8 * i, out[i]);
+		}
+		else
+		{
+			for (int i = 0; i < 8; ++i) _mm256_storeu_ps(arg_Out + 8 * i, out[i]);
+		}
+	}
+
+	SCENE_AVX2 inline void loadStatic8(const SceneColumns& arg_Columns, size_t arg_Index, __m256 arg_Rows[8])
+	{
+		arg_Rows[2] = _mm256_loadu_ps(arg_Columns.width + arg_Index);
+		arg_Rows[3] = _mm256_loadu_ps(arg_Columns.height + arg_Index);
+		arg_Rows[5] = _mm256_loadu_ps(arg_Columns.layer + arg_Index);
+		arg_Rows[6] = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(arg_Columns.color + arg_Index)));
+		arg_Rows[7] = _mm256_setzero_ps();
+	}
+
+	inline bool isStreamable(const RectInstance* arg_Out)
+	{
+		return (reinterpret_cast<uintptr_t>(arg_Out) & 31) == 0;
+	}
+
+	SCENE_AVX2 void animateAvx2(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds)
+	{
+		const WrapAxis8 axisX = broadcast(makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX));
+		const WrapAxis8 axisY = broadcast(makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY));
+		const WrapAxis8 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+		const __m256 dt = _mm256_set1_ps(arg_Dt);
+
+		size_t i = arg_Begin;
+		for (; i + 8 <= arg_End; i += 8)
+		{
+			const __m256 x = _mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.velocityX + i), dt, _mm256_loadu_ps(arg_Columns.x + i));
+			const __m256 y = _mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.velocityY + i), dt, _mm256_loadu_ps(arg_Columns.y + i));
+			const __m256 rotation = _mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.spin + i), dt, _mm256_loadu_ps(arg_Columns.rotation + i));
+			_mm256_storeu_ps(arg_Columns.x + i, wrap8(x, axisX));
+			_mm256_storeu_ps(arg_Columns.y + i, wrap8(y, axisY));
+			_mm256_storeu_ps(arg_Columns.rotation + i, wrap8(rotation, angle));
+		}
+		animateScalar(arg_Columns, i, arg_End, arg_Dt, arg_Bounds);
+	}
+
+	SCENE_AVX2 void transformAvx2(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, const SceneTransform& arg_Transform)
+	{
+		const __m256 cosine = _mm256_set1_ps(std::cos(arg_Transform.rotation) * arg_Transform.scale);
+		const __m256 sine = _mm256_set1_ps(std::sin(arg_Transform.rotation) * arg_Transform.scale);
+		const __m256 scale = _mm256_set1_ps(arg_Transform.scale);
+		const __m256 translateX = _mm256_set1_ps(arg_Transform.translateX);
+		const __m256 translateY = _mm256_set1_ps(arg_Transform.translateY);
+		const __m256 rotate = _mm256_set1_ps(arg_Transform.rotation);
+		const WrapAxis8 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+
+		size_t i = arg_Begin;
+		for (; i + 8 <= arg_End; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(arg_Columns.x + i);
+			const __m256 y = _mm256_loadu_ps(arg_Columns.y + i);
+			_mm256_storeu_ps(arg_Columns.x + i, _mm256_fmadd_ps(cosine, x, _mm256_fnmadd_ps(sine, y, translateX)));
+			_mm256_storeu_ps(arg_Columns.y + i, _mm256_fmadd_ps(sine, x, _mm256_fmadd_ps(cosine, y, translateY)));
+			_mm256_storeu_ps(arg_Columns.width + i, _mm256_mul_ps(_mm256_loadu_ps(arg_Columns.width + i), scale));
+			_mm256_storeu_ps(arg_Columns.height + i, _mm256_mul_ps(_mm256_loadu_ps(arg_Columns.height + i), scale));
+			_mm256_storeu_ps(arg_Columns.rotation + i, wrap8(_mm256_add_ps(_mm256_loadu_ps(arg_Columns.rotation + i), rotate), angle));
+		}
+		transformScalar(arg_Columns, i, arg_End, arg_Transform);
+	}
+
+	SCENE_AVX2 void packAvx2(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out)
+	{
+		const bool stream = isStreamable(arg_Out);
+
+		size_t i = arg_Begin;
+		for (; i + 8 <= arg_End; i += 8)
+		{
+			__m256 rows[8];
+			rows[0] = _mm256_loadu_ps(arg_Columns.x + i);
+			rows[1] = _mm256_loadu_ps(arg_Columns.y + i);
+			rows[4] = _mm256_loadu_ps(arg_Columns.rotation + i);
+			loadStatic8(arg_Columns, i, rows);
+			pack8(rows, reinterpret_cast<float*>(arg_Out + (i - arg_Begin)), stream);
+		}
+		if (stream) _mm_sfence();
+		packScalar(arg_Columns, i, arg_End, arg_Out + (i - arg_Begin));
+	}
+
+	SCENE_AVX2 void packIndexedAvx2(const SceneColumns& arg_Columns, const uint32_t* arg_Indices, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out)
+	{
+		const bool stream = isStreamable(arg_Out);
+
+		size_t i = arg_Begin;
+		for (; i + 8 <= arg_End; i += 8)
+		{
+			const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(arg_Indices + i));
+			__m256 rows[8];
+			rows[0] = _mm256_i32gather_ps(arg_Columns.x, index, 4);
+			rows[1] = _mm256_i32gather_ps(arg_Columns.y, index, 4);
+			rows[2] = _mm256_i32gather_ps(arg_Columns.width, index, 4);
+			rows[3] = _mm256_i32gather_ps(arg_Columns.height, index, 4);
+			rows[4] = _mm256_i32gather_ps(arg_Columns.rotation, index, 4);
+			rows[5] = _mm256_i32gather_ps(arg_Columns.layer, index, 4);
+			rows[6] = _mm256_castsi256_ps(_mm256_i32gather_epi32(reinterpret_cast<const int*>(arg_Columns.color), index, 4));
+			rows[7] = _mm256_setzero_ps();
+			pack8(rows, reinterpret_cast<float*>(arg_Out + (i - arg_Begin)), stream);
+		}
+		if (stream) _mm_sfence();
+		packIndexedScalar(arg_Columns, arg_Indices, i, arg_End, arg_Out + (i - arg_Begin));
+	}
+
+	SCENE_AVX2 void animateAndPackAvx2(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds, RectInstance* arg_Out)
+	{
+		const WrapAxis8 axisX = broadcast(makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX));
+		const WrapAxis8 axisY = broadcast(makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY));
+		const WrapAxis8 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+		const __m256 dt = _mm256_set1_ps(arg_Dt);
+		const bool stream = isStreamable(arg_Out);
+
+		size_t i = arg_Begin;
+		for (; i + 8 <= arg_End; i += 8)
+		{
+			__m256 rows[8];
+			rows[0] = wrap8(_mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.velocityX + i), dt, _mm256_loadu_ps(arg_Columns.x + i)), axisX);
+			rows[1] = wrap8(_mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.velocityY + i), dt, _mm256_loadu_ps(arg_Columns.y + i)), axisY);
+			rows[4] = wrap8(_mm256_fmadd_ps(_mm256_loadu_ps(arg_Columns.spin + i), dt, _mm256_loadu_ps(arg_Columns.rotation + i)), angle);
+			_mm256_storeu_ps(arg_Columns.x + i, rows[0]);
+			_mm256_storeu_ps(arg_Columns.y + i, rows[1]);
+			_mm256_storeu_ps(arg_Columns.rotation + i, rows[4]);
+			loadStatic8(arg_Columns, i, rows);
+			pack8(rows, reinterpret_cast<float*>(arg_Out + (i - arg_Begin)), stream);
+		}
+		if (stream) _mm_sfence();
+		animateAndPackScalar(arg_Columns, i, arg_End, arg_Dt, arg_Bounds, arg_Out + (i - arg_Begin));
+	}
+
+	const SceneKernelSet avx2Set = { "avx2", &animateAvx2, &transformAvx2, &packAvx2, &packIndexedAvx2, &animateAndPackAvx2 };
+#endif
+
+#if SCENE_KERNELS_NEON
+	struct WrapAxis4
+	{
+		float32x4_t min;
+		float32x4_t extent;
+		float32x4_t inverse;
+	};
+
+	WrapAxis4 broadcast(const WrapAxis& arg_Axis)
+	{
+		return { vdupq_n_f32(arg_Axis.min), vdupq_n_f32(arg_Axis.extent), vdupq_n_f32(arg_Axis.inverse) };
+	}
+
+	inline float32x4_t wrap4(float32x4_t arg_Value, const WrapAxis4& arg_Axis)
+	{
+		const float32x4_t turns = vrndmq_f32(vmulq_f32(vsubq_f32(arg_Value, arg_Axis.min), arg_Axis.inverse));
+		return vfmsq_f32(arg_Value, arg_Axis.extent, turns);
+	}
+
+	// Interleaves four rects into four 32-byte RectInstances.
+	inline void pack4(const SceneColumns& arg_Columns, size_t arg_Index, float32x4_t arg_X, float32x4_t arg_Y, float32x4_t arg_Rotation, float* arg_Out)
+	{
+		const float32x4_t width = vld1q_f32(arg_Columns.width + arg_Index);
+		const float32x4_t height = vld1q_f32(arg_Columns.height + arg_Index);
+		const float32x4_t layer = vld1q_f32(arg_Columns.layer + arg_Index);
+		const float32x4_t color = vreinterpretq_f32_u32(vld1q_u32(arg_Columns.color + arg_Index));
+
+		const float32x4x2_t xw = vzipq_f32(arg_X, width);
+		const float32x4x2_t yh = vzipq_f32(arg_Y, height);
+		const float32x4x2_t front01 = vzipq_f32(xw.val[0], yh.val[0]);
+		const float32x4x2_t front23 = vzipq_f32(xw.val[1], yh.val[1]);
+
+		const float32x4x2_t rc = vzipq_f32(arg_Rotation, color);
+		const float32x4x2_t lp = vzipq_f32(layer, vdupq_n_f32(0.0f));
+		const float32x4x2_t back01 = vzipq_f32(rc.val[0], lp.val[0]);
+		const float32x4x2_t back23 = vzipq_f32(rc.val[1], lp.val[1]);
+
+		vst1q_f32(arg_Out, front01.val[0]);
+		vst1q_f32(arg_Out + 4, back01.val[0]);
+		vst1q_f32(arg_Out + 8, front01.val[1]);
+		vst1q_f32(arg_Out + 12, back01.val[1]);
+		vst1q_f32(arg_Out + 16, front23.val[0]);
+		vst1q_f32(arg_Out + 20, back23.val[0]);
+		vst1q_f32(arg_Out + 24, front23.val[1]);
+		vst1q_f32(arg_Out + 28, back23.val[1]);
+	}
+
+	void animateNeon(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds)
+	{
+		const WrapAxis4 axisX = broadcast(makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX));
+		const WrapAxis4 axisY = broadcast(makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY));
+		const WrapAxis4 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+		const float32x4_t dt = vdupq_n_f32(arg_Dt);
+
+		size_t i = arg_Begin;
+		for (; i + 4 <= arg_End; i += 4)
+		{
+			vst1q_f32(arg_Columns.x + i, wrap4(vfmaq_f32(vld1q_f32(arg_Columns.x + i), vld1q_f32(arg_Columns.velocityX + i), dt), axisX));
+			vst1q_f32(arg_Columns.y + i, wrap4(vfmaq_f32(vld1q_f32(arg_Columns.y + i), vld1q_f32(arg_Columns.velocityY + i), dt), axisY));
+			vst1q_f32(arg_Columns.rotation + i, wrap4(vfmaq_f32(vld1q_f32(arg_Columns.rotation + i), vld1q_f32(arg_Columns.spin + i), dt), angle));
+		}
+		animateScalar(arg_Columns, i, arg_End, arg_Dt, arg_Bounds);
+	}
+
+	void transformNeon(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, const SceneTransform& arg_Transform)
+	{
+		const float32x4_t cosine = vdupq_n_f32(std::cos(arg_Transform.rotation) * arg_Transform.scale);
+		const float32x4_t sine = vdupq_n_f32(std::sin(arg_Transform.rotation) * arg_Transform.scale);
+		const float32x4_t scale = vdupq_n_f32(arg_Transform.scale);
+		const float32x4_t translateX = vdupq_n_f32(arg_Transform.translateX);
+		const float32x4_t translateY = vdupq_n_f32(arg_Transform.translateY);
+		const float32x4_t rotate = vdupq_n_f32(arg_Transform.rotation);
+		const WrapAxis4 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+
+		size_t i = arg_Begin;
+		for (; i + 4 <= arg_End; i += 4)
+		{
+			const float32x4_t x = vld1q_f32(arg_Columns.x + i);
+			const float32x4_t y = vld1q_f32(arg_Columns.y + i);
+			vst1q_f32(arg_Columns.x + i, vfmaq_f32(vfmsq_f32(translateX, sine, y), cosine, x));
+			vst1q_f32(arg_Columns.y + i, vfmaq_f32(vfmaq_f32(translateY, cosine, y), sine, x));
+			vst1q_f32(arg_Columns.width + i, vmulq_f32(vld1q_f32(arg_Columns.width + i), scale));
+			vst1q_f32(arg_Columns.height + i, vmulq_f32(vld1q_f32(arg_Columns.height + i), scale));
+			vst1q_f32(arg_Columns.rotation + i, wrap4(vaddq_f32(vld1q_f32(arg_Columns.rotation + i), rotate), angle));
+		}
+		transformScalar(arg_Columns, i, arg_End, arg_Transform);
+	}
+
+	void packNeon(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out)
+	{
+		size_t i = arg_Begin;
+		for (; i + 4 <= arg_End; i += 4)
+		{
+			pack4(arg_Columns, i, vld1q_f32(arg_Columns.x + i), vld1q_f32(arg_Columns.y + i), vld1q_f32(arg_Columns.rotation + i),
+				reinterpret_cast<float*>(arg_Out + (i - arg_Begin)));
+		}
+		packScalar(arg_Columns, i, arg_End, arg_Out + (i - arg_Begin));
+	}
+
+	void animateAndPackNeon(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds, RectInstance* arg_Out)
+	{
+		const WrapAxis4 axisX = broadcast(makeWrapAxis(arg_Bounds.minX, arg_Bounds.maxX));
+		const WrapAxis4 axisY = broadcast(makeWrapAxis(arg_Bounds.minY, arg_Bounds.maxY));
+		const WrapAxis4 angle = broadcast(makeWrapAxis(0.0f, TWO_PI));
+		const float32x4_t dt = vdupq_n_f32(arg_Dt);
+
+		size_t i = arg_Begin;
+		for (; i + 4 <= arg_End; i += 4)
+		{
+			const float32x4_t x = wrap4(vfmaq_f32(vld1q_f32(arg_Columns.x + i), vld1q_f32(arg_Columns.velocityX + i), dt), axisX);
+			const float32x4_t y = wrap4(vfmaq_f32(vld1q_f32(arg_Columns.y + i), vld1q_f32(arg_Columns.velocityY + i), dt), axisY);
+			const float32x4_t rotation = wrap4(vfmaq_f32(vld1q_f32(arg_Columns.rotation + i), vld1q_f32(arg_Columns.spin + i), dt), angle);
+			vst1q_f32(arg_Columns.x + i, x);
+			vst1q_f32(arg_Columns.y + i, y);
+			vst1q_f32(arg_Columns.rotation + i, rotation);
+			pack4(arg_Columns, i, x, y, rotation, reinterpret_cast<float*>(arg_Out + (i - arg_Begin)));
+		}
+		animateAndPackScalar(arg_Columns, i, arg_End, arg_Dt, arg_Bounds, arg_Out + (i - arg_Begin));
+	}
+
+	// NEON has no gather, so indexed packing stays scalar.
+	const SceneKernelSet neonSet = { "neon", &animateNeon, &transformNeon, &packNeon, &packIndexedScalar, &animateAndPackNeon };
+#endif
+}
+
+const SceneKernelSet& SceneKernels::scalar()
+{
+	return scalarSet;
+}
+
+const SceneKernelSet& SceneKernels::best()
+{
+#if SCENE_KERNELS_AVX2
+	static const bool avx2 = []() {
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	}();
+	if (avx2) return avx2Set;
+#elif SCENE_KERNELS_NEON
+	return neonSet;
+#endif
+	return scalarSet;
+}
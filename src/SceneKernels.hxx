@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DrawParameters.hxx"
+
+// Column pointers of a SceneStore, indexed by dense position. Kernels take a [begin, end)
+// range so a JobSystem can split one pass across threads; ranges must not overlap.
+struct SceneColumns
+{
+	float* x;
+	float* y;
+	float* width;
+	float* height;
+	float* rotation;
+	const float* layer;
+	const uint32_t* color;
+	const float* velocityX;
+	const float* velocityY;
+	const float* spin;
+};
+
+// Positions wrap around this box as rects move.
+struct SceneBounds
+{
+	float minX;
+	float minY;
+	float maxX;
+	float maxY;
+};
+
+// Similarity transform: scale and rotate about the origin, then translate.
+struct SceneTransform
+{
+	float scale;
+	float rotation;
+	float translateX;
+	float translateY;
+};
+
+// One implementation of every scene pass. The SIMD sets process 8 (AVX2) or 4 (NEON) rects
+// per step with a scalar tail, and may round differently from the scalar set in the last bit
+// as they use fused multiply-adds.
+struct SceneKernelSet
+{
+	const char* name;
+	// position += velocity * dt, wrapped into the bounds; rotation += spin * dt, wrapped to
+	// [0, 2pi).
+	void (*animate)(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds);
+	void (*transform)(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, const SceneTransform& arg_Transform);
+	// Writes arg_Out[0 .. end - begin) from the columns; arg_Out may be mapped GPU memory,
+	// which is only written, never read.
+	void (*pack)(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out);
+	// Writes arg_Out[0 .. end - begin) from the rects at dense indices arg_Indices[begin ..
+	// end), e.g. the visible ones.
+	void (*packIndexed)(const SceneColumns& arg_Columns, const uint32_t* arg_Indices, size_t arg_Begin, size_t arg_End, RectInstance* arg_Out);
+	// animate followed by pack in one pass over the columns.
+	void (*animateAndPack)(const SceneColumns& arg_Columns, size_t arg_Begin, size_t arg_End, float arg_Dt, const SceneBounds& arg_Bounds, RectInstance* arg_Out);
+};
+
+namespace SceneKernels
+{
+	const SceneKernelSet& scalar();
+	// The widest set this CPU runs, checked at runtime on x86; scalar() if there is none.
+	const SceneKernelSet& best();
+}
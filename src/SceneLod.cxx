@@ -0,0 +1,131 @@
+#include "SceneLod.hxx"
+#include "Config.hxx"
+#include "SceneStore.hxx"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Bounds the tile arrays when the tile size is small against the view; tiles grow past
+	// APP_SCENE_LOD_TILE pixels rather than exceed it.
+	const size_t MAX_TILES = 1 << 20;
+}
+
+SceneLod::Settings SceneLod::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.enabled = Config::getBool("APP_SCENE_LOD", true);
+	settings.detailPixels = std::clamp(Config::getDouble("APP_SCENE_LOD_PIXELS", 1.0), 0.0, 1024.0);
+	settings.tilePixels = std::clamp(Config::getDouble("APP_SCENE_LOD_TILE", 2.0), 1.0, 1024.0);
+
+	return settings;
+}
+
+SceneLod::SceneLod(Settings arg_Settings)
+	: settings(arg_Settings)
+{
+}
+
+void SceneLod::aggregate(const SceneStore& arg_Scene, const uint32_t* arg_Indices, size_t arg_Count,
+	const SpatialGrid::Box& arg_View, double arg_PixelSize, std::vector<uint32_t>& arg_Detailed)
+{
+	// Rect centers stay inside the scene bounds, so tiles need to cover only that part of
+	// the view. Rects reaching in from outside it go to the nearest border tile.
+	const SceneBounds& bounds = arg_Scene.getBounds();
+	SpatialGrid::Box region{
+		std::max(arg_View.minX, bounds.minX),
+		std::max(arg_View.minY, bounds.minY),
+		std::min(arg_View.maxX, bounds.maxX),
+		std::min(arg_View.maxY, bounds.maxY)
+	};
+	if (region.minX > region.maxX || region.minY > region.maxY) region = arg_View;
+	layoutTiles(region, arg_PixelSize);
+
+	const float* x = arg_Scene.getX();
+	const float* y = arg_Scene.getY();
+	const float* width = arg_Scene.getWidth();
+	const float* height = arg_Scene.getHeight();
+	const uint32_t* color = arg_Scene.getColor();
+
+	const float detailSize = static_cast<float>(settings.detailPixels * arg_PixelSize);
+	const float tileScale = 1.0f / tileSize;
+	const int lastX = static_cast<int>(tilesX) - 1;
+	const int lastY = static_cast<int>(tilesY) - 1;
+
+	for (size_t k = 0; k < arg_Count; ++k)
+	{
+		const uint32_t i = arg_Indices ? arg_Indices[k] : static_cast<uint32_t>(k);
+		if (std::max(width[i], height[i]) >= detailSize)
+		{
+			arg_Detailed.push_back(i);
+			continue;
+		}
+
+		const int tileX = std::clamp(static_cast<int>(std::floor((x[i] - originX) * tileScale)), 0, lastX);
+		const int tileY = std::clamp(static_cast<int>(std::floor((y[i] - originY) * tileScale)), 0, lastY);
+		Tile& tile = tiles[static_cast<size_t>(tileY) * tilesX + static_cast<size_t>(tileX)];
+
+		const float area = width[i] * height[i];
+		tile.red += area * static_cast<float>(color[i] & 0xff);
+		tile.green += area * static_cast<float>(color[i] >> 8 & 0xff);
+		tile.blue += area * static_cast<float>(color[i] >> 16 & 0xff);
+		tile.area += area;
+	}
+
+	tileCount = static_cast<size_t>(std::count_if(tiles.begin(), tiles.end(), [](const Tile& arg_Tile) { return arg_Tile.area > 0.0f; }));
+}
+
+void SceneLod::writeTiles(RectInstance* arg_Out) const
+{
+	const float tileArea = tileSize * tileSize;
+	size_t written = 0;
+
+	for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+	{
+		for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+		{
+			const Tile& tile = tiles[static_cast<size_t>(tileY) * tilesX + tileX];
+			if (tile.area <= 0.0f) continue;
+
+			// Rects land at independent positions, so the share of the tile they leave
+			// uncovered falls off exponentially with their total area.
+			const float scale = 1.0f / (255.0f * tile.area);
+			const float coverage = 1.0f - std::exp(-tile.area / tileArea);
+
+			RectInstance instance{};
+			instance.center[0] = originX + (static_cast<float>(tileX) + 0.5f) * tileSize;
+			instance.center[1] = originY + (static_cast<float>(tileY) + 0.5f) * tileSize;
+			instance.size[0] = tileSize;
+			instance.size[1] = tileSize;
+			instance.color = packColor(tile.red * scale, tile.green * scale, tile.blue * scale, coverage);
+			arg_Out[written++] = instance;
+		}
+	}
+}
+
+void SceneLod::layoutTiles(const SpatialGrid::Box& arg_Region, double arg_PixelSize)
+{
+	// The smallest power of two covering the requested pixels, doubled until the tiles fit.
+	double size = std::exp2(std::ceil(std::log2(std::max(settings.tilePixels * arg_PixelSize, 1e-30))));
+	double firstX = 0.0;
+	double firstY = 0.0;
+	double countX = 0.0;
+	double countY = 0.0;
+	for (;;)
+	{
+		firstX = std::floor(arg_Region.minX / size);
+		firstY = std::floor(arg_Region.minY / size);
+		countX = std::floor(arg_Region.maxX / size) - firstX + 1.0;
+		countY = std::floor(arg_Region.maxY / size) - firstY + 1.0;
+		if (countX * countY <= static_cast<double>(MAX_TILES)) break;
+		size *= 2.0;
+	}
+
+	tileSize = static_cast<float>(size);
+	originX = static_cast<float>(firstX * size);
+	originY = static_cast<float>(firstY * size);
+	tilesX = static_cast<uint32_t>(countX);
+	tilesY = static_cast<uint32_t>(countY);
+	tiles.assign(static_cast<size_t>(tilesX) * tilesY, Tile{});
+}
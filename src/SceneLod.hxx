@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DrawParameters.hxx"
+#include "SpatialGrid.hxx"
+
+class SceneStore;
+
+// Level of detail for zoomed-out views. Rects smaller on screen than the detail size are not
+// drawn one by one; they are summed into square tiles of a few pixels instead, each drawn as
+// one instance with the area-weighted mean color of its rects and their expected coverage as
+// alpha. Tile count is bounded by the viewport's pixel count, so drawing the whole scene
+// costs the GPU as much as the screen, not as much as the rects. Tile sides are powers of two
+// in world units and tiles are aligned to multiples of their side, so they stay in place
+// while panning and only change when the zoom crosses an octave.
+//   APP_SCENE_LOD         aggregate small rects into tiles (default on)
+//   APP_SCENE_LOD_PIXELS  rects below this size in pixels are aggregated (default 1)
+//   APP_SCENE_LOD_TILE    smallest tile side in pixels (default 2)
+class SceneLod
+{
+public:
+	struct Settings
+	{
+		bool enabled;
+		double detailPixels;
+		double tilePixels;
+
+		static Settings fromConfig();
+	};
+
+	explicit SceneLod(Settings arg_Settings);
+
+	bool isEnabled() const { return settings.enabled; }
+
+	// Sorts the rects at dense indices arg_Indices[0 .. arg_Count), or all rects in dense
+	// order if arg_Indices is null: those at or above the detail size are appended to
+	// arg_Detailed, the rest go into tiles over arg_View. arg_PixelSize is world units per
+	// pixel. Replaces the tiles of the previous call.
+	void aggregate(const SceneStore& arg_Scene, const uint32_t* arg_Indices, size_t arg_Count,
+		const SpatialGrid::Box& arg_View, double arg_PixelSize, std::vector<uint32_t>& arg_Detailed);
+
+	// Non-empty tiles of the last aggregate(); never more than the rects aggregated.
+	size_t getTileCount() const { return tileCount; }
+	float getTileSize() const { return tileSize; }
+	// Writes getTileCount() instances; arg_Out may be mapped GPU memory.
+	void writeTiles(RectInstance* arg_Out) const;
+
+private:
+	// Area-weighted color sums, in 8-bit units, and the total area of a tile's rects.
+	struct Tile
+	{
+		float red;
+		float green;
+		float blue;
+		float area;
+	};
+
+	void layoutTiles(const SpatialGrid::Box& arg_Region, double arg_PixelSize);
+
+private:
+	Settings settings;
+
+	std::vector<Tile> tiles;
+	uint32_t tilesX = 0;
+	uint32_t tilesY = 0;
+	float tileSize = 0.0f;
+	float originX = 0.0f;
+	float originY = 0.0f;
+	size_t tileCount = 0;
+};
@@ -0,0 +1,276 @@
+#include "SceneStore.hxx"
+#include "Config.hxx"
+#include "JobSystem.hxx"
+
+#include <cmath>
+#include <stdexcept>
+
+SceneStore::Settings SceneStore::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.simd = Config::getBool("APP_SCENE_SIMD", true);
+
+	return settings;
+}
+
+SceneStore::SceneStore(Settings arg_Settings)
+	: kernels(arg_Settings.simd ? &SceneKernels::best() : &SceneKernels::scalar())
+{
+}
+
+SceneHandle SceneStore::add(const Rect& arg_Rect)
+{
+	if (x.size() >= UINT32_MAX) throw std::length_error("SceneStore is full");
+
+	uint32_t slot = freeSlot;
+	if (slot != UINT32_MAX)
+	{
+		freeSlot = slots[slot].index;
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(slots.size());
+		slots.push_back({ 0, 0 });
+	}
+
+	slots[slot].index = static_cast<uint32_t>(x.size());
+	denseSlots.push_back(slot);
+
+	x.push_back(arg_Rect.x);
+	y.push_back(arg_Rect.y);
+	width.push_back(arg_Rect.width);
+	height.push_back(arg_Rect.height);
+	rotation.push_back(arg_Rect.rotation);
+	layer.push_back(arg_Rect.layer);
+	color.push_back(arg_Rect.color);
+	velocityX.push_back(arg_Rect.velocityX);
+	velocityY.push_back(arg_Rect.velocityY);
+	spin.push_back(arg_Rect.spin);
+
+	return { slot, slots[slot].generation };
+}
+
+bool SceneStore::remove(SceneHandle arg_Handle)
+{
+	if (!find(arg_Handle)) return false;
+
+	Slot& slot = slots[arg_Handle.slot];
+	const uint32_t index = slot.index;
+	const uint32_t last = static_cast<uint32_t>(x.size() - 1);
+
+	// Swap and pop: the last rect fills the hole, and its slot follows it.
+	if (index != last)
+	{
+		x[index] = x[last];
+		y[index] = y[last];
+		width[index] = width[last];
+		height[index] = height[last];
+		rotation[index] = rotation[last];
+		layer[index] = layer[last];
+		color[index] = color[last];
+		velocityX[index] = velocityX[last];
+		velocityY[index] = velocityY[last];
+		spin[index] = spin[last];
+		denseSlots[index] = denseSlots[last];
+		slots[denseSlots[index]].index = index;
+	}
+
+	x.pop_back();
+	y.pop_back();
+	width.pop_back();
+	height.pop_back();
+	rotation.pop_back();
+	layer.pop_back();
+	color.pop_back();
+	velocityX.pop_back();
+	velocityY.pop_back();
+	spin.pop_back();
+	denseSlots.pop_back();
+
+	++slot.generation;
+	slot.index = freeSlot;
+	freeSlot = arg_Handle.slot;
+	return true;
+}
+
+bool SceneStore::contains(SceneHandle arg_Handle) const
+{
+	return find(arg_Handle) != nullptr;
+}
+
+void SceneStore::clear()
+{
+	// Every live slot is released so that outstanding handles go stale.
+	for (uint32_t slot : denseSlots)
+	{
+		++slots[slot].generation;
+		slots[slot].index = freeSlot;
+		freeSlot = slot;
+	}
+
+	x.clear();
+	y.clear();
+	width.clear();
+	height.clear();
+	rotation.clear();
+	layer.clear();
+	color.clear();
+	velocityX.clear();
+	velocityY.clear();
+	spin.clear();
+	denseSlots.clear();
+}
+
+void SceneStore::reserve(size_t arg_Count)
+{
+	x.reserve(arg_Count);
+	y.reserve(arg_Count);
+	width.reserve(arg_Count);
+	height.reserve(arg_Count);
+	rotation.reserve(arg_Count);
+	layer.reserve(arg_Count);
+	color.reserve(arg_Count);
+	velocityX.reserve(arg_Count);
+	velocityY.reserve(arg_Count);
+	spin.reserve(arg_Count);
+	denseSlots.reserve(arg_Count);
+	slots.reserve(arg_Count);
+}
+
+void SceneStore::setPosition(SceneHandle arg_Handle, float arg_X, float arg_Y)
+{
+	const Slot* slot = find(arg_Handle);
+	if (!slot) return;
+
+	x[slot->index] = arg_X;
+	y[slot->index] = arg_Y;
+}
+
+void SceneStore::setVelocity(SceneHandle arg_Handle, float arg_VelocityX, float arg_VelocityY)
+{
+	const Slot* slot = find(arg_Handle);
+	if (!slot) return;
+
+	velocityX[slot->index] = arg_VelocityX;
+	velocityY[slot->index] = arg_VelocityY;
+}
+
+void SceneStore::setColor(SceneHandle arg_Handle, uint32_t arg_Color)
+{
+	const Slot* slot = find(arg_Handle);
+	if (slot) color[slot->index] = arg_Color;
+}
+
+bool SceneStore::get(SceneHandle arg_Handle, Rect& arg_Rect) const
+{
+	const Slot* slot = find(arg_Handle);
+	if (!slot) return false;
+
+	const uint32_t i = slot->index;
+	arg_Rect = { x[i], y[i], width[i], height[i], rotation[i], layer[i], color[i], velocityX[i], velocityY[i], spin[i] };
+	return true;
+}
+
+bool SceneStore::pick(const uint32_t* arg_Indices, size_t arg_Count, float arg_X, float arg_Y, SceneHandle& arg_Handle) const
+{
+	bool found = false;
+	float topLayer = 0.0f;
+	for (size_t i = 0; i < arg_Count; ++i)
+	{
+		const uint32_t index = arg_Indices[i];
+
+		// The point in the rect's own frame, where the rect spans [-size / 2, size / 2].
+		const float dx = arg_X - x[index];
+		const float dy = arg_Y - y[index];
+		const float cosine = std::cos(rotation[index]);
+		const float sine = std::sin(rotation[index]);
+		const float localX = cosine * dx + sine * dy;
+		const float localY = cosine * dy - sine * dx;
+		if (std::fabs(localX) > 0.5f * width[index] || std::fabs(localY) > 0.5f * height[index]) continue;
+
+		if (!found || layer[index] > topLayer)
+		{
+			found = true;
+			topLayer = layer[index];
+			arg_Handle = getHandle(index);
+		}
+	}
+	return found;
+}
+
+SceneHandle SceneStore::getHandle(size_t arg_Index) const
+{
+	const uint32_t slot = denseSlots[arg_Index];
+	return { slot, slots[slot].generation };
+}
+
+void SceneStore::animate(float arg_Dt, JobSystem* arg_Jobs)
+{
+	const SceneColumns view = columns();
+	auto body = [&](size_t arg_Begin, size_t arg_End) { kernels->animate(view, arg_Begin, arg_End, arg_Dt, bounds); };
+
+	if (arg_Jobs) arg_Jobs->parallelFor(size(), GRAIN, body);
+	else body(0, size());
+}
+
+void SceneStore::applyTransform(const SceneTransform& arg_Transform, JobSystem* arg_Jobs)
+{
+	const SceneColumns view = columns();
+	auto body = [&](size_t arg_Begin, size_t arg_End) { kernels->transform(view, arg_Begin, arg_End, arg_Transform); };
+
+	if (arg_Jobs) arg_Jobs->parallelFor(size(), GRAIN, body);
+	else body(0, size());
+}
+
+void SceneStore::writeInstances(RectInstance* arg_Out, JobSystem* arg_Jobs) const
+{
+	const SceneColumns view = columns();
+	auto body = [&](size_t arg_Begin, size_t arg_End) { kernels->pack(view, arg_Begin, arg_End, arg_Out + arg_Begin); };
+
+	if (arg_Jobs) arg_Jobs->parallelFor(size(), GRAIN, body);
+	else body(0, size());
+}
+
+void SceneStore::writeInstances(const uint32_t* arg_Indices, size_t arg_Count, RectInstance* arg_Out, JobSystem* arg_Jobs) const
+{
+	const SceneColumns view = columns();
+	auto body = [&](size_t arg_Begin, size_t arg_End) { kernels->packIndexed(view, arg_Indices, arg_Begin, arg_End, arg_Out + arg_Begin); };
+
+	if (arg_Jobs) arg_Jobs->parallelFor(arg_Count, GRAIN, body);
+	else body(0, arg_Count);
+}
+
+void SceneStore::update(float arg_Dt, RectInstance* arg_Out, JobSystem* arg_Jobs)
+{
+	const SceneColumns view = columns();
+	auto body = [&](size_t arg_Begin, size_t arg_End) { kernels->animateAndPack(view, arg_Begin, arg_End, arg_Dt, bounds, arg_Out + arg_Begin); };
+
+	if (arg_Jobs) arg_Jobs->parallelFor(size(), GRAIN, body);
+	else body(0, size());
+}
+
+SceneColumns SceneStore::columns() const
+{
+	SceneColumns view{};
+	view.x = const_cast<float*>(x.data());
+	view.y = const_cast<float*>(y.data());
+	view.width = const_cast<float*>(width.data());
+	view.height = const_cast<float*>(height.data());
+	view.rotation = const_cast<float*>(rotation.data());
+	view.layer = layer.data();
+	view.color = color.data();
+	view.velocityX = velocityX.data();
+	view.velocityY = velocityY.data();
+	view.spin = spin.data();
+	return view;
+}
+
+const SceneStore::Slot* SceneStore::find(SceneHandle arg_Handle) const
+{
+	if (arg_Handle.slot >= slots.size()) return nullptr;
+
+	const Slot& slot = slots[arg_Handle.slot];
+	if (slot.generation != arg_Handle.generation) return nullptr;
+	// A free slot's generation was bumped on release, so any handle to it is already stale.
+	return &slot;
+}
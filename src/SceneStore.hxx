@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DrawParameters.hxx"
+#include "SceneKernels.hxx"
+
+class JobSystem;
+
+// Stable reference to a rect in a SceneStore. The generation tells a handle to a removed
+// rect apart from one to a rect that later reused its slot.
+struct SceneHandle
+{
+	uint32_t slot = UINT32_MAX;
+	uint32_t generation = 0;
+};
+
+// Rectangles stored as one array per field (structure of arrays), so per-frame passes stream
+// through only the fields they touch and map directly onto SIMD lanes. Rects are kept dense:
+// remove() moves the last rect into the hole, and a slot table maps handles to the current
+// dense index, so add, remove and lookup are O(1) and the arrays never hold gaps. Per-frame
+// passes take an optional JobSystem and split the dense range across its threads.
+//   APP_SCENE_SIMD   use the widest SIMD kernels the CPU runs (default on)
+class SceneStore
+{
+public:
+	struct Settings
+	{
+		bool simd;
+
+		static Settings fromConfig();
+	};
+
+	struct Rect
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+		float rotation;
+		float layer;
+		uint32_t color;
+		float velocityX;
+		float velocityY;
+		float spin;
+	};
+
+	explicit SceneStore(Settings arg_Settings);
+
+	SceneHandle add(const Rect& arg_Rect);
+	// Returns false if the handle is stale.
+	bool remove(SceneHandle arg_Handle);
+	bool contains(SceneHandle arg_Handle) const;
+	void clear();
+	void reserve(size_t arg_Count);
+
+	// Setters ignore stale handles.
+	void setPosition(SceneHandle arg_Handle, float arg_X, float arg_Y);
+	void setVelocity(SceneHandle arg_Handle, float arg_VelocityX, float arg_VelocityY);
+	void setColor(SceneHandle arg_Handle, uint32_t arg_Color);
+	bool get(SceneHandle arg_Handle, Rect& arg_Rect) const;
+
+	void setBounds(const SceneBounds& arg_Bounds) { bounds = arg_Bounds; }
+	const SceneBounds& getBounds() const { return bounds; }
+
+	size_t size() const { return x.size(); }
+	const char* getKernelName() const { return kernels->name; }
+
+	// Moves every rect by its velocity and spin over arg_Dt seconds.
+	void animate(float arg_Dt, JobSystem* arg_Jobs);
+	void applyTransform(const SceneTransform& arg_Transform, JobSystem* arg_Jobs);
+	// Writes size() instances in dense order.
+	void writeInstances(RectInstance* arg_Out, JobSystem* arg_Jobs) const;
+	// Writes arg_Count instances for the rects at the given dense indices, in that order.
+	void writeInstances(const uint32_t* arg_Indices, size_t arg_Count, RectInstance* arg_Out, JobSystem* arg_Jobs) const;
+	// animate() and writeInstances() in a single pass.
+	void update(float arg_Dt, RectInstance* arg_Out, JobSystem* arg_Jobs);
+
+	// Dense columns, valid until the next add or remove.
+	const float* getX() const { return x.data(); }
+	const float* getY() const { return y.data(); }
+	const float* getWidth() const { return width.data(); }
+	const float* getHeight() const { return height.data(); }
+	const uint32_t* getColor() const { return color.data(); }
+	// Among the rects at the given dense indices, the one on the highest layer whose rotated
+	// box contains the point. Returns false if none does.
+	bool pick(const uint32_t* arg_Indices, size_t arg_Count, float arg_X, float arg_Y, SceneHandle& arg_Handle) const;
+	// Handle of the rect at a dense index.
+	SceneHandle getHandle(size_t arg_Index) const;
+
+private:
+	// Rects per job; a multiple of every SIMD width so only the last range has a tail.
+	static const size_t GRAIN = 16384;
+
+	struct Slot
+	{
+		// Dense index while live, next free slot while free.
+		uint32_t index;
+		uint32_t generation;
+	};
+
+	// The kernels take mutable columns; the const passes only read through them.
+	SceneColumns columns() const;
+	const Slot* find(SceneHandle arg_Handle) const;
+
+private:
+	const SceneKernelSet* kernels;
+	SceneBounds bounds{ -1.0f, -1.0f, 1.0f, 1.0f };
+
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> width;
+	std::vector<float> height;
+	std::vector<float> rotation;
+	std::vector<float> layer;
+	std::vector<uint32_t> color;
+	std::vector<float> velocityX;
+	std::vector<float> velocityY;
+	std::vector<float> spin;
+	// Slot of each dense index, to fix up the slot of the rect moved by remove().
+	std::vector<uint32_t> denseSlots;
+
+	std::vector<Slot> slots;
+	uint32_t freeSlot = UINT32_MAX;
+};
@@ -0,0 +1,224 @@
+#include "SceneStreamer.hxx"
+#include "Config.hxx"
+#include "Log.hxx"
+#include "StagingBelt.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace SceneFormat;
+
+namespace
+{
+	template <typename First, typename Second>
+	bool overlaps(const First& arg_First, const Second& arg_Second)
+	{
+		return arg_First.minX <= arg_Second.maxX && arg_First.maxX >= arg_Second.minX
+			&& arg_First.minY <= arg_Second.maxY && arg_First.maxY >= arg_Second.minY;
+	}
+}
+
+SceneStreamer::Settings SceneStreamer::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.budgetBytes = static_cast<uint64_t>(std::clamp(Config::getInt("APP_SCENE_STREAM_BUDGET_MB", 256), 1LL, 1LL << 20)) << 20;
+	settings.uploadBytes = static_cast<uint64_t>(std::clamp(Config::getInt("APP_SCENE_STREAM_UPLOAD_MB", 32), 1LL, 4096LL)) << 20;
+	settings.lodPixels = std::clamp(Config::getDouble("APP_SCENE_STREAM_LOD_PIXELS", 1.0), 0.0, 1024.0);
+	settings.prefetchChunks = static_cast<uint32_t>(std::clamp(Config::getInt("APP_SCENE_STREAM_PREFETCH", 8), 0LL, 1024LL));
+
+	return settings;
+}
+
+SceneStreamer::SceneStreamer(WGPUDevice arg_Device, const SceneFile& arg_File, Settings arg_Settings, uint64_t arg_MaxBufferSize)
+	: file(arg_File),
+	settings(arg_Settings)
+{
+	const ChunkRecord* chunks = file.getChunks();
+	levelChunks.resize(file.getHeader().levelCount);
+	size_t rectChunks = 0;
+	for (uint32_t i = 0; i < file.getChunkCount(); ++i)
+	{
+		if (chunks[i].type != ChunkType::Rects || chunks[i].count == 0) continue;
+
+		levelChunks[chunks[i].level].push_back(i);
+		slotBytes = std::max(slotBytes, chunks[i].size);
+		++rectChunks;
+	}
+	chunkSlot.assign(file.getChunkCount(), NONE);
+	chunkDrawnFrame.assign(file.getChunkCount(), 0);
+	if (rectChunks == 0) return;
+
+	if (slotBytes > arg_MaxBufferSize) throw std::runtime_error("Scene chunks are larger than the device's buffer limit");
+	const uint64_t capacity = std::min(settings.budgetBytes, arg_MaxBufferSize);
+	slotCount = static_cast<uint32_t>(std::clamp<uint64_t>(capacity / slotBytes, 1, rectChunks));
+
+	WGPUBufferDescriptor bufferDesc{};
+	bufferDesc.label = "Scene chunk slots";
+	bufferDesc.size = static_cast<uint64_t>(slotCount) * slotBytes;
+	bufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex;
+	bufferDesc.mappedAtCreation = false;
+	buffer = wgpuDeviceCreateBuffer(arg_Device, &bufferDesc);
+
+	slotChunk.assign(slotCount, NONE);
+	slotUsedFrame.assign(slotCount, 0);
+	visible.reserve(rectChunks);
+	missing.reserve(rectChunks);
+	draws.reserve(rectChunks);
+}
+
+SceneStreamer::~SceneStreamer()
+{
+	if (buffer) wgpuBufferRelease(buffer);
+}
+
+void SceneStreamer::update(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, const SpatialGrid::Box& arg_View, double arg_PixelSize)
+{
+	++frame;
+	draws.clear();
+	visible.clear();
+	missing.clear();
+	if (!buffer) return;
+
+	const uint32_t selected = selectLevel(arg_PixelSize);
+	if (selected != level)
+	{
+		LOG_MSG_SUC("Scene stream level " << selected << ", " << levelChunks[selected].size() << " chunks");
+		level = selected;
+	}
+
+	const ChunkRecord* chunks = file.getChunks();
+	for (uint32_t chunk : levelChunks[level])
+	{
+		if (!overlaps(chunks[chunk].bounds, arg_View)) continue;
+
+		visible.push_back(chunk);
+		if (chunkSlot[chunk] == NONE) missing.push_back(chunk);
+		else slotUsedFrame[chunkSlot[chunk]] = frame;
+	}
+
+	// Nearest to the view center first, so the middle of the screen fills in first.
+	const float centerX = 0.5f * (arg_View.minX + arg_View.maxX);
+	const float centerY = 0.5f * (arg_View.minY + arg_View.maxY);
+	auto distance = [&](uint32_t arg_Chunk)
+	{
+		const SceneBounds& bounds = chunks[arg_Chunk].bounds;
+		const float dx = 0.5f * (bounds.minX + bounds.maxX) - centerX;
+		const float dy = 0.5f * (bounds.minY + bounds.maxY) - centerY;
+		return dx * dx + dy * dy;
+	};
+	std::sort(missing.begin(), missing.end(), [&](uint32_t arg_Left, uint32_t arg_Right) { return distance(arg_Left) < distance(arg_Right); });
+
+	uint64_t uploaded = 0;
+	size_t loaded = 0;
+	for (; loaded < missing.size(); ++loaded)
+	{
+		const ChunkRecord& chunk = chunks[missing[loaded]];
+		if (loaded > 0 && uploaded + chunk.size > settings.uploadBytes) break;
+
+		const uint32_t slot = acquireSlot();
+		if (slot == NONE) break;
+
+		upload(arg_Encoder, arg_Staging, missing[loaded], slot);
+		uploaded += chunk.size;
+	}
+	missing.erase(missing.begin(), missing.begin() + static_cast<std::ptrdiff_t>(loaded));
+
+	// Read ahead what the next frames upload, so the copy does not wait on the disk.
+	for (size_t i = 0; i < std::min<size_t>(missing.size(), settings.prefetchChunks); ++i)
+		file.getMapping().prefetch(chunks[missing[i]].offset, chunks[missing[i]].size);
+
+	// Holes of missing chunks are covered by the finest coarser level resident there.
+	for (uint32_t hole : missing)
+	{
+		for (size_t coarser = level + 1; coarser < levelChunks.size(); ++coarser)
+		{
+			bool covered = false;
+			for (uint32_t chunk : levelChunks[coarser])
+			{
+				if (chunkSlot[chunk] == NONE || !overlaps(chunks[chunk].bounds, chunks[hole].bounds)) continue;
+
+				covered = true;
+				if (chunkDrawnFrame[chunk] != frame) addDraw(chunk);
+			}
+			if (covered) break;
+		}
+	}
+
+	for (uint32_t chunk : visible)
+	{
+		if (chunkSlot[chunk] != NONE) addDraw(chunk);
+	}
+}
+
+SceneStreamer::Stats SceneStreamer::getStats() const
+{
+	Stats stats{};
+	stats.slots = slotCount;
+	stats.resident = static_cast<uint32_t>(std::count_if(slotChunk.begin(), slotChunk.end(), [](uint32_t arg_Chunk) { return arg_Chunk != NONE; }));
+	stats.missing = static_cast<uint32_t>(missing.size());
+	stats.level = level;
+	stats.chunksUploaded = chunksUploaded;
+	stats.bytesUploaded = bytesUploaded;
+	stats.evictions = evictions;
+
+	return stats;
+}
+
+uint32_t SceneStreamer::selectLevel(double arg_PixelSize) const
+{
+	const Header& header = file.getHeader();
+	const double limit = settings.lodPixels * arg_PixelSize;
+	uint32_t coarsest = 0;
+	for (uint32_t candidate = 0; candidate < header.levelCount; ++candidate)
+	{
+		if (levelChunks[candidate].empty()) continue;
+		if (header.levelSizes[candidate] >= limit) return candidate;
+		coarsest = candidate;
+	}
+	return coarsest;
+}
+
+uint32_t SceneStreamer::acquireSlot()
+{
+	uint32_t oldest = NONE;
+	for (uint32_t slot = 0; slot < slotCount; ++slot)
+	{
+		if (slotChunk[slot] == NONE) return slot;
+		if (slotUsedFrame[slot] == frame) continue;
+		if (oldest == NONE || slotUsedFrame[slot] < slotUsedFrame[oldest]) oldest = slot;
+	}
+	return oldest;
+}
+
+void SceneStreamer::upload(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, uint32_t arg_Chunk, uint32_t arg_Slot)
+{
+	const ChunkRecord& chunk = file.getChunks()[arg_Chunk];
+	if (slotChunk[arg_Slot] != NONE)
+	{
+		chunkSlot[slotChunk[arg_Slot]] = NONE;
+		++evictions;
+	}
+
+	// The only copy on the CPU: from the page cache into memory the GPU copies from.
+	void* target = arg_Staging.write(arg_Encoder, buffer, static_cast<uint64_t>(arg_Slot) * slotBytes, chunk.size);
+	std::memcpy(target, file.getChunkData(chunk), chunk.size);
+	// The pages stay in the page cache; dropping them from the mapping keeps the resident
+	// set at what the GPU does not hold yet.
+	file.getMapping().release(chunk.offset, chunk.size);
+
+	slotChunk[arg_Slot] = arg_Chunk;
+	slotUsedFrame[arg_Slot] = frame;
+	chunkSlot[arg_Chunk] = arg_Slot;
+	++chunksUploaded;
+	bytesUploaded += chunk.size;
+}
+
+void SceneStreamer::addDraw(uint32_t arg_Chunk)
+{
+	const ChunkRecord& chunk = file.getChunks()[arg_Chunk];
+	const uint32_t slot = chunkSlot[arg_Chunk];
+	chunkDrawnFrame[arg_Chunk] = frame;
+	slotUsedFrame[slot] = frame;
+	draws.push_back({ static_cast<uint32_t>(static_cast<uint64_t>(slot) * slotBytes / sizeof(RectInstance)), chunk.count, chunk.level });
+}
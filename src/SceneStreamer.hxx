@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+#include "SceneFile.hxx"
+#include "SpatialGrid.hxx"
+
+class StagingBelt;
+
+// Keeps the rect chunks of a scene file that the view needs resident on the GPU. One vertex
+// buffer is cut into slots the size of the largest chunk; a chunk is copied from the file
+// mapping straight into staging memory and from there into a free slot, or into the least
+// recently drawn one once all are taken. The level drawn is the finest whose features are at
+// least the LOD size on screen, or the coarsest if none is. Uploads are capped per frame, so
+// moving the view never stalls a frame on reading the file; while chunks of the level are
+// missing, resident chunks of coarser levels covering them are drawn in their place, and the
+// next missing chunks are prefetched from disk in the background.
+//   APP_SCENE_STREAM_BUDGET_MB  GPU memory for resident chunks (default 256)
+//   APP_SCENE_STREAM_UPLOAD_MB  chunk bytes uploaded per frame, at least one chunk (default 32)
+//   APP_SCENE_STREAM_LOD_PIXELS a level is replaced by the next coarser one once its features
+//                               are smaller on screen than this many pixels (default 1)
+//   APP_SCENE_STREAM_PREFETCH   missing chunks prefetched per frame (default 8)
+class SceneStreamer
+{
+public:
+	struct Settings
+	{
+		uint64_t budgetBytes;
+		uint64_t uploadBytes;
+		double lodPixels;
+		uint32_t prefetchChunks;
+
+		static Settings fromConfig();
+	};
+
+	// One instanced draw of a resident chunk; levels above 0 are tiles, drawn as unit quads.
+	struct Draw
+	{
+		uint32_t firstInstance;
+		uint32_t count;
+		uint32_t level;
+	};
+
+	struct Stats
+	{
+		uint32_t slots;
+		uint32_t resident;
+		uint32_t missing;
+		uint32_t level;
+		uint64_t chunksUploaded;
+		uint64_t bytesUploaded;
+		uint64_t evictions;
+	};
+
+	// The file must outlive the streamer. arg_MaxBufferSize is the device limit the slot
+	// buffer has to fit in.
+	SceneStreamer(WGPUDevice arg_Device, const SceneFile& arg_File, Settings arg_Settings, uint64_t arg_MaxBufferSize);
+	~SceneStreamer();
+
+	SceneStreamer(const SceneStreamer&) = delete;
+	SceneStreamer& operator=(const SceneStreamer&) = delete;
+
+	// Selects the level and chunks for the view, records the uploads of missing ones and
+	// rebuilds the draw list. arg_PixelSize is world units per pixel.
+	void update(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, const SpatialGrid::Box& arg_View, double arg_PixelSize);
+
+	// Coarser fallback chunks come first, so the chunks of the level are drawn over them.
+	const std::vector<Draw>& getDraws() const { return draws; }
+	WGPUBuffer getBuffer() const { return buffer; }
+	Stats getStats() const;
+
+private:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	uint32_t selectLevel(double arg_PixelSize) const;
+	// A free slot, or the least recently drawn one not drawn this frame; NONE if all are.
+	uint32_t acquireSlot();
+	void upload(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, uint32_t arg_Chunk, uint32_t arg_Slot);
+	void addDraw(uint32_t arg_Chunk);
+
+private:
+	const SceneFile& file;
+	Settings settings;
+	WGPUBuffer buffer = nullptr;
+	uint64_t slotBytes = 0;
+	uint32_t slotCount = 0;
+
+	// Indices of the rect chunks on each level.
+	std::vector<std::vector<uint32_t>> levelChunks;
+	// Per chunk of the file.
+	std::vector<uint32_t> chunkSlot;
+	std::vector<uint64_t> chunkDrawnFrame;
+	// Per slot.
+	std::vector<uint32_t> slotChunk;
+	std::vector<uint64_t> slotUsedFrame;
+
+	uint64_t frame = 0;
+	uint32_t level = 0;
+	// Chunks of the level in the view, and those of them not resident.
+	std::vector<uint32_t> visible;
+	std::vector<uint32_t> missing;
+	std::vector<Draw> draws;
+	uint64_t chunksUploaded = 0;
+	uint64_t bytesUploaded = 0;
+	uint64_t evictions = 0;
+};
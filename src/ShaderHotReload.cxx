@@ -0,0 +1,341 @@
+#include "ShaderHotReload.hxx"
+#include "AllocationTracker.hxx"
+#include "GpuDebug.hxx"
+#include "Log.hxx"
+#include "Profiler.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace
+{
+	const int WATCH_POLL_MS = 200;
+	const int DEBOUNCE_MS = 50;
+}
+
+ShaderHotReloader::ShaderHotReloader(WGPUDevice arg_Device, std::string arg_ShaderPath, SourceLoader arg_SourceLoader, PipelineBuilder arg_PipelineBuilder)
+	: device(arg_Device),
+	shaderPath(std::move(arg_ShaderPath)),
+	sourceLoader(std::move(arg_SourceLoader)),
+	pipelineBuilder(std::move(arg_PipelineBuilder))
+{
+}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+	stop();
+
+	if (modulesCreated.load() != modulesReleased.load())
+	{
+		LOG_MSG_ERR("Shader hot reload leaked " << (modulesCreated.load() - modulesReleased.load()) << " shader modules");
+	}
+	if (pipelinesCreated.load() != pipelinesReleased.load() + swaps.load())
+	{
+		LOG_MSG_ERR("Shader hot reload leaked " << (pipelinesCreated.load() - pipelinesReleased.load() - swaps.load()) << " pipelines");
+	}
+}
+
+void ShaderHotReloader::start()
+{
+	if (running.exchange(true)) return;
+
+#ifdef __linux__
+	inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotifyFd >= 0)
+	{
+		// Watch the directory rather than the file: most editors save by writing a temporary
+		// file and renaming it over the original, which would orphan a file watch.
+		std::string directory = std::filesystem::path(shaderPath).parent_path().string();
+		watchDescriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (watchDescriptor < 0)
+		{
+			close(inotifyFd);
+			inotifyFd = -1;
+		}
+	}
+	if (inotifyFd >= 0) wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+	watchThread = std::thread(&ShaderHotReloader::watchThreadMain, this);
+
+	LOG_MSG_SUC("Watching shader: " << shaderPath);
+}
+
+void ShaderHotReloader::stop()
+{
+	if (!running.exchange(false)) return;
+
+	wake();
+	if (watchThread.joinable()) watchThread.join();
+
+	// Nothing takes it once stopped.
+	WGPURenderPipeline leftover = pendingPipeline.exchange(nullptr);
+	if (leftover)
+	{
+		wgpuRenderPipelineRelease(leftover);
+		pipelinesReleased.fetch_add(1);
+	}
+
+#ifdef __linux__
+	if (inotifyFd >= 0)
+	{
+		if (watchDescriptor >= 0) inotify_rm_watch(inotifyFd, watchDescriptor);
+		close(inotifyFd);
+		inotifyFd = -1;
+		watchDescriptor = -1;
+	}
+	if (wakeFd >= 0)
+	{
+		close(wakeFd);
+		wakeFd = -1;
+	}
+#endif
+}
+
+void ShaderHotReloader::requestReload()
+{
+	reloadRequested.store(true);
+	wake();
+}
+
+void ShaderHotReloader::wake()
+{
+#ifdef __linux__
+	if (wakeFd >= 0)
+	{
+		const uint64_t one = 1;
+		ssize_t written = write(wakeFd, &one, sizeof(one));
+		(void)written;
+	}
+#endif
+	// Taken so a notify can't slip in between the waiter's predicate check and its wait.
+	std::lock_guard<std::mutex> lock(wakeMutex);
+	wakeCondition.notify_all();
+}
+
+WGPURenderPipeline ShaderHotReloader::takePendingPipeline()
+{
+	if (!pendingPipeline.load(std::memory_order_relaxed)) return nullptr;
+
+	WGPURenderPipeline fresh = pendingPipeline.exchange(nullptr, std::memory_order_acquire);
+	if (fresh) swaps.fetch_add(1, std::memory_order_relaxed);
+
+	return fresh;
+}
+
+ShaderHotReloader::Stats ShaderHotReloader::getStats() const
+{
+	Stats stats{};
+	stats.reloads = reloads.load();
+	stats.failures = failures.load();
+	stats.swaps = swaps.load();
+	stats.modulesCreated = modulesCreated.load();
+	stats.modulesReleased = modulesReleased.load();
+	stats.pipelinesCreated = pipelinesCreated.load();
+	stats.pipelinesReleased = pipelinesReleased.load();
+	stats.lastCompileMs = lastCompileMs.load();
+
+	return stats;
+}
+
+void ShaderHotReloader::watchThreadMain()
+{
+	Profiler::instance().setThreadName("shader-reload");
+	AllocationTracker::setThreadName("shader-reload");
+
+	while (running.load())
+	{
+		// A pending request skips the wait, so back-to-back requests don't each sit out a poll.
+		if (reloadRequested.exchange(false) || waitForChange())
+		{
+			rebuild();
+		}
+	}
+}
+
+bool ShaderHotReloader::waitForChange()
+{
+	auto isShaderFile = [](const std::string& arg_Name)
+		{
+			return std::filesystem::path(arg_Name).extension() == ".wgsl";
+		};
+
+#ifdef __linux__
+	if (inotifyFd >= 0)
+	{
+		pollfd pollDescs[2]{};
+		pollDescs[0].fd = inotifyFd;
+		pollDescs[0].events = POLLIN;
+		pollDescs[1].fd = wakeFd;
+		pollDescs[1].events = POLLIN;
+
+		bool changed = false;
+		int timeout = WATCH_POLL_MS;
+
+		// Keep draining until the directory has been quiet for DEBOUNCE_MS, so that a
+		// truncate + write + close sequence results in a single rebuild. A reload request or
+		// stop() ends the wait early.
+		while (poll(pollDescs, wakeFd >= 0 ? 2 : 1, timeout) > 0)
+		{
+			if (pollDescs[1].revents & POLLIN)
+			{
+				uint64_t count = 0;
+				ssize_t length = read(wakeFd, &count, sizeof(count));
+				(void)length;
+				break;
+			}
+
+			alignas(inotify_event) char buffer[4096];
+			ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+			for (ssize_t offset = 0; offset < length;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				if (event->len > 0 && isShaderFile(event->name)) changed = true;
+				offset += sizeof(inotify_event) + event->len;
+			}
+
+			if (!changed) break;
+			timeout = DEBOUNCE_MS;
+		}
+
+		return changed;
+	}
+#endif
+
+	{
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCondition.wait_for(lock, std::chrono::milliseconds(WATCH_POLL_MS),
+			[this]() { return reloadRequested.load() || !running.load(); });
+	}
+
+	std::error_code err;
+	std::filesystem::file_time_type writeTime{};
+	for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::path(shaderPath).parent_path(), err))
+	{
+		if (!isShaderFile(entry.path().string())) continue;
+		writeTime = std::max(writeTime, entry.last_write_time(err));
+	}
+	if (err || writeTime == lastWriteTime) return false;
+
+	bool firstCheck = lastWriteTime == std::filesystem::file_time_type{};
+	lastWriteTime = writeTime;
+
+	return !firstCheck;
+}
+
+void ShaderHotReloader::rebuild()
+{
+	PROFILE_ZONE("shaderRebuild");
+
+	std::string source;
+	try
+	{
+		source = sourceLoader();
+	}
+	catch (const std::exception& err)
+	{
+		LOG_MSG_ERR("Could not load shader: " << err.what());
+		(void)err;
+		failures.fetch_add(1);
+		return;
+	}
+
+	reloads.fetch_add(1);
+
+	auto start = std::chrono::steady_clock::now();
+	WGPURenderPipeline fresh = compileAndValidate(source);
+	lastCompileMs.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+	if (!fresh)
+	{
+		failures.fetch_add(1);
+		return;
+	}
+
+	// If the render thread hasn't picked up the previous result yet it is simply superseded.
+	WGPURenderPipeline superseded = pendingPipeline.exchange(fresh, std::memory_order_release);
+	if (superseded)
+	{
+		wgpuRenderPipelineRelease(superseded);
+		pipelinesReleased.fetch_add(1);
+	}
+
+	LOG_MSG_SUC("Reloaded shader in " << lastCompileMs.load() << " ms");
+}
+
+WGPURenderPipeline ShaderHotReloader::compileAndValidate(const std::string& arg_Source)
+{
+	struct UserData
+	{
+		bool failed;
+		std::string message;
+	};
+	UserData userData{};
+
+	auto onErrorScopePopped =
+		[](WGPUErrorType arg_ErrorType, char const* arg_Message, void* arg_UserData)
+		{
+			UserData& userData = *reinterpret_cast<UserData*>(arg_UserData);
+
+			if (arg_ErrorType != WGPUErrorType_NoError)
+			{
+				userData.failed = true;
+				if (arg_Message) userData.message = arg_Message;
+			}
+		};
+
+	WGPUShaderModuleWGSLDescriptor shaderWGSLDesc{};
+	shaderWGSLDesc.chain.next = nullptr;
+	shaderWGSLDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
+	shaderWGSLDesc.code = arg_Source.c_str();
+
+	WGPUShaderModuleDescriptor shaderDesc{};
+	shaderDesc.nextInChain = &shaderWGSLDesc.chain;
+	shaderDesc.label = "Hot reloaded shader";
+
+	// wgpu-native does not implement wgpuShaderModuleGetCompilationInfo yet, so validation
+	// relies on an error scope around both the module and the pipeline that uses it. That
+	// also catches interface mismatches the module alone would not report. This runs off the
+	// render thread and only on reload, so it stays enabled without GPU_VALIDATION. The
+	// scope stack is shared with the render thread's scopes, so this waits for the stack
+	// and holds it until the pop; the render thread's scopes skip rather than wait.
+	// The stack is per device, not per thread: a validation error the render thread raises
+	// meanwhile lands in this scope too, rejecting the reload (the next change retries) and
+	// going unreported on the render side, whose frame scope is skipped for that frame.
+	GpuDebug::ValidationScope scope(device, true);
+
+	WGPUShaderModule shaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+	WGPURenderPipeline fresh = nullptr;
+	if (shaderModule)
+	{
+		modulesCreated.fetch_add(1);
+		fresh = pipelineBuilder(shaderModule);
+		if (fresh) pipelinesCreated.fetch_add(1);
+		wgpuShaderModuleRelease(shaderModule);
+		modulesReleased.fetch_add(1);
+	}
+
+	scope.pop(onErrorScopePopped, &userData);
+
+	if (userData.failed || !shaderModule)
+	{
+		LOG_MSG_ERR("Shader reload rejected: " << userData.message);
+		if (fresh)
+		{
+			wgpuRenderPipelineRelease(fresh);
+			pipelinesReleased.fetch_add(1);
+		}
+		return nullptr;
+	}
+
+	return fresh;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <webgpu/webgpu.h>
+
+// Keeps a render pipeline built from WGSL files on disk up to date. Changes to any .wgsl file
+// in the shader's directory (so #included files count too) are picked up on a watcher thread
+// (inotify on Linux, mtime polling elsewhere), compiled and validated there, and handed to the render thread through a single atomic
+// slot so that the swap itself costs one exchange between frames.
+class ShaderHotReloader
+{
+public:
+	using SourceLoader = std::function<std::string()>;
+	using PipelineBuilder = std::function<WGPURenderPipeline(WGPUShaderModule)>;
+
+	struct Stats
+	{
+		uint64_t reloads;
+		uint64_t failures;
+		uint64_t swaps;
+		uint64_t modulesCreated;
+		uint64_t modulesReleased;
+		// Every pipeline built on reload is either released here (rejected, superseded before
+		// it was taken, or pending at stop()) or counted in swaps and owned by the caller.
+		uint64_t pipelinesCreated;
+		uint64_t pipelinesReleased;
+		double lastCompileMs;
+	};
+
+	// arg_SourceLoader runs on the watcher thread and may throw to reject a reload.
+	ShaderHotReloader(WGPUDevice arg_Device, std::string arg_ShaderPath, SourceLoader arg_SourceLoader, PipelineBuilder arg_PipelineBuilder);
+	~ShaderHotReloader();
+
+	ShaderHotReloader(const ShaderHotReloader&) = delete;
+	ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+	void start();
+	void stop();
+
+	// Forces a rebuild from the current file contents, even if it didn't change on disk.
+	// Requests made before the watcher gets to them are merged into one rebuild.
+	void requestReload();
+
+	// Render thread only. Returns the most recent successfully validated pipeline, or nullptr
+	// if nothing new arrived since the last call. Ownership passes to the caller.
+	WGPURenderPipeline takePendingPipeline();
+
+	Stats getStats() const;
+
+private:
+	void watchThreadMain();
+	bool waitForChange();
+	// Ends the watcher's current wait.
+	void wake();
+	void rebuild();
+	WGPURenderPipeline compileAndValidate(const std::string& arg_Source);
+
+private:
+	WGPUDevice device;
+	std::string shaderPath;
+	SourceLoader sourceLoader;
+	PipelineBuilder pipelineBuilder;
+
+	std::thread watchThread;
+	std::atomic<bool> running{ false };
+	std::atomic<bool> reloadRequested{ false };
+	std::atomic<WGPURenderPipeline> pendingPipeline{ nullptr };
+
+	std::atomic<uint64_t> reloads{ 0 };
+	std::atomic<uint64_t> failures{ 0 };
+	std::atomic<uint64_t> swaps{ 0 };
+	std::atomic<uint64_t> modulesCreated{ 0 };
+	std::atomic<uint64_t> modulesReleased{ 0 };
+	std::atomic<uint64_t> pipelinesCreated{ 0 };
+	std::atomic<uint64_t> pipelinesReleased{ 0 };
+	std::atomic<double> lastCompileMs{ 0.0 };
+
+	std::filesystem::file_time_type lastWriteTime{};
+	int inotifyFd = -1;
+	int watchDescriptor = -1;
+	// eventfd polled next to inotifyFd; the condition variable wakes the polling fallback.
+	int wakeFd = -1;
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+};
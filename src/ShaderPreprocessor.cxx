@@ -0,0 +1,366 @@
+#include "ShaderPreprocessor.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	const int MAX_INCLUDE_DEPTH = 16;
+
+	bool isIdentStart(char arg_Char)
+	{
+		return std::isalpha(static_cast<unsigned char>(arg_Char)) || arg_Char == '_';
+	}
+
+	bool isIdentChar(char arg_Char)
+	{
+		return std::isalnum(static_cast<unsigned char>(arg_Char)) || arg_Char == '_';
+	}
+
+	std::string trim(const std::string& arg_Text)
+	{
+		size_t begin = arg_Text.find_first_not_of(" \t\r");
+		if (begin == std::string::npos) return {};
+		size_t end = arg_Text.find_last_not_of(" \t\r");
+		return arg_Text.substr(begin, end - begin + 1);
+	}
+
+	// Recursive descent over a single #if expression. Precedence, loosest first:
+	// || , && , == != , < <= > >= , + - , * / , unary ! - , primary
+	class ExpressionParser
+	{
+	public:
+		ExpressionParser(const std::string& arg_Text, const ShaderPreprocessor::Defines& arg_Defines, const std::string& arg_Location)
+			: ExpressionParser(arg_Text, arg_Defines, arg_Location, ownExpanding)
+		{
+		}
+
+		long long parse()
+		{
+			long long value = parseOr();
+			skipSpace();
+			if (pos != text.size()) fail("unexpected '" + text.substr(pos) + "'");
+			return value;
+		}
+
+	private:
+		// Parses a macro's value while the macros in arg_Expanding are being expanded.
+		ExpressionParser(const std::string& arg_Text, const ShaderPreprocessor::Defines& arg_Defines, const std::string& arg_Location, std::vector<std::string>& arg_Expanding)
+			: text(arg_Text), defines(arg_Defines), location(arg_Location), expanding(arg_Expanding)
+		{
+		}
+
+		[[noreturn]] void fail(const std::string& arg_Message) const
+		{
+			throw std::runtime_error(location + ": #if " + arg_Message);
+		}
+
+		void skipSpace()
+		{
+			while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+		}
+
+		bool accept(const char* arg_Token)
+		{
+			skipSpace();
+			size_t length = std::char_traits<char>::length(arg_Token);
+			if (text.compare(pos, length, arg_Token) != 0) return false;
+			pos += length;
+			return true;
+		}
+
+		std::string parseIdentifier()
+		{
+			skipSpace();
+			size_t begin = pos;
+			while (pos < text.size() && isIdentChar(text[pos])) ++pos;
+			if (begin == pos) fail("expected identifier");
+			return text.substr(begin, pos - begin);
+		}
+
+		long long parseOr()
+		{
+			long long value = parseAnd();
+			while (accept("||")) value = (parseAnd() || value) ? 1 : 0;
+			return value;
+		}
+
+		long long parseAnd()
+		{
+			long long value = parseEquality();
+			while (accept("&&")) value = (parseEquality() && value) ? 1 : 0;
+			return value;
+		}
+
+		long long parseEquality()
+		{
+			long long value = parseRelational();
+			for (;;)
+			{
+				if (accept("==")) value = value == parseRelational();
+				else if (accept("!=")) value = value != parseRelational();
+				else return value;
+			}
+		}
+
+		long long parseRelational()
+		{
+			long long value = parseAdditive();
+			for (;;)
+			{
+				if (accept("<=")) value = value <= parseAdditive();
+				else if (accept(">=")) value = value >= parseAdditive();
+				else if (accept("<")) value = value < parseAdditive();
+				else if (accept(">")) value = value > parseAdditive();
+				else return value;
+			}
+		}
+
+		long long parseAdditive()
+		{
+			long long value = parseMultiplicative();
+			for (;;)
+			{
+				if (accept("+")) value += parseMultiplicative();
+				else if (accept("-")) value -= parseMultiplicative();
+				else return value;
+			}
+		}
+
+		long long parseMultiplicative()
+		{
+			long long value = parseUnary();
+			for (;;)
+			{
+				if (accept("*")) value *= parseUnary();
+				else if (accept("/"))
+				{
+					long long divisor = parseUnary();
+					if (divisor == 0) fail("division by zero");
+					value /= divisor;
+				}
+				else return value;
+			}
+		}
+
+		long long parseUnary()
+		{
+			if (accept("!")) return !parseUnary();
+			if (accept("-")) return -parseUnary();
+			return parsePrimary();
+		}
+
+		long long parsePrimary()
+		{
+			skipSpace();
+			if (accept("("))
+			{
+				long long value = parseOr();
+				if (!accept(")")) fail("expected ')'");
+				return value;
+			}
+
+			if (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])))
+			{
+				size_t begin = pos;
+				while (pos < text.size() && isIdentChar(text[pos])) ++pos;
+				return std::strtoll(text.substr(begin, pos - begin).c_str(), nullptr, 0);
+			}
+
+			std::string name = parseIdentifier();
+			if (name == "defined")
+			{
+				bool parenthesised = accept("(");
+				std::string macro = parseIdentifier();
+				if (parenthesised && !accept(")")) fail("expected ')'");
+				return defines.count(macro) ? 1 : 0;
+			}
+
+			auto found = defines.find(name);
+			if (found == defines.end() || found->second.empty()) return 0;
+
+			// Macro values are themselves expressions, e.g. "#define AA_SAMPLES (2 * 2)". One
+			// that leads back to itself, directly or through others, would never end.
+			if (std::find(expanding.begin(), expanding.end(), name) != expanding.end())
+				fail("macro " + name + " refers to itself");
+
+			expanding.push_back(name);
+			const long long value = ExpressionParser(found->second, defines, location, expanding).parse();
+			expanding.pop_back();
+			return value;
+		}
+
+	private:
+		const std::string& text;
+		const ShaderPreprocessor::Defines& defines;
+		const std::string& location;
+		std::vector<std::string> ownExpanding;
+		std::vector<std::string>& expanding;
+		size_t pos = 0;
+	};
+}
+
+ShaderPreprocessor::ShaderPreprocessor(Defines arg_Defines)
+	: defines(std::move(arg_Defines))
+{
+}
+
+std::string ShaderPreprocessor::process(const std::string& arg_Path)
+{
+	includedFiles.clear();
+	dependencies.clear();
+
+	std::string output;
+	processFile(arg_Path, output, 0);
+
+	return output;
+}
+
+void ShaderPreprocessor::processFile(const std::string& arg_Path, std::string& arg_Output, int arg_Depth)
+{
+	if (arg_Depth > MAX_INCLUDE_DEPTH)
+		throw std::runtime_error(arg_Path + ": #include nested too deeply");
+
+	std::string canonical = std::filesystem::weakly_canonical(arg_Path).string();
+	if (!includedFiles.insert(canonical).second) return;
+	dependencies.push_back(canonical);
+
+	std::ifstream file(arg_Path);
+	if (!file) throw std::runtime_error("Could not open shader file: " + arg_Path);
+
+	std::vector<ConditionalState> conditionals;
+	auto isActive = [&conditionals]() { return conditionals.empty() || conditionals.back().active; };
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+		const std::string location = arg_Path + ":" + std::to_string(lineNumber);
+		std::string trimmed = trim(line);
+
+		if (trimmed.empty() || trimmed[0] != '#')
+		{
+			if (isActive())
+			{
+				arg_Output += substitute(line);
+				arg_Output += '\n';
+			}
+			continue;
+		}
+
+		size_t directiveEnd = 1;
+		while (directiveEnd < trimmed.size() && isIdentChar(trimmed[directiveEnd])) ++directiveEnd;
+		std::string directive = trimmed.substr(1, directiveEnd - 1);
+		std::string rest = trim(trimmed.substr(directiveEnd));
+
+		if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+		{
+			ConditionalState state{};
+			state.parentActive = isActive();
+
+			bool condition = false;
+			if (state.parentActive)
+			{
+				if (directive == "if") condition = evaluate(rest, location);
+				else if (directive == "ifdef") condition = defines.count(rest) != 0;
+				else condition = defines.count(rest) == 0;
+			}
+
+			state.active = state.parentActive && condition;
+			state.anyTaken = state.active;
+			conditionals.push_back(state);
+		}
+		else if (directive == "elif" || directive == "else")
+		{
+			if (conditionals.empty() || conditionals.back().seenElse)
+				throw std::runtime_error(location + ": unexpected #" + directive);
+
+			ConditionalState& state = conditionals.back();
+			bool condition = directive == "else" || (state.parentActive && !state.anyTaken && evaluate(rest, location));
+
+			state.active = state.parentActive && !state.anyTaken && condition;
+			state.anyTaken = state.anyTaken || state.active;
+			state.seenElse = directive == "else";
+		}
+		else if (directive == "endif")
+		{
+			if (conditionals.empty()) throw std::runtime_error(location + ": unexpected #endif");
+			conditionals.pop_back();
+		}
+		else if (!isActive())
+		{
+			continue;
+		}
+		else if (directive == "include")
+		{
+			size_t open = rest.find('"');
+			size_t close = rest.rfind('"');
+			if (open == std::string::npos || close <= open)
+				throw std::runtime_error(location + ": expected #include \"file\"");
+
+			std::filesystem::path includePath = std::filesystem::path(arg_Path).parent_path() / rest.substr(open + 1, close - open - 1);
+			processFile(includePath.string(), arg_Output, arg_Depth + 1);
+		}
+		else if (directive == "define")
+		{
+			size_t nameEnd = 0;
+			while (nameEnd < rest.size() && isIdentChar(rest[nameEnd])) ++nameEnd;
+			if (nameEnd == 0 || !isIdentStart(rest[0])) throw std::runtime_error(location + ": expected macro name");
+
+			defines[rest.substr(0, nameEnd)] = trim(rest.substr(nameEnd));
+		}
+		else if (directive == "undef")
+		{
+			defines.erase(rest);
+		}
+		else
+		{
+			throw std::runtime_error(location + ": unknown directive #" + directive);
+		}
+	}
+
+	if (!conditionals.empty()) throw std::runtime_error(arg_Path + ": missing #endif");
+}
+
+bool ShaderPreprocessor::evaluate(const std::string& arg_Expression, const std::string& arg_Location) const
+{
+	return ExpressionParser(arg_Expression, defines, arg_Location).parse() != 0;
+}
+
+std::string ShaderPreprocessor::substitute(const std::string& arg_Line) const
+{
+	if (defines.empty()) return arg_Line;
+
+	std::string result;
+	result.reserve(arg_Line.size());
+
+	size_t pos = 0;
+	while (pos < arg_Line.size())
+	{
+		if (arg_Line.compare(pos, 2, "//") == 0)
+		{
+			result.append(arg_Line, pos, std::string::npos);
+			break;
+		}
+
+		if (!isIdentStart(arg_Line[pos]))
+		{
+			result += arg_Line[pos++];
+			continue;
+		}
+
+		size_t begin = pos;
+		while (pos < arg_Line.size() && isIdentChar(arg_Line[pos])) ++pos;
+		std::string identifier = arg_Line.substr(begin, pos - begin);
+
+		auto found = defines.find(identifier);
+		result += (found != defines.end() && !found->second.empty()) ? found->second : identifier;
+	}
+
+	return result;
+}
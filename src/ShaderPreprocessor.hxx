@@ -0,0 +1,45 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Minimal C-style preprocessor for WGSL, which has no include or conditional compilation of
+// its own. Supports:
+//   #include "file.wgsl"   (relative to the including file, each file included once)
+//   #define NAME [value] / #undef NAME
+//   #if expr / #ifdef NAME / #ifndef NAME / #elif expr / #else / #endif
+// Expressions accept integers, macro names (undefined names evaluate to 0), defined(NAME),
+// parentheses, ! && || == != < <= > >= + - * /. Defined macros are substituted in code lines.
+// Errors are reported by throwing std::runtime_error with file and line.
+class ShaderPreprocessor
+{
+public:
+	using Defines = std::map<std::string, std::string>;
+
+	explicit ShaderPreprocessor(Defines arg_Defines = {});
+
+	std::string process(const std::string& arg_Path);
+
+	// Every file read by the last process() call, in inclusion order.
+	const std::vector<std::string>& getDependencies() const { return dependencies; }
+
+private:
+	struct ConditionalState
+	{
+		bool parentActive;
+		bool active;
+		bool anyTaken;
+		bool seenElse;
+	};
+
+	void processFile(const std::string& arg_Path, std::string& arg_Output, int arg_Depth);
+	bool evaluate(const std::string& arg_Expression, const std::string& arg_Location) const;
+	std::string substitute(const std::string& arg_Line) const;
+
+private:
+	Defines defines;
+	std::set<std::string> includedFiles;
+	std::vector<std::string> dependencies;
+};
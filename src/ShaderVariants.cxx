@@ -0,0 +1,156 @@
+#include "ShaderVariants.hxx"
+#include "Log.hxx"
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	double millisecondsSince(std::chrono::steady_clock::time_point arg_Start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - arg_Start).count();
+	}
+}
+
+std::string ShaderVariantKey::moduleKey() const
+{
+	// Defines is an ordered map, so the key is canonical regardless of insertion order.
+	std::ostringstream key;
+	for (const auto& define : defines)
+		key << define.first << '=' << define.second << ';';
+
+	return key.str();
+}
+
+std::string ShaderVariantKey::pipelineKey() const
+{
+	std::ostringstream key;
+	key << moduleKey() << "|blend=" << blending << "|format=" << colorFormat << "|samples=" << sampleCount;
+
+	return key.str();
+}
+
+ShaderVariantCache::ShaderVariantCache(WGPUDevice arg_Device, std::string arg_ShaderPath, PipelineBuilder arg_PipelineBuilder)
+	: device(arg_Device), shaderPath(std::move(arg_ShaderPath)), pipelineBuilder(std::move(arg_PipelineBuilder))
+{
+}
+
+ShaderVariantCache::~ShaderVariantCache()
+{
+	clear();
+}
+
+WGPURenderPipeline ShaderVariantCache::getPipeline(const ShaderVariantKey& arg_Key)
+{
+	const std::string key = arg_Key.pipelineKey();
+
+	auto found = variants.find(key);
+	if (found != variants.end())
+	{
+		++found->second.stats.uses;
+		return found->second.pipeline;
+	}
+
+	Variant variant{};
+	variant.stats.key = key;
+	variant.stats.uses = 1;
+
+	auto start = std::chrono::steady_clock::now();
+	WGPUShaderModule shaderModule = getModule(arg_Key, variant.stats.preprocessMs);
+	variant.pipeline = pipelineBuilder(shaderModule, arg_Key);
+	variant.stats.compileMs = millisecondsSince(start);
+
+	if (!variant.pipeline) throw std::runtime_error("Could not create pipeline variant " + key);
+
+	LOG_MSG_SUC("Built shader variant [" << key << "] in " << variant.stats.compileMs << " ms");
+	++pipelineCounts.built;
+
+	variants.emplace(key, variant);
+	return variant.pipeline;
+}
+
+void ShaderVariantCache::adopt(const ShaderVariantKey& arg_Key, WGPURenderPipeline arg_Pipeline)
+{
+	clear();
+	cooked.reset();
+
+	Variant variant{};
+	variant.pipeline = arg_Pipeline;
+	variant.stats.key = arg_Key.pipelineKey();
+	variants.emplace(variant.stats.key, variant);
+	++pipelineCounts.adopted;
+}
+
+void ShaderVariantCache::clear()
+{
+	for (auto& variant : variants)
+		wgpuRenderPipelineRelease(variant.second.pipeline);
+	pipelineCounts.released += variants.size();
+	variants.clear();
+
+	for (auto& shaderModule : modules)
+		wgpuShaderModuleRelease(shaderModule.second);
+	modules.clear();
+}
+
+std::string ShaderVariantCache::preprocess(const ShaderVariantKey& arg_Key) const
+{
+	ShaderPreprocessor preprocessor(arg_Key.defines);
+	return preprocessor.process(shaderPath);
+}
+
+std::vector<ShaderVariantCache::VariantStats> ShaderVariantCache::getStats() const
+{
+	std::vector<VariantStats> stats;
+	stats.reserve(variants.size());
+	for (const auto& variant : variants)
+		stats.push_back(variant.second.stats);
+
+	return stats;
+}
+
+void ShaderVariantCache::logStats() const
+{
+#ifdef DEBUG_MODE
+	LOG_MSG_SUC("Shader variants: " << variants.size() << " pipelines, " << modules.size() << " modules");
+	for (const auto& variant : variants)
+	{
+		LOG_MSG_SUC(" - [" << variant.first << "] preprocess " << variant.second.stats.preprocessMs
+			<< " ms, compile " << variant.second.stats.compileMs << " ms, " << variant.second.stats.uses << " uses");
+	}
+#endif
+}
+
+WGPUShaderModule ShaderVariantCache::getModule(const ShaderVariantKey& arg_Key, double& arg_PreprocessMs)
+{
+	arg_PreprocessMs = 0.0;
+
+	const std::string key = arg_Key.moduleKey();
+	auto found = modules.find(key);
+	if (found != modules.end()) return found->second;
+
+	auto start = std::chrono::steady_clock::now();
+	std::string source;
+	const char* code = cooked ? cooked->findShaderSource(key) : nullptr;
+	if (!code)
+	{
+		source = preprocess(arg_Key);
+		code = source.c_str();
+	}
+	arg_PreprocessMs = millisecondsSince(start);
+
+	WGPUShaderModuleWGSLDescriptor shaderWGSLDesc{};
+	shaderWGSLDesc.chain.next = nullptr;
+	shaderWGSLDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
+	shaderWGSLDesc.code = code;
+
+	WGPUShaderModuleDescriptor shaderDesc{};
+	shaderDesc.nextInChain = &shaderWGSLDesc.chain;
+
+	WGPUShaderModule shaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+	if (!shaderModule) throw std::runtime_error("Could not create shader module for variant " + key);
+
+	modules.emplace(key, shaderModule);
+	return shaderModule;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+#include "CookedBlob.hxx"
+#include "ShaderPreprocessor.hxx"
+
+// Everything that selects a specialized pipeline. Defines feed the preprocessor and so
+// produce a distinct shader module; the remaining fields are fixed-function pipeline state.
+// Tuning values are defines too: wgpu-native 0.19 does not apply WGSL `override` constants.
+struct ShaderVariantKey
+{
+	ShaderPreprocessor::Defines defines;
+	bool blending = true;
+	WGPUTextureFormat colorFormat = WGPUTextureFormat_Undefined;
+	uint32_t sampleCount = 1;
+
+	std::string moduleKey() const;
+	std::string pipelineKey() const;
+};
+
+// Lazily builds one pipeline per distinct ShaderVariantKey, sharing shader modules between
+// variants that only differ in pipeline state. Modules whose defines were cooked
+// into a shader blob are created from the blob's source instead of preprocessing the files.
+// Render thread only.
+class ShaderVariantCache
+{
+public:
+	using PipelineBuilder = std::function<WGPURenderPipeline(WGPUShaderModule, const ShaderVariantKey&)>;
+
+	struct VariantStats
+	{
+		std::string key;
+		double preprocessMs;
+		double compileMs;
+		uint64_t uses;
+	};
+
+	// Pipelines that entered the cache and left it; built + adopted == released once cleared.
+	struct PipelineCounts
+	{
+		uint64_t built;
+		uint64_t adopted;
+		uint64_t released;
+	};
+
+	ShaderVariantCache(WGPUDevice arg_Device, std::string arg_ShaderPath, PipelineBuilder arg_PipelineBuilder);
+	~ShaderVariantCache();
+
+	ShaderVariantCache(const ShaderVariantCache&) = delete;
+	ShaderVariantCache& operator=(const ShaderVariantCache&) = delete;
+
+	WGPURenderPipeline getPipeline(const ShaderVariantKey& arg_Key);
+
+	// Cooked sources of the shader, used until the next adopt(); null to always preprocess.
+	void setCookedShaders(std::unique_ptr<CookedBlob> arg_Blob) { cooked = std::move(arg_Blob); }
+
+	// Replaces the pipeline for arg_Key (e.g. after a hot reload) and drops every other
+	// variant so they are rebuilt from the new source on next use, dropping cooked sources
+	// that no longer match it. Takes ownership.
+	void adopt(const ShaderVariantKey& arg_Key, WGPURenderPipeline arg_Pipeline);
+	void clear();
+
+	// Thread-safe: only reads from disk.
+	std::string preprocess(const ShaderVariantKey& arg_Key) const;
+
+	const std::string& getShaderPath() const { return shaderPath; }
+	size_t getVariantCount() const { return variants.size(); }
+	size_t getModuleCount() const { return modules.size(); }
+	std::vector<VariantStats> getStats() const;
+	PipelineCounts getPipelineCounts() const { return pipelineCounts; }
+	void logStats() const;
+
+private:
+	struct Variant
+	{
+		WGPURenderPipeline pipeline;
+		VariantStats stats;
+	};
+
+	WGPUShaderModule getModule(const ShaderVariantKey& arg_Key, double& arg_PreprocessMs);
+
+private:
+	WGPUDevice device;
+	std::string shaderPath;
+	PipelineBuilder pipelineBuilder;
+	std::unique_ptr<CookedBlob> cooked;
+
+	std::unordered_map<std::string, WGPUShaderModule> modules;
+	std::unordered_map<std::string, Variant> variants;
+	PipelineCounts pipelineCounts{};
+};
@@ -0,0 +1,292 @@
+#include "SpatialGrid.hxx"
+#include "JobSystem.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	// Rects per job of the parallel build passes.
+	const size_t BUILD_GRAIN = 65536;
+	const uint32_t MAX_CELLS_PER_AXIS = 4096;
+	// Pending entries tolerated before a rebuild: a fixed floor plus this share of the entries.
+	const size_t PENDING_FLOOR = 1024;
+	const size_t PENDING_DIVISOR = 8;
+
+	template <typename Body>
+	void runRange(JobSystem* arg_Jobs, size_t arg_Count, Body&& arg_Body)
+	{
+		if (arg_Jobs) arg_Jobs->parallelFor(arg_Count, BUILD_GRAIN, arg_Body);
+		else arg_Body(size_t(0), arg_Count);
+	}
+}
+
+void SpatialGrid::build(const SceneBounds& arg_Bounds, size_t arg_Count, const float* arg_X, const float* arg_Y,
+	const float* arg_Width, const float* arg_Height, const uint32_t* arg_Ids, JobSystem* arg_Jobs)
+{
+	// Locations keep a flag bit, and ids without a table are the entry index.
+	if (arg_Count >= PENDING) throw std::length_error("SpatialGrid holds at most 2^31 - 1 entries");
+
+	bounds = arg_Bounds;
+	const float spanX = std::max(bounds.maxX - bounds.minX, 1e-6f);
+	const float spanY = std::max(bounds.maxY - bounds.minY, 1e-6f);
+
+	// Square cells holding TARGET_PER_CELL entries on average.
+	const double side = std::sqrt(static_cast<double>(spanX) * spanY * TARGET_PER_CELL / static_cast<double>(std::max<size_t>(arg_Count, 1)));
+	cellsX = static_cast<uint32_t>(std::clamp(std::ceil(spanX / side), 1.0, static_cast<double>(MAX_CELLS_PER_AXIS)));
+	cellsY = static_cast<uint32_t>(std::clamp(std::ceil(spanY / side), 1.0, static_cast<double>(MAX_CELLS_PER_AXIS)));
+	cellWidth = spanX / static_cast<float>(cellsX);
+	cellHeight = spanY / static_cast<float>(cellsY);
+	cellScaleX = static_cast<float>(cellsX) / spanX;
+	cellScaleY = static_cast<float>(cellsY) / spanY;
+
+	const size_t cells = static_cast<size_t>(cellsX) * cellsY;
+	if (cursorCapacity < cells)
+	{
+		cellCursors.reset(new std::atomic<uint32_t>[cells]);
+		cursorCapacity = cells;
+	}
+	for (size_t c = 0; c < cells; ++c) cellCursors[c].store(0, std::memory_order_relaxed);
+
+	entryCells.resize(arg_Count);
+	entries.resize(arg_Count);
+	chunkExtents.assign((arg_Count + BUILD_GRAIN - 1) / BUILD_GRAIN + 1, 0.0f);
+	chunkMaxIds.assign(chunkExtents.size(), 0);
+
+	// Pass 1: cell of every entry and the entry count of every cell.
+	runRange(arg_Jobs, arg_Count, [&](size_t arg_Begin, size_t arg_End)
+	{
+		float extent = 0.0f;
+		uint32_t maxId = 0;
+		for (size_t i = arg_Begin; i < arg_End; ++i)
+		{
+			const uint32_t cell = cellOf(arg_X[i], arg_Y[i]);
+			entryCells[i] = cell;
+			cellCursors[cell].fetch_add(1, std::memory_order_relaxed);
+			extent = std::max(extent, boundingExtent(arg_Width[i], arg_Height[i]));
+			maxId = std::max(maxId, arg_Ids ? arg_Ids[i] : static_cast<uint32_t>(i));
+		}
+		chunkExtents[arg_Begin / BUILD_GRAIN] = std::max(chunkExtents[arg_Begin / BUILD_GRAIN], extent);
+		chunkMaxIds[arg_Begin / BUILD_GRAIN] = std::max(chunkMaxIds[arg_Begin / BUILD_GRAIN], maxId);
+	});
+
+	maxExtent = *std::max_element(chunkExtents.begin(), chunkExtents.end());
+	const uint32_t maxId = *std::max_element(chunkMaxIds.begin(), chunkMaxIds.end());
+
+	// Cell ranges, with each cursor set to the start of its range.
+	cellStart.resize(cells + 1);
+	uint32_t offset = 0;
+	for (size_t c = 0; c < cells; ++c)
+	{
+		cellStart[c] = offset;
+		offset += cellCursors[c].exchange(offset, std::memory_order_relaxed);
+	}
+	cellStart[cells] = offset;
+
+	locations.assign(arg_Count > 0 ? static_cast<size_t>(maxId) + 1 : 0, ABSENT);
+
+	// Pass 2: scatter into the cell ranges. Order within a cell depends on scheduling.
+	runRange(arg_Jobs, arg_Count, [&](size_t arg_Begin, size_t arg_End)
+	{
+		for (size_t i = arg_Begin; i < arg_End; ++i)
+		{
+			const uint32_t position = cellCursors[entryCells[i]].fetch_add(1, std::memory_order_relaxed);
+			const uint32_t id = arg_Ids ? arg_Ids[i] : static_cast<uint32_t>(i);
+			entries[position] = { arg_X[i], arg_Y[i], boundingExtent(arg_Width[i], arg_Height[i]), id };
+			locations[id] = position;
+		}
+	});
+
+	pending.clear();
+	liveEntries = arg_Count;
+	++rebuilds;
+}
+
+void SpatialGrid::insert(uint32_t arg_Id, float arg_X, float arg_Y, float arg_Width, float arg_Height)
+{
+	if (contains(arg_Id))
+	{
+		move(arg_Id, arg_X, arg_Y, arg_Width, arg_Height);
+		return;
+	}
+	if (cellsX == 0) build(bounds, 0, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+	const float extent = boundingExtent(arg_Width, arg_Height);
+	maxExtent = std::max(maxExtent, extent);
+	pending.push_back({ arg_X, arg_Y, extent, arg_Id });
+	trackId(arg_Id, PENDING | static_cast<uint32_t>(pending.size() - 1));
+	++liveEntries;
+
+	if (pending.size() > PENDING_FLOOR + liveEntries / PENDING_DIVISOR) rebuildWithPending();
+}
+
+void SpatialGrid::move(uint32_t arg_Id, float arg_X, float arg_Y, float arg_Width, float arg_Height)
+{
+	const uint32_t location = arg_Id < locations.size() ? locations[arg_Id] : ABSENT;
+	if (location == ABSENT)
+	{
+		insert(arg_Id, arg_X, arg_Y, arg_Width, arg_Height);
+		return;
+	}
+
+	const float extent = boundingExtent(arg_Width, arg_Height);
+	Entry& entry = (location & PENDING) ? pending[location & ~PENDING] : entries[location];
+	if ((location & PENDING) || cellOf(entry.x, entry.y) == cellOf(arg_X, arg_Y))
+	{
+		maxExtent = std::max(maxExtent, extent);
+		entry = { arg_X, arg_Y, extent, arg_Id };
+		return;
+	}
+
+	remove(arg_Id);
+	insert(arg_Id, arg_X, arg_Y, arg_Width, arg_Height);
+}
+
+bool SpatialGrid::remove(uint32_t arg_Id)
+{
+	const uint32_t location = arg_Id < locations.size() ? locations[arg_Id] : ABSENT;
+	if (location == ABSENT) return false;
+
+	if (location & PENDING)
+	{
+		// Swap and pop, so the pending list stays dense for queries.
+		const uint32_t index = location & ~PENDING;
+		pending[index] = pending.back();
+		pending.pop_back();
+		if (index < pending.size()) locations[pending[index].id] = PENDING | index;
+	}
+	else
+	{
+		entries[location].id = ABSENT;
+	}
+
+	locations[arg_Id] = ABSENT;
+	--liveEntries;
+	return true;
+}
+
+bool SpatialGrid::contains(uint32_t arg_Id) const
+{
+	return arg_Id < locations.size() && locations[arg_Id] != ABSENT;
+}
+
+void SpatialGrid::query(const Box& arg_Box, std::vector<uint32_t>& arg_Ids) const
+{
+	if (cellsX == 0) return;
+
+	// Entries are filed by center, so any cell within maxExtent of the box may hold a hit.
+	const uint32_t firstCell = cellOf(arg_Box.minX - maxExtent, arg_Box.minY - maxExtent);
+	const uint32_t lastCell = cellOf(arg_Box.maxX + maxExtent, arg_Box.maxY + maxExtent);
+	const uint32_t x0 = firstCell % cellsX;
+	const uint32_t y0 = firstCell / cellsX;
+	const uint32_t x1 = lastCell % cellsX;
+	const uint32_t y1 = lastCell / cellsX;
+
+	for (uint32_t cy = y0; cy <= y1; ++cy)
+	{
+		const float cellMinY = bounds.minY + static_cast<float>(cy) * cellHeight;
+		const bool insideY = cy > 0 && cy + 1 < cellsY
+			&& cellMinY - maxExtent >= arg_Box.minY && cellMinY + cellHeight + maxExtent <= arg_Box.maxY;
+
+		for (uint32_t cx = x0; cx <= x1; ++cx)
+		{
+			const size_t cell = static_cast<size_t>(cy) * cellsX + cx;
+			const Entry* begin = entries.data() + cellStart[cell];
+			const Entry* end = entries.data() + cellStart[cell + 1];
+
+			// Every bound in an interior cell lies within its widened extent, so a cell whose
+			// widened extent is inside the box needs no tests. Border cells also hold rects
+			// whose centers are outside the bounds.
+			const float cellMinX = bounds.minX + static_cast<float>(cx) * cellWidth;
+			const bool inside = insideY && cx > 0 && cx + 1 < cellsX
+				&& cellMinX - maxExtent >= arg_Box.minX && cellMinX + cellWidth + maxExtent <= arg_Box.maxX;
+			if (inside)
+			{
+				for (const Entry* entry = begin; entry != end; ++entry)
+				{
+					if (entry->id != ABSENT) arg_Ids.push_back(entry->id);
+				}
+			}
+			else
+			{
+				scan(begin, end, arg_Box, arg_Ids);
+			}
+		}
+	}
+
+	scan(pending.data(), pending.data() + pending.size(), arg_Box, arg_Ids);
+}
+
+void SpatialGrid::queryPoint(float arg_X, float arg_Y, std::vector<uint32_t>& arg_Ids) const
+{
+	query({ arg_X, arg_Y, arg_X, arg_Y }, arg_Ids);
+}
+
+SpatialGrid::Stats SpatialGrid::getStats() const
+{
+	Stats stats{};
+	stats.cellsX = cellsX;
+	stats.cellsY = cellsY;
+	stats.entries = liveEntries;
+	stats.pending = pending.size();
+	stats.maxExtent = maxExtent;
+	stats.rebuilds = rebuilds;
+	return stats;
+}
+
+uint32_t SpatialGrid::cellOf(float arg_X, float arg_Y) const
+{
+	// Written so that NaN lands in cell 0 rather than in an out-of-range conversion.
+	float cellX = (arg_X - bounds.minX) * cellScaleX;
+	float cellY = (arg_Y - bounds.minY) * cellScaleY;
+	cellX = cellX > 0.0f ? std::min(cellX, static_cast<float>(cellsX - 1)) : 0.0f;
+	cellY = cellY > 0.0f ? std::min(cellY, static_cast<float>(cellsY - 1)) : 0.0f;
+	return static_cast<uint32_t>(cellY) * cellsX + static_cast<uint32_t>(cellX);
+}
+
+float SpatialGrid::boundingExtent(float arg_Width, float arg_Height)
+{
+	return 0.5f * std::sqrt(arg_Width * arg_Width + arg_Height * arg_Height);
+}
+
+void SpatialGrid::trackId(uint32_t arg_Id, uint32_t arg_Location)
+{
+	if (arg_Id >= locations.size()) locations.resize(static_cast<size_t>(arg_Id) + 1, ABSENT);
+	locations[arg_Id] = arg_Location;
+}
+
+void SpatialGrid::rebuildWithPending()
+{
+	rebuildX.clear();
+	rebuildY.clear();
+	rebuildWidth.clear();
+	rebuildIds.clear();
+
+	auto collect = [&](const Entry& arg_Entry)
+	{
+		if (arg_Entry.id == ABSENT) return;
+		rebuildX.push_back(arg_Entry.x);
+		rebuildY.push_back(arg_Entry.y);
+		// A width of twice the extent and no height gives back the same extent exactly.
+		rebuildWidth.push_back(2.0f * arg_Entry.extent);
+		rebuildIds.push_back(arg_Entry.id);
+	};
+	for (const Entry& entry : entries) collect(entry);
+	for (const Entry& entry : pending) collect(entry);
+
+	rebuildHeight.assign(rebuildX.size(), 0.0f);
+	build(bounds, rebuildX.size(), rebuildX.data(), rebuildY.data(), rebuildWidth.data(), rebuildHeight.data(), rebuildIds.data(), nullptr);
+}
+
+void SpatialGrid::scan(const Entry* arg_Begin, const Entry* arg_End, const Box& arg_Box, std::vector<uint32_t>& arg_Ids)
+{
+	for (const Entry* entry = arg_Begin; entry != arg_End; ++entry)
+	{
+		if (entry->id == ABSENT) continue;
+		if (entry->x + entry->extent < arg_Box.minX || entry->x - entry->extent > arg_Box.maxX) continue;
+		if (entry->y + entry->extent < arg_Box.minY || entry->y - entry->extent > arg_Box.maxY) continue;
+
+		arg_Ids.push_back(entry->id);
+	}
+}
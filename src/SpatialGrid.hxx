@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "SceneKernels.hxx"
+
+class JobSystem;
+
+// Loose uniform grid over rects for viewport culling and picking. Each rect is bounded by the
+// square around its circumscribed circle, so rotating it never moves it in the grid, and is
+// filed under the cell holding its center. Queries widen their range by the largest bound so
+// rects reaching into a cell from a neighbour are found, then test each bound exactly.
+//
+// build() sorts every entry into per-cell ranges of one array, in parallel on a JobSystem.
+// Entries inserted or moved to another cell afterwards go to a small pending list that
+// queries scan as well, and the grid rebuilds itself once that list grows past a fraction of
+// the entries. Moves within a cell update the entry in place. Not thread safe.
+class SpatialGrid
+{
+public:
+	struct Box
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+	};
+
+	struct Stats
+	{
+		uint32_t cellsX;
+		uint32_t cellsY;
+		size_t entries;
+		size_t pending;
+		float maxExtent;
+		uint64_t rebuilds;
+	};
+
+	// Rebuilds from arg_Count rects given as center and size. arg_Ids name the rects in
+	// queries and later updates; they must be unique and should be dense, as the grid keeps
+	// a table indexed by id.
+	void build(const SceneBounds& arg_Bounds, size_t arg_Count, const float* arg_X, const float* arg_Y,
+		const float* arg_Width, const float* arg_Height, const uint32_t* arg_Ids, JobSystem* arg_Jobs);
+
+	void insert(uint32_t arg_Id, float arg_X, float arg_Y, float arg_Width, float arg_Height);
+	// Same as remove() followed by insert(), but in place while the center stays in its cell.
+	void move(uint32_t arg_Id, float arg_X, float arg_Y, float arg_Width, float arg_Height);
+	bool remove(uint32_t arg_Id);
+	bool contains(uint32_t arg_Id) const;
+
+	// Appends the ids of every rect whose bound overlaps the box; the bounds are conservative,
+	// so callers that need exact hits test the candidates themselves.
+	void query(const Box& arg_Box, std::vector<uint32_t>& arg_Ids) const;
+	void queryPoint(float arg_X, float arg_Y, std::vector<uint32_t>& arg_Ids) const;
+
+	size_t size() const { return liveEntries; }
+	Stats getStats() const;
+
+private:
+	// Entries per cell that build() aims for.
+	static const size_t TARGET_PER_CELL = 4;
+
+	// Center and half extent of the bounding square.
+	struct Entry
+	{
+		float x;
+		float y;
+		float extent;
+		uint32_t id;
+	};
+
+	// Where an id lives: an index into entries, or into pending with PENDING set.
+	static constexpr uint32_t ABSENT = UINT32_MAX;
+	static constexpr uint32_t PENDING = 0x80000000u;
+
+	uint32_t cellOf(float arg_X, float arg_Y) const;
+	static float boundingExtent(float arg_Width, float arg_Height);
+	void trackId(uint32_t arg_Id, uint32_t arg_Location);
+	void rebuildWithPending();
+	static void scan(const Entry* arg_Begin, const Entry* arg_End, const Box& arg_Box, std::vector<uint32_t>& arg_Ids);
+
+private:
+	SceneBounds bounds{ -1.0f, -1.0f, 1.0f, 1.0f };
+	uint32_t cellsX = 0;
+	uint32_t cellsY = 0;
+	float cellScaleX = 0.0f;
+	float cellScaleY = 0.0f;
+	float cellWidth = 0.0f;
+	float cellHeight = 0.0f;
+	float maxExtent = 0.0f;
+
+	// Entries sorted by cell; cell c owns [cellStart[c], cellStart[c + 1]). Removed and moved
+	// entries stay behind with an ABSENT id until the next build.
+	std::vector<uint32_t> cellStart;
+	std::vector<Entry> entries;
+	std::vector<Entry> pending;
+	std::vector<uint32_t> locations;
+	size_t liveEntries = 0;
+	uint64_t rebuilds = 0;
+
+	// Scratch of build(), kept so that rebuilding every frame does not allocate.
+	std::vector<uint32_t> entryCells;
+	std::unique_ptr<std::atomic<uint32_t>[]> cellCursors;
+	size_t cursorCapacity = 0;
+	std::vector<float> chunkExtents;
+	std::vector<uint32_t> chunkMaxIds;
+	// Scratch of rebuildWithPending(), for grids kept up to date with move() every frame.
+	std::vector<float> rebuildX;
+	std::vector<float> rebuildY;
+	std::vector<float> rebuildWidth;
+	std::vector<float> rebuildHeight;
+	std::vector<uint32_t> rebuildIds;
+};
@@ -0,0 +1,145 @@
+#include "StagingBelt.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <webgpu/wgpu.h>
+
+namespace
+{
+	// Offsets within a chunk keep 32-byte alignment for vector stores.
+	const uint64_t ALIGNMENT = 32;
+
+	uint64_t alignUp(uint64_t arg_Value)
+	{
+		return (arg_Value + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	}
+}
+
+StagingBelt::StagingBelt(WGPUDevice arg_Device, uint64_t arg_ChunkSize, const char* arg_Label)
+	: device(arg_Device), chunkSize(alignUp(std::max<uint64_t>(arg_ChunkSize, ALIGNMENT))), label(arg_Label)
+{
+}
+
+StagingBelt::~StagingBelt()
+{
+	// Pending map callbacks point at the chunks, so let them run before the chunks go away.
+	if (hasPendingMaps()) wgpuDevicePoll(device, true, nullptr);
+
+	for (const std::unique_ptr<Chunk>& chunk : chunks) wgpuBufferRelease(chunk->buffer);
+}
+
+void* StagingBelt::write(WGPUCommandEncoder arg_Encoder, WGPUBuffer arg_Target, uint64_t arg_Offset, uint64_t arg_Size)
+{
+	Chunk& chunk = acquire(arg_Size);
+	const uint64_t offset = chunk.head;
+	chunk.head = alignUp(offset + arg_Size);
+	bytesThisFrame += arg_Size;
+
+	wgpuCommandEncoderCopyBufferToBuffer(arg_Encoder, chunk.buffer, offset, arg_Target, arg_Offset, arg_Size);
+	return chunk.data + offset;
+}
+
+void* StagingBelt::writeTexture(WGPUCommandEncoder arg_Encoder, const WGPUImageCopyTexture& arg_Target, const WGPUExtent3D& arg_Size, uint32_t arg_BytesPerRow)
+{
+	const uint64_t size = static_cast<uint64_t>(arg_BytesPerRow) * arg_Size.height * arg_Size.depthOrArrayLayers;
+	Chunk& chunk = acquire(size);
+	const uint64_t offset = chunk.head;
+	chunk.head = alignUp(offset + size);
+	bytesThisFrame += size;
+
+	WGPUImageCopyBuffer source{};
+	source.nextInChain = nullptr;
+	source.layout.nextInChain = nullptr;
+	source.layout.offset = offset;
+	source.layout.bytesPerRow = arg_BytesPerRow;
+	source.layout.rowsPerImage = arg_Size.height;
+	source.buffer = chunk.buffer;
+	wgpuCommandEncoderCopyBufferToTexture(arg_Encoder, &source, &arg_Target, &arg_Size);
+	return chunk.data + offset;
+}
+
+StagingBelt::Chunk& StagingBelt::acquire(uint64_t arg_Size)
+{
+	for (const std::unique_ptr<Chunk>& chunk : chunks)
+	{
+		if (chunk->state == ChunkState::Mapped && chunk->size - chunk->head >= arg_Size) return *chunk;
+	}
+
+	WGPUBufferDescriptor bufferDesc{};
+	bufferDesc.nextInChain = nullptr;
+	bufferDesc.label = label;
+	bufferDesc.size = std::max(chunkSize, alignUp(arg_Size));
+	bufferDesc.usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc;
+	bufferDesc.mappedAtCreation = true;
+
+	std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+	chunk->buffer = wgpuDeviceCreateBuffer(device, &bufferDesc);
+	if (!chunk->buffer) throw std::runtime_error("Could not create staging belt chunk");
+
+	chunk->size = bufferDesc.size;
+	chunk->head = 0;
+	chunk->data = static_cast<uint8_t*>(wgpuBufferGetMappedRange(chunk->buffer, 0, chunk->size));
+	chunk->state = ChunkState::Mapped;
+
+	chunks.push_back(std::move(chunk));
+	return *chunks.back();
+}
+
+void StagingBelt::finish()
+{
+	for (const std::unique_ptr<Chunk>& chunk : chunks)
+	{
+		if (chunk->state != ChunkState::Mapped || chunk->head == 0) continue;
+
+		wgpuBufferUnmap(chunk->buffer);
+		chunk->data = nullptr;
+		chunk->state = ChunkState::Closed;
+	}
+	bytesThisFrame = 0;
+}
+
+void StagingBelt::recall()
+{
+	for (const std::unique_ptr<Chunk>& chunk : chunks)
+	{
+		if (chunk->state != ChunkState::Closed) continue;
+
+		chunk->state = ChunkState::Mapping;
+		wgpuBufferMapAsync(chunk->buffer, WGPUMapMode_Write, 0, chunk->size, &StagingBelt::onMapped, chunk.get());
+	}
+}
+
+bool StagingBelt::hasPendingMaps() const
+{
+	for (const std::unique_ptr<Chunk>& chunk : chunks)
+	{
+		if (chunk->state == ChunkState::Mapping) return true;
+	}
+	return false;
+}
+
+StagingBelt::Stats StagingBelt::getStats() const
+{
+	Stats stats{};
+	stats.chunks = chunks.size();
+	for (const std::unique_ptr<Chunk>& chunk : chunks) stats.capacity += chunk->size;
+	stats.bytesThisFrame = bytesThisFrame;
+	return stats;
+}
+
+void StagingBelt::onMapped(WGPUBufferMapAsyncStatus arg_Status, void* arg_UserData)
+{
+	Chunk& chunk = *reinterpret_cast<Chunk*>(arg_UserData);
+
+	// A failed map leaves the chunk closed, and the next recall() tries again.
+	if (arg_Status != WGPUBufferMapAsyncStatus_Success)
+	{
+		chunk.state = ChunkState::Closed;
+		return;
+	}
+
+	chunk.data = static_cast<uint8_t*>(wgpuBufferGetMappedRange(chunk.buffer, 0, chunk.size));
+	chunk.head = 0;
+	chunk.state = ChunkState::Mapped;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+// Uploads through persistently reused MapWrite buffers, so callers write straight into
+// memory the GPU copies from instead of into a CPU array that wgpuQueueWriteBuffer copies
+// again. write() hands out mapped space in a chunk and records a copy from it into the
+// destination; finish() unmaps the chunks written this frame before the submit, recall()
+// maps them again after it, and a chunk is reused once its map callback has run. Chunks are
+// only added, so after warmup a steady upload size no longer creates buffers. The device has
+// to be polled for the callbacks to run, see hasPendingMaps().
+class StagingBelt
+{
+public:
+	struct Stats
+	{
+		size_t chunks;
+		uint64_t capacity;
+		uint64_t bytesThisFrame;
+	};
+
+	StagingBelt(WGPUDevice arg_Device, uint64_t arg_ChunkSize, const char* arg_Label);
+	~StagingBelt();
+
+	StagingBelt(const StagingBelt&) = delete;
+	StagingBelt& operator=(const StagingBelt&) = delete;
+
+	// arg_Size bytes of mapped memory, copied to arg_Target at arg_Offset when the encoder's
+	// commands run. Valid until finish(); write-only, as it may be write-combined. Sizes and
+	// offsets must be multiples of 4.
+	void* write(WGPUCommandEncoder arg_Encoder, WGPUBuffer arg_Target, uint64_t arg_Offset, uint64_t arg_Size);
+
+	// As write(), for arg_Size.height rows of arg_BytesPerRow bytes copied into the region of
+	// arg_Target; arg_BytesPerRow must be a multiple of 256 and may include padding.
+	void* writeTexture(WGPUCommandEncoder arg_Encoder, const WGPUImageCopyTexture& arg_Target, const WGPUExtent3D& arg_Size, uint32_t arg_BytesPerRow);
+
+	// After the last write() of the frame, before wgpuQueueSubmit.
+	void finish();
+
+	// After wgpuQueueSubmit.
+	void recall();
+
+	// True while a chunk waits for its map callback.
+	bool hasPendingMaps() const;
+
+	Stats getStats() const;
+
+private:
+	enum class ChunkState
+	{
+		Mapped,
+		Closed,
+		Mapping
+	};
+
+	struct Chunk
+	{
+		WGPUBuffer buffer;
+		uint64_t size;
+		uint64_t head;
+		uint8_t* data;
+		ChunkState state;
+	};
+
+	static void onMapped(WGPUBufferMapAsyncStatus arg_Status, void* arg_UserData);
+	Chunk& acquire(uint64_t arg_Size);
+
+private:
+	WGPUDevice device;
+	uint64_t chunkSize;
+	const char* label;
+	// Chunks are referenced by their map callbacks, so they must not move.
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	uint64_t bytesThisFrame = 0;
+};
@@ -0,0 +1,241 @@
+#include "SwapChain.hxx"
+#include "Config.hxx"
+#include "GpuDebug.hxx"
+#include "Log.hxx"
+#include "PresentModeSelector.hxx"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <webgpu/wgpu.h>
+
+SwapChain::SwapChain(
+	WGPUDevice arg_Device,
+	WGPUSurface arg_Surface,
+	WGPUTextureFormat arg_Format,
+	uint32_t arg_Width,
+	uint32_t arg_Height,
+	WGPUPresentMode arg_PresentMode,
+	uint32_t arg_FrameLatency
+)
+	: device(arg_Device),
+	surface(arg_Surface),
+	format(arg_Format),
+	presentMode(arg_PresentMode),
+	frameLatency(arg_FrameLatency),
+	pendingWidth(arg_Width),
+	pendingHeight(arg_Height),
+	debounce(std::chrono::milliseconds(std::max(0LL, Config::getInt("APP_RESIZE_DEBOUNCE_MS", 50))))
+{
+	applyPendingResize(true);
+}
+
+SwapChain::~SwapChain()
+{
+	if (offscreen)
+	{
+		wgpuTextureDestroy(offscreen);
+		wgpuTextureRelease(offscreen);
+	}
+	if (configured && surface) wgpuSurfaceUnconfigure(surface);
+}
+
+void SwapChain::resize(uint32_t arg_Width, uint32_t arg_Height)
+{
+	pendingWidth = arg_Width;
+	pendingHeight = arg_Height;
+}
+
+bool SwapChain::acquire(SurfaceFrame& arg_Frame)
+{
+	arg_Frame = { nullptr, nullptr };
+
+	if (!applyPendingResize(false)) return false;
+
+	WGPUSurfaceTexture surfaceTexture{};
+	if (!surface)
+	{
+		// The caller releases the frame's texture, so it gets its own reference.
+		wgpuTextureReference(offscreen);
+		surfaceTexture.texture = offscreen;
+	}
+
+	for (int attempt = 0; attempt < 2 && surface; ++attempt)
+	{
+		wgpuSurfaceGetCurrentTexture(surface, &surfaceTexture);
+
+		switch (surfaceTexture.status)
+		{
+		case WGPUSurfaceGetCurrentTextureStatus_Success:
+			break;
+		case WGPUSurfaceGetCurrentTextureStatus_Timeout:
+			if (surfaceTexture.texture) wgpuTextureRelease(surfaceTexture.texture);
+			return false;
+		case WGPUSurfaceGetCurrentTextureStatus_Outdated:
+		case WGPUSurfaceGetCurrentTextureStatus_Lost:
+			LOG_MSG_SUC("Surface " << (surfaceTexture.status == WGPUSurfaceGetCurrentTextureStatus_Lost ? "lost" : "outdated") << ", reconfiguring");
+			if (surfaceTexture.texture) wgpuTextureRelease(surfaceTexture.texture);
+			surfaceTexture.texture = nullptr;
+			// Outdated while a resize is pending is the resize itself, so it waits out the
+			// debounce like one, skipping frames meanwhile; otherwise only a configure helps.
+			if (surfaceTexture.status == WGPUSurfaceGetCurrentTextureStatus_Outdated && isResizePending())
+			{
+				if (!applyPendingResize(false) || isResizePending()) return false;
+			}
+			else if (!applyPendingResize(true))
+			{
+				return false;
+			}
+			continue;
+		default:
+			if (surfaceTexture.texture) wgpuTextureRelease(surfaceTexture.texture);
+			throw std::runtime_error("Could not acquire surface texture, status " + std::to_string(surfaceTexture.status));
+		}
+
+		break;
+	}
+
+	if (!surfaceTexture.texture) return false;
+
+	// Still presentable, but no longer matches the window; fix it at the next opportunity.
+	if (surfaceTexture.suboptimal) reconfigureRequested = true;
+
+	WGPUTextureViewDescriptor viewDescriptor;
+	viewDescriptor.nextInChain = nullptr;
+	viewDescriptor.label = GPU_LABEL("Surface texture view");
+	viewDescriptor.format = wgpuTextureGetFormat(surfaceTexture.texture);
+	viewDescriptor.dimension = WGPUTextureViewDimension_2D;
+	viewDescriptor.baseMipLevel = 0;
+	viewDescriptor.mipLevelCount = 1;
+	viewDescriptor.baseArrayLayer = 0;
+	viewDescriptor.arrayLayerCount = 1;
+	viewDescriptor.aspect = WGPUTextureAspect_All;
+
+	arg_Frame.texture = surfaceTexture.texture;
+	arg_Frame.view = wgpuTextureCreateView(surfaceTexture.texture, &viewDescriptor);
+
+	return true;
+}
+
+void SwapChain::present()
+{
+	if (surface) wgpuSurfacePresent(surface);
+}
+
+void SwapChain::release(SurfaceFrame& arg_Frame)
+{
+	if (arg_Frame.view) wgpuTextureViewRelease(arg_Frame.view);
+	if (arg_Frame.texture) wgpuTextureRelease(arg_Frame.texture);
+	arg_Frame = { nullptr, nullptr };
+}
+
+void SwapChain::setPresentMode(WGPUPresentMode arg_PresentMode)
+{
+	if (arg_PresentMode == presentMode) return;
+
+	presentMode = arg_PresentMode;
+	presentModeChanged = true;
+}
+
+std::vector<WGPUPresentMode> SwapChain::queryPresentModes(WGPUSurface arg_Surface, WGPUAdapter arg_Adapter)
+{
+	if (!arg_Surface) return {};
+
+	WGPUSurfaceCapabilities capabilities{};
+	capabilities.nextInChain = nullptr;
+	wgpuSurfaceGetCapabilities(arg_Surface, arg_Adapter, &capabilities);
+
+	std::vector<WGPUPresentMode> modes(capabilities.presentModes, capabilities.presentModes + capabilities.presentModeCount);
+	wgpuSurfaceCapabilitiesFreeMembers(capabilities);
+
+	return modes;
+}
+
+bool SwapChain::applyPendingResize(bool arg_Immediate)
+{
+	if (isMinimized()) return false;
+
+	if (!configured || arg_Immediate || presentModeChanged)
+	{
+		configure();
+		return true;
+	}
+
+	if ((isResizePending() || reconfigureRequested) && std::chrono::steady_clock::now() - lastConfigure >= debounce)
+		configure();
+
+	return true;
+}
+
+void SwapChain::configure()
+{
+	width = pendingWidth;
+	height = pendingHeight;
+
+	if (!surface)
+	{
+		configureOffscreen();
+		return;
+	}
+
+	WGPUSurfaceConfiguration surfaceConfig = {};
+	surfaceConfig.nextInChain = nullptr;
+	surfaceConfig.width = width;
+	surfaceConfig.height = height;
+	surfaceConfig.format = format;
+	surfaceConfig.viewFormatCount = 0;
+	surfaceConfig.viewFormats = nullptr;
+	surfaceConfig.usage = WGPUTextureUsage_RenderAttachment;
+	surfaceConfig.device = device;
+	surfaceConfig.presentMode = presentMode;
+	surfaceConfig.alphaMode = WGPUCompositeAlphaMode_Auto;
+
+	// The header declares the field as WGPUBool, but wgpu reads it as a frame count.
+	WGPUSurfaceConfigurationExtras configExtras{};
+	configExtras.chain.next = nullptr;
+	configExtras.chain.sType = static_cast<WGPUSType>(WGPUSType_SurfaceConfigurationExtras);
+	configExtras.desiredMaximumFrameLatency = frameLatency;
+	if (frameLatency > 0) surfaceConfig.nextInChain = &configExtras.chain;
+
+	wgpuSurfaceConfigure(surface, &surfaceConfig);
+
+	configured = true;
+	reconfigureRequested = false;
+	presentModeChanged = false;
+	lastConfigure = std::chrono::steady_clock::now();
+	++configureCount;
+
+	LOG_MSG_SUC("Surface configured to " << width << "x" << height << ", present mode " << PresentModeSelector::modeName(presentMode));
+}
+
+void SwapChain::configureOffscreen()
+{
+	if (offscreen)
+	{
+		wgpuTextureDestroy(offscreen);
+		wgpuTextureRelease(offscreen);
+	}
+
+	WGPUTextureDescriptor textureDesc{};
+	textureDesc.nextInChain = nullptr;
+	textureDesc.label = GPU_LABEL("Offscreen frame");
+	textureDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_CopySrc;
+	textureDesc.dimension = WGPUTextureDimension_2D;
+	textureDesc.size = { width, height, 1 };
+	textureDesc.format = format;
+	textureDesc.mipLevelCount = 1;
+	textureDesc.sampleCount = 1;
+	textureDesc.viewFormatCount = 0;
+	textureDesc.viewFormats = nullptr;
+	offscreen = wgpuDeviceCreateTexture(device, &textureDesc);
+
+	if (!offscreen) throw std::runtime_error("Could not create offscreen frame texture");
+
+	configured = true;
+	reconfigureRequested = false;
+	presentModeChanged = false;
+	lastConfigure = std::chrono::steady_clock::now();
+	++configureCount;
+
+	LOG_MSG_SUC("Offscreen frame configured to " << width << "x" << height);
+}
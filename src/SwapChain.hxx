@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+struct SurfaceFrame
+{
+	WGPUTexture texture;
+	WGPUTextureView view;
+};
+
+// Owns the surface configuration. Resize events only record the newest framebuffer size;
+// the surface is reconfigured from the render loop, at most once per debounce interval
+// (APP_RESIZE_DEBOUNCE_MS, default 50), because wgpu waits for the device to go idle on every
+// configure and a drag delivers a resize event per mouse move. Lost surfaces, and outdated
+// ones without a resize pending, are reconfigured immediately and the acquire retried; an
+// outdated surface during a resize skips frames until the debounce reconfigures it. Otherwise
+// a frame is only skipped when the window is minimized or the acquire times out. Without a surface (headless runs) frames
+// render into one offscreen texture of the requested size and present does nothing.
+class SwapChain
+{
+public:
+	SwapChain(
+		WGPUDevice arg_Device,
+		WGPUSurface arg_Surface,
+		WGPUTextureFormat arg_Format,
+		uint32_t arg_Width,
+		uint32_t arg_Height,
+		WGPUPresentMode arg_PresentMode,
+		uint32_t arg_FrameLatency
+	);
+	~SwapChain();
+
+	SwapChain(const SwapChain&) = delete;
+	SwapChain& operator=(const SwapChain&) = delete;
+
+	// Framebuffer size in pixels, from the GLFW framebuffer size callback.
+	void resize(uint32_t arg_Width, uint32_t arg_Height);
+
+	// Returns false if there is nothing to render into this frame. On success the caller
+	// presents and then hands the frame back through release().
+	bool acquire(SurfaceFrame& arg_Frame);
+	void present();
+	void release(SurfaceFrame& arg_Frame);
+
+	// Takes effect at the next acquire, without the resize debounce.
+	void setPresentMode(WGPUPresentMode arg_PresentMode);
+
+	// Present modes the surface supports with this adapter; query before releasing the adapter.
+	static std::vector<WGPUPresentMode> queryPresentModes(WGPUSurface arg_Surface, WGPUAdapter arg_Adapter);
+
+	bool isMinimized() const { return pendingWidth == 0 || pendingHeight == 0; }
+	bool isResizePending() const { return pendingWidth != width || pendingHeight != height; }
+	uint32_t getWidth() const { return width; }
+	uint32_t getHeight() const { return height; }
+	WGPUTextureFormat getFormat() const { return format; }
+	WGPUPresentMode getPresentMode() const { return presentMode; }
+	uint64_t getConfigureCount() const { return configureCount; }
+
+private:
+	void configure();
+	void configureOffscreen();
+	bool applyPendingResize(bool arg_Immediate);
+
+private:
+	WGPUDevice device;
+	WGPUSurface surface;
+	WGPUTextureFormat format;
+	WGPUPresentMode presentMode;
+	uint32_t frameLatency;
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint32_t pendingWidth = 0;
+	uint32_t pendingHeight = 0;
+	bool configured = false;
+	bool reconfigureRequested = false;
+	bool presentModeChanged = false;
+	WGPUTexture offscreen = nullptr;
+
+	std::chrono::steady_clock::duration debounce;
+	std::chrono::steady_clock::time_point lastConfigure;
+	uint64_t configureCount = 0;
+};
@@ -0,0 +1,371 @@
+#include "TextureStreamer.hxx"
+#include "AllocationTracker.hxx"
+#include "Config.hxx"
+#include "GpuDebug.hxx"
+#include "ImageDecoder.hxx"
+#include "Log.hxx"
+#include "MappedFile.hxx"
+#include "Profiler.hxx"
+#include "StagingBelt.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	// Rows of buffer-to-texture copies start at multiples of this.
+	const uint32_t ROW_PITCH_ALIGNMENT = 256;
+	const char* COOKED_EXTENSION = ".texture";
+
+	bool endsWith(const std::string& arg_Text, const std::string& arg_Suffix)
+	{
+		return arg_Text.size() >= arg_Suffix.size() && arg_Text.compare(arg_Text.size() - arg_Suffix.size(), arg_Suffix.size(), arg_Suffix) == 0;
+	}
+
+	double secondsSince(std::chrono::steady_clock::time_point arg_Start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - arg_Start).count();
+	}
+}
+
+TextureStreamer::Settings TextureStreamer::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.threadCount = static_cast<uint32_t>(std::clamp(Config::getInt("APP_TEXTURE_THREADS", 2), 1LL, 64LL));
+	settings.uploadBytes = static_cast<uint64_t>(std::clamp(Config::getInt("APP_TEXTURE_UPLOAD_MB", 16), 1LL, 4096LL)) << 20;
+	settings.pendingBytes = static_cast<uint64_t>(std::clamp(Config::getInt("APP_TEXTURE_PENDING_MB", 256), 1LL, 1LL << 20)) << 20;
+
+	return settings;
+}
+
+TextureStreamer::TextureStreamer(WGPUDevice arg_Device, Settings arg_Settings, uint32_t arg_MaxDimension)
+	: device(arg_Device),
+	settings(arg_Settings),
+	maxDimension(std::min(arg_MaxDimension, ImageDecoder::MAX_DIMENSION))
+{
+	workers.reserve(settings.threadCount);
+	for (uint32_t i = 0; i < settings.threadCount; ++i) workers.emplace_back(&TextureStreamer::workerMain, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& worker : workers) worker.join();
+	for (const std::unique_ptr<Request>& request : requests)
+	{
+		if (request->texture) wgpuTextureRelease(request->texture);
+	}
+}
+
+TextureStreamer::Handle TextureStreamer::request(const std::string& arg_Path, int arg_Priority)
+{
+	std::unique_ptr<Request> request = std::make_unique<Request>();
+	request->path = arg_Path;
+	request->priority = arg_Priority;
+	request->state = State::Queued;
+	request->requested = std::chrono::steady_clock::now();
+
+	Handle handle = 0;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		handle = static_cast<Handle>(requests.size());
+		requests.push_back(std::move(request));
+		queued.push_back(handle);
+		++stats.requested;
+	}
+	wake.notify_one();
+
+	return handle;
+}
+
+void TextureStreamer::setPriority(Handle arg_Handle, int arg_Priority)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	requests.at(arg_Handle)->priority = arg_Priority;
+}
+
+void TextureStreamer::cancel(Handle arg_Handle)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Request& request = *requests.at(arg_Handle);
+	switch (request.state)
+	{
+	case State::Queued:
+		queued.erase(std::find(queued.begin(), queued.end(), arg_Handle));
+		request.state = State::Cancelled;
+		++stats.cancelled;
+		break;
+	case State::Decoding:
+		request.cancelled = true;
+		break;
+	case State::Uploading:
+		decoded.erase(std::remove(decoded.begin(), decoded.end(), arg_Handle), decoded.end());
+		uploads.erase(std::remove(uploads.begin(), uploads.end(), arg_Handle), uploads.end());
+		pendingBytes -= static_cast<uint64_t>(request.bytesPerRow) * request.height;
+		releaseData(request);
+		request.state = State::Cancelled;
+		++stats.cancelled;
+		wake.notify_all();
+		[[fallthrough]];
+	case State::Ready:
+		// Copies already recorded keep their own reference.
+		if (request.texture) wgpuTextureRelease(request.texture);
+		request.texture = nullptr;
+		request.state = State::Cancelled;
+		break;
+	default:
+		break;
+	}
+}
+
+void TextureStreamer::update(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging)
+{
+	PROFILE_ZONE("TextureStreamer::update");
+
+	const auto now = std::chrono::steady_clock::now();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (lastUpdate != std::chrono::steady_clock::time_point{}) stats.busySeconds += std::chrono::duration<double>(now - lastUpdate).count();
+		lastUpdate = stats.requested > stats.ready + stats.failed + stats.cancelled ? now : std::chrono::steady_clock::time_point{};
+
+		uploads.insert(uploads.end(), decoded.begin(), decoded.end());
+		decoded.clear();
+	}
+	if (uploads.empty()) return;
+
+	// Priorities only change on this thread, so they can be read without the lock.
+	std::sort(uploads.begin(), uploads.end(), [this](Handle arg_Left, Handle arg_Right) { return isBefore(arg_Left, arg_Right); });
+
+	uint64_t copied = 0;
+	size_t finished = 0;
+	for (Handle handle : uploads)
+	{
+		Request& request = *requests[handle];
+		// At least one row per frame, however wide.
+		const uint64_t allowance = copied == 0 ? std::max<uint64_t>(settings.uploadBytes, request.bytesPerRow) : settings.uploadBytes - copied;
+		copied += static_cast<uint64_t>(upload(arg_Encoder, arg_Staging, request, allowance)) * request.bytesPerRow;
+		if (request.rowsUploaded < request.height && request.error.empty()) break;
+
+		++finished;
+	}
+	const double copySeconds = secondsSince(now);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for (size_t i = 0; i < finished; ++i)
+	{
+		Request& request = *requests[uploads[i]];
+		pendingBytes -= static_cast<uint64_t>(request.bytesPerRow) * request.height;
+		releaseData(request);
+		if (!request.error.empty())
+		{
+			request.state = State::Failed;
+			++stats.failed;
+			continue;
+		}
+		request.state = State::Ready;
+		++stats.ready;
+		stats.latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - request.requested).count()));
+	}
+	uploads.erase(uploads.begin(), uploads.begin() + static_cast<std::ptrdiff_t>(finished));
+	stats.bytesUploaded += copied;
+	stats.copySeconds += copySeconds;
+	if (finished > 0) wake.notify_all();
+}
+
+TextureStreamer::State TextureStreamer::getState(Handle arg_Handle) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return requests.at(arg_Handle)->state;
+}
+
+WGPUTexture TextureStreamer::getTexture(Handle arg_Handle) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	const Request& request = *requests.at(arg_Handle);
+	return request.state == State::Ready ? request.texture : nullptr;
+}
+
+std::string TextureStreamer::getError(Handle arg_Handle) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	const Request& request = *requests.at(arg_Handle);
+	return request.state == State::Failed ? request.error : std::string();
+}
+
+bool TextureStreamer::isBusy() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats.requested > stats.ready + stats.failed + stats.cancelled;
+}
+
+TextureStreamer::Stats TextureStreamer::getStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+void TextureStreamer::logSummary() const
+{
+#ifdef DEBUG_MODE
+	const Stats summary = getStats();
+	const double megabytes = static_cast<double>(summary.bytesUploaded) / 1e6;
+	LOG_MSG_SUC("Textures: " << summary.ready << " ready, " << summary.failed << " failed, " << summary.cancelled << " cancelled; "
+		<< megabytes << " MB uploaded, " << (summary.busySeconds > 0.0 ? megabytes / summary.busySeconds : 0.0) << " MB/s while busy; decode "
+		<< summary.decodeSeconds * 1000.0 << " ms, copy " << summary.copySeconds * 1000.0 << " ms");
+	if (summary.latency.getCount() > 0)
+	{
+		LOG_MSG_SUC("Texture request to ready ms: p50 " << static_cast<double>(summary.latency.percentile(50.0)) / 1e6
+			<< ", p95 " << static_cast<double>(summary.latency.percentile(95.0)) / 1e6
+			<< ", max " << static_cast<double>(summary.latency.getMax()) / 1e6);
+	}
+#endif
+}
+
+void TextureStreamer::workerMain()
+{
+	Profiler::instance().setThreadName("texture");
+	AllocationTracker::setThreadName("texture");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;)
+	{
+		wake.wait(lock, [&]() { return stopping || (!queued.empty() && pendingBytes < settings.pendingBytes); });
+		if (stopping) return;
+
+		const auto next = std::min_element(queued.begin(), queued.end(), [this](Handle arg_Left, Handle arg_Right) { return isBefore(arg_Left, arg_Right); });
+		Request& request = *requests[*next];
+		const Handle handle = *next;
+		queued.erase(next);
+		request.state = State::Decoding;
+		lock.unlock();
+
+		const auto start = std::chrono::steady_clock::now();
+		{
+			PROFILE_ZONE("decodeTexture");
+			try
+			{
+				decode(request);
+			}
+			catch (const std::exception& err)
+			{
+				request.error = err.what();
+				LOG_MSG_ERR("Could not load texture " << request.path << ": " << request.error);
+			}
+		}
+		const double seconds = secondsSince(start);
+
+		lock.lock();
+		stats.decodeSeconds += seconds;
+		if (request.cancelled || !request.error.empty())
+		{
+			releaseData(request);
+			request.state = request.cancelled ? State::Cancelled : State::Failed;
+			++(request.cancelled ? stats.cancelled : stats.failed);
+			continue;
+		}
+
+		request.state = State::Uploading;
+		decoded.push_back(handle);
+		pendingBytes += static_cast<uint64_t>(request.bytesPerRow) * request.height;
+	}
+}
+
+bool TextureStreamer::isBefore(Handle arg_Left, Handle arg_Right) const
+{
+	const int left = requests[arg_Left]->priority;
+	const int right = requests[arg_Right]->priority;
+	return left != right ? left > right : arg_Left < arg_Right;
+}
+
+void TextureStreamer::decode(Request& arg_Request) const
+{
+	if (endsWith(arg_Request.path, COOKED_EXTENSION))
+	{
+		arg_Request.blob = std::make_unique<CookedBlob>(arg_Request.path, CookedFormat::BlobType::Texture);
+		const CookedFormat::Header& header = arg_Request.blob->getHeader();
+		arg_Request.width = header.width;
+		arg_Request.height = header.height;
+		arg_Request.bytesPerRow = header.bytesPerRow;
+
+		// Faults the payload in here, so the render thread's copy into staging memory does not
+		// wait on the disk.
+		const MappedFile& mapping = arg_Request.blob->getMapping();
+		mapping.prefetch(header.payloadOffset, header.payloadSize);
+		mapping.fault(header.payloadOffset, header.payloadSize);
+	}
+	else
+	{
+		const MappedFile file(arg_Request.path);
+		const ImageDecoder::Info info = ImageDecoder::probe(file.data(), file.size());
+		arg_Request.width = info.width;
+		arg_Request.height = info.height;
+		arg_Request.bytesPerRow = (info.width * 4 + ROW_PITCH_ALIGNMENT - 1) / ROW_PITCH_ALIGNMENT * ROW_PITCH_ALIGNMENT;
+		if (info.width <= maxDimension && info.height <= maxDimension)
+		{
+			arg_Request.texels.resize(static_cast<size_t>(arg_Request.bytesPerRow) * info.height);
+			ImageDecoder::decode(file.data(), file.size(), arg_Request.texels.data(), arg_Request.bytesPerRow);
+		}
+	}
+
+	if (arg_Request.width == 0 || arg_Request.height == 0 || arg_Request.width > maxDimension || arg_Request.height > maxDimension)
+		throw std::runtime_error(arg_Request.path + ": " + std::to_string(arg_Request.width) + "x" + std::to_string(arg_Request.height)
+			+ " is outside the device's texture size");
+}
+
+uint32_t TextureStreamer::upload(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, Request& arg_Request, uint64_t arg_MaxBytes)
+{
+	if (!arg_Request.texture)
+	{
+		WGPUTextureDescriptor textureDesc{};
+		textureDesc.nextInChain = nullptr;
+		textureDesc.label = GPU_LABEL("Streamed texture");
+		textureDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst;
+		textureDesc.dimension = WGPUTextureDimension_2D;
+		textureDesc.size = { arg_Request.width, arg_Request.height, 1 };
+		textureDesc.format = WGPUTextureFormat_RGBA8UnormSrgb;
+		textureDesc.mipLevelCount = 1;
+		textureDesc.sampleCount = 1;
+		textureDesc.viewFormatCount = 0;
+		textureDesc.viewFormats = nullptr;
+		arg_Request.texture = wgpuDeviceCreateTexture(device, &textureDesc);
+		if (!arg_Request.texture)
+		{
+			// Fails the request like a decode error instead of the frame; update() retires it.
+			arg_Request.error = "Could not create texture";
+			LOG_MSG_ERR("Could not create texture for " << arg_Request.path);
+			return 0;
+		}
+	}
+
+	const uint32_t rows = static_cast<uint32_t>(std::min<uint64_t>(arg_Request.height - arg_Request.rowsUploaded, arg_MaxBytes / arg_Request.bytesPerRow));
+	if (rows == 0) return 0;
+
+	WGPUImageCopyTexture target{};
+	target.nextInChain = nullptr;
+	target.texture = arg_Request.texture;
+	target.mipLevel = 0;
+	target.origin = { 0, arg_Request.rowsUploaded, 0 };
+	target.aspect = WGPUTextureAspect_All;
+	const WGPUExtent3D extent{ arg_Request.width, rows, 1 };
+
+	// The rows are already at the copy pitch, so they go into staging memory in one copy.
+	const uint8_t* source = arg_Request.blob ? arg_Request.blob->getPayload() : arg_Request.texels.data();
+	const uint64_t offset = static_cast<uint64_t>(arg_Request.rowsUploaded) * arg_Request.bytesPerRow;
+	const uint64_t size = static_cast<uint64_t>(rows) * arg_Request.bytesPerRow;
+	std::memcpy(arg_Staging.writeTexture(arg_Encoder, target, extent, arg_Request.bytesPerRow), source + offset, size);
+
+	arg_Request.rowsUploaded += rows;
+	return rows;
+}
+
+void TextureStreamer::releaseData(Request& arg_Request)
+{
+	std::vector<uint8_t>().swap(arg_Request.texels);
+	arg_Request.blob.reset();
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+#include "CookedBlob.hxx"
+#include "Histogram.hxx"
+
+class StagingBelt;
+
+// Loads textures from disk without stalling the frame. Decoding threads take the highest
+// priority request, map the file and decode it (see ImageDecoder) into RGBA8 rows at the
+// 256-byte pitch of buffer-to-texture copies; cooked .texture blobs are in that layout
+// already and are mapped and faulted in. Once per frame update() creates the textures of
+// decoded images and copies their rows through the staging belt, highest priority first and
+// within the per-frame byte budget, so a large image arrives over several frames instead of
+// in one long one; at least one row moves per frame. Decoding pauses while too many decoded
+// bytes wait for upload. Requests can be reprioritized or cancelled at any stage.
+// Render thread only; the decoding threads are internal.
+//   APP_TEXTURE_THREADS     decoding threads (default 2)
+//   APP_TEXTURE_UPLOAD_MB   texel bytes uploaded per frame (default 16)
+//   APP_TEXTURE_PENDING_MB  decoded bytes waiting for upload before decoding pauses (default 256)
+class TextureStreamer
+{
+public:
+	struct Settings
+	{
+		uint32_t threadCount;
+		uint64_t uploadBytes;
+		uint64_t pendingBytes;
+
+		static Settings fromConfig();
+	};
+
+	using Handle = uint32_t;
+
+	enum class State
+	{
+		Queued,
+		Decoding,
+		Uploading,
+		Ready,
+		Failed,
+		Cancelled
+	};
+
+	struct Stats
+	{
+		uint64_t requested;
+		uint64_t ready;
+		uint64_t failed;
+		uint64_t cancelled;
+		uint64_t bytesUploaded;
+		// Wall time with requests outstanding, and the parts of it spent decoding (summed over
+		// threads) and copying into staging memory.
+		double busySeconds;
+		double decodeSeconds;
+		double copySeconds;
+		// Request to ready, in nanoseconds.
+		Histogram latency;
+	};
+
+	// arg_MaxDimension is the device's maxTextureDimension2D; larger images fail.
+	TextureStreamer(WGPUDevice arg_Device, Settings arg_Settings, uint32_t arg_MaxDimension);
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	// Higher priorities are decoded and uploaded first; equal ones in request order.
+	Handle request(const std::string& arg_Path, int arg_Priority);
+	void setPriority(Handle arg_Handle, int arg_Priority);
+	// Drops the request wherever it is and releases its texture.
+	void cancel(Handle arg_Handle);
+
+	// Records this frame's uploads; before the staging belt's finish().
+	void update(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging);
+
+	State getState(Handle arg_Handle) const;
+	// RGBA8UnormSrgb with TextureBinding usage, or null until ready.
+	WGPUTexture getTexture(Handle arg_Handle) const;
+	// Why a failed request failed.
+	std::string getError(Handle arg_Handle) const;
+	// True while requests are queued, decoding or uploading.
+	bool isBusy() const;
+
+	Stats getStats() const;
+	void logSummary() const;
+
+private:
+	struct Request
+	{
+		std::string path;
+		int priority;
+		State state;
+		// Set while decoding; the decoding thread drops the result.
+		bool cancelled;
+		std::chrono::steady_clock::time_point requested;
+
+		// Filled in by the decoding thread: rows of bytesPerRow from texels, or from the
+		// payload of a cooked blob.
+		uint32_t width;
+		uint32_t height;
+		uint32_t bytesPerRow;
+		std::vector<uint8_t> texels;
+		std::unique_ptr<CookedBlob> blob;
+		std::string error;
+
+		uint32_t rowsUploaded;
+		WGPUTexture texture;
+	};
+
+	void workerMain();
+	// Higher priority, then earlier request.
+	bool isBefore(Handle arg_Left, Handle arg_Right) const;
+	void decode(Request& arg_Request) const;
+	// Copies as many rows as fit in arg_MaxBytes, creating the texture first; returns the
+	// number copied. Sets the request's error if the texture can't be created.
+	uint32_t upload(WGPUCommandEncoder arg_Encoder, StagingBelt& arg_Staging, Request& arg_Request, uint64_t arg_MaxBytes);
+	static void releaseData(Request& arg_Request);
+
+private:
+	WGPUDevice device;
+	Settings settings;
+	uint32_t maxDimension;
+
+	mutable std::mutex mutex;
+	std::condition_variable wake;
+	std::vector<std::thread> workers;
+	bool stopping = false;
+
+	// Indexed by handle. Guarded by the mutex, apart from the fields of a request owned by
+	// the thread that decodes or uploads it.
+	std::vector<std::unique_ptr<Request>> requests;
+	// Waiting for a decoding thread.
+	std::vector<Handle> queued;
+	// Decoded, not yet taken by update().
+	std::vector<Handle> decoded;
+	uint64_t pendingBytes = 0;
+	Stats stats{};
+
+	// Render thread only: decoded requests being uploaded, and the time of the last update().
+	std::vector<Handle> uploads;
+	std::chrono::steady_clock::time_point lastUpdate;
+};
@@ -0,0 +1,65 @@
+#include "UniformRing.hxx"
+#include "BindGroupCache.hxx"
+
+#include <cstring>
+#include <stdexcept>
+
+UniformRing::UniformRing(WGPUDevice arg_Device, uint32_t arg_Alignment, uint64_t arg_Capacity, const char* arg_Label)
+	: alignment(arg_Alignment ? arg_Alignment : 256), capacity((arg_Capacity + 3) & ~static_cast<uint64_t>(3))
+{
+	WGPUBufferDescriptor bufferDesc{};
+	bufferDesc.nextInChain = nullptr;
+	bufferDesc.label = arg_Label;
+	bufferDesc.size = capacity;
+	bufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform;
+	bufferDesc.mappedAtCreation = false;
+	buffer = wgpuDeviceCreateBuffer(arg_Device, &bufferDesc);
+
+	if (!buffer) throw std::runtime_error("Could not create uniform ring buffer");
+
+	staging.resize(capacity);
+}
+
+UniformRing::~UniformRing()
+{
+	if (buffer)
+	{
+		wgpuBufferDestroy(buffer);
+		wgpuBufferRelease(buffer);
+	}
+}
+
+bool UniformRing::push(const void* arg_Data, uint32_t arg_Size, uint32_t& arg_Offset)
+{
+	if (head + arg_Size > capacity) return false;
+
+	arg_Offset = static_cast<uint32_t>(head);
+	std::memcpy(staging.data() + head, arg_Data, arg_Size);
+
+	lastEnd = head + arg_Size;
+	head += alignUp(arg_Size, alignment);
+
+	return true;
+}
+
+void UniformRing::flush(WGPUQueue arg_Queue)
+{
+	if (head == 0) return;
+
+	// Queue writes are ordered after earlier submits and before later ones, so overwriting
+	// the previous frame's data here never races with the GPU reading it.
+	uint64_t size = (lastEnd + 3) & ~static_cast<uint64_t>(3);
+	wgpuQueueWriteBuffer(arg_Queue, buffer, 0, staging.data(), size);
+}
+
+WGPUBindGroup UniformRing::getBindGroup(BindGroupCache& arg_Cache, WGPUBindGroupLayout arg_Layout, uint32_t arg_Binding, uint64_t arg_BindingSize) const
+{
+	WGPUBindGroupEntry entry{};
+	entry.nextInChain = nullptr;
+	entry.binding = arg_Binding;
+	entry.buffer = buffer;
+	entry.offset = 0;
+	entry.size = arg_BindingSize;
+
+	return arg_Cache.get(arg_Layout, &entry, 1);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <webgpu/webgpu.h>
+
+class BindGroupCache;
+
+// Per-frame linear allocator over one uniform buffer. Each push() copies into a CPU
+// staging area at the next offset aligned to minUniformBufferOffsetAlignment and returns
+// that offset for use as a dynamic offset; flush() uploads everything pushed this frame
+// with a single wgpuQueueWriteBuffer. A single bind group covering one binding-sized window
+// serves every allocation.
+class UniformRing
+{
+public:
+	UniformRing(WGPUDevice arg_Device, uint32_t arg_Alignment, uint64_t arg_Capacity, const char* arg_Label);
+	~UniformRing();
+
+	UniformRing(const UniformRing&) = delete;
+	UniformRing& operator=(const UniformRing&) = delete;
+
+	void beginFrame() { head = 0; }
+
+	// Returns false if the ring is full for this frame.
+	bool push(const void* arg_Data, uint32_t arg_Size, uint32_t& arg_Offset);
+
+	// Must be called after encoding and before the frame's wgpuQueueSubmit.
+	void flush(WGPUQueue arg_Queue);
+
+	WGPUBindGroup getBindGroup(BindGroupCache& arg_Cache, WGPUBindGroupLayout arg_Layout, uint32_t arg_Binding, uint64_t arg_BindingSize) const;
+
+	WGPUBuffer getBuffer() const { return buffer; }
+	uint32_t getAlignment() const { return alignment; }
+	uint64_t getCapacity() const { return capacity; }
+	uint64_t getBytesUsed() const { return head; }
+
+	static uint32_t alignUp(uint32_t arg_Size, uint32_t arg_Alignment)
+	{
+		return (arg_Size + arg_Alignment - 1) / arg_Alignment * arg_Alignment;
+	}
+
+private:
+	WGPUBuffer buffer = nullptr;
+	uint32_t alignment;
+	uint64_t capacity;
+	uint64_t head = 0;
+	uint64_t lastEnd = 0;
+	std::vector<uint8_t> staging;
+};
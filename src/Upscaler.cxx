@@ -0,0 +1,208 @@
+#include "Upscaler.hxx"
+#include "BindGroupCache.hxx"
+#include "GpuDebug.hxx"
+#include "ShaderPreprocessor.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	struct UpscaleParams
+	{
+		float uvScale[2];
+		float uvMax[2];
+	};
+}
+
+Upscaler::Upscaler(WGPUDevice arg_Device, WGPUQueue arg_Queue, BindGroupCache& arg_BindGroupCache, WGPUTextureFormat arg_Format, const std::string& arg_ShaderPath)
+	: device(arg_Device),
+	queue(arg_Queue),
+	bindGroupCache(arg_BindGroupCache),
+	format(arg_Format)
+{
+	const std::string source = ShaderPreprocessor().process(arg_ShaderPath);
+
+	WGPUShaderModuleWGSLDescriptor wgslDesc{};
+	wgslDesc.chain.next = nullptr;
+	wgslDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
+	wgslDesc.code = source.c_str();
+
+	WGPUShaderModuleDescriptor shaderDesc{};
+	shaderDesc.nextInChain = &wgslDesc.chain;
+	shaderDesc.label = GPU_LABEL("Upscale shader");
+	WGPUShaderModule shaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
+	if (!shaderModule) throw std::runtime_error("Could not create upscale shader module");
+
+	WGPUColorTargetState colorTarget{};
+	colorTarget.format = format;
+	colorTarget.blend = nullptr;
+	colorTarget.writeMask = WGPUColorWriteMask_All;
+
+	WGPUFragmentState fragmentState{};
+	fragmentState.module = shaderModule;
+	fragmentState.entryPoint = "fs_main";
+	fragmentState.constantCount = 0;
+	fragmentState.constants = nullptr;
+	fragmentState.targetCount = 1;
+	fragmentState.targets = &colorTarget;
+
+	WGPURenderPipelineDescriptor pipelineDesc{};
+	pipelineDesc.nextInChain = nullptr;
+	pipelineDesc.label = GPU_LABEL("Upscale pipeline");
+	pipelineDesc.layout = nullptr;
+	pipelineDesc.vertex.module = shaderModule;
+	pipelineDesc.vertex.entryPoint = "vs_main";
+	pipelineDesc.vertex.bufferCount = 0;
+	pipelineDesc.vertex.buffers = nullptr;
+	pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
+	pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
+	pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
+	pipelineDesc.primitive.cullMode = WGPUCullMode_None;
+	pipelineDesc.fragment = &fragmentState;
+	pipelineDesc.depthStencil = nullptr;
+	pipelineDesc.multisample.count = 1;
+	pipelineDesc.multisample.mask = ~0u;
+	pipelineDesc.multisample.alphaToCoverageEnabled = false;
+
+	pipeline = wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
+	wgpuShaderModuleRelease(shaderModule);
+	if (!pipeline) throw std::runtime_error("Could not create upscale pipeline");
+
+	bindGroupLayout = wgpuRenderPipelineGetBindGroupLayout(pipeline, 0);
+
+	WGPUSamplerDescriptor samplerDesc{};
+	samplerDesc.nextInChain = nullptr;
+	samplerDesc.label = GPU_LABEL("Upscale sampler");
+	samplerDesc.addressModeU = WGPUAddressMode_ClampToEdge;
+	samplerDesc.addressModeV = WGPUAddressMode_ClampToEdge;
+	samplerDesc.addressModeW = WGPUAddressMode_ClampToEdge;
+	samplerDesc.magFilter = WGPUFilterMode_Linear;
+	samplerDesc.minFilter = WGPUFilterMode_Linear;
+	samplerDesc.mipmapFilter = WGPUMipmapFilterMode_Nearest;
+	samplerDesc.lodMinClamp = 0.0f;
+	samplerDesc.lodMaxClamp = 1.0f;
+	samplerDesc.compare = WGPUCompareFunction_Undefined;
+	samplerDesc.maxAnisotropy = 1;
+	sampler = wgpuDeviceCreateSampler(device, &samplerDesc);
+
+	WGPUBufferDescriptor paramsDesc{};
+	paramsDesc.nextInChain = nullptr;
+	paramsDesc.label = GPU_LABEL("Upscale parameters");
+	paramsDesc.usage = WGPUBufferUsage_Uniform | WGPUBufferUsage_CopyDst;
+	paramsDesc.size = sizeof(UpscaleParams);
+	paramsDesc.mappedAtCreation = false;
+	paramsBuffer = wgpuDeviceCreateBuffer(device, &paramsDesc);
+
+	if (!sampler || !paramsBuffer) throw std::runtime_error("Could not create upscale resources");
+}
+
+Upscaler::~Upscaler()
+{
+	releaseTarget();
+	if (bindGroupLayout) bindGroupCache.evictLayout(bindGroupLayout);
+	if (paramsBuffer) wgpuBufferRelease(paramsBuffer);
+	if (sampler) wgpuSamplerRelease(sampler);
+	if (bindGroupLayout) wgpuBindGroupLayoutRelease(bindGroupLayout);
+	if (pipeline) wgpuRenderPipelineRelease(pipeline);
+}
+
+void Upscaler::resize(uint32_t arg_Width, uint32_t arg_Height)
+{
+	if (arg_Width == width && arg_Height == height && target) return;
+
+	releaseTarget();
+	width = arg_Width;
+	height = arg_Height;
+	writtenWidth = 0;
+	writtenHeight = 0;
+
+	WGPUTextureDescriptor targetDesc{};
+	targetDesc.nextInChain = nullptr;
+	targetDesc.label = GPU_LABEL("Scaled render target");
+	targetDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding;
+	targetDesc.dimension = WGPUTextureDimension_2D;
+	targetDesc.size = { width, height, 1 };
+	targetDesc.format = format;
+	targetDesc.mipLevelCount = 1;
+	targetDesc.sampleCount = 1;
+	targetDesc.viewFormatCount = 0;
+	targetDesc.viewFormats = nullptr;
+	target = wgpuDeviceCreateTexture(device, &targetDesc);
+	if (!target) throw std::runtime_error("Could not create scaled render target");
+
+	targetView = wgpuTextureCreateView(target, nullptr);
+
+	WGPUBindGroupEntry entries[3] = {};
+	entries[0].binding = 0;
+	entries[0].textureView = targetView;
+	entries[1].binding = 1;
+	entries[1].sampler = sampler;
+	entries[2].binding = 2;
+	entries[2].buffer = paramsBuffer;
+	entries[2].offset = 0;
+	entries[2].size = sizeof(UpscaleParams);
+	bindGroup = bindGroupCache.get(bindGroupLayout, entries, 3);
+}
+
+void Upscaler::getRenderSize(double arg_Scale, uint32_t& arg_Width, uint32_t& arg_Height) const
+{
+	arg_Width = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(width * arg_Scale)), 1, std::max(width, 1u));
+	arg_Height = std::clamp<uint32_t>(static_cast<uint32_t>(std::lround(height * arg_Scale)), 1, std::max(height, 1u));
+}
+
+void Upscaler::encode(WGPUCommandEncoder arg_Encoder, WGPUTextureView arg_Destination, double arg_Scale)
+{
+	uint32_t renderWidth = 0;
+	uint32_t renderHeight = 0;
+	getRenderSize(arg_Scale, renderWidth, renderHeight);
+
+	if (renderWidth != writtenWidth || renderHeight != writtenHeight)
+	{
+		UpscaleParams params{};
+		params.uvScale[0] = static_cast<float>(renderWidth) / static_cast<float>(width);
+		params.uvScale[1] = static_cast<float>(renderHeight) / static_cast<float>(height);
+		params.uvMax[0] = (static_cast<float>(renderWidth) - 0.5f) / static_cast<float>(width);
+		params.uvMax[1] = (static_cast<float>(renderHeight) - 0.5f) / static_cast<float>(height);
+		wgpuQueueWriteBuffer(queue, paramsBuffer, 0, &params, sizeof(params));
+
+		writtenWidth = renderWidth;
+		writtenHeight = renderHeight;
+	}
+
+	WGPURenderPassColorAttachment colorAttachment{};
+	colorAttachment.view = arg_Destination;
+	colorAttachment.loadOp = WGPULoadOp_Clear;
+	colorAttachment.storeOp = WGPUStoreOp_Store;
+	colorAttachment.clearValue = { 0.0, 0.0, 0.0, 1.0 };
+
+	WGPURenderPassDescriptor passDesc{};
+	passDesc.label = GPU_LABEL("Upscale pass");
+	passDesc.colorAttachmentCount = 1;
+	passDesc.colorAttachments = &colorAttachment;
+
+	WGPURenderPassEncoder pass = wgpuCommandEncoderBeginRenderPass(arg_Encoder, &passDesc);
+	wgpuRenderPassEncoderSetPipeline(pass, pipeline);
+	wgpuRenderPassEncoderSetBindGroup(pass, 0, bindGroup, 0, nullptr);
+	wgpuRenderPassEncoderDraw(pass, 3, 1, 0, 0);
+	wgpuRenderPassEncoderEnd(pass);
+	wgpuRenderPassEncoderRelease(pass);
+}
+
+void Upscaler::releaseTarget()
+{
+	if (targetView)
+	{
+		bindGroupCache.evictTextureView(targetView);
+		wgpuTextureViewRelease(targetView);
+	}
+	if (target)
+	{
+		wgpuTextureDestroy(target);
+		wgpuTextureRelease(target);
+	}
+	bindGroup = nullptr;
+	targetView = nullptr;
+	target = nullptr;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <webgpu/webgpu.h>
+
+class BindGroupCache;
+
+// Offscreen render target for dynamic resolution plus the bilinear pass that scales it onto
+// the surface. The target is allocated at the full surface size and the scene is rendered
+// into its top-left corner through the viewport, so changing the scale never reallocates
+// anything; only a surface resize does.
+class Upscaler
+{
+public:
+	// The sampling bind group comes from arg_BindGroupCache, which must outlive the upscaler.
+	Upscaler(WGPUDevice arg_Device, WGPUQueue arg_Queue, BindGroupCache& arg_BindGroupCache, WGPUTextureFormat arg_Format, const std::string& arg_ShaderPath);
+	~Upscaler();
+
+	Upscaler(const Upscaler&) = delete;
+	Upscaler& operator=(const Upscaler&) = delete;
+
+	// Full-resolution size, i.e. the surface size.
+	void resize(uint32_t arg_Width, uint32_t arg_Height);
+
+	// Size of the region rendered at the given scale.
+	void getRenderSize(double arg_Scale, uint32_t& arg_Width, uint32_t& arg_Height) const;
+
+	WGPUTextureView getTargetView() const { return targetView; }
+
+	// Records the pass that samples the region rendered at arg_Scale onto arg_Destination.
+	void encode(WGPUCommandEncoder arg_Encoder, WGPUTextureView arg_Destination, double arg_Scale);
+
+private:
+	void releaseTarget();
+
+private:
+	WGPUDevice device;
+	WGPUQueue queue;
+	BindGroupCache& bindGroupCache;
+	WGPUTextureFormat format;
+
+	WGPURenderPipeline pipeline = nullptr;
+	WGPUBindGroupLayout bindGroupLayout = nullptr;
+	WGPUSampler sampler = nullptr;
+	WGPUBuffer paramsBuffer = nullptr;
+
+	WGPUTexture target = nullptr;
+	WGPUTextureView targetView = nullptr;
+	// Owned by the cache; evicted along with the target view.
+	WGPUBindGroup bindGroup = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	uint32_t writtenWidth = 0;
+	uint32_t writtenHeight = 0;
+};
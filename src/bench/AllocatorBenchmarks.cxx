@@ -0,0 +1,227 @@
+#include "AllocatorBenchmarks.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "DrawParameters.hxx"
+#include "FrameArena.hxx"
+#include "ObjectPool.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+
+#if defined(__GLIBC__)
+	#include <malloc.h>
+#endif
+
+namespace
+{
+	const uint32_t SCENE_SIZES[] = { 256, 4096 };
+
+	// Scratch arrays of one frame: culling lists, sort keys, staging and the like.
+	const size_t SCRATCH_SIZES[] = { 64, 256, 1024, 4096, 16384, 512, 128, 2048, 8192, 96, 384, 1536, 6144, 32, 768, 3072 };
+
+	DrawRecord makeRecord(uint32_t arg_Index, uint32_t arg_Count)
+	{
+		DrawRecord record{};
+		makeGridDrawParams(arg_Index, arg_Count, record.params);
+		record.sortKey = (static_cast<uint64_t>(arg_Index % 8) << 56) | arg_Index;
+		record.vertexCount = 3;
+		return record;
+	}
+
+	std::vector<uint32_t> shuffledIndices(uint32_t arg_Count)
+	{
+		std::vector<uint32_t> indices(arg_Count);
+		for (uint32_t i = 0; i < arg_Count; ++i) indices[i] = i;
+		std::shuffle(indices.begin(), indices.end(), std::mt19937(42));
+		return indices;
+	}
+
+	struct HeapStats
+	{
+		bool available;
+		size_t heapBytes;
+		size_t freeBytes;
+	};
+
+	HeapStats getHeapStats()
+	{
+		HeapStats stats{};
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+		const struct mallinfo2 info = mallinfo2();
+		stats.available = true;
+		stats.heapBytes = info.arena + info.hblkhd;
+		stats.freeBytes = info.fordblks;
+#endif
+		return stats;
+	}
+
+	// Draw records with lifetimes of 1 to maxLifetime frames, created at a load that drifts
+	// and spikes, so slabs fill and drain at different rates. arg_Report runs after the last
+	// frame, while that frame's records are still alive.
+	template <typename Create, typename Destroy, typename Report>
+	std::vector<double> soak(uint64_t arg_Frames, Create&& arg_Create, Destroy&& arg_Destroy, Report&& arg_Report)
+	{
+		const uint32_t maxLifetime = 240;
+
+		std::mt19937 rng(7);
+		std::uniform_int_distribution<uint32_t> lifetime(1, maxLifetime);
+		std::uniform_real_distribution<double> spike(0.0, 1.0);
+
+		std::vector<std::vector<DrawRecord*>> expiring(maxLifetime + 1);
+		std::vector<double> frameNs;
+		frameNs.reserve(arg_Frames);
+
+		for (uint64_t frame = 0; frame < arg_Frames; ++frame)
+		{
+			const double load = 1000.0 + 800.0 * std::sin(static_cast<double>(frame) / 900.0);
+			const uint32_t created = static_cast<uint32_t>(spike(rng) < 0.01 ? load * 4.0 : load);
+
+			auto start = std::chrono::steady_clock::now();
+
+			std::vector<DrawRecord*>& expired = expiring[frame % expiring.size()];
+			for (DrawRecord* record : expired) arg_Destroy(record);
+			expired.clear();
+
+			for (uint32_t i = 0; i < created; ++i)
+			{
+				DrawRecord* record = arg_Create(makeRecord(i, created));
+				expiring[(frame + lifetime(rng)) % expiring.size()].push_back(record);
+			}
+
+			frameNs.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+		}
+
+		arg_Report();
+
+		for (std::vector<DrawRecord*>& records : expiring)
+			for (DrawRecord* record : records) arg_Destroy(record);
+
+		return frameNs;
+	}
+
+	void runSoak(BenchmarkSuite& arg_Suite)
+	{
+		const uint64_t frames = static_cast<uint64_t>(std::max(100LL, Config::getInt("APP_BENCH_SOAK_FRAMES", 20000)));
+
+		if (arg_Suite.isSelected("alloc/soak/new"))
+		{
+			HeapStats last{};
+			std::vector<double> frameNs = soak(frames,
+				[](const DrawRecord& arg_Record) { return new DrawRecord(arg_Record); },
+				[](DrawRecord* arg_Record) { delete arg_Record; },
+				[&]() { last = getHeapStats(); });
+			arg_Suite.addSamples("alloc/soak/new", "ns", 1, std::move(frameNs));
+
+			// Free bytes inside the heap that the live records pin in place.
+			if (last.available)
+			{
+				const double freeRatio = last.heapBytes > 0 ? static_cast<double>(last.freeBytes) / static_cast<double>(last.heapBytes) : 0.0;
+				arg_Suite.setContext("soak.heap.bytes", std::to_string(last.heapBytes));
+				arg_Suite.setContext("soak.heap.freeRatio", std::to_string(freeRatio));
+				std::cerr << "soak heap: " << last.heapBytes / 1024 << " KiB held, " << freeRatio * 100.0 << "% of it free\n";
+			}
+		}
+
+		if (arg_Suite.isSelected("alloc/soak/pool"))
+		{
+			ObjectPool<DrawRecord> pool;
+			FixedBlockPool::FragmentationReport report{};
+			std::vector<double> frameNs = soak(frames,
+				[&](const DrawRecord& arg_Record) { return pool.create(arg_Record); },
+				[&](DrawRecord* arg_Record) { pool.destroy(arg_Record); },
+				[&]() { report = pool.getFragmentationReport(); });
+			arg_Suite.addSamples("alloc/soak/pool", "ns", 1, std::move(frameNs));
+
+			arg_Suite.setContext("soak.pool.bytes", std::to_string(report.stats.capacity * report.stats.blockSize));
+			arg_Suite.setContext("soak.pool.freeRatio", std::to_string(report.freeRatio));
+			arg_Suite.setContext("soak.pool.sparseSlabs", std::to_string(report.sparseSlabs + report.emptySlabs));
+			std::cerr << "soak pool: " << report.stats.slabs << " slabs, " << report.stats.live << " live of " << report.stats.capacity
+				<< " blocks (peak " << report.stats.peakLive << "), " << report.freeRatio * 100.0 << "% free, "
+				<< report.emptySlabs << " empty, " << report.sparseSlabs << " at most a quarter used, "
+				<< report.fullSlabs << " full\n";
+		}
+	}
+}
+
+void runAllocatorBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	for (uint32_t size : SCENE_SIZES)
+	{
+		const std::string suffix = "/" + std::to_string(size);
+
+		arg_Suite.run("alloc/drawList/heap" + suffix, size, [&]()
+			{
+				std::vector<DrawRecord> drawList;
+				for (uint32_t i = 0; i < size; ++i) drawList.push_back(makeRecord(i, size));
+				doNotOptimize(drawList.data());
+			});
+
+		LinearArena drawListArena;
+		arg_Suite.run("alloc/drawList/arena" + suffix, size, [&]()
+			{
+				drawListArena.reset();
+				std::vector<DrawRecord, ArenaAllocator<DrawRecord>> drawList{ ArenaAllocator<DrawRecord>(drawListArena) };
+				for (uint32_t i = 0; i < size; ++i) drawList.push_back(makeRecord(i, size));
+				doNotOptimize(drawList.data());
+			});
+
+		const std::vector<uint32_t> order = shuffledIndices(size);
+		std::vector<DrawRecord*> records(size);
+
+		arg_Suite.run("alloc/records/new" + suffix, size, [&]()
+			{
+				for (uint32_t i = 0; i < size; ++i) records[i] = new DrawRecord(makeRecord(i, size));
+				doNotOptimize(records.data());
+				for (uint32_t i : order) delete records[i];
+			});
+
+		ObjectPool<DrawRecord> recordPool;
+		arg_Suite.run("alloc/records/pool" + suffix, size, [&]()
+			{
+				for (uint32_t i = 0; i < size; ++i) records[i] = recordPool.create(makeRecord(i, size));
+				doNotOptimize(records.data());
+				for (uint32_t i : order) recordPool.destroy(records[i]);
+			});
+
+		arg_Suite.run("alloc/map/heap" + suffix, size, [&]()
+			{
+				std::map<uint32_t, uint32_t> map;
+				for (uint32_t key : order) map.emplace(key, key);
+				doNotOptimize(map.size());
+			});
+
+		BlockPoolSet nodePools;
+		arg_Suite.run("alloc/map/pool" + suffix, size, [&]()
+			{
+				using PooledMap = std::map<uint32_t, uint32_t, std::less<uint32_t>, PoolAllocator<std::pair<const uint32_t, uint32_t>>>;
+				PooledMap map{ PoolAllocator<std::pair<const uint32_t, uint32_t>>(nodePools) };
+				for (uint32_t key : order) map.emplace(key, key);
+				doNotOptimize(map.size());
+			});
+	}
+
+	const size_t scratchCount = sizeof(SCRATCH_SIZES) / sizeof(SCRATCH_SIZES[0]);
+	void* scratch[scratchCount];
+
+	arg_Suite.run("alloc/scratch/malloc", scratchCount, [&]()
+		{
+			for (size_t i = 0; i < scratchCount; ++i) scratch[i] = std::malloc(SCRATCH_SIZES[i]);
+			doNotOptimize(scratch);
+			for (size_t i = 0; i < scratchCount; ++i) std::free(scratch[i]);
+		});
+
+	LinearArena scratchArena;
+	arg_Suite.run("alloc/scratch/arena", scratchCount, [&]()
+		{
+			scratchArena.reset();
+			for (size_t i = 0; i < scratchCount; ++i) scratch[i] = scratchArena.allocate(SCRATCH_SIZES[i]);
+			doNotOptimize(scratch);
+		});
+
+	runSoak(arg_Suite);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// The allocators in FrameArena.hxx and ObjectPool.hxx against the general heap, on the
+// allocation patterns of a frame: draw lists, scratch arrays, short-lived draw records and
+// node containers. A soak run then churns draw records with varying lifetimes for many
+// frames and reports how fragmented the pool and the heap ended up.
+void runAllocatorBenchmarks(BenchmarkSuite& arg_Suite);
@@ -0,0 +1,260 @@
+#include "Config.hxx"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Compares two bench reports and fails if any benchmark got slower than the threshold.
+//   bench_compare <baseline.json> <current.json> [--threshold=0.1] [--metric=p50]
+// The metric is one of mean, p50, p95, p99. With mean, a change also has to exceed two
+// standard errors, so a noisy benchmark does not fail on jitter alone.
+namespace
+{
+	struct Entry
+	{
+		std::map<std::string, double> numbers;
+		std::string skipped;
+	};
+
+	// Just enough JSON for the reports bench writes: objects, arrays, strings and numbers.
+	class ReportParser
+	{
+	public:
+		explicit ReportParser(std::string arg_Text) : text(std::move(arg_Text)) {}
+
+		std::map<std::string, Entry> parse()
+		{
+			std::map<std::string, Entry> entries;
+
+			expect('{');
+			while (!consume('}'))
+			{
+				const std::string key = parseString();
+				expect(':');
+				if (key == "benchmarks") parseBenchmarks(entries);
+				else skipValue();
+				consume(',');
+			}
+
+			return entries;
+		}
+
+	private:
+		void parseBenchmarks(std::map<std::string, Entry>& arg_Entries)
+		{
+			expect('[');
+			while (!consume(']'))
+			{
+				std::string name;
+				Entry entry;
+
+				expect('{');
+				while (!consume('}'))
+				{
+					const std::string key = parseString();
+					expect(':');
+					skipSpace();
+					if (text[position] == '"')
+					{
+						const std::string value = parseString();
+						if (key == "name") name = value;
+						else if (key == "skipped") entry.skipped = value;
+					}
+					else
+					{
+						entry.numbers[key] = parseNumber();
+					}
+					consume(',');
+				}
+
+				arg_Entries[name] = entry;
+				consume(',');
+			}
+		}
+
+		void skipValue()
+		{
+			skipSpace();
+			const char c = peek();
+			if (c == '"')
+			{
+				parseString();
+			}
+			else if (c == '{' || c == '[')
+			{
+				const char close = c == '{' ? '}' : ']';
+				++position;
+				while (!consume(close))
+				{
+					skipValue();
+					consume(':');
+					consume(',');
+				}
+			}
+			else
+			{
+				while (position < text.size() && text[position] != ',' && text[position] != '}' && text[position] != ']') ++position;
+			}
+		}
+
+		std::string parseString()
+		{
+			expect('"');
+			std::string value;
+			while (position < text.size() && text[position] != '"')
+			{
+				if (text[position] == '\\' && position + 1 < text.size()) ++position;
+				value += text[position++];
+			}
+			expect('"');
+			return value;
+		}
+
+		double parseNumber()
+		{
+			skipSpace();
+			const char* start = text.c_str() + position;
+			char* end = nullptr;
+			const double value = std::strtod(start, &end);
+			if (end == start) fail("number");
+			position += static_cast<size_t>(end - start);
+			return value;
+		}
+
+		void skipSpace()
+		{
+			while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) ++position;
+		}
+
+		char peek()
+		{
+			skipSpace();
+			return position < text.size() ? text[position] : '\0';
+		}
+
+		bool consume(char arg_Char)
+		{
+			if (peek() != arg_Char) return false;
+			++position;
+			return true;
+		}
+
+		void expect(char arg_Char)
+		{
+			if (!consume(arg_Char)) fail(std::string("'") + arg_Char + "'");
+		}
+
+		[[noreturn]] void fail(const std::string& arg_Expected) const
+		{
+			throw std::runtime_error("Malformed report: expected " + arg_Expected + " at offset " + std::to_string(position));
+		}
+
+	private:
+		std::string text;
+		size_t position = 0;
+	};
+
+	std::map<std::string, Entry> loadReport(const std::string& arg_Path)
+	{
+		std::ifstream file(arg_Path);
+		if (!file) throw std::runtime_error("Could not read " + arg_Path);
+
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		return ReportParser(buffer.str()).parse();
+	}
+
+	double squaredStandardError(const Entry& arg_Entry)
+	{
+		auto variance = arg_Entry.numbers.find("variance");
+		auto samples = arg_Entry.numbers.find("samples");
+		if (variance == arg_Entry.numbers.end() || samples == arg_Entry.numbers.end() || samples->second < 1.0) return 0.0;
+
+		return variance->second / samples->second;
+	}
+}
+
+int main(int argc, char** argv) try
+{
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i)
+		if (std::string(argv[i]).compare(0, 2, "--") != 0) paths.push_back(argv[i]);
+	Config::parseCommandLine(argc, argv);
+
+	if (paths.size() != 2)
+	{
+		std::cerr << "usage: bench_compare <baseline.json> <current.json> [--threshold=0.1] [--metric=p50]\n";
+		return 2;
+	}
+
+	const double threshold = Config::getDouble("APP_THRESHOLD", 0.1);
+	const std::string metric = Config::getString("APP_METRIC", "p50");
+
+	const std::map<std::string, Entry> baseline = loadReport(paths[0]);
+	const std::map<std::string, Entry> current = loadReport(paths[1]);
+
+	size_t regressions = 0;
+	std::cout << std::fixed << std::setprecision(3);
+
+	for (const auto& [name, entry] : current)
+	{
+		auto base = baseline.find(name);
+		if (base == baseline.end())
+		{
+			std::cout << "new        " << name << '\n';
+			continue;
+		}
+		if (!entry.skipped.empty() || !base->second.skipped.empty())
+		{
+			std::cout << "skipped    " << name << '\n';
+			continue;
+		}
+
+		auto before = base->second.numbers.find(metric);
+		auto after = entry.numbers.find(metric);
+		if (before == base->second.numbers.end() || after == entry.numbers.end() || before->second <= 0.0)
+		{
+			std::cout << "no " << metric << "     " << name << '\n';
+			continue;
+		}
+
+		const double change = after->second / before->second - 1.0;
+		bool significant = std::abs(change) > threshold;
+		if (metric == "mean")
+			significant = significant && std::abs(after->second - before->second) > 2.0 * std::sqrt(squaredStandardError(entry) + squaredStandardError(base->second));
+
+		const char* verdict = "ok         ";
+		if (significant && change > 0.0)
+		{
+			verdict = "REGRESSION ";
+			++regressions;
+		}
+		else if (significant)
+		{
+			verdict = "improved   ";
+		}
+
+		std::cout << verdict << name << ": " << before->second << " -> " << after->second
+			<< " (" << std::showpos << change * 100.0 << std::noshowpos << "%)\n";
+	}
+
+	for (const auto& [name, entry] : baseline)
+		if (current.find(name) == current.end()) std::cout << "missing    " << name << '\n';
+
+	std::cout << regressions << " regression(s) beyond " << threshold * 100.0 << "% in " << metric << '\n';
+
+	return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+catch (const std::exception& err)
+{
+	std::cerr << err.what() << '\n';
+	return 2;
+}
@@ -0,0 +1,123 @@
+#include "AllocatorBenchmarks.hxx"
+#include "Application.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "CpuBenchmarks.hxx"
+#include "SceneBenchmarks.hxx"
+#include "SceneFileBenchmarks.hxx"
+#include "SpatialBenchmarks.hxx"
+#include "TextureBenchmarks.hxx"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+	std::vector<uint32_t> parseSizes(const std::string& arg_List)
+	{
+		std::vector<uint32_t> sizes;
+		std::stringstream stream(arg_List);
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			char* end = nullptr;
+			unsigned long value = std::strtoul(item.c_str(), &end, 10);
+			if (end != item.c_str() && value > 0) sizes.push_back(static_cast<uint32_t>(value));
+		}
+		return sizes;
+	}
+
+	// Drives the real render loop headlessly. Frame times include waiting for the GPU, so on
+	// a software adapter they measure the rasterizer as much as the renderer.
+	void runFrameBenchmarks(BenchmarkSuite& arg_Suite, std::string& arg_AdapterName)
+	{
+		const uint64_t frames = static_cast<uint64_t>(std::max(10LL, Config::getInt("APP_BENCH_FRAMES", 300)));
+		const std::vector<uint32_t> sizes = parseSizes(Config::getString("APP_BENCH_SCENES", "1,64,1024"));
+
+		for (uint32_t size : sizes)
+		{
+			const std::string name = "frame/draws/" + std::to_string(size);
+			if (!arg_Suite.isSelected(name)) continue;
+
+			Application::Options options = Application::Options::fromConfig();
+			options.headless = true;
+			options.frames = frames;
+			options.drawsPerFrame = size;
+
+			try
+			{
+				Application app(options);
+				app.run();
+
+				// The first frames include pipeline creation and first-use costs.
+				const std::vector<double>& times = app.getFrameTimes();
+				const size_t warmup = std::min<size_t>(times.size() / 10, 30);
+				arg_Suite.addSamples(name, "ms", app.getDrawsPerFrame(), std::vector<double>(times.begin() + warmup, times.end()));
+				arg_AdapterName = app.getAdapterName();
+
+				std::cerr << name << ": done\n";
+			}
+			catch (const std::exception& err)
+			{
+				std::cerr << name << ": skipped, " << err.what() << '\n';
+				arg_Suite.skip(name, err.what());
+			}
+		}
+	}
+}
+
+// Runs the CPU microbenchmarks, then the headless frame benchmarks, and writes one JSON report.
+//   APP_BENCH_OUT       JSON output path (default stdout)
+//   APP_BENCH_GPU       run the headless frame and texture upload benchmarks (default on)
+//   APP_BENCH_FRAMES    frames per frame benchmark (default 300)
+//   APP_BENCH_SCENES    comma-separated draw counts (default 1,64,1024)
+//   APP_BENCH_SOAK_FRAMES frames of the allocator soak run (default 20000)
+// Use APP_ADAPTER=cpu (or APP_BACKEND=gl with a software GL) on machines without a GPU.
+int main(int argc, char** argv) try
+{
+	Config::parseCommandLine(argc, argv);
+
+	BenchmarkSuite suite(BenchmarkSuite::Settings::fromConfig());
+#ifdef DEBUG_MODE
+	suite.setContext("build", "debug");
+#else
+	suite.setContext("build", "release");
+#endif
+
+	runCpuBenchmarks(suite);
+	runAllocatorBenchmarks(suite);
+	runSceneBenchmarks(suite);
+	runSceneFileBenchmarks(suite);
+	runSpatialBenchmarks(suite);
+	runTextureBenchmarks(suite);
+
+	std::string adapterName;
+	if (Config::getBool("APP_BENCH_GPU", true))
+	{
+		runFrameBenchmarks(suite, adapterName);
+		runTextureUploadBenchmarks(suite);
+	}
+	suite.setContext("adapter", adapterName);
+
+	const std::string json = suite.toJson();
+	const std::string outPath = Config::getString("APP_BENCH_OUT");
+	if (outPath.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(outPath, std::ios::trunc);
+		if (!file) throw std::runtime_error("Could not write " + outPath);
+		file << json;
+	}
+
+	return EXIT_SUCCESS;
+}
+catch (const std::exception& err)
+{
+	std::cerr << err.what() << '\n';
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+#include "Benchmark.hxx"
+#include "Config.hxx"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+	std::string escapeJson(const std::string& arg_Text)
+	{
+		std::string escaped;
+		escaped.reserve(arg_Text.size());
+		for (char c : arg_Text)
+		{
+			switch (c)
+			{
+			case '"': escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\t': escaped += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(c) < 0x20) escaped += ' ';
+				else escaped += c;
+			}
+		}
+		return escaped;
+	}
+
+	double percentile(const std::vector<double>& arg_Sorted, double arg_Percentile)
+	{
+		if (arg_Sorted.empty()) return 0.0;
+
+		const double rank = arg_Percentile / 100.0 * static_cast<double>(arg_Sorted.size() - 1);
+		const size_t lower = static_cast<size_t>(rank);
+		const size_t upper = std::min(lower + 1, arg_Sorted.size() - 1);
+		const double fraction = rank - static_cast<double>(lower);
+		return arg_Sorted[lower] + (arg_Sorted[upper] - arg_Sorted[lower]) * fraction;
+	}
+}
+
+BenchmarkSuite::Settings BenchmarkSuite::Settings::fromConfig()
+{
+	Settings settings{};
+	settings.filter = Config::getString("APP_BENCH_FILTER");
+	settings.samples = static_cast<uint32_t>(std::clamp(Config::getInt("APP_BENCH_SAMPLES", 30), 3LL, 10000LL));
+	settings.minSampleMs = std::clamp(Config::getDouble("APP_BENCH_SAMPLE_MS", 2.0), 0.01, 1000.0);
+
+	return settings;
+}
+
+BenchmarkSuite::BenchmarkSuite(Settings arg_Settings)
+	: settings(std::move(arg_Settings))
+{
+}
+
+bool BenchmarkSuite::isSelected(const std::string& arg_Name) const
+{
+	return settings.filter.empty() || arg_Name.find(settings.filter) != std::string::npos;
+}
+
+void BenchmarkSuite::addSamples(const std::string& arg_Name, const char* arg_Unit, uint64_t arg_Items, std::vector<double> arg_Samples)
+{
+	results.push_back(summarize(arg_Name, arg_Unit, arg_Items, std::move(arg_Samples)));
+}
+
+void BenchmarkSuite::skip(const std::string& arg_Name, const std::string& arg_Reason)
+{
+	BenchmarkResult result{};
+	result.name = arg_Name;
+	result.skipped = arg_Reason.empty() ? "skipped" : arg_Reason;
+	results.push_back(result);
+}
+
+BenchmarkResult BenchmarkSuite::summarize(const std::string& arg_Name, const char* arg_Unit, uint64_t arg_Items, std::vector<double> arg_Samples)
+{
+	BenchmarkResult result{};
+	result.name = arg_Name;
+	result.unit = arg_Unit;
+	result.items = arg_Items;
+	result.samples = arg_Samples.size();
+	if (arg_Samples.empty()) return result;
+
+	std::sort(arg_Samples.begin(), arg_Samples.end());
+
+	double sum = 0.0;
+	for (double sample : arg_Samples) sum += sample;
+	result.mean = sum / static_cast<double>(arg_Samples.size());
+
+	double squares = 0.0;
+	for (double sample : arg_Samples) squares += (sample - result.mean) * (sample - result.mean);
+	result.variance = arg_Samples.size() > 1 ? squares / static_cast<double>(arg_Samples.size() - 1) : 0.0;
+	result.stddev = std::sqrt(result.variance);
+
+	result.min = arg_Samples.front();
+	result.p50 = percentile(arg_Samples, 50.0);
+	result.p95 = percentile(arg_Samples, 95.0);
+	result.p99 = percentile(arg_Samples, 99.0);
+	result.max = arg_Samples.back();
+
+	return result;
+}
+
+std::string BenchmarkSuite::toJson() const
+{
+	std::ostringstream out;
+	out << std::setprecision(9);
+
+	out << "{\n  \"context\": {";
+	bool first = true;
+	for (const auto& [key, value] : context)
+	{
+		out << (first ? "\n" : ",\n") << "    \"" << escapeJson(key) << "\": \"" << escapeJson(value) << '"';
+		first = false;
+	}
+	out << "\n  },\n  \"benchmarks\": [";
+
+	first = true;
+	for (const BenchmarkResult& result : results)
+	{
+		out << (first ? "\n" : ",\n") << "    { \"name\": \"" << escapeJson(result.name) << '"';
+		first = false;
+
+		if (!result.skipped.empty())
+		{
+			out << ", \"skipped\": \"" << escapeJson(result.skipped) << "\" }";
+			continue;
+		}
+
+		out << ", \"unit\": \"" << result.unit << '"'
+			<< ", \"items\": " << result.items
+			<< ", \"samples\": " << result.samples
+			<< ", \"mean\": " << result.mean
+			<< ", \"variance\": " << result.variance
+			<< ", \"stddev\": " << result.stddev
+			<< ", \"min\": " << result.min
+			<< ", \"p50\": " << result.p50
+			<< ", \"p95\": " << result.p95
+			<< ", \"p99\": " << result.p99
+			<< ", \"max\": " << result.max
+			<< " }";
+	}
+	out << "\n  ]\n}\n";
+
+	return out.str();
+}
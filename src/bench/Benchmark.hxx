@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Keeps the compiler from discarding a computation whose result is otherwise unused.
+template <typename T>
+inline void doNotOptimize(const T& arg_Value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(arg_Value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &arg_Value;
+#endif
+}
+
+struct BenchmarkResult
+{
+	std::string name;
+	std::string unit;
+	// Work items per iteration, e.g. rects processed or draws per frame.
+	uint64_t items;
+	size_t samples;
+	double mean;
+	double variance;
+	double stddev;
+	double min;
+	double p50;
+	double p95;
+	double p99;
+	double max;
+	// Non-empty when the benchmark could not run, e.g. no adapter on this machine.
+	std::string skipped;
+};
+
+// Collects benchmark samples and writes them as JSON for BenchCompare.
+//   APP_BENCH_FILTER    only run benchmarks whose name contains this
+//   APP_BENCH_SAMPLES   samples per CPU benchmark (default 30)
+//   APP_BENCH_SAMPLE_MS minimum duration of one CPU sample (default 2)
+class BenchmarkSuite
+{
+public:
+	struct Settings
+	{
+		std::string filter;
+		uint32_t samples;
+		double minSampleMs;
+
+		static Settings fromConfig();
+	};
+
+	explicit BenchmarkSuite(Settings arg_Settings);
+
+	bool isSelected(const std::string& arg_Name) const;
+
+	// Runs arg_Body in batches long enough to time reliably and records ns per call.
+	template <typename Body>
+	void run(const std::string& arg_Name, uint64_t arg_Items, Body&& arg_Body);
+
+	void addSamples(const std::string& arg_Name, const char* arg_Unit, uint64_t arg_Items, std::vector<double> arg_Samples);
+	void skip(const std::string& arg_Name, const std::string& arg_Reason);
+
+	void setContext(const std::string& arg_Key, const std::string& arg_Value) { context[arg_Key] = arg_Value; }
+	const std::vector<BenchmarkResult>& getResults() const { return results; }
+
+	std::string toJson() const;
+
+	static BenchmarkResult summarize(const std::string& arg_Name, const char* arg_Unit, uint64_t arg_Items, std::vector<double> arg_Samples);
+
+private:
+	Settings settings;
+	std::vector<BenchmarkResult> results;
+	std::map<std::string, std::string> context;
+};
+
+template <typename Body>
+void BenchmarkSuite::run(const std::string& arg_Name, uint64_t arg_Items, Body&& arg_Body)
+{
+	if (!isSelected(arg_Name)) return;
+
+	using Clock = std::chrono::steady_clock;
+
+	// Warm caches and size the batch from a single call.
+	auto start = Clock::now();
+	arg_Body();
+	const double singleNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+	const double minSampleNs = settings.minSampleMs * 1e6;
+	const uint64_t iterations = singleNs >= minSampleNs ? 1 : static_cast<uint64_t>(minSampleNs / std::max(singleNs, 1.0)) + 1;
+
+	std::vector<double> samples;
+	samples.reserve(settings.samples);
+	for (uint32_t sample = 0; sample < settings.samples; ++sample)
+	{
+		start = Clock::now();
+		for (uint64_t i = 0; i < iterations; ++i) arg_Body();
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+		samples.push_back(static_cast<double>(elapsed) / static_cast<double>(iterations));
+	}
+
+	addSamples(arg_Name, "ns", arg_Items, std::move(samples));
+}
@@ -0,0 +1,43 @@
+#include "CpuBenchmarks.hxx"
+#include "Benchmark.hxx"
+#include "DrawParameters.hxx"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	const uint32_t SCENE_SIZES[] = { 256, 4096, 65536 };
+
+	std::vector<DrawParams> makeScene(uint32_t arg_Count)
+	{
+		std::vector<DrawParams> scene(arg_Count);
+		for (uint32_t i = 0; i < arg_Count; ++i) makeGridDrawParams(i, arg_Count, scene[i]);
+		return scene;
+	}
+}
+
+void runCpuBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	for (uint32_t size : SCENE_SIZES)
+	{
+		const std::string suffix = "/" + std::to_string(size);
+		const std::vector<DrawParams> scene = makeScene(size);
+
+		std::vector<DrawParams> built(size);
+		arg_Suite.run("cpu/batchBuild" + suffix, size, [&]()
+			{
+				for (uint32_t i = 0; i < size; ++i) makeGridDrawParams(i, size, built[i]);
+				doNotOptimize(built.data());
+			});
+
+		// The instance packing updateInstanceBuffer() does for the grid workloads. Culling and the
+		// scene's own packing are covered by the spatial/ and scene/ benchmarks.
+		std::vector<RectInstance> instances(size);
+		arg_Suite.run("cpu/instancePack" + suffix, size, [&]()
+			{
+				for (uint32_t i = 0; i < size; ++i) instances[i] = makeRectInstance(scene[i]);
+				doNotOptimize(instances.data());
+			});
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// Microbenchmarks of the per-frame CPU paths, at several scene sizes. None of them need a
+// device, so they run on any machine.
+void runCpuBenchmarks(BenchmarkSuite& arg_Suite);
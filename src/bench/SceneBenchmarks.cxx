@@ -0,0 +1,122 @@
+#include "SceneBenchmarks.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "JobSystem.hxx"
+#include "SceneLod.hxx"
+#include "SceneStore.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const float STEP = 1.0f / 60.0f;
+	// The LOD entries look at the whole scene on a 1080p viewport.
+	const double VIEWPORT_HEIGHT = 1080.0;
+
+	const char* const BENCHMARKS[] = {
+		"scene/animate/scalar", "scene/animate/simd", "scene/pack/scalar", "scene/pack/simd",
+		"scene/update/scalar", "scene/update/simd", "scene/update/jobs", "scene/transform/jobs", "scene/churn",
+		"scene/lod/aggregate", "scene/lod/tiles"
+	};
+
+	std::vector<size_t> sceneSizes()
+	{
+		std::vector<size_t> sizes;
+		std::stringstream stream(Config::getString("APP_BENCH_SCENE_SIZES", "65536,1048576"));
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			const unsigned long long value = std::strtoull(item.c_str(), nullptr, 10);
+			if (value > 0) sizes.push_back(static_cast<size_t>(value));
+		}
+		return sizes;
+	}
+
+	void populate(SceneStore& arg_Store, size_t arg_Count, float arg_Side = 0.01f)
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+		arg_Store.reserve(arg_Count);
+		for (size_t i = 0; i < arg_Count; ++i)
+		{
+			const float side = arg_Side + 0.5f * arg_Side * unit(rng);
+			arg_Store.add({ unit(rng), unit(rng), side, side, unit(rng), 0.0f, static_cast<uint32_t>(rng()), unit(rng), unit(rng), unit(rng) });
+		}
+	}
+}
+
+void runSceneBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	JobSystem jobs(JobSystem::Settings::fromConfig());
+	arg_Suite.setContext("scene_kernels", SceneKernels::best().name);
+	arg_Suite.setContext("job_threads", std::to_string(jobs.getThreadCount()));
+
+	for (size_t size : sceneSizes())
+	{
+		const std::string suffix = "/" + std::to_string(size);
+
+		// Populating a million rects takes a while, so skip sizes the filter rules out.
+		bool selected = false;
+		for (const char* name : BENCHMARKS) selected = selected || arg_Suite.isSelected(name + suffix);
+		if (!selected) continue;
+
+		SceneStore scalar(SceneStore::Settings{ false });
+		SceneStore simd(SceneStore::Settings{ true });
+		populate(scalar, size);
+		populate(simd, size);
+		std::vector<RectInstance> instances(size);
+
+		arg_Suite.run("scene/animate/scalar" + suffix, size, [&]() { scalar.animate(STEP, nullptr); });
+		arg_Suite.run("scene/animate/simd" + suffix, size, [&]() { simd.animate(STEP, nullptr); });
+		arg_Suite.run("scene/pack/scalar" + suffix, size, [&]() { scalar.writeInstances(instances.data(), nullptr); });
+		arg_Suite.run("scene/pack/simd" + suffix, size, [&]() { simd.writeInstances(instances.data(), nullptr); });
+		arg_Suite.run("scene/update/scalar" + suffix, size, [&]() { scalar.update(STEP, instances.data(), nullptr); });
+		arg_Suite.run("scene/update/simd" + suffix, size, [&]() { simd.update(STEP, instances.data(), nullptr); });
+		arg_Suite.run("scene/update/jobs" + suffix, size, [&]() { simd.update(STEP, instances.data(), &jobs); });
+		arg_Suite.run("scene/transform/jobs" + suffix, size, [&]() { simd.applyTransform({ 1.0f, 0.001f, 0.0f, 0.0f }, &jobs); });
+
+		// Removes and re-adds a fixed share of rects in random order, the pattern of spawning
+		// and despawning entities.
+		const size_t churn = std::max<size_t>(1, size / 16);
+		std::vector<SceneHandle> handles;
+		handles.reserve(churn);
+		std::mt19937 rng(11);
+		arg_Suite.run("scene/churn" + suffix, churn, [&]()
+		{
+			handles.clear();
+			for (size_t i = 0; i < churn; ++i) handles.push_back(simd.getHandle(rng() % simd.size()));
+			SceneStore::Rect rect{};
+			for (SceneHandle handle : handles)
+			{
+				if (simd.get(handle, rect) && simd.remove(handle)) simd.add(rect);
+			}
+			doNotOptimize(simd.size());
+		});
+
+		if (!arg_Suite.isSelected("scene/lod/aggregate" + suffix) && !arg_Suite.isSelected("scene/lod/tiles" + suffix)) continue;
+
+		// Rects of about half a pixel, as the full view of a large scene has them.
+		const double pixelSize = 2.0 / VIEWPORT_HEIGHT;
+		SceneStore small(SceneStore::Settings{ true });
+		populate(small, size, static_cast<float>(0.5 * pixelSize));
+		SceneLod lod(SceneLod::Settings{ true, 1.0, 2.0 });
+		std::vector<uint32_t> detailed;
+		detailed.reserve(size);
+
+		arg_Suite.run("scene/lod/aggregate" + suffix, size, [&]()
+		{
+			detailed.clear();
+			lod.aggregate(small, nullptr, small.size(), { -1.0f, -1.0f, 1.0f, 1.0f }, pixelSize, detailed);
+			doNotOptimize(lod.getTileCount());
+		});
+		instances.resize(std::max(size, lod.getTileCount()));
+		arg_Suite.run("scene/lod/tiles" + suffix, lod.getTileCount(), [&]() { lod.writeTiles(instances.data()); });
+	}
+}
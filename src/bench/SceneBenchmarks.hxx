@@ -0,0 +1,8 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// SceneStore passes over 64K and 1M rects: scalar against SIMD kernels on one thread, the
+// fused update on the job system, and handle churn through add and remove.
+//   APP_BENCH_SCENE_SIZES  comma-separated rect counts (default 65536,1048576)
+void runSceneBenchmarks(BenchmarkSuite& arg_Suite);
@@ -0,0 +1,121 @@
+#include "SceneFileBenchmarks.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "SceneBuilder.hxx"
+#include "SceneFile.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const BENCHMARKS[] = {
+		"scenefile/convert", "scenefile/open", "scenefile/read/sequential", "scenefile/read/chunks", "scenefile/read/remap"
+	};
+
+	std::vector<RectInstance> makeRects(size_t arg_Count)
+	{
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const float side = 2.0f / std::sqrt(static_cast<float>(arg_Count));
+
+		std::vector<RectInstance> rects(arg_Count);
+		for (RectInstance& rect : rects)
+		{
+			rect.center[0] = unit(rng) * 2.0f - 1.0f;
+			rect.center[1] = unit(rng) * 2.0f - 1.0f;
+			rect.size[0] = side * (0.5f + unit(rng));
+			rect.size[1] = side * (0.5f + unit(rng));
+			rect.color = static_cast<uint32_t>(rng());
+		}
+		return rects;
+	}
+}
+
+void runSceneFileBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	const size_t count = static_cast<size_t>(std::clamp(Config::getInt("APP_BENCH_SCENE_FILE_RECTS", 1048576), 1LL, 1LL << 30));
+	const std::string suffix = "/" + std::to_string(count);
+
+	bool selected = false;
+	for (const char* name : BENCHMARKS) selected = selected || arg_Suite.isSelected(name + suffix);
+	if (!selected) return;
+
+	const std::string path = (std::filesystem::temp_directory_path() / "bench.scene").string();
+	const SceneBuilder builder(SceneBuilder::Settings::fromConfig());
+	const std::vector<RectInstance> source = makeRects(count);
+	std::vector<RectInstance> rects;
+
+	// Every pass sorts a fresh copy, as the converter gets its rects in source order.
+	arg_Suite.run("scenefile/convert" + suffix, count, [&]()
+	{
+		rects = source;
+		builder.write(rects, path);
+	});
+	if (rects.empty())
+	{
+		rects = source;
+		builder.write(rects, path);
+	}
+
+	{
+		const SceneFile file(path);
+		arg_Suite.setContext("scene_file_bytes", std::to_string(file.getMapping().size()));
+		arg_Suite.run("scenefile/open" + suffix, file.getChunkCount(), [&]()
+		{
+			const SceneFile opened(path);
+			doNotOptimize(opened.getHeader().rectCount);
+		});
+
+		std::vector<const SceneFormat::ChunkRecord*> chunks;
+		uint64_t bytes = 0;
+		uint64_t largest = 0;
+		for (size_t i = 0; i < file.getChunkCount(); ++i)
+		{
+			const SceneFormat::ChunkRecord& chunk = file.getChunks()[i];
+			if (chunk.type != SceneFormat::ChunkType::Rects) continue;
+
+			chunks.push_back(&chunk);
+			bytes += chunk.size;
+			largest = std::max(largest, chunk.size);
+		}
+
+		// Stands in for the staging memory the streamer copies into.
+		std::vector<uint8_t> staging(largest);
+		auto readAll = [&]()
+		{
+			for (const SceneFormat::ChunkRecord* chunk : chunks)
+			{
+				std::memcpy(staging.data(), file.getChunkData(*chunk), chunk->size);
+				doNotOptimize(staging[0]);
+			}
+		};
+
+		arg_Suite.run("scenefile/read/sequential" + suffix, bytes, readAll);
+
+		std::vector<const SceneFormat::ChunkRecord*> shuffled = chunks;
+		std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(11));
+		arg_Suite.run("scenefile/read/chunks" + suffix, bytes, [&]()
+		{
+			for (const SceneFormat::ChunkRecord* chunk : shuffled)
+			{
+				std::memcpy(staging.data(), file.getChunkData(*chunk), chunk->size);
+				doNotOptimize(staging[0]);
+			}
+		});
+
+		arg_Suite.run("scenefile/read/remap" + suffix, bytes, [&]()
+		{
+			file.getMapping().release(0, file.getMapping().size());
+			readAll();
+		});
+	}
+
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// Scene files of APP_BENCH_SCENE_FILE_RECTS rects, written to the temp directory: converting
+// rects into a file, opening and validating it, and reading its rect chunks out of the
+// mapping into a staging-sized buffer, in file order and in random chunk order. The read
+// entries count bytes as items and run against the warm page cache; remap drops the
+// mapping's pages before every pass, as the streamer does after each upload.
+//   APP_BENCH_SCENE_FILE_RECTS  rects in the file (default 1048576)
+void runSceneFileBenchmarks(BenchmarkSuite& arg_Suite);
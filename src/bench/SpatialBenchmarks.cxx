@@ -0,0 +1,137 @@
+#include "SpatialBenchmarks.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "JobSystem.hxx"
+#include "SpatialGrid.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const BENCHMARKS[] = {
+		"spatial/build/serial", "spatial/build/jobs", "spatial/query/view", "spatial/query/point", "spatial/move"
+	};
+
+	// Queries per iteration of the query benchmarks, cycling through fixed positions.
+	const size_t QUERIES = 256;
+
+	std::vector<size_t> spatialSizes()
+	{
+		std::vector<size_t> sizes;
+		std::stringstream stream(Config::getString("APP_BENCH_SPATIAL_SIZES", "1048576,10485760"));
+		std::string item;
+		while (std::getline(stream, item, ','))
+		{
+			const unsigned long long value = std::strtoull(item.c_str(), nullptr, 10);
+			if (value > 0) sizes.push_back(static_cast<size_t>(value));
+		}
+		return sizes;
+	}
+
+	// Rects spread over [-1, 1] with the same total cover at every count.
+	struct RectSet
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> width;
+		std::vector<float> height;
+	};
+
+	RectSet makeRects(size_t arg_Count)
+	{
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const float side = 2.0f / std::sqrt(static_cast<float>(arg_Count));
+
+		RectSet rects;
+		rects.x.resize(arg_Count);
+		rects.y.resize(arg_Count);
+		rects.width.resize(arg_Count);
+		rects.height.resize(arg_Count);
+		for (size_t i = 0; i < arg_Count; ++i)
+		{
+			rects.x[i] = unit(rng) * 2.0f - 1.0f;
+			rects.y[i] = unit(rng) * 2.0f - 1.0f;
+			rects.width[i] = side * (0.5f + unit(rng));
+			rects.height[i] = side * (0.5f + unit(rng));
+		}
+		return rects;
+	}
+}
+
+void runSpatialBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	JobSystem jobs(JobSystem::Settings::fromConfig());
+	const SceneBounds bounds{ -1.0f, -1.0f, 1.0f, 1.0f };
+
+	for (size_t size : spatialSizes())
+	{
+		const std::string suffix = "/" + std::to_string(size);
+
+		// Generating ten million rects takes a while, so skip sizes the filter rules out.
+		bool selected = false;
+		for (const char* name : BENCHMARKS) selected = selected || arg_Suite.isSelected(name + suffix);
+		if (!selected) continue;
+
+		RectSet rects = makeRects(size);
+		SpatialGrid grid;
+		auto build = [&](JobSystem* arg_Jobs)
+		{
+			grid.build(bounds, size, rects.x.data(), rects.y.data(), rects.width.data(), rects.height.data(), nullptr, arg_Jobs);
+		};
+
+		arg_Suite.run("spatial/build/serial" + suffix, size, [&]() { build(nullptr); });
+		arg_Suite.run("spatial/build/jobs" + suffix, size, [&]() { build(&jobs); });
+		build(&jobs);
+
+		std::mt19937 rng(9);
+		std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+		std::vector<std::pair<float, float>> points(QUERIES);
+		for (auto& point : points) point = { position(rng), position(rng) };
+
+		// A view a tenth of the scene wide holds about 1% of the rects.
+		std::vector<uint32_t> hits;
+		hits.reserve(size / 50 + 1024);
+		arg_Suite.run("spatial/query/view" + suffix, QUERIES, [&]()
+		{
+			for (const auto& point : points)
+			{
+				hits.clear();
+				grid.query({ point.first - 0.1f, point.second - 0.1f, point.first + 0.1f, point.second + 0.1f }, hits);
+				doNotOptimize(hits.size());
+			}
+		});
+		arg_Suite.run("spatial/query/point" + suffix, QUERIES, [&]()
+		{
+			for (const auto& point : points)
+			{
+				hits.clear();
+				grid.queryPoint(point.first, point.second, hits);
+				doNotOptimize(hits.size());
+			}
+		});
+
+		// 1% of the rects move a small step each iteration, as in an editor drag or sparse
+		// simulation; some cross cells and go through the pending list and its rebuilds.
+		const size_t moves = std::max<size_t>(1, size / 100);
+		std::uniform_int_distribution<size_t> pick(0, size - 1);
+		std::uniform_real_distribution<float> step(-0.002f, 0.002f);
+		std::vector<uint32_t> moved(moves);
+		for (uint32_t& id : moved) id = static_cast<uint32_t>(pick(rng));
+		arg_Suite.run("spatial/move" + suffix, moves, [&]()
+		{
+			for (uint32_t id : moved)
+			{
+				rects.x[id] = std::clamp(rects.x[id] + step(rng), -1.0f, 1.0f);
+				rects.y[id] = std::clamp(rects.y[id] + step(rng), -1.0f, 1.0f);
+				grid.move(id, rects.x[id], rects.y[id], rects.width[id], rects.height[id]);
+			}
+		});
+	}
+}
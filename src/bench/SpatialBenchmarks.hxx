@@ -0,0 +1,8 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// SpatialGrid over 1M and 10M rects: bulk rebuild on one thread and on the job system, view
+// and point queries, and incremental moves of a share of the rects per frame.
+//   APP_BENCH_SPATIAL_SIZES  comma-separated rect counts (default 1048576,10485760)
+void runSpatialBenchmarks(BenchmarkSuite& arg_Suite);
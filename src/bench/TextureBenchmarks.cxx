@@ -0,0 +1,238 @@
+#include "TextureBenchmarks.hxx"
+#include "Application.hxx"
+#include "Benchmark.hxx"
+#include "Config.hxx"
+#include "CookedBlob.hxx"
+#include "ImageDecoder.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const char* const BENCHMARKS[] = { "texture/decode/qoi", "texture/decode/ppm", "texture/decode/pam16" };
+	const uint32_t UPLOAD_TEXTURES = 8;
+	const uint32_t UPLOAD_RUNS = 5;
+
+	uint32_t getBenchSide()
+	{
+		return static_cast<uint32_t>(std::clamp(Config::getInt("APP_BENCH_TEXTURE_SIZE", 2048), 1LL, static_cast<long long>(ImageDecoder::MAX_DIMENSION)));
+	}
+
+	std::vector<uint8_t> makeImage(uint32_t arg_Side)
+	{
+		std::mt19937 rng(5);
+		std::vector<uint8_t> pixels(static_cast<size_t>(arg_Side) * arg_Side * 4);
+		for (uint32_t y = 0; y < arg_Side; ++y)
+		{
+			for (uint32_t x = 0; x < arg_Side; ++x)
+			{
+				uint8_t* pixel = &pixels[(static_cast<size_t>(y) * arg_Side + x) * 4];
+				const uint32_t noise = rng() % 4;
+				pixel[0] = static_cast<uint8_t>(x * 255 / arg_Side + noise);
+				pixel[1] = static_cast<uint8_t>(y * 255 / arg_Side);
+				pixel[2] = static_cast<uint8_t>((x + y) / 16 % 2 ? 40 : 200);
+				pixel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+
+	void putBigEndian32(std::vector<uint8_t>& arg_Out, uint32_t arg_Value)
+	{
+		for (int shift = 24; shift >= 0; shift -= 8) arg_Out.push_back(static_cast<uint8_t>(arg_Value >> shift));
+	}
+
+	// The reference encoder's choice of ops, without alpha changes.
+	std::vector<uint8_t> encodeQoi(const std::vector<uint8_t>& arg_Pixels, uint32_t arg_Side)
+	{
+		std::vector<uint8_t> out = { 'q', 'o', 'i', 'f' };
+		putBigEndian32(out, arg_Side);
+		putBigEndian32(out, arg_Side);
+		out.push_back(4);
+		out.push_back(0);
+
+		uint8_t index[64][4] = {};
+		uint8_t previous[4] = { 0, 0, 0, 255 };
+		uint32_t run = 0;
+		const size_t count = arg_Pixels.size() / 4;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint8_t* pixel = &arg_Pixels[i * 4];
+			if (std::memcmp(pixel, previous, 4) == 0)
+			{
+				if (++run == 62 || i + 1 == count)
+				{
+					out.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+					run = 0;
+				}
+				continue;
+			}
+			if (run > 0)
+			{
+				out.push_back(static_cast<uint8_t>(0xc0 | (run - 1)));
+				run = 0;
+			}
+
+			const uint32_t slot = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64;
+			if (std::memcmp(index[slot], pixel, 4) == 0)
+			{
+				out.push_back(static_cast<uint8_t>(slot));
+			}
+			else
+			{
+				std::memcpy(index[slot], pixel, 4);
+				const int red = static_cast<int8_t>(pixel[0] - previous[0]);
+				const int green = static_cast<int8_t>(pixel[1] - previous[1]);
+				const int blue = static_cast<int8_t>(pixel[2] - previous[2]);
+				if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+				{
+					out.push_back(static_cast<uint8_t>(0x40 | (red + 2) << 4 | (green + 2) << 2 | (blue + 2)));
+				}
+				else if (green >= -32 && green <= 31 && red - green >= -8 && red - green <= 7 && blue - green >= -8 && blue - green <= 7)
+				{
+					out.push_back(static_cast<uint8_t>(0x80 | (green + 32)));
+					out.push_back(static_cast<uint8_t>((red - green + 8) << 4 | (blue - green + 8)));
+				}
+				else
+				{
+					out.insert(out.end(), { 0xfe, pixel[0], pixel[1], pixel[2] });
+				}
+			}
+			std::memcpy(previous, pixel, 4);
+		}
+		out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+		return out;
+	}
+
+	std::vector<uint8_t> encodeNetpbm(const std::vector<uint8_t>& arg_Pixels, uint32_t arg_Side, bool arg_Wide)
+	{
+		const std::string side = std::to_string(arg_Side);
+		const std::string header = arg_Wide
+			? "P7\nWIDTH " + side + "\nHEIGHT " + side + "\nDEPTH 4\nMAXVAL 65535\nTUPLTYPE RGB_ALPHA\nENDHDR\n"
+			: "P6\n" + side + " " + side + "\n255\n";
+
+		std::vector<uint8_t> out(header.begin(), header.end());
+		for (size_t i = 0; i < arg_Pixels.size(); ++i)
+		{
+			if (arg_Wide)
+			{
+				out.push_back(arg_Pixels[i]);
+				out.push_back(arg_Pixels[i]);
+			}
+			else if (i % 4 != 3)
+			{
+				out.push_back(arg_Pixels[i]);
+			}
+		}
+		return out;
+	}
+
+	// A decoder that is fast because it is wrong must not pass, so each format is decoded
+	// once and compared with the source before it is timed.
+	void checkRoundTrip(const char* arg_Name, const std::vector<uint8_t>& arg_Pixels, uint32_t arg_Side, const std::vector<uint8_t>& arg_Staging, size_t arg_RowPitch)
+	{
+		const size_t rowBytes = static_cast<size_t>(arg_Side) * 4;
+		for (uint32_t y = 0; y < arg_Side; ++y)
+		{
+			if (std::memcmp(&arg_Staging[y * arg_RowPitch], &arg_Pixels[y * rowBytes], rowBytes) != 0)
+				throw std::runtime_error(std::string(arg_Name) + ": row " + std::to_string(y) + " does not match the source pixels");
+		}
+	}
+}
+
+void runTextureBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	const uint32_t side = getBenchSide();
+	const std::string suffix = "/" + std::to_string(side);
+
+	bool selected = false;
+	for (const char* name : BENCHMARKS) selected = selected || arg_Suite.isSelected(name + suffix);
+	if (!selected) return;
+
+	const std::vector<uint8_t> pixels = makeImage(side);
+	const size_t rowPitch = (static_cast<size_t>(side) * 4 + 255) / 256 * 256;
+	std::vector<uint8_t> staging(rowPitch * side);
+
+	const std::vector<uint8_t> files[] = { encodeQoi(pixels, side), encodeNetpbm(pixels, side, false), encodeNetpbm(pixels, side, true) };
+	for (size_t i = 0; i < std::size(BENCHMARKS); ++i)
+	{
+		const std::vector<uint8_t>& file = files[i];
+		ImageDecoder::decode(file.data(), file.size(), staging.data(), rowPitch);
+		checkRoundTrip(BENCHMARKS[i], pixels, side, staging, rowPitch);
+
+		arg_Suite.run(BENCHMARKS[i] + suffix, pixels.size(), [&]()
+		{
+			ImageDecoder::decode(file.data(), file.size(), staging.data(), rowPitch);
+			doNotOptimize(staging[0]);
+		});
+	}
+}
+
+void runTextureUploadBenchmarks(BenchmarkSuite& arg_Suite)
+{
+	const uint32_t side = getBenchSide();
+	const std::string name = "texture/upload/" + std::to_string(side);
+	if (!arg_Suite.isSelected(name)) return;
+
+	// Cooked blobs, so decoding is a page fault-in and the upload path dominates.
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "bench_textures";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	const std::vector<uint8_t> pixels = makeImage(side);
+	CookedFormat::Header header{};
+	header.type = CookedFormat::BlobType::Texture;
+	header.width = side;
+	header.height = side;
+	header.bytesPerRow = static_cast<uint32_t>((side * 4 + CookedFormat::PAYLOAD_ALIGNMENT - 1) / CookedFormat::PAYLOAD_ALIGNMENT * CookedFormat::PAYLOAD_ALIGNMENT);
+	std::vector<uint8_t> texels(static_cast<size_t>(header.bytesPerRow) * side);
+	for (uint32_t y = 0; y < side; ++y)
+		std::memcpy(&texels[static_cast<size_t>(y) * header.bytesPerRow], &pixels[static_cast<size_t>(y) * side * 4], static_cast<size_t>(side) * 4);
+	for (uint32_t i = 0; i < UPLOAD_TEXTURES; ++i)
+		writeCookedBlob((directory / ("bench" + std::to_string(i) + ".texture")).string(), header, texels.data(), texels.size());
+
+	Application::Options options = Application::Options::fromConfig();
+	options.headless = true;
+	options.frames = 100000;
+	options.drawsPerFrame = 1;
+	options.textureDirectory = directory.string();
+	options.stopAfterTextures = true;
+
+	try
+	{
+		// Wall time with uploads outstanding, so it includes the frames they are spread over.
+		std::vector<double> samples;
+		uint64_t bytes = 0;
+		for (uint32_t run = 0; run < UPLOAD_RUNS; ++run)
+		{
+			Application app(options);
+			app.run();
+
+			const TextureStreamer::Stats stats = app.getTextureStats();
+			if (stats.ready != UPLOAD_TEXTURES)
+				throw std::runtime_error(std::to_string(stats.ready) + " of " + std::to_string(UPLOAD_TEXTURES) + " textures became ready");
+			samples.push_back(stats.busySeconds * 1000.0);
+			bytes = stats.bytesUploaded;
+		}
+
+		std::vector<double> sorted = samples;
+		std::sort(sorted.begin(), sorted.end());
+		std::cerr << name << ": " << static_cast<double>(bytes) / 1e6 / (sorted[sorted.size() / 2] / 1000.0) << " MB/s median\n";
+		arg_Suite.addSamples(name, "ms", bytes, std::move(samples));
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << name << ": skipped, " << err.what() << '\n';
+		arg_Suite.skip(name, err.what());
+	}
+
+	std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+class BenchmarkSuite;
+
+// ImageDecoder on a square image of APP_BENCH_TEXTURE_SIZE pixels, held in memory: QOI, 8-bit
+// PPM and 16-bit PAM with alpha, each decoded into RGBA8 rows at the 256-byte copy pitch the
+// texture streamer stages at. Items are decoded bytes. The image is a smooth gradient with
+// noise, so QOI sees a mix of its difference, index and literal ops. Each decode is checked
+// against the source pixels first.
+//   APP_BENCH_TEXTURE_SIZE  image side in pixels (default 2048)
+void runTextureBenchmarks(BenchmarkSuite& arg_Suite);
+
+// Streams cooked blobs of the same image through a headless Application's TextureStreamer and
+// staging belt. Samples are the ms from request to the last texture ready, items the bytes
+// uploaded; the median MB/s goes to stderr. Needs an adapter, or the entry is skipped.
+void runTextureUploadBenchmarks(BenchmarkSuite& arg_Suite);
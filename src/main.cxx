@@ -1,694 +1,126 @@
-#ifdef DEBUG_MODE
-	#include <iostream>
-#endif
-#include <stdexcept>
-#include <cstdint>
-#include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
 #include <vector>
-#include <chrono>
-#include <thread>
 
-#include <glfw3webgpu.h>
-#include <GLFW/glfw3.h>
-#include <webgpu/webgpu.h>
-#include <webgpu/wgpu.h>
+#include "Application.hxx"
+#include "CapacitySearch.hxx"
+#include "Config.hxx"
+#include "FramePacer.hxx"
+#include "Log.hxx"
+#include "ResolutionController.hxx"
 
-#ifdef DEBUG_MODE
-
-#define LOG_MSG_SUC(msg) std::cout << msg << '\n';
-#define LOG_MSG_ERR(msg) std::cerr << "ERROR: " << msg << '\n';
-
-#else
-
-#define LOG_MSG_SUC(msg)
-#define LOG_MSG_ERR(msg)
-
-#endif
-
-const char* shaderSource = R"(
-struct VertexInput {
-	@location(0) position: vec2f,
-	@location(1) color: vec3f,
-};
-
-struct VertexOutput {
-	@builtin(position) position: vec4f,
-	@location(0) color: vec3f,
-}
-
-@vertex
-fn vs_main(in: VertexInput) -> VertexOutput {
-    var out: VertexOutput; 
-    out.position = vec4f(in.position, 0.0, 1.0); 
-    out.color = in.color; 
-    return out;
-}
-
-@fragment
-fn fs_main(in: VertexOutput) -> @location(0) vec4f {
-    return vec4f(in.color, 1.0);
-}
-)";
-
-void wgpuPollEvents([[maybe_unused]] WGPUDevice device, [[maybe_unused]] bool yieldToWebBrowser) {
-#if defined(WEBGPU_BACKEND_DAWN)
-	wgpuDeviceTick(device);
-#elif defined(WEBGPU_BACKEND_WGPU)
-	wgpuDevicePoll(device, false, nullptr);
-#elif defined(WEBGPU_BACKEND_EMSCRIPTEN)
-	if (yieldToWebBrowser) {
-		emscripten_sleep(100);
-	}
-#endif
-}
-
-namespace WindowProperties
+// APP_DYNRES_SIMULATE=1: check the dynamic resolution controller against synthetic load
+// curves without opening a window or touching the GPU.
+bool runResolutionSimulation()
 {
-	const int WINDOW_WIDTH = 1280;
-	const int WINDOW_HEIGHT = 960;
-	const char* WINDOW_TITLE = "WebGPU C++ Hello Triangle";
-	WGPUColor clearColor = { 0.0, 0.0, 0.006, 1.0 };
-	GLFWmonitor* monitor = nullptr;
-	GLFWwindow* share = nullptr;
-
-	const float MIN_BLUE = 0.006f;
-	const float MAX_BLUE = 0.08f;
-	const float FADE_SPEED = 0.0004f;
-}
-
-class Application
-{
-public:
-	Application() = default;
-	
-	void run()
-	{
-		initializeGLFW();
-		createWindow();
-		initializeWGPU();
-		windowLoop();
-		terminateApplication();
-	}
-
-private:
-	GLFWwindow* window;
-
-	uint32_t vertexCount;
-	bool bgFadingUp = true;
-
-	std::vector<WGPUFeatureName> adapterFeatures;
-	std::vector<WGPUFeatureName> deviceFeatures;
-	WGPUAdapterProperties adapterProperties;
-	WGPUSupportedLimits adapterSupportedLimits;
-	WGPUSupportedLimits deviceSupportedLimits;
-	WGPUTextureFormat surfaceFormat;
-	WGPUBuffer vertexBuffer;
-
-	WGPUInstance instance;
-	WGPUAdapter adapter;
-	WGPUDevice device;
-	WGPUQueue queue;
-	WGPUSurface surface;
-	WGPURenderPipeline pipeline;
-
-private:
-	void initializeGLFW()
-	{
-		if (!glfwInit()) throw std::runtime_error("Failed to initialize GLFW");
-
-		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-	}
-
-	void initializeWGPU()
-	{
-		createInstance();
-		getAdapter();
-		getDevice();
-		initializeRenderPipeline();
-		getQueue();
-		initializeBuffers();
-	}
-
-	void createInstance()
-	{
-		WGPUInstanceDescriptor instanceDesc = {};
-		instanceDesc.nextInChain = nullptr;
-		instance = wgpuCreateInstance(&instanceDesc);
-
-		if (!instance)
-		{
-			glfwTerminate();
-			throw std::runtime_error("Could not initialize WebGPU");
-		}
-
-		LOG_MSG_SUC("WebGPU instance: " << instance);
-	}
-
-	void createShaderModule(WGPUShaderModule& arg_ShaderModule) const
-	{
-		WGPUShaderModuleWGSLDescriptor shaderWGSLDesc{};
-		shaderWGSLDesc.chain.next = nullptr;
-		shaderWGSLDesc.chain.sType = WGPUSType_ShaderModuleWGSLDescriptor;
-		shaderWGSLDesc.code = shaderSource;
-
-		WGPUShaderModuleDescriptor shaderDesc{};
-		shaderDesc.nextInChain = &shaderWGSLDesc.chain;
-
-		arg_ShaderModule = wgpuDeviceCreateShaderModule(device, &shaderDesc);
-	}
-
-	void createWindow()
-	{
-		window = glfwCreateWindow(
-			WindowProperties::WINDOW_WIDTH,
-			WindowProperties::WINDOW_HEIGHT,
-			WindowProperties::WINDOW_TITLE,
-			WindowProperties::monitor,
-			WindowProperties::share
-		);
-
-		if (!window)
-		{
-			glfwTerminate();
-			throw std::runtime_error("Failed to create GLFW window");
-		}
-	}
-
-	void windowLoop()
-	{
-		while (!glfwWindowShouldClose(window))
-		{
-			renderFrame();
-
-			glfwPollEvents();
-		}
-	}
-
-	void terminateApplication()
-	{
-		wgpuRenderPipelineRelease(pipeline);
-
-		glfwDestroyWindow(window);
-		glfwTerminate();
-
-		wgpuQueueRelease(queue);
-		wgpuSurfaceUnconfigure(surface);
-		wgpuSurfaceRelease(surface);
-		wgpuBufferRelease(vertexBuffer);
-	}
-
-	void renderFrame()
-	{
-		std::pair<WGPUSurfaceTexture, WGPUTextureView> surfaceData = getNextSurfaceViewData();
-		WGPUSurfaceTexture surfaceTexture = surfaceData.first;
-		WGPUTextureView targetView = surfaceData.second;
-
-		if (!targetView) return;
-
-		WGPUCommandEncoderDescriptor encoderDesc = {};
-		encoderDesc.label = "Command Encoder";
-		WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
-
-		WGPURenderPassColorAttachment renderPassColorAttachment = {};
-		renderPassColorAttachment.view = targetView;
-		renderPassColorAttachment.loadOp = WGPULoadOp_Clear;
-		renderPassColorAttachment.storeOp = WGPUStoreOp_Store;
-		renderPassColorAttachment.clearValue = WindowProperties::clearColor;
-
-		if (bgFadingUp) {
-			WindowProperties::clearColor.b += WindowProperties::FADE_SPEED;
-			if (WindowProperties::clearColor.b >= WindowProperties::MAX_BLUE) {
-				WindowProperties::clearColor.b = WindowProperties::MAX_BLUE;
-				bgFadingUp = false;
-			}
-		}
-		else {
-			WindowProperties::clearColor.b -= WindowProperties::FADE_SPEED;
-			if (WindowProperties::clearColor.b <= WindowProperties::MIN_BLUE) {
-				WindowProperties::clearColor.b = WindowProperties::MIN_BLUE;
-				bgFadingUp = true; 
-			}
-		}
-
-		WGPURenderPassDescriptor renderPassDesc = {};
-		renderPassDesc.colorAttachmentCount = 1;
-		renderPassDesc.colorAttachments = &renderPassColorAttachment;
-		WGPURenderPassEncoder renderPass = wgpuCommandEncoderBeginRenderPass(encoder, &renderPassDesc);
-
-		wgpuRenderPassEncoderSetPipeline(renderPass, pipeline);
-		wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, vertexBuffer, 0, wgpuBufferGetSize(vertexBuffer));
-		wgpuRenderPassEncoderDraw(renderPass, vertexCount, 1, 0, 0);
-
-		wgpuRenderPassEncoderEnd(renderPass);
-
-		WGPUCommandBufferDescriptor commandBufferDesc = {};
-		commandBufferDesc.label = "Command Buffer";
-		WGPUCommandBuffer commandBuffer = wgpuCommandEncoderFinish(encoder, &commandBufferDesc);
-		wgpuQueueSubmit(queue, 1, &commandBuffer);
-
-		wgpuSurfacePresent(surface);
-
-		wgpuCommandBufferRelease(commandBuffer);
-		wgpuTextureViewRelease(targetView);
-		
-		wgpuTextureRelease(surfaceTexture.texture);
-		wgpuCommandEncoderRelease(encoder);
-	}
-
-	void initializeBuffers()
-	{
-		std::vector<float> vertexData = {
-			-0.5,	-0.5, 1.0, 0.0, 0.0,
-			+0.5,	-0.5, 0.0, 1.0, 0.0,
-			+0.0,   +0.5, 0.0, 0.0, 1.0
-		};
-
-		vertexCount = static_cast<uint32_t>(vertexData.size() / 5);
-
-		WGPUBufferDescriptor vertexBufferDesc{};
-		vertexBufferDesc.nextInChain = nullptr;
-		vertexBufferDesc.label = "Vertex buffer";
-		vertexBufferDesc.size = vertexData.size() * sizeof(float);
-		vertexBufferDesc.usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex;
-		vertexBufferDesc.mappedAtCreation = false;
-		vertexBuffer = wgpuDeviceCreateBuffer(device, &vertexBufferDesc);
-
-		wgpuQueueWriteBuffer(queue, vertexBuffer, 0, vertexData.data(), vertexBufferDesc.size);
-
-		WGPUCommandEncoderDescriptor encoderDesc{};
-		encoderDesc.nextInChain = nullptr;
-		encoderDesc.label = "Command encoder";
-		WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, &encoderDesc);
-
-		WGPUCommandBuffer command = wgpuCommandEncoderFinish(encoder, nullptr);
-		wgpuCommandEncoderRelease(encoder);
-		wgpuQueueSubmit(queue, 1, &command);
-		wgpuCommandBufferRelease(command);
-	}
-
-	void getAdapter()
-	{
-		surface = glfwGetWGPUSurface(instance, window);
-
-		WGPURequestAdapterOptions adapterOpts{};
-		adapterOpts.nextInChain = nullptr;
-		adapterOpts.compatibleSurface = surface;
-		adapter = requestAdapterSync(instance, adapterOpts);
-		wgpuInstanceRelease(instance);
-
-		if (!adapter)
-		{
-			glfwTerminate();
-			throw std::runtime_error("Couldn't get adapter");
-		}
-
-		LOG_MSG_SUC("\nGot adapter: " << adapter);
-
-		adapterFeatures = {};
-		size_t featureCount = wgpuAdapterEnumerateFeatures(adapter, nullptr);
-		adapterFeatures.resize(featureCount);
-		wgpuAdapterEnumerateFeatures(adapter, adapterFeatures.data());
-
-		adapterProperties = {};
-		adapterProperties.nextInChain = nullptr;
-		wgpuAdapterGetProperties(adapter, &adapterProperties);
-
-		adapterSupportedLimits = {};
-		adapterSupportedLimits.nextInChain = nullptr;
-		wgpuAdapterGetLimits(adapter, &adapterSupportedLimits);
-
-#ifdef DEBUG_MODE
-		logAdapter();
-#endif
-	}
-
-	void getDevice()
-	{
-		WGPURequiredLimits requiredLimits = getRequiredLimits(adapter);
-		WGPUDeviceDescriptor deviceDesc{};
-		deviceDesc.nextInChain = nullptr;
-		deviceDesc.label = "The device";
-		deviceDesc.requiredFeatureCount = 0;
-		deviceDesc.requiredLimits = &requiredLimits;
-		deviceDesc.defaultQueue.label = "Default queue";
-		deviceDesc.defaultQueue.nextInChain = nullptr;
-		deviceDesc.deviceLostCallback =
-			[](WGPUDeviceLostReason arg_DeviceLostReason, char const* arg_Message, void*)
-			{
-				std::string err_msg = "Device lost: reason " + arg_DeviceLostReason;
-				arg_Message ? err_msg += arg_Message : err_msg;
-				LOG_MSG_SUC(err_msg);
-			};
-
-		device = requestDeviceSync(adapter, &deviceDesc);
-		configSurface();
-
-		if (!device)
-		{
-			glfwTerminate();
-			throw std::runtime_error("Could not get device");
-		}
-
-		LOG_MSG_SUC("Got device: " << device);
-		
-		deviceFeatures = {};
-		size_t featureCount = wgpuDeviceEnumerateFeatures(device, nullptr);
-		deviceFeatures.resize(featureCount);
-		wgpuDeviceEnumerateFeatures(device, deviceFeatures.data());
-
-		deviceSupportedLimits = {};
-		deviceSupportedLimits.nextInChain = nullptr;
-		wgpuDeviceGetLimits(device, &deviceSupportedLimits);
-
-#ifdef DEBUG_MODE
-		logDevice();
-#endif
-	}
-
-	void getQueue()
-	{
-		queue = wgpuDeviceGetQueue(device);
-
-		auto onQueueWorkDone =
-			[](WGPUQueueWorkDoneStatus arg_WorkDoneStatus, void*)
-			{
-#ifdef DEBUG_MODE
-				std::cout << "Queue work finished with status: " << arg_WorkDoneStatus;
-#else
-				(void)arg_WorkDoneStatus;
-#endif
-			};
-
-		wgpuQueueOnSubmittedWorkDone(queue, onQueueWorkDone, nullptr);
-	}
-
-	void configSurface() const
+	bool allConverged = true;
+	for (const ResolutionController::CurveResult& result : ResolutionController::simulateLoadCurves(ResolutionController::Settings::fromConfig()))
 	{
-		WGPUSurfaceConfiguration surfaceConfig = {};
-		WGPUTextureFormat textureFormat = wgpuSurfaceGetPreferredFormat(surface, adapter);
-		surfaceConfig.nextInChain = nullptr;
-		surfaceConfig.width = WindowProperties::WINDOW_WIDTH;
-		surfaceConfig.height = WindowProperties::WINDOW_WIDTH;
-		surfaceConfig.format = textureFormat;
-		surfaceConfig.viewFormatCount = 0;
-		surfaceConfig.viewFormats = nullptr;
-		surfaceConfig.usage = WGPUTextureUsage_RenderAttachment;
-		surfaceConfig.device = device;
-		surfaceConfig.presentMode = WGPUPresentMode_Fifo;
-		surfaceConfig.alphaMode = WGPUCompositeAlphaMode_Auto;
-		
-		wgpuSurfaceConfigure(surface, &surfaceConfig);
-	}
-
-	void initializeRenderPipeline()
-	{
-		WGPUShaderModule shaderModule;
-		createShaderModule(shaderModule);
-
-		std::vector<WGPUVertexAttribute> vertexAttrib(2);
-
-		vertexAttrib[0].shaderLocation = 0;
-		vertexAttrib[0].format = WGPUVertexFormat_Float32x2;
-		vertexAttrib[0].offset = 0;
-
-		vertexAttrib[1].shaderLocation = 1;
-		vertexAttrib[1].format = WGPUVertexFormat_Float32x3;
-		vertexAttrib[1].offset = 2 * sizeof(float);
-
-		WGPUVertexBufferLayout vertexBufferLayout{};
-		vertexBufferLayout.attributeCount = 2;
-		vertexBufferLayout.attributes = vertexAttrib.data();
-		vertexBufferLayout.arrayStride = 5 * sizeof(float);
-		vertexBufferLayout.stepMode = WGPUVertexStepMode_Vertex;
-
-		surfaceFormat = wgpuSurfaceGetPreferredFormat(surface, adapter);
-		wgpuAdapterRelease(adapter);
-
-		WGPUBlendState blendState{};
-		blendState.color.srcFactor = WGPUBlendFactor_SrcAlpha;
-		blendState.color.dstFactor = WGPUBlendFactor_OneMinusSrcAlpha;
-		blendState.color.operation = WGPUBlendOperation_Add;
-
-		blendState.alpha.srcFactor = WGPUBlendFactor_Zero;
-		blendState.alpha.dstFactor = WGPUBlendFactor_One;
-		blendState.alpha.operation = WGPUBlendOperation_Add;
-
-		WGPUColorTargetState colorTarget{};
-		colorTarget.format = surfaceFormat;
-		colorTarget.blend = &blendState;
-		colorTarget.writeMask = WGPUColorWriteMask_All;
-
-		WGPURenderPipelineDescriptor pipelineDesc{};
-		pipelineDesc.nextInChain = nullptr;
-		pipelineDesc.vertex.bufferCount = 1;
-		pipelineDesc.vertex.buffers = &vertexBufferLayout;
-		pipelineDesc.vertex.module = shaderModule;
-		pipelineDesc.vertex.entryPoint = "vs_main";
-		pipelineDesc.vertex.constantCount = 0;
-		pipelineDesc.vertex.constants = nullptr;
-
-		pipelineDesc.primitive.topology = WGPUPrimitiveTopology_TriangleList;
-		pipelineDesc.primitive.stripIndexFormat = WGPUIndexFormat_Undefined;
-		pipelineDesc.primitive.frontFace = WGPUFrontFace_CCW;
-		pipelineDesc.primitive.cullMode = WGPUCullMode_None;
-
-		WGPUFragmentState fragmentState{};
-		fragmentState.module = shaderModule;
-		fragmentState.entryPoint = "fs_main";
-		fragmentState.constantCount = 0;
-		fragmentState.constants = nullptr;
-		fragmentState.targetCount = 1;
-		fragmentState.targets = &colorTarget;
-
-		pipelineDesc.fragment = &fragmentState;
-		pipelineDesc.depthStencil = nullptr;
-
-		pipelineDesc.multisample.count = 1;
-		pipelineDesc.multisample.mask = ~0u;
-		pipelineDesc.multisample.alphaToCoverageEnabled = false;
-		
-		pipeline = wgpuDeviceCreateRenderPipeline(device, &pipelineDesc);
+		std::cout << (result.converged ? "converged " : "FAILED    ") << result.name
+			<< ": scale " << result.finalScale
+			<< ", " << result.finalMs << " ms"
+			<< ", last change at frame " << result.settleFrame
+			<< ", " << result.changesAfterSettle << " changes while settled\n";
+		allConverged = allConverged && result.converged;
 	}
 
-	void limitsSetDefault(WGPULimits& limits)
-	{
-		limits.maxBindGroups = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxBindGroupsPlusVertexBuffers = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxBindingsPerBindGroup = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxBufferSize = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxColorAttachmentBytesPerSample = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxColorAttachments = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeInvocationsPerWorkgroup = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeWorkgroupSizeX = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeWorkgroupSizeY = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeWorkgroupSizeZ = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeWorkgroupsPerDimension = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxComputeWorkgroupStorageSize = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxDynamicStorageBuffersPerPipelineLayout = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxDynamicUniformBuffersPerPipelineLayout = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxInterStageShaderComponents = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxInterStageShaderVariables = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxSampledTexturesPerShaderStage = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxSamplersPerShaderStage = WGPU_LIMIT_U32_UNDEFINED;
-		// no maxStorageBufferBindingSize
-		limits.maxStorageBuffersPerShaderStage = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxStorageTexturesPerShaderStage = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxTextureArrayLayers = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxTextureDimension1D = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxTextureDimension2D = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxTextureDimension3D = WGPU_LIMIT_U32_UNDEFINED;
-		// no maxUniformBufferBindingSize
-		limits.maxUniformBuffersPerShaderStage = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxVertexAttributes = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxVertexBufferArrayStride = WGPU_LIMIT_U32_UNDEFINED;
-		limits.maxVertexBuffers = WGPU_LIMIT_U32_UNDEFINED;
-		limits.minStorageBufferOffsetAlignment = WGPU_LIMIT_U32_UNDEFINED;
-		limits.minUniformBufferOffsetAlignment = WGPU_LIMIT_U32_UNDEFINED;
-	}
+	return allConverged;
+}
 
-	void logAdapter()
+bool runPacingSimulation()
+{
+	bool allPassed = true;
+	for (const FramePacer::SimulationResult& result : FramePacer::simulate())
 	{
-#ifdef DEBUG_MODE
-		std::cout << "Adapter features:\n";
-		std::cout << std::hex;
-		for (const WGPUFeatureName feature : adapterFeatures)
-			std::cout << " - 0x" << feature << '\n';
-
-		std::cout << std::dec;
-
-		std::cout << "\nAdapter properties:\n";
-
-		std::cout << " - vendorID: "			<< adapterProperties.vendorID << '\n';
-		std::cout << " - vendorName: "			<< adapterProperties.vendorName << '\n';
-		std::cout << " - architecture: "		<< adapterProperties.architecture << '\n';
-		std::cout << " - name: "				<< adapterProperties.name << '\n';
-		std::cout << " - driverDescription: " 	<< adapterProperties.driverDescription << '\n';
-		std::cout << " - backendType: " 		<< adapterProperties.backendType << '\n';
-
-		std::cout << "\nAdapter limits:\n";
-		
-		std::cout << " - maxTextureDimension1D: " << adapterSupportedLimits.limits.maxTextureDimension1D << '\n';
-		std::cout << " - maxTextureDimension2D: " << adapterSupportedLimits.limits.maxTextureDimension2D << '\n';
-		std::cout << " - maxTextureDimension3D: " << adapterSupportedLimits.limits.maxTextureDimension3D << '\n';
-		std::cout << " - maxTextureArrayLayers: " << adapterSupportedLimits.limits.maxTextureArrayLayers << '\n';
-#endif
+		std::cout << (result.passed ? "passed " : "FAILED ") << result.name
+			<< ": interval " << result.meanIntervalMs << " ms"
+			<< ", interval error p99 " << result.intervalErrorP99Ms << " ms"
+			<< ", start to present " << result.meanLatencyMs << " ms"
+			<< ", " << result.missedDeadlines << " missed\n";
+		allPassed = allPassed && result.passed;
 	}
 
-	void logDevice()
-	{
-#ifdef DEBUG_MODE
-		std::cout << "Device features:\n";
-		std::cout << std::hex;
-
-		for (const WGPUFeatureName feature : deviceFeatures)
-			std::cout << " - 0x" << feature << '\n';
-		
-		std::cout << std::dec;
-
-		std::cout << "\nDevice limits:\n";
-
-		std::cout << " - maxTextureDimension1D: " << deviceSupportedLimits.limits.maxTextureDimension1D << '\n';
-		std::cout << " - maxTextureDimension2D: " << deviceSupportedLimits.limits.maxTextureDimension2D << '\n';
-		std::cout << " - maxTextureDimension3D: " << deviceSupportedLimits.limits.maxTextureDimension3D << '\n';
-		std::cout << " - maxTextureArrayLayers: " << deviceSupportedLimits.limits.maxTextureArrayLayers << '\n';
-#endif
-	}
+	return allPassed;
+}
 
-	std::pair<WGPUSurfaceTexture, WGPUTextureView> getNextSurfaceViewData()
+bool runCapacitySimulation()
+{
+	bool allPassed = true;
+	for (const CapacitySearch::SimulationResult& result : CapacitySearch::simulate(CapacitySearch::Settings::fromConfig()))
 	{
-		WGPUSurfaceTexture surfaceTexture;
-		wgpuSurfaceGetCurrentTexture(surface, &surfaceTexture);
-
-		if (surfaceTexture.status != WGPUSurfaceGetCurrentTextureStatus_Success)
-		{
-			return { surfaceTexture, nullptr };
-		}
-
-		WGPUTextureViewDescriptor viewDescriptor;
-		viewDescriptor.nextInChain = nullptr;
-		viewDescriptor.label = "Surface texture view";
-		viewDescriptor.format = wgpuTextureGetFormat(surfaceTexture.texture);
-		viewDescriptor.dimension = WGPUTextureViewDimension_2D;
-		viewDescriptor.baseMipLevel = 0;
-		viewDescriptor.mipLevelCount = 1;
-		viewDescriptor.baseArrayLayer = 0;
-		viewDescriptor.arrayLayerCount = 1;
-		viewDescriptor.aspect = WGPUTextureAspect_All;
-		WGPUTextureView targetView = wgpuTextureCreateView(surfaceTexture.texture, &viewDescriptor);
-
-		return { surfaceTexture, targetView };
+		std::cout << (result.passed ? "passed " : "FAILED ") << result.name
+			<< ": ceiling " << result.found
+			<< ", expected " << result.expected
+			<< ", " << result.probes << " probes"
+			<< ", " << result.frames << " frames\n";
+		allPassed = allPassed && result.passed;
 	}
 
-	WGPUAdapter requestAdapterSync(WGPUInstance arg_Instance, WGPURequestAdapterOptions arg_RequestAdapterOpts)
-	{
-		struct UserData
-		{
-			WGPUAdapter adapter;
-			bool requestEnded;
-		};
-		UserData userData{};
-		userData.adapter = nullptr;
-		userData.requestEnded = false;
-
-		auto onAdapterRequestEnded =
-			[](WGPURequestAdapterStatus arg_RequestAdapterStatus, WGPUAdapter arg_Adapter, char const* arg_Message, void* arg_UserData)
-			{
-				UserData& userData = *reinterpret_cast<UserData*>(arg_UserData);
-				userData.adapter = nullptr;
-				userData.requestEnded = false;
-
-				if (arg_RequestAdapterStatus == WGPURequestAdapterStatus_Success)
-				{
-					userData.adapter = arg_Adapter;
-					LOG_MSG_SUC("Got adapter successfully");
-				}
-				else
-				{
-					std::string err_msg = "WebGPU Adapter request denied: ";
-					err_msg += arg_Message;
-					throw std::runtime_error(err_msg.c_str());
-				}
-
-				userData.requestEnded = true;
-			};
-
-		wgpuInstanceRequestAdapter(
-			arg_Instance,
-			&arg_RequestAdapterOpts,
-			onAdapterRequestEnded,
-			(void*)&userData
-		);
-
-		assert(userData.requestEnded);
-
-		return userData.adapter;
-	};
-
-	WGPUDevice requestDeviceSync(WGPUAdapter arg_Adapter, WGPUDeviceDescriptor const* arg_DeviceDescriptor)
-	{
-		struct UserData
-		{
-			WGPUDevice device;
-			bool requestEnded;
-		};
-		UserData userData;
-		userData.device = nullptr;
-		userData.requestEnded = false;
-
-		auto onDeviceRequestEnded =
-			[](WGPURequestDeviceStatus arg_RequestDeviceStatus, WGPUDevice arg_Device, char const* arg_Message, void* arg_UserData)
-			{
-				UserData& userData = *reinterpret_cast<UserData*>(arg_UserData);
-
-				if (arg_RequestDeviceStatus == WGPURequestDeviceStatus_Success)
-				{
-					userData.device = arg_Device;
-					LOG_MSG_SUC("\nGot device successfully");
-				}
-				else
-				{
-					std::string err_msg = "WebGPU Device request denied: ";
-					err_msg += arg_Message;
-					throw std::runtime_error(err_msg);
-				}
-
-				userData.requestEnded = true;
-			};
-
-		wgpuAdapterRequestDevice(
-			arg_Adapter,
-			arg_DeviceDescriptor,
-			onDeviceRequestEnded,
-			(void*)&userData
-		);
-
-		assert(userData.requestEnded);
-
-		return userData.device;
-	}
+	return allPassed;
+}
 
-	WGPURequiredLimits getRequiredLimits(WGPUAdapter arg_Adapter)
-	{
-		(void)arg_Adapter;
+// APP_SHADER_RELOAD_STRESS=1: render headlessly through SHADER_RELOAD_REQUESTS shader reloads,
+// each requested once the previous one was swapped in. Fails unless every reload compiled and
+// was swapped in, on frame time spikes, and on leaked shader modules or pipelines.
+//   APP_SHADER_RELOAD_P99_MS  p99 frame time limit, first frames excluded (default 16.7)
+bool runShaderReloadStress()
+{
+	const uint32_t SHADER_RELOAD_REQUESTS = 1000;
+	const size_t WARMUP_FRAMES = 30;
+	// Stops a run whose reloads never finish; each reload normally takes a few frames.
+	const uint64_t MAX_FRAMES_PER_RELOAD = 100;
+
+	Application::Options options = Application::Options::fromConfig();
+	options.headless = true;
+	options.capacitySearch = false;
+	options.frames = static_cast<uint64_t>(SHADER_RELOAD_REQUESTS) * MAX_FRAMES_PER_RELOAD;
+	options.shaderReloadRequests = SHADER_RELOAD_REQUESTS;
+
+	Application app(options);
+	app.run();
 
-		WGPURequiredLimits requiredLimits{};
-		limitsSetDefault(requiredLimits.limits);
+	// The first frames include pipeline creation and first-use costs.
+	const std::vector<double>& frameTimes = app.getFrameTimes();
+	std::vector<double> times(frameTimes.begin() + static_cast<std::ptrdiff_t>(std::min(WARMUP_FRAMES, frameTimes.size())), frameTimes.end());
+	std::sort(times.begin(), times.end());
+	const double p99Ms = times.empty() ? 0.0 : times[times.size() * 99 / 100];
+	const double limitMs = Config::getDouble("APP_SHADER_RELOAD_P99_MS", 16.7);
+
+	const ShaderHotReloader::Stats& stats = app.getShaderReloadStats();
+	const ShaderVariantCache::PipelineCounts& pipelines = app.getPipelineCounts();
+	const bool allSwapped = stats.reloads >= SHADER_RELOAD_REQUESTS && stats.swaps >= SHADER_RELOAD_REQUESTS && stats.failures == 0;
+	const bool noLeaks = stats.modulesCreated == stats.modulesReleased
+		&& stats.pipelinesCreated == stats.pipelinesReleased + stats.swaps
+		&& pipelines.adopted == stats.swaps
+		&& pipelines.released == pipelines.built + pipelines.adopted;
+	const bool passed = allSwapped && noLeaks && p99Ms <= limitMs;
+	std::cout << (passed ? "passed " : "FAILED ") << "shader reload stress"
+		<< ": " << stats.reloads << " reloads"
+		<< ", " << stats.swaps << " swapped in"
+		<< ", " << stats.failures << " rejected"
+		<< ", frame p99 " << p99Ms << " ms (limit " << limitMs << ")"
+		<< ", " << stats.modulesCreated << " modules created, " << stats.modulesReleased << " released"
+		<< ", " << (pipelines.built + stats.pipelinesCreated) << " pipelines created, "
+		<< (pipelines.released + stats.pipelinesReleased) << " released\n";
+
+	return passed;
+}
 
-		requiredLimits.limits.maxVertexAttributes = 2;
-		requiredLimits.limits.maxVertexBufferArrayStride = 1;
-		requiredLimits.limits.maxBufferSize = 5 * 6 * sizeof(float);
-		requiredLimits.limits.maxVertexBufferArrayStride = 5 * sizeof(float);
-		requiredLimits.limits.minStorageBufferOffsetAlignment = adapterSupportedLimits.limits.minStorageBufferOffsetAlignment;
-		requiredLimits.limits.minUniformBufferOffsetAlignment = adapterSupportedLimits.limits.minUniformBufferOffsetAlignment;
-		requiredLimits.limits.maxInterStageShaderComponents = 3;
+int main(int argc, char** argv) try
+{
+	Config::parseCommandLine(argc, argv);
 
-		return requiredLimits;
-	}
-};
+	if (Config::getBool("APP_DYNRES_SIMULATE", false))
+		return runResolutionSimulation() ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (Config::getBool("APP_PACING_SIMULATE", false))
+		return runPacingSimulation() ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (Config::getBool("APP_CAPACITY_SIMULATE", false))
+		return runCapacitySimulation() ? EXIT_SUCCESS : EXIT_FAILURE;
+	if (Config::getBool("APP_SHADER_RELOAD_STRESS", false))
+		return runShaderReloadStress() ? EXIT_SUCCESS : EXIT_FAILURE;
 
-int main() try
-{
 	Application app;
 	app.run();
 
@@ -698,10 +130,7 @@ int main() try
 }
 catch (const std::exception& err)
 {
-#ifdef DEBUG_MODE
-	std::cerr << err.what();
-#else
+	LOG_MSG_ERR(err.what());
 	(void)err;
-#endif
 	return EXIT_FAILURE;
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+struct VertexInput {
+	@location(0) position: vec2f,
+	@location(1) color: vec3f,
+	// Per-instance RectInstance, applied before the per-draw DrawParams.
+	@location(2) instanceCenter: vec2f,
+	@location(3) instanceSize: vec2f,
+	// Rotation in radians, then layer.
+	@location(4) instanceRotationLayer: vec2f,
+	@location(5) instanceColor: vec4f,
+};
+
+struct VertexOutput {
+	@builtin(position) position: vec4f,
+	@location(0) color: vec3f,
+	// Instance alpha, the coverage of aggregated tiles; 1 for single rects.
+	@location(1) alpha: f32,
+}
+
+// Per-draw parameters, see DrawParams in DrawParameters.hxx.
+struct DrawParams {
+	offset: vec2f,
+	scale: vec2f,
+	color: vec4f,
+}
+
+// Per-frame view transform, see CameraParams in DrawParameters.hxx.
+struct CameraParams {
+	matrix: mat2x2f,
+	offset: vec2f,
+	padding: vec2f,
+}
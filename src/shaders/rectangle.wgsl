@@ -0,0 +1,42 @@
+#include "common.wgsl"
+
+// Tuning values, overridable per variant through defines.
+#ifndef BRIGHTNESS
+#define BRIGHTNESS 1.0
+#endif
+#ifndef ALPHA
+#define ALPHA 1.0
+#endif
+
+// The camera group follows the draw parameter group, if there is one.
+#if PUSH_CONSTANTS
+var<push_constant> draw: DrawParams;
+@group(0) @binding(0) var<uniform> camera: CameraParams;
+#else
+@group(0) @binding(0) var<uniform> draw: DrawParams;
+@group(1) @binding(0) var<uniform> camera: CameraParams;
+#endif
+
+@vertex
+fn vs_main(in: VertexInput) -> VertexOutput {
+	var out: VertexOutput;
+	let scaled = in.position * in.instanceSize;
+	let c = cos(in.instanceRotationLayer.x);
+	let s = sin(in.instanceRotationLayer.x);
+	let local = vec2f(c * scaled.x - s * scaled.y, s * scaled.x + c * scaled.y) + in.instanceCenter;
+	let world = local * draw.scale + draw.offset;
+	out.position = vec4f(camera.matrix * world + camera.offset, 0.0, 1.0);
+	out.color = in.color * in.instanceColor.rgb * draw.color.rgb;
+	out.alpha = in.instanceColor.a;
+	return out;
+}
+
+@fragment
+fn fs_main(in: VertexOutput) -> @location(0) vec4f {
+	var color = in.color * BRIGHTNESS;
+#if !SRGB_TARGET
+	// Non-sRGB surface: encode here so colors match what an sRGB target would show.
+	color = pow(color, vec3f(1.0 / 2.2));
+#endif
+	return vec4f(color, ALPHA * in.alpha);
+}
@@ -0,0 +1,33 @@
+// Stretches the scaled region of the offscreen target over the whole surface.
+
+struct UpscaleParams {
+	// Fraction of the source texture covered by the rendered region.
+	uvScale: vec2f,
+	// Last texel center inside that region, so filtering never reads outside it.
+	uvMax: vec2f,
+}
+
+struct FullscreenOutput {
+	@builtin(position) position: vec4f,
+	@location(0) uv: vec2f,
+}
+
+@group(0) @binding(0) var sourceTexture: texture_2d<f32>;
+@group(0) @binding(1) var sourceSampler: sampler;
+@group(0) @binding(2) var<uniform> params: UpscaleParams;
+
+// One triangle covering the screen; no vertex buffer needed.
+@vertex
+fn vs_main(@builtin(vertex_index) index: u32) -> FullscreenOutput {
+	var out: FullscreenOutput;
+	let uv = vec2f(f32((index << 1u) & 2u), f32(index & 2u));
+	out.position = vec4f(uv * vec2f(2.0, -2.0) + vec2f(-1.0, 1.0), 0.0, 1.0);
+	out.uv = uv;
+	return out;
+}
+
+@fragment
+fn fs_main(in: FullscreenOutput) -> @location(0) vec4f {
+	let uv = min(in.uv * params.uvScale, params.uvMax);
+	return textureSample(sourceTexture, sourceSampler, uv);
+}
@@ -0,0 +1,431 @@
+#include "Config.hxx"
+#include "ContentHash.hxx"
+#include "CookedBlob.hxx"
+#include "ImageDecoder.hxx"
+#include "MappedFile.hxx"
+#include "RectListReader.hxx"
+#include "SceneBuilder.hxx"
+#include "ShaderPreprocessor.hxx"
+#include "ShaderVariants.hxx"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// Cooks source assets into files the renderer maps and uses as they are; the `cook` target
+// runs it over src/shaders and src/assets.
+//   asset_cooker <output dir> <source dir>... [--palette=#rrggbb,...] [--scene-chunk-rects=65536]
+// Files directly in each source directory are cooked by extension:
+//   .csv .json            rect lists (see RectListReader) into <stem>.scene, as scene_convert
+//   .qoi .pgm .ppm .pam   images into <stem>.texture blobs, RGBA8 rows padded to 256 bytes
+//   .wgsl                 shaders no other shader includes into <stem>.shader blobs, holding the
+//                         source preprocessed for every 0/1 combination of the flags its
+//                         conditionals test, keyed as ShaderVariantCache looks them up
+// <output dir>/cook.manifest records the content hash of each output's inputs, includes
+// counted, along with their sizes and modification times. Inputs whose size and time are
+// unchanged are not read again; those whose contents are unchanged only update the manifest.
+// Outputs of sources that are gone are removed, and other settings recook everything.
+namespace fs = std::filesystem;
+
+namespace
+{
+	const uint32_t COOKER_VERSION = 1;
+	const char* MANIFEST_NAME = "cook.manifest";
+	// Every flag doubles the variants cooked.
+	const size_t MAX_SHADER_FLAGS = 6;
+
+	enum class AssetKind
+	{
+		Scene,
+		Texture,
+		Shader
+	};
+
+	struct Input
+	{
+		std::string path;
+		uint64_t size;
+		long long modified;
+	};
+
+	struct ManifestEntry
+	{
+		uint64_t hash;
+		std::vector<Input> inputs;
+	};
+
+	using Manifest = std::map<std::string, ManifestEntry>;
+
+	struct Asset
+	{
+		AssetKind kind;
+		std::string source;
+		std::string output;
+	};
+
+	std::string toHex(uint64_t arg_Value)
+	{
+		std::ostringstream text;
+		text << std::hex << arg_Value;
+		return text.str();
+	}
+
+	Input statInput(const std::string& arg_Path)
+	{
+		return { arg_Path, fs::file_size(arg_Path), static_cast<long long>(fs::last_write_time(arg_Path).time_since_epoch().count()) };
+	}
+
+	bool isUnchanged(const std::vector<Input>& arg_Inputs)
+	{
+		for (const Input& input : arg_Inputs)
+		{
+			std::error_code error;
+			if (!fs::is_regular_file(input.path, error)) return false;
+
+			const Input current = statInput(input.path);
+			if (current.size != input.size || current.modified != input.modified) return false;
+		}
+		return true;
+	}
+
+	uint64_t hashInputs(const std::vector<Input>& arg_Inputs)
+	{
+		uint64_t hash = COOKER_VERSION;
+		for (const Input& input : arg_Inputs)
+		{
+			const MappedFile file(input.path);
+			hash = hashContent(file.data(), file.size(), hash);
+		}
+		return hash;
+	}
+
+	// One line of settings, then per output: name, hash, and size, time and path per input,
+	// separated by tabs.
+	Manifest readManifest(const std::string& arg_Path, const std::string& arg_Settings)
+	{
+		Manifest manifest;
+		std::ifstream stream(arg_Path);
+		std::string line;
+		if (!std::getline(stream, line) || line != arg_Settings) return manifest;
+
+		while (std::getline(stream, line))
+		{
+			std::vector<std::string> fields;
+			std::istringstream row(line);
+			for (std::string field; std::getline(row, field, '\t');) fields.push_back(field);
+			if (fields.size() < 2 || (fields.size() - 2) % 3 != 0) continue;
+
+			ManifestEntry& entry = manifest[fields[0]];
+			entry.hash = std::strtoull(fields[1].c_str(), nullptr, 16);
+			for (size_t i = 2; i < fields.size(); i += 3)
+				entry.inputs.push_back({ fields[i + 2], std::strtoull(fields[i].c_str(), nullptr, 10), std::strtoll(fields[i + 1].c_str(), nullptr, 10) });
+		}
+		return manifest;
+	}
+
+	void writeManifest(const std::string& arg_Path, const std::string& arg_Settings, const Manifest& arg_Manifest)
+	{
+		std::ofstream stream(arg_Path, std::ios::trunc);
+		stream << arg_Settings << '\n';
+		for (const auto& entry : arg_Manifest)
+		{
+			stream << entry.first << '\t' << toHex(entry.second.hash);
+			for (const Input& input : entry.second.inputs) stream << '\t' << input.size << '\t' << input.modified << '\t' << input.path;
+			stream << '\n';
+		}
+		if (!stream) throw std::runtime_error("Could not write " + arg_Path);
+	}
+
+	// What the preprocessor directives of a shader and everything it includes refer to,
+	// whether or not the conditionals around them are taken.
+	struct ShaderScan
+	{
+		std::vector<std::string> files;
+		std::set<std::string> tested;
+		std::set<std::string> defined;
+	};
+
+	bool isIdentStart(char arg_Char) { return std::isalpha(static_cast<unsigned char>(arg_Char)) || arg_Char == '_'; }
+	bool isIdentChar(char arg_Char) { return std::isalnum(static_cast<unsigned char>(arg_Char)) || arg_Char == '_'; }
+
+	std::vector<std::string> identifiers(const std::string& arg_Text)
+	{
+		std::vector<std::string> names;
+		for (size_t i = 0; i < arg_Text.size();)
+		{
+			if (!isIdentChar(arg_Text[i]))
+			{
+				++i;
+				continue;
+			}
+
+			// Numbers such as 0x1F are skipped whole.
+			size_t end = i;
+			while (end < arg_Text.size() && isIdentChar(arg_Text[end])) ++end;
+			if (isIdentStart(arg_Text[i])) names.push_back(arg_Text.substr(i, end - i));
+			i = end;
+		}
+		return names;
+	}
+
+	void scanShader(const std::string& arg_Path, ShaderScan& arg_Scan)
+	{
+		const std::string canonical = fs::weakly_canonical(arg_Path).string();
+		if (std::find(arg_Scan.files.begin(), arg_Scan.files.end(), canonical) != arg_Scan.files.end()) return;
+		arg_Scan.files.push_back(canonical);
+
+		std::ifstream stream(arg_Path);
+		if (!stream) throw std::runtime_error("Could not open shader file: " + arg_Path);
+
+		for (std::string line; std::getline(stream, line);)
+		{
+			const size_t hash = line.find_first_not_of(" \t");
+			if (hash == std::string::npos || line[hash] != '#') continue;
+
+			size_t directiveEnd = hash + 1;
+			while (directiveEnd < line.size() && isIdentChar(line[directiveEnd])) ++directiveEnd;
+			const std::string directive = line.substr(hash + 1, directiveEnd - hash - 1);
+			const std::string rest = line.substr(directiveEnd);
+
+			if (directive == "if" || directive == "elif" || directive == "ifdef" || directive == "ifndef")
+			{
+				for (const std::string& name : identifiers(rest))
+					if (name != "defined") arg_Scan.tested.insert(name);
+			}
+			else if (directive == "define")
+			{
+				const std::vector<std::string> names = identifiers(rest);
+				if (!names.empty()) arg_Scan.defined.insert(names.front());
+			}
+			else if (directive == "include")
+			{
+				const size_t open = rest.find('"');
+				const size_t close = rest.rfind('"');
+				if (open != std::string::npos && close > open)
+					scanShader((fs::path(arg_Path).parent_path() / rest.substr(open + 1, close - open - 1)).string(), arg_Scan);
+			}
+		}
+	}
+
+	void cookScene(const Asset& arg_Asset, const std::vector<uint32_t>& arg_Palette)
+	{
+		RectListReader::Result source = RectListReader::readFile(arg_Asset.source, arg_Palette);
+		if (source.rects.size() > UINT32_MAX) throw std::runtime_error("Scene files hold at most 2^32 - 1 rects");
+
+		SceneBuilder builder(SceneBuilder::Settings::fromConfig());
+		builder.setPalette(std::move(source.palette));
+
+		// Written beside the output and renamed over it, as cooked blobs are.
+		const std::string temporary = arg_Asset.output + ".tmp";
+		builder.write(source.rects, temporary);
+		fs::rename(temporary, arg_Asset.output);
+	}
+
+	void cookTexture(const Asset& arg_Asset, uint64_t arg_Hash)
+	{
+		const MappedFile file(arg_Asset.source);
+		const ImageDecoder::Info info = ImageDecoder::probe(file.data(), file.size());
+
+		CookedFormat::Header header{};
+		header.type = CookedFormat::BlobType::Texture;
+		header.sourceHash = arg_Hash;
+		header.width = info.width;
+		header.height = info.height;
+		header.bytesPerRow = static_cast<uint32_t>((info.width * 4 + CookedFormat::PAYLOAD_ALIGNMENT - 1) / CookedFormat::PAYLOAD_ALIGNMENT * CookedFormat::PAYLOAD_ALIGNMENT);
+
+		std::vector<uint8_t> texels(static_cast<size_t>(header.bytesPerRow) * info.height);
+		ImageDecoder::decode(file.data(), file.size(), texels.data(), header.bytesPerRow);
+		writeCookedBlob(arg_Asset.output, header, texels.data(), texels.size());
+	}
+
+	void cookShader(const Asset& arg_Asset, const ShaderScan& arg_Scan, uint64_t arg_Hash)
+	{
+		std::vector<std::string> flags;
+		std::set_difference(arg_Scan.tested.begin(), arg_Scan.tested.end(), arg_Scan.defined.begin(), arg_Scan.defined.end(), std::back_inserter(flags));
+		if (flags.size() > MAX_SHADER_FLAGS)
+			throw std::runtime_error(arg_Asset.source + " tests " + std::to_string(flags.size()) + " flags, more than the " + std::to_string(MAX_SHADER_FLAGS) + " cooked");
+
+		std::vector<std::pair<std::string, std::string>> variants;
+		for (uint32_t combination = 0; combination < 1u << flags.size(); ++combination)
+		{
+			ShaderVariantKey key;
+			for (size_t flag = 0; flag < flags.size(); ++flag) key.defines[flags[flag]] = combination >> flag & 1 ? "1" : "0";
+
+			ShaderPreprocessor preprocessor(key.defines);
+			variants.emplace_back(key.moduleKey(), preprocessor.process(arg_Asset.source));
+		}
+
+		// Records first, then each key and zero-terminated source.
+		std::vector<CookedFormat::ShaderVariant> records(variants.size());
+		std::vector<uint8_t> payload(records.size() * sizeof(CookedFormat::ShaderVariant));
+		auto append = [&](const std::string& arg_Text)
+		{
+			const uint64_t offset = payload.size();
+			payload.insert(payload.end(), arg_Text.begin(), arg_Text.end());
+			return offset;
+		};
+		for (size_t i = 0; i < variants.size(); ++i)
+		{
+			records[i].keySize = static_cast<uint32_t>(variants[i].first.size());
+			records[i].keyOffset = append(variants[i].first);
+			records[i].sourceSize = static_cast<uint32_t>(variants[i].second.size());
+			records[i].sourceOffset = append(variants[i].second);
+			payload.push_back('\0');
+		}
+		std::memcpy(payload.data(), records.data(), records.size() * sizeof(CookedFormat::ShaderVariant));
+
+		CookedFormat::Header header{};
+		header.type = CookedFormat::BlobType::Shader;
+		header.sourceHash = arg_Hash;
+		header.variantCount = static_cast<uint32_t>(records.size());
+		writeCookedBlob(arg_Asset.output, header, payload.data(), payload.size());
+	}
+
+	// Cookable files directly in arg_Directory, in name order; shaders other shaders include
+	// are left out.
+	void collectAssets(const std::string& arg_Directory, const std::string& arg_OutputDirectory, std::vector<Asset>& arg_Assets)
+	{
+		std::vector<fs::path> files;
+		for (const fs::directory_entry& entry : fs::directory_iterator(arg_Directory))
+			if (entry.is_regular_file()) files.push_back(entry.path());
+		std::sort(files.begin(), files.end());
+
+		std::set<std::string> included;
+		for (const fs::path& file : files)
+		{
+			if (file.extension() != ".wgsl") continue;
+
+			ShaderScan scan;
+			scanShader(file.string(), scan);
+			included.insert(scan.files.begin() + 1, scan.files.end());
+		}
+
+		for (const fs::path& file : files)
+		{
+			const std::string extension = file.extension().string();
+			const std::string stem = (fs::path(arg_OutputDirectory) / file.stem()).string();
+			if (extension == ".csv" || extension == ".json")
+				arg_Assets.push_back({ AssetKind::Scene, file.string(), stem + ".scene" });
+			else if (extension == ".qoi" || extension == ".pgm" || extension == ".ppm" || extension == ".pam")
+				arg_Assets.push_back({ AssetKind::Texture, file.string(), stem + ".texture" });
+			else if (extension == ".wgsl" && included.count(fs::weakly_canonical(file).string()) == 0)
+				arg_Assets.push_back({ AssetKind::Shader, file.string(), stem + ".shader" });
+		}
+	}
+}
+
+int main(int argc, char** argv) try
+{
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i)
+		if (std::string(argv[i]).compare(0, 2, "--") != 0) paths.push_back(argv[i]);
+	Config::parseCommandLine(argc, argv);
+
+	if (paths.size() < 2)
+	{
+		std::cerr << "usage: asset_cooker <output dir> <source dir>... [--palette=#rrggbb,...] [--scene-chunk-rects=65536]\n";
+		return 2;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::string outputDirectory = paths[0];
+	fs::create_directories(outputDirectory);
+
+	const std::string paletteText = Config::getString("APP_PALETTE");
+	const std::vector<uint32_t> palette = RectListReader::parsePalette(paletteText);
+	const std::string settings = "asset_cooker " + std::to_string(COOKER_VERSION) + " palette=" + paletteText
+		+ " chunk-rects=" + std::to_string(SceneBuilder::Settings::fromConfig().chunkRects);
+
+	const std::string manifestPath = (fs::path(outputDirectory) / MANIFEST_NAME).string();
+	const Manifest previous = readManifest(manifestPath, settings);
+	Manifest manifest;
+
+	std::vector<Asset> assets;
+	for (size_t i = 1; i < paths.size(); ++i)
+	{
+		if (fs::is_directory(paths[i])) collectAssets(paths[i], outputDirectory, assets);
+		else std::cout << "Skipping " << paths[i] << ": no such directory\n";
+	}
+
+	size_t cooked = 0;
+	size_t current = 0;
+	for (const Asset& asset : assets)
+	{
+		const std::string name = fs::path(asset.output).filename().string();
+		if (manifest.count(name) != 0) throw std::runtime_error(asset.source + " cooks to " + name + ", as an earlier source does");
+
+		const auto found = previous.find(name);
+		const bool outputExists = fs::exists(asset.output);
+		if (found != previous.end() && outputExists && isUnchanged(found->second.inputs))
+		{
+			manifest[name] = found->second;
+			++current;
+			continue;
+		}
+
+		ShaderScan scan;
+		if (asset.kind == AssetKind::Shader) scanShader(asset.source, scan);
+		else scan.files.push_back(asset.source);
+
+		ManifestEntry entry{};
+		for (const std::string& file : scan.files) entry.inputs.push_back(statInput(file));
+		entry.hash = hashInputs(entry.inputs);
+
+		if (found != previous.end() && outputExists && found->second.hash == entry.hash)
+		{
+			manifest[name] = entry;
+			++current;
+			continue;
+		}
+
+		switch (asset.kind)
+		{
+		case AssetKind::Scene:
+			cookScene(asset, palette);
+			break;
+		case AssetKind::Texture:
+			cookTexture(asset, entry.hash);
+			break;
+		case AssetKind::Shader:
+			cookShader(asset, scan, entry.hash);
+			break;
+		}
+		manifest[name] = entry;
+		++cooked;
+		std::cout << "Cooked " << asset.source << " -> " << asset.output << '\n';
+	}
+
+	size_t removed = 0;
+	for (const auto& entry : previous)
+	{
+		if (manifest.count(entry.first) != 0) continue;
+
+		std::error_code error;
+		if (fs::remove(fs::path(outputDirectory) / entry.first, error)) ++removed;
+	}
+
+	writeManifest(manifestPath, settings, manifest);
+
+	std::cout << cooked << " cooked, " << current << " up to date, " << removed << " removed in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+	return EXIT_SUCCESS;
+}
+catch (const std::exception& err)
+{
+	std::cerr << err.what() << '\n';
+	return 2;
+}
@@ -0,0 +1,87 @@
+#include "Config.hxx"
+#include "RectListReader.hxx"
+#include "SceneBuilder.hxx"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Converts a rect list into a scene file for APP_SCENE_FILE.
+//   scene_convert <input.csv|input.json> <output.scene> [--palette=#rrggbb,...] [--scene-chunk-rects=65536]
+//   scene_convert --generate=N <output.scene>
+// See RectListReader for the input formats; --palette resolves color indices in CSV rows.
+namespace
+{
+	// The generated scene of the scene workload, at rest.
+	std::vector<RectInstance> generate(size_t arg_Count)
+	{
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const float side = 2.0f / std::sqrt(static_cast<float>(arg_Count));
+
+		std::vector<RectInstance> rects(arg_Count);
+		for (size_t i = 0; i < arg_Count; ++i)
+		{
+			RectInstance& rect = rects[i];
+			rect.center[0] = unit(random) * 2.0f - 1.0f;
+			rect.center[1] = unit(random) * 2.0f - 1.0f;
+			rect.size[0] = side * (0.5f + unit(random));
+			rect.size[1] = side * (0.5f + unit(random));
+			rect.rotation = unit(random) * 6.2831853f;
+			rect.layer = static_cast<float>(i) / static_cast<float>(arg_Count);
+			rect.color = packColor(unit(random), unit(random), unit(random), 1.0f);
+		}
+		return rects;
+	}
+}
+
+int main(int argc, char** argv) try
+{
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i)
+		if (std::string(argv[i]).compare(0, 2, "--") != 0) paths.push_back(argv[i]);
+	Config::parseCommandLine(argc, argv);
+
+	const long long generated = Config::getInt("APP_GENERATE", 0);
+	if (paths.size() != (generated > 0 ? 1u : 2u))
+	{
+		std::cerr << "usage: scene_convert <input.csv|input.json> <output.scene> [--palette=#rrggbb,...] [--scene-chunk-rects=65536]\n"
+			<< "       scene_convert --generate=N <output.scene>\n";
+		return 2;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	SceneBuilder builder(SceneBuilder::Settings::fromConfig());
+	std::vector<RectInstance> rects;
+	if (generated > 0)
+	{
+		rects = generate(static_cast<size_t>(generated));
+	}
+	else
+	{
+		RectListReader::Result source = RectListReader::readFile(paths[0], RectListReader::parsePalette(Config::getString("APP_PALETTE")));
+		rects = std::move(source.rects);
+		builder.setPalette(std::move(source.palette));
+	}
+	if (rects.size() > UINT32_MAX) throw std::runtime_error("Scene files hold at most 2^32 - 1 rects");
+	const auto read = std::chrono::steady_clock::now();
+
+	const SceneBuilder::Stats stats = builder.write(rects, paths.back());
+	const auto written = std::chrono::steady_clock::now();
+
+	std::cout << paths.back() << ": " << stats.rects << " rects, " << stats.levels << " levels, " << stats.chunks << " chunks, "
+		<< stats.bytes << " bytes; read " << std::chrono::duration<double, std::milli>(read - start).count() << " ms, written "
+		<< std::chrono::duration<double, std::milli>(written - read).count() << " ms\n";
+	return EXIT_SUCCESS;
+}
+catch (const std::exception& err)
+{
+	std::cerr << err.what() << '\n';
+	return 2;
+}